@@ -19,9 +19,11 @@
 #include "jamsym.h"
 #include "jamstack.h"
 #include "jamheap.h"
+#include "jamjtag.h"
 #include "jamutil.h"
 #include "jamcomp.h"
 #include "jamarray.h"
+#include "jamctx.h"
 
 /*
 *	Table of names of Boolean data representation schemes
@@ -227,158 +229,6 @@ JAM_RETURN_TYPE jam_extract_bool_comma_sep
 /****************************************************************************/
 /*																			*/
 
-JAM_RETURN_TYPE jam_extract_bool_binary
-(
-	JAMS_HEAP_RECORD *heap_record,
-	char *statement_buffer
-)
-
-/*																			*/
-/*	Description:	Extracts Boolean array data from statement buffer.		*/
-/*					Works on data in binary (001100100101) representation.	*/
-/*																			*/
-/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
-/*																			*/
-/****************************************************************************/
-{
-	int index = 0;
-	long address = 0L;
-	long dimension = heap_record->dimension;
-	JAM_RETURN_TYPE status = JAMC_SUCCESS;
-	long *heap_data = &heap_record->data[0];
-
-	for (address = 0L; (status == JAMC_SUCCESS) && (address < dimension);
-		++address)
-	{
-		while ((jam_isspace(statement_buffer[index])) &&
-			(index < JAMC_MAX_STATEMENT_LENGTH))
-		{
-			++index;	/* skip over white space */
-		}
-
-		if (statement_buffer[index] == '0')
-		{
-			/* clear a single bit */
-			heap_data[address >> 5] &=
-				(~(unsigned long)(1L << (address & 0x1f)));
-		}
-		else if (statement_buffer[index] == '1')
-		{
-			/* set a single bit */
-			heap_data[address >> 5] |= (1L << (address & 0x1f));
-		}
-		else
-		{
-			status = JAMC_SYNTAX_ERROR;
-		}
-
-		++index;
-	}
-
-	if (status == JAMC_SUCCESS)
-	{
-		while ((jam_isspace(statement_buffer[index])) &&
-			(index < JAMC_MAX_STATEMENT_LENGTH))
-		{
-			++index;	/* skip over white space */
-		}
-
-		if (statement_buffer[index] != JAMC_SEMICOLON_CHAR)
-		{
-			status = JAMC_SYNTAX_ERROR;
-		}
-	}
-
-	return (status);
-}
-
-/****************************************************************************/
-/*																			*/
-
-JAM_RETURN_TYPE jam_extract_bool_hex
-(
-	JAMS_HEAP_RECORD *heap_record,
-	char *statement_buffer
-)
-
-/*																			*/
-/*	Description:	Extracts Boolean array data from statement buffer.		*/
-/*					Works on data in hexadecimal (3BA97C0F) representation.	*/
-/*																			*/
-/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
-/*																			*/
-/****************************************************************************/
-{
-	int index = 0;
-	int ch = 0;
-	long data = 0L;
-	long nibble = 0L;
-	long nibbles = 0L;
-	JAM_RETURN_TYPE status = JAMC_SUCCESS;
-	long *heap_data = &heap_record->data[0];
-
-	/* compute number of hex digits expected */
-	nibbles = (heap_record->dimension >> 2) +
-		((heap_record->dimension & 3) ? 1 : 0);
-
-	for (nibble = 0L; (status == JAMC_SUCCESS) && (nibble < nibbles); ++nibble)
-	{
-		while ((jam_isspace(statement_buffer[index])) &&
-			(index < JAMC_MAX_STATEMENT_LENGTH))
-		{
-			++index;	/* skip over white space */
-		}
-
-		ch = (int) statement_buffer[index];
-
-		if ((ch >= 'A') && (ch <= 'F'))
-		{
-			data = (long) (ch + 10 - 'A');
-		}
-		else if ((ch >= 'a') && (ch <= 'f'))
-		{
-			data = (long) (ch + 10 - 'a');
-		}
-		else if ((ch >= '0') && (ch <= '9'))
-		{
-			data = (long) (ch - '0');
-		}
-		else
-		{
-			status = JAMC_SYNTAX_ERROR;
-		}
-
-		if (status == JAMC_SUCCESS)
-		{
-			/* modify four bits of data in the array */
-			heap_data[nibble >> 3] = (heap_data[nibble >> 3] & 
-				(~(unsigned long) (15L << ((nibble & 7) << 2)))) |
-				(data << ((nibble & 7) << 2));
-		}
-
-		++index;
-	}
-
-	if (status == JAMC_SUCCESS)
-	{
-		while ((jam_isspace(statement_buffer[index])) &&
-			(index < JAMC_MAX_STATEMENT_LENGTH))
-		{
-			++index;	/* skip over white space */
-		}
-
-		if (statement_buffer[index] != JAMC_SEMICOLON_CHAR)
-		{
-			status = JAMC_SYNTAX_ERROR;
-		}
-	}
-
-	return (status);
-}
-
-/****************************************************************************/
-/*																			*/
-
 int jam_6bit_char(int ch)
 
 /*																			*/
@@ -450,336 +300,67 @@ BOOL jam_rlc_key_char
 /****************************************************************************/
 /*																			*/
 
-JAM_RETURN_TYPE jam_extract_bool_run_length
-(
-	JAMS_HEAP_RECORD *heap_record,
-	char *statement_buffer
-)
+int jam_get_real_char(void)
 
 /*																			*/
-/*	Description:	Extracts Boolean array data from statement buffer.		*/
-/*					Works on data encoded using RLC (run-length compressed)	*/
-/*					representation.											*/
+/*	Description:	Gets next character from input stream, eliminating		*/
+/*					white space and comments.								*/
 /*																			*/
-/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*	Returns:		Character code, or EOF if no characters available		*/
 /*																			*/
 /****************************************************************************/
 {
-	int index = 0;
-	int index2 = 0;
-	int count_index = 0;
-	int count_size = 0;
-	int value = 0;
-	long bit = 0L;
-	long count = 0L;
-	long address = 0L;
-	long dimension = heap_record->dimension;
-	JAME_RLC_BLOCK_TYPE block_type = JAM_CONSTANT_ZEROS;
+	int ch = 0;
+	BOOL comment = FALSE;
+	BOOL found = FALSE;
 	JAM_RETURN_TYPE status = JAMC_SUCCESS;
-	long *heap_data = &heap_record->data[0];
 
-	/* remove all white space */
-	while (statement_buffer[index] != JAMC_NULL_CHAR)
+	while ((status == JAMC_SUCCESS) && (!found))
 	{
-		if (!jam_isspace(statement_buffer[index]))
+		ch = jam_getc();
+
+		if ((!comment) && (ch == JAMC_COMMENT_CHAR))
 		{
-			statement_buffer[index2] = statement_buffer[index];
-			++index2;
+			/* beginning of comment */
+			comment = TRUE;
 		}
-		++index;
-	}
-	statement_buffer[index2] = JAMC_NULL_CHAR;
 
-	index = 0;
-	while ((status == JAMC_SUCCESS) && (address < dimension))
-	{
-		if (jam_rlc_key_char(statement_buffer[index], &block_type, &count_size))
+		if (!comment)
 		{
-			++index;
-
-			count = 0L;
-			for (count_index = 0; count_index < count_size; ++count_index)
-			{
-				count <<= 6;
-				value = jam_6bit_char(statement_buffer[index]);
-				if (value == -1)
-				{
-					status = JAMC_SYNTAX_ERROR;
-				}
-				else
-				{
-					count |= value;
-				}
-				++index;
-			}
-
-			if (status == JAMC_SUCCESS)
+			if (!jam_isspace((char) ch))
 			{
-				switch (block_type)
-				{
-				case JAM_CONSTANT_ZEROS:
-					for (bit = 0; bit < count; bit++)
-					{
-						/* add zeros to array */
-						heap_data[address >> 5] &=
-							~(unsigned long) (1L << (address & 0x1f));
-						++address;
-					}
-					break;
-
-				case JAM_CONSTANT_ONES:
-					for (bit = 0; bit < count; bit++)
-					{
-						/* add ones to array */
-						heap_data[address >> 5] |= (1L << (address & 0x1f));
-						++address;
-					}
-					break;
-
-				case JAM_RANDOM:
-					for (bit = 0; bit < count; bit++)
-					{
-						/* add random data to array */
-						value = jam_6bit_char(statement_buffer[index + (bit / 6)]);
-						if (value == -1)
-						{
-							status = JAMC_SYNTAX_ERROR;
-						}
-						else if (value & (1 << (bit % 6)))
-						{
-							heap_data[address >> 5] |= (1L << (address & 0x1f));
-						}
-						else
-						{
-							heap_data[address >> 5] &=
-								~(unsigned long) (1L << (address & 0x1f));
-						}
-						++address;
-					}
-					index = index + (int)((count / 6) + ((count % 6) ? 1 : 0));
-					break;
-
-				default:
-					status = JAMC_SYNTAX_ERROR;
-					break;
-				}
+				found = TRUE;
 			}
 		}
-		else
+
+		if (ch == EOF)
 		{
-			/* unrecognized key character */
-			status = JAMC_SYNTAX_ERROR;
+			/* end of file */
+			status = JAMC_UNEXPECTED_END;
 		}
-	}
-
-	if ((status == JAMC_SUCCESS) &&
-		(statement_buffer[index] != JAMC_SEMICOLON_CHAR))
-	{
-		status = JAMC_SYNTAX_ERROR;
-	}
 
-	if ((status == JAMC_SUCCESS) && (address != dimension))
-	{
-		status = JAMC_SYNTAX_ERROR;
+		if (comment &&
+			((ch == JAMC_NEWLINE_CHAR) || (ch == JAMC_RETURN_CHAR)))
+		{
+			/* end of comment */
+			comment = FALSE;
+		}
 	}
 
-	return (status);
+	return (ch);
 }
 
 /****************************************************************************/
 /*																			*/
 
-JAM_RETURN_TYPE jam_extract_bool_compressed
+JAM_RETURN_TYPE jam_read_bool_comma_sep
 (
-	JAMS_HEAP_RECORD *heap_record,
-	char *statement_buffer
+	JAMS_HEAP_RECORD *heap_record
 )
 
 /*																			*/
-/*	Description:	Extracts Boolean array data from statement buffer.		*/
-/*					Works on data encoded using ACA representation.			*/
-/*																			*/
-/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
-/*																			*/
-/****************************************************************************/
-{
-	int bit = 0;
-	int word = 0;
-	int value = 0;
-	int index = 0;
-	int index2 = 0;
-	long uncompressed_length = 0L;
-	char *ch_data = NULL;
-	long out_size = 0L;
-	long address = 0L;
-	long *heap_data = &heap_record->data[0];
-	JAM_RETURN_TYPE status = JAMC_SUCCESS;
-
-	/* remove all white space */
-	while (statement_buffer[index] != JAMC_NULL_CHAR)
-	{
-		if (!jam_isspace(statement_buffer[index]))
-		{
-			statement_buffer[index2] = statement_buffer[index];
-			++index2;
-		}
-		++index;
-	}
-	statement_buffer[index2] = JAMC_NULL_CHAR;
-
-	/* convert 6-bit encoded characters to binary -- in the same buffer */
-	index = 0;
-	while ((status == JAMC_SUCCESS) &&
-		(statement_buffer[index] != JAMC_NULL_CHAR) &&
-		(statement_buffer[index] != JAMC_SEMICOLON_CHAR))
-	{
-		value = jam_6bit_char(statement_buffer[index]);
-		statement_buffer[index] = 0;
-
-		if (value == -1)
-		{
-			status = JAMC_SYNTAX_ERROR;
-		}
-		else
-		{
-			for (bit = 0; bit < 6; ++bit)
-			{
-				if (value & (1 << (bit % 6)))
-				{
-					statement_buffer[address >> 3] |= (1L << (address & 7));
-				}
-				else
-				{
-					statement_buffer[address >> 3] &=
-						~(unsigned int) (1 << (address & 7));
-				}
-				++address;
-			}
-		}
-
-		++index;
-	}
-
-	if ((status == JAMC_SUCCESS) &&
-		(statement_buffer[index] != JAMC_SEMICOLON_CHAR))
-	{
-		status = JAMC_SYNTAX_ERROR;
-	}
-
-	/*
-	*	We need two memory buffers:
-	*
-	*	in   (length of compressed bitstream)
-	*	out  (length of uncompressed bitstream)
-	*
-	*	The statement buffer is re-used for the "in" buffer.  The "out"
-	*	buffer is inside the heap record.
-	*/
-
-	if (status == JAMC_SUCCESS)
-	{
-		/*
-		*	Uncompress the data
-		*/
-		out_size = (heap_record->dimension >> 3) +
-			((heap_record->dimension & 7) ? 1 : 0);
-
-		uncompressed_length = jam_uncompress(
-			statement_buffer, 
-			(address >> 3) + ((address & 7) ? 1 : 0),
-			(char *)heap_data,
-			out_size,
-			jam_version);
-
-		if (uncompressed_length != out_size)
-		{
-			status = JAMC_SYNTAX_ERROR;
-		}
-		else
-		{
-			/* convert data from bytes into 32-bit words */
-			out_size = (heap_record->dimension >> 5) +
-				((heap_record->dimension & 0x1f) ? 1 : 0);
-			ch_data = (char *)heap_data;
-
-			for (word = 0; word < out_size; ++word)
-			{
-				heap_data[word] =
-					((((long) ch_data[(word * 4) + 3]) & 0xff) << 24L) |
-					((((long) ch_data[(word * 4) + 2]) & 0xff) << 16L) |
-					((((long) ch_data[(word * 4) + 1]) & 0xff) << 8L) |
-					(((long) ch_data[word * 4]) & 0xff);
-			}
-		}
-	}
-
-	return (status);
-}
-
-/****************************************************************************/
-/*																			*/
-
-int jam_get_real_char(void)
-
-/*																			*/
-/*	Description:	Gets next character from input stream, eliminating		*/
-/*					white space and comments.								*/
-/*																			*/
-/*	Returns:		Character code, or EOF if no characters available		*/
-/*																			*/
-/****************************************************************************/
-{
-	int ch = 0;
-	BOOL comment = FALSE;
-	BOOL found = FALSE;
-	JAM_RETURN_TYPE status = JAMC_SUCCESS;
-
-	while ((status == JAMC_SUCCESS) && (!found))
-	{
-		ch = jam_getc();
-
-		if ((!comment) && (ch == JAMC_COMMENT_CHAR))
-		{
-			/* beginning of comment */
-			comment = TRUE;
-		}
-
-		if (!comment)
-		{
-			if (!jam_isspace((char) ch))
-			{
-				found = TRUE;
-			}
-		}
-
-		if (ch == EOF)
-		{
-			/* end of file */
-			status = JAMC_UNEXPECTED_END;
-		}
-
-		if (comment &&
-			((ch == JAMC_NEWLINE_CHAR) || (ch == JAMC_RETURN_CHAR)))
-		{
-			/* end of comment */
-			comment = FALSE;
-		}
-	}
-
-	return (ch);
-}
-
-/****************************************************************************/
-/*																			*/
-
-JAM_RETURN_TYPE jam_read_bool_comma_sep
-(
-	JAMS_HEAP_RECORD *heap_record
-)
-
-/*																			*/
-/*	Description:	Reads Boolean array data directly from input stream.	*/
-/*					Works on data in comma separated representation.		*/
+/*	Description:	Reads Boolean array data directly from input stream.	*/
+/*					Works on data in comma separated representation.		*/
 /*																			*/
 /*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
 /*																			*/
@@ -1232,38 +813,1230 @@ JAM_RETURN_TYPE jam_read_bool_compressed
 		}
 	}
 
-	if (done && (status == JAMC_SUCCESS))
+	if (done && (status == JAMC_SUCCESS))
+	{
+		/*
+		*	Uncompress the data
+		*/
+		in_size = (address >> 3) + ((address & 7) ? 1 : 0);
+		uncompressed_length = jam_uncompress(
+			in, in_size, (char *)heap_data, out_size, jam_version);
+
+		if (uncompressed_length != out_size)
+		{
+			status = JAMC_SYNTAX_ERROR;
+		}
+		else
+		{
+			/* convert data from bytes into 32-bit words */
+			out_size = (heap_record->dimension >> 5) +
+				((heap_record->dimension & 0x1f) ? 1 : 0);
+			ch_data = (char *)heap_data;
+
+			/* last word first -- a long may be wider than its four bytes */
+			for (word = out_size - 1; word >= 0; --word)
+			{
+				heap_data[word] =
+					((((long) ch_data[(word * 4) + 3]) & 0xff) << 24L) |
+					((((long) ch_data[(word * 4) + 2]) & 0xff) << 16L) |
+					((((long) ch_data[(word * 4) + 1]) & 0xff) << 8L) |
+					(((long) ch_data[word * 4]) & 0xff);
+			}
+		}
+	}
+
+	if (in != NULL) jam_free_temp_workspace(in);
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_find_bool_data_position
+(
+	JAME_BOOLEAN_REP representation,
+	long statement_position,
+	long *data_position
+)
+
+/*																			*/
+/*	Description:	Finds the position in the input file of the				*/
+/*					initialization data of a Boolean array, by reading		*/
+/*					the declaration statement again from its beginning.		*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	int ch = 0;
+	long position = 0L;
+	BOOL done = FALSE;
+	BOOL comment = FALSE;
+	BOOL found_equal = FALSE;
+	BOOL found_space = FALSE;
+	BOOL found_keyword = FALSE;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	*data_position = 0L;
+
+	if (jam_seek(statement_position) == 0)
+	{
+		position = statement_position;
+	}
+	else status = JAMC_IO_ERROR;
+
+	while ((status == JAMC_SUCCESS) && !done)
+	{
+		ch = jam_getc();
+
+		if ((!comment) && (ch == JAMC_COMMENT_CHAR))
+		{
+			/* beginning of comment */
+			comment = TRUE;
+		}
+
+		if ((!comment) && (!found_equal) && (ch == JAMC_EQUAL_CHAR))
+		{
+			/* found the equal sign */
+			found_equal = TRUE;
+		}
+
+		if ((!comment) && found_equal && (!found_space) &&
+			jam_isspace((char)ch))
+		{
+			/* found the space after the equal sign */
+			found_space = TRUE;
+		}
+
+		if ((!comment) && found_equal && found_space)
+		{
+			if (representation == JAM_BOOL_COMMA_SEP)
+			{
+				if (jam_isdigit((char)ch))
+				{
+					/* found the first character of the data area */
+					done = TRUE;
+					*data_position = position;
+				}
+			}
+			else	/* other representations */
+			{
+				if ((jam_version == 2) && (!found_keyword) &&
+					((ch == JAMC_POUND_CHAR) ||
+					(ch == JAMC_DOLLAR_CHAR) ||
+					(ch == JAMC_AT_CHAR)))
+				{
+					found_keyword = TRUE;
+					done = TRUE;
+					*data_position = position + 1;
+				}
+
+				if ((jam_version != 2) && (!found_keyword) &&
+					(jam_isalpha((char)ch)))
+				{
+					/* found the first char of the representation keyword */
+					found_keyword = TRUE;
+				}
+
+				if ((jam_version != 2) && found_keyword &&
+					(jam_isspace((char)ch)))
+				{
+					/* found the first character of the data area */
+					done = TRUE;
+					*data_position = position;
+				}
+			}
+
+		}
+
+		if ((!comment) && (ch == JAMC_SEMICOLON_CHAR))
+		{
+			/* end of statement */
+			done = TRUE;
+		}
+
+		if (ch == EOF)
+		{
+			/* end of file */
+			done = TRUE;
+			status = JAMC_UNEXPECTED_END;
+		}
+
+		if (comment &&
+			((ch == JAMC_NEWLINE_CHAR) || (ch == JAMC_RETURN_CHAR)))
+		{
+			/* end of comment */
+			comment = FALSE;
+		}
+
+		++position;	/* position of next character to be read */
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+int jam_get_data_char
+(
+	char *program,
+	long *position
+)
+
+/*																			*/
+/*	Description:	Gets the next character of array data, eliminating		*/
+/*					white space and comments, as jam_get_real_char()		*/
+/*					does.  If program is not NULL, the character is taken	*/
+/*					from the program in memory at the given position,		*/
+/*					which is moved on, and the file is not read.			*/
+/*																			*/
+/*	Returns:		Character code, or EOF if no characters available		*/
+/*																			*/
+/****************************************************************************/
+{
+	int ch = 0;
+	BOOL comment = FALSE;
+	BOOL found = FALSE;
+
+	if (program == NULL)
+	{
+		ch = jam_get_real_char();
+	}
+
+	while ((program != NULL) && (!found))
+	{
+		ch = (*position < jam_program_size) ?
+			(int) program[(*position)++] : EOF;
+
+		if (ch == JAMC_COMMENT_CHAR)
+		{
+			/* beginning of comment */
+			comment = TRUE;
+		}
+		else if ((ch == JAMC_NEWLINE_CHAR) || (ch == JAMC_RETURN_CHAR))
+		{
+			/* end of comment */
+			comment = FALSE;
+		}
+		else if ((ch == EOF) || ((!comment) && !jam_isspace((char) ch)))
+		{
+			found = TRUE;
+		}
+	}
+
+	return (ch);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_check_bool_data
+(
+	JAME_BOOLEAN_REP representation,
+	long dimension,
+	long statement_position
+)
+
+/*																			*/
+/*	Description:	Checks the BIN, HEX, RLC or ACA initialization data of	*/
+/*					a Boolean array without decoding it, so that bad data	*/
+/*					is reported by the declaration, before the program		*/
+/*					goes on.  The data is read as jam_decode_array_data()	*/
+/*					reads it, and gives the same errors, but no bits are	*/
+/*					stored.  For RLC data only the block counts are added	*/
+/*					up, and for ACA data only the characters and the		*/
+/*					length at the start of the compressed data are			*/
+/*					checked; the decoder does not find any other errors		*/
+/*					in ACA data.  If the program is in memory (see			*/
+/*					jam_set_direct_scan()), the data is read there.  The	*/
+/*					file is left at the current file position.				*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	int ch = 0;
+	int count_index = 0;
+	int count_size = 0;
+	int value = 0;
+	long count = 0L;
+	long address = 0L;
+	long length = 0L;
+	long data_position = 0L;
+	long position = 0L;
+	unsigned long aca_length = 0UL;
+	char *program = jam_direct_scan ? jam_program : NULL;
+	JAME_RLC_BLOCK_TYPE block_type = JAM_CONSTANT_ZEROS;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	status = jam_find_bool_data_position(representation,
+		statement_position, &data_position);
+
+	position = data_position;
+
+	if ((status == JAMC_SUCCESS) && (jam_seek(data_position) != 0))
+	{
+		status = JAMC_IO_ERROR;
+	}
+
+	switch (representation)
+	{
+	case JAM_BOOL_BINARY:
+		/* one digit for each element, then the semicolon */
+		for (address = 0L; (status == JAMC_SUCCESS) &&
+			(address <= dimension); ++address)
+		{
+			ch = jam_get_data_char(program, &position);
+
+			if ((address < dimension) && (ch == EOF))
+			{
+				status = JAMC_UNEXPECTED_END;
+			}
+			else if ((address < dimension) ? ((ch != '0') && (ch != '1')) :
+				(ch != JAMC_SEMICOLON_CHAR))
+			{
+				status = JAMC_SYNTAX_ERROR;
+			}
+		}
+		break;
+
+	case JAM_BOOL_HEX:
+		/* one digit for each four elements, then the semicolon */
+		length = (dimension >> 2) + ((dimension & 3) ? 1 : 0);
+
+		for (address = 0L; (status == JAMC_SUCCESS) &&
+			(address <= length); ++address)
+		{
+			ch = jam_get_data_char(program, &position);
+
+			if ((address < length) && (ch == EOF))
+			{
+				status = JAMC_UNEXPECTED_END;
+			}
+			else if ((address < length) ? (!jam_isdigit((char) ch) &&
+				!((ch >= 'A') && (ch <= 'F')) && !((ch >= 'a') && (ch <= 'f'))) :
+				(ch != JAMC_SEMICOLON_CHAR))
+			{
+				status = JAMC_SYNTAX_ERROR;
+			}
+		}
+		break;
+
+	case JAM_BOOL_RUN_LENGTH:
+		/* blocks which add up to the dimension, then the semicolon */
+		while ((status == JAMC_SUCCESS) && (address < dimension))
+		{
+			ch = jam_get_data_char(program, &position);
+
+			if (jam_rlc_key_char(ch, &block_type, &count_size))
+			{
+				count = 0L;
+
+				for (count_index = 0; (status == JAMC_SUCCESS) &&
+					(count_index < count_size); ++count_index)
+				{
+					ch = jam_get_data_char(program, &position);
+					value = jam_6bit_char(ch);
+
+					if (value == -1)
+					{
+						status = JAMC_SYNTAX_ERROR;
+					}
+					else
+					{
+						count = (count << 6) + (long) value;
+					}
+				}
+
+				/* random data has six elements to a character */
+				length = (block_type == JAM_RANDOM) ? ((count + 5L) / 6L) : 0L;
+
+				while ((status == JAMC_SUCCESS) && (length-- > 0L))
+				{
+					ch = jam_get_data_char(program, &position);
+
+					if (jam_6bit_char(ch) == -1)
+					{
+						status = JAMC_SYNTAX_ERROR;
+					}
+				}
+
+				address += count;
+			}
+			else
+			{
+				/* unrecognized key character */
+				status = JAMC_SYNTAX_ERROR;
+			}
+		}
+
+		ch = jam_get_data_char(program, &position);
+
+		if (ch == EOF)
+		{
+			status = JAMC_UNEXPECTED_END;
+		}
+
+		if ((status == JAMC_SUCCESS) &&
+			((ch != JAMC_SEMICOLON_CHAR) || (address != dimension)))
+		{
+			status = JAMC_SYNTAX_ERROR;
+		}
+		break;
+
+	case JAM_BOOL_COMPRESSED:
+		/*
+		*	Six bits to a character, up to the semicolon.  The first
+		*	32 bits are the length of the uncompressed data in bytes.
+		*/
+		for (ch = jam_get_data_char(program, &position);
+			(status == JAMC_SUCCESS) && (ch != JAMC_SEMICOLON_CHAR);
+			ch = jam_get_data_char(program, &position))
+		{
+			value = jam_6bit_char(ch);
+
+			if (value == -1)
+			{
+				status = JAMC_SYNTAX_ERROR;
+			}
+			else if (address < 32L)
+			{
+				aca_length |= ((unsigned long) value << address) & 0xffffffffUL;
+			}
+
+			address += 6L;
+		}
+
+		/* the length is only read if the data fills four bytes */
+		if ((status == JAMC_SUCCESS) && ((address < 25L) || (aca_length !=
+			(unsigned long) ((dimension >> 3) + ((dimension & 7) ? 1 : 0)))))
+		{
+			status = JAMC_SYNTAX_ERROR;
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	if ((status == JAMC_SUCCESS) &&
+		(jam_seek(jam_current_file_position) != 0))
+	{
+		status = JAMC_IO_ERROR;
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_decode_array_data
+(
+	JAMS_HEAP_RECORD *heap_record
+)
+
+/*																			*/
+/*	Description:	Decodes the initialization data of a Boolean array		*/
+/*					which is still pending.  The data is read directly		*/
+/*					from the input stream, starting from the declaration	*/
+/*					statement whose position jam_read_boolean_array_data()	*/
+/*					left in the heap record.  Called before each use of		*/
+/*					the array data, so an array which is never used is		*/
+/*					never decoded.  The file is left at the current file	*/
+/*					position.  Literal data may be taken from the shared	*/
+/*					array store instead, if another context has already		*/
+/*					decoded it.  Cached arrays are left to					*/
+/*					jam_get_array_data().									*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	long index = 0L;
+	long statement_position = 0L;
+	long data_position = 0L;
+	long shared_words = 0L;
+	long *shared_data = NULL;
+	BOOL share_claimed = FALSE;
+	JAME_BOOLEAN_REP representation = heap_record->rep;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	if (heap_record->pending && !heap_record->cached)
+	{
+		statement_position = heap_record->position;
+		heap_record->pending = FALSE;
+
+		/*
+		*	Data in the literal formats decodes the same way in every
+		*	context, so use the copy in the shared store if there is one
+		*/
+		if ((jam_array_share != NULL) &&
+			(representation != JAM_BOOL_COMMA_SEP))
+		{
+			shared_words = (heap_record->dimension >> 5) +
+				((heap_record->dimension & 0x1f) ? 1 : 0);
+
+			shared_data = jam_array_share->find(
+				statement_position, shared_words);
+
+			if (shared_data != NULL)
+			{
+				for (index = 0L; index < shared_words; ++index)
+				{
+					heap_record->data[index] = shared_data[index];
+				}
+			}
+			else
+			{
+				/* this context decodes the data and stores it for others */
+				share_claimed = TRUE;
+			}
+		}
+
+		if (shared_data == NULL)
+		{
+			status = jam_find_bool_data_position(representation,
+				statement_position, &data_position);
+
+			if (status == JAMC_SUCCESS)
+			{
+				heap_record->position = data_position;
+
+				switch (representation)
+				{
+				case JAM_BOOL_COMMA_SEP:
+					status = jam_read_bool_comma_sep(heap_record);
+					break;
+
+				case JAM_BOOL_BINARY:
+					status = jam_read_bool_binary(heap_record);
+					break;
+
+				case JAM_BOOL_HEX:
+					status = jam_read_bool_hex(heap_record);
+					break;
+
+				case JAM_BOOL_RUN_LENGTH:
+					status = jam_read_bool_run_length(heap_record);
+					break;
+
+				case JAM_BOOL_COMPRESSED:
+					status = jam_read_bool_compressed(heap_record);
+					break;
+
+				default:
+					status = JAMC_INTERNAL_ERROR;
+				}
+			}
+
+			/*
+			*	Restore file pointer to where the interpreter left it
+			*/
+			if ((status == JAMC_SUCCESS) &&
+				(jam_seek(jam_current_file_position) != 0))
+			{
+				status = JAMC_IO_ERROR;
+			}
+
+			/* in Jam 2.0, Boolean arrays in BIN and HEX format are reversed */
+			if ((status == JAMC_SUCCESS) && (jam_version == 2) &&
+				(representation == JAM_BOOL_BINARY))
+			{
+				status = jam_reverse_boolean_array_bin(heap_record);
+			}
+
+			if ((status == JAMC_SUCCESS) && (jam_version == 2) &&
+				(representation == JAM_BOOL_HEX))
+			{
+				status = jam_reverse_boolean_array_hex(heap_record);
+			}
+		}
+
+		if (share_claimed)
+		{
+			jam_array_share->store(statement_position, shared_words,
+				(status == JAMC_SUCCESS) ? heap_record->data : NULL);
+		}
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_decode_full_array
+(
+	JAMS_HEAP_RECORD *heap_record
+)
+
+/*																			*/
+/*	Description:	Decodes all the data of a cached Boolean array into an	*/
+/*					ordinary heap record of its own, which is used for		*/
+/*					every later access.  This is needed when the array is	*/
+/*					written to, since changes to the window would be lost	*/
+/*					when it is refilled, when a range does not fit in the	*/
+/*					window, and for data which is not in ACA format.		*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	long index = 0L;
+	long words = (heap_record->dimension >> 5) +
+		((heap_record->dimension & 0x1f) ? 1 : 0);
+	JAMS_ARRAY_CACHE *cache = (JAMS_ARRAY_CACHE *) heap_record->data;
+	JAMS_HEAP_RECORD *full_record = NULL;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	full_record = (JAMS_HEAP_RECORD *) jam_malloc((unsigned int)
+		(sizeof(JAMS_HEAP_RECORD) + (words * sizeof(long))));
+
+	if (full_record == NULL)
+	{
+		status = JAMC_OUT_OF_MEMORY;
+	}
+	else
+	{
+		full_record->next = NULL;
+		full_record->symbol_record = heap_record->symbol_record;
+		full_record->rep = heap_record->rep;
+		full_record->cached = FALSE;
+		full_record->pending = TRUE;
+		full_record->dimension = heap_record->dimension;
+		full_record->position = heap_record->position;
+
+		for (index = 0L; index <= words; ++index)
+		{
+			full_record->data[index] = 0L;
+		}
+
+		cache->full_record = full_record;
+
+		status = jam_decode_array_data(full_record);
+
+		/* the decoder is not used again */
+		jam_free_aca_snapshots(cache);
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+long jam_read_aca_bits
+(
+	JAMS_ACA_DECODER *decoder,
+	int bits,
+	JAM_RETURN_TYPE *status
+)
+
+/*																			*/
+/*	Description:	Reads the next bits of the packed ACA data of a cached	*/
+/*					array, six bits for each character of the file.  The	*/
+/*					file must be at the position of the next character.		*/
+/*																			*/
+/*	Returns:		Value of the bits, least significant bit first			*/
+/*																			*/
+/****************************************************************************/
+{
+	int ch = 0;
+	int value = 0;
+	long result = 0L;
+	BOOL comment = FALSE;
+
+	while ((*status == JAMC_SUCCESS) && (decoder->in_bit_count < bits))
+	{
+		/* skip over white space and comments, as jam_get_real_char() does */
+		do
+		{
+			ch = jam_getc();
+			++decoder->in_position;
+
+			if (ch == JAMC_COMMENT_CHAR)
+			{
+				comment = TRUE;
+			}
+			else if ((ch == JAMC_NEWLINE_CHAR) || (ch == JAMC_RETURN_CHAR))
+			{
+				comment = FALSE;
+			}
+		}
+		while ((ch != EOF) && (comment || jam_isspace((char) ch)));
+
+		value = (ch == EOF) ? -1 : jam_6bit_char(ch);
+
+		if (ch == EOF)
+		{
+			*status = JAMC_UNEXPECTED_END;
+		}
+		else if (value == -1)
+		{
+			*status = JAMC_SYNTAX_ERROR;
+		}
+		else
+		{
+			decoder->in_bits |= ((unsigned long) value) << decoder->in_bit_count;
+			decoder->in_bit_count += 6;
+		}
+	}
+
+	if (*status == JAMC_SUCCESS)
+	{
+		result = (long) (decoder->in_bits & ((1UL << bits) - 1UL));
+		decoder->in_bits >>= bits;
+		decoder->in_bit_count -= bits;
+	}
+
+	return (result);
+}
+
+/****************************************************************************/
+/*																			*/
+
+int jam_read_aca_byte
+(
+	JAMS_ARRAY_CACHE *cache,
+	JAM_RETURN_TYPE *status
+)
+
+/*																			*/
+/*	Description:	Uncompresses the next byte of the ACA data of a cached	*/
+/*					array, as jam_uncompress() does for the whole data.		*/
+/*					The last JAMC_ACA_HISTORY_SIZE bytes are kept, since	*/
+/*					a match copies bytes from up to that far back.  The		*/
+/*					first time the decoder reaches a snapshot point, a		*/
+/*					copy of it is kept, if there is memory for it.			*/
+/*																			*/
+/*	Returns:		The byte												*/
+/*																			*/
+/****************************************************************************/
+{
+	int value = 0;
+	long snapshot = 0L;
+	JAMS_ACA_DECODER *decoder = &cache->decoder;
+	long match_length = (jam_version == 2) ?
+		(JAMC_ACA_HISTORY_SIZE - 1) : JAMC_ACA_HISTORY_SIZE;
+
+	while ((*status == JAMC_SUCCESS) &&
+		(decoder->literal_count == 0) && (decoder->match_count == 0))
+	{
+		/* a 0 bit indicates three literal bytes, a 1 bit a match */
+		if (jam_read_aca_bits(decoder, 1, status) == 0L)
+		{
+			decoder->literal_count = 3;
+		}
+		else
+		{
+			decoder->match_offset = (int) jam_read_aca_bits(decoder,
+				jam_bits_required((short) ((decoder->out_count > match_length) ?
+				match_length : decoder->out_count)), status);
+			decoder->match_count = (int) jam_read_aca_bits(decoder, 8, status);
+		}
+	}
+
+	if ((*status == JAMC_SUCCESS) && (decoder->literal_count > 0))
+	{
+		value = (int) jam_read_aca_bits(decoder, 8, status);
+		--decoder->literal_count;
+	}
+	else if (*status == JAMC_SUCCESS)
+	{
+		if ((decoder->match_offset > 0) &&
+			(decoder->match_offset <= JAMC_ACA_HISTORY_SIZE) &&
+			(decoder->match_offset <= decoder->out_count))
+		{
+			value = decoder->history[(decoder->out_count -
+				decoder->match_offset) % JAMC_ACA_HISTORY_SIZE];
+		}
+		--decoder->match_count;
+	}
+
+	decoder->history[decoder->out_count % JAMC_ACA_HISTORY_SIZE] =
+		(unsigned char) value;
+	++decoder->out_count;
+
+	if ((*status == JAMC_SUCCESS) && (cache->snapshot_interval > 0L) &&
+		((decoder->out_count % cache->snapshot_interval) == 0L))
+	{
+		snapshot = (decoder->out_count / cache->snapshot_interval) - 1L;
+
+		if ((snapshot < JAMC_ACA_SNAPSHOT_COUNT) &&
+			(cache->snapshots[snapshot] == NULL))
+		{
+			cache->snapshots[snapshot] = (JAMS_ACA_DECODER *)
+				jam_malloc((unsigned int) sizeof(JAMS_ACA_DECODER));
+
+			/* without a snapshot, going back starts further back */
+			if (cache->snapshots[snapshot] != NULL)
+			{
+				*cache->snapshots[snapshot] = *decoder;
+			}
+		}
+	}
+
+	return (value);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_restart_aca_data
+(
+	JAMS_HEAP_RECORD *heap_record
+)
+
+/*																			*/
+/*	Description:	Sets the decoder of a cached array back to the start	*/
+/*					of its ACA data, and checks the length of the data.		*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	int i = 0;
+	long length = 0L;
+	JAMS_ARRAY_CACHE *cache = (JAMS_ARRAY_CACHE *) heap_record->data;
+	JAMS_ACA_DECODER *decoder = &cache->decoder;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	decoder->in_position = cache->in_begin;
+	decoder->in_bits = 0L;
+	decoder->in_bit_count = 0;
+	decoder->literal_count = 0;
+	decoder->match_count = 0;
+	decoder->match_offset = 0;
+	decoder->out_count = 0L;
+
+	if (jam_seek(decoder->in_position) != 0)
+	{
+		status = JAMC_IO_ERROR;
+	}
+
+	/* the data starts with its uncompressed length, a 32-bit field */
+	for (i = 0; (status == JAMC_SUCCESS) && (i < 4); ++i)
+	{
+		length |= jam_read_aca_bits(decoder, 8, &status) << (i * 8);
+	}
+
+	if ((status == JAMC_SUCCESS) &&
+		(length != (heap_record->dimension >> 3) +
+		((heap_record->dimension & 7) ? 1 : 0)))
+	{
+		status = JAMC_SYNTAX_ERROR;
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_rewind_aca_data
+(
+	JAMS_HEAP_RECORD *heap_record,
+	long byte
+)
+
+/*																			*/
+/*	Description:	Sets the decoder of a cached array back, so that byte	*/
+/*					is either still in its history or uncompressed later.	*/
+/*					The decoder is restored from the last snapshot which	*/
+/*					allows that, and starts again from the beginning of		*/
+/*					the data if there is none.								*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	int snapshot = 0;
+	JAMS_ARRAY_CACHE *cache = (JAMS_ARRAY_CACHE *) heap_record->data;
+	JAMS_ACA_DECODER *decoder = NULL;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	for (snapshot = 0; snapshot < JAMC_ACA_SNAPSHOT_COUNT; ++snapshot)
+	{
+		if ((cache->snapshots[snapshot] != NULL) &&
+			(byte >= cache->snapshots[snapshot]->out_count -
+			JAMC_ACA_HISTORY_SIZE))
+		{
+			decoder = cache->snapshots[snapshot];
+		}
+	}
+
+	if (decoder == NULL)
+	{
+		status = jam_restart_aca_data(heap_record);
+	}
+	else
+	{
+		cache->decoder = *decoder;
+
+		if (jam_seek(cache->decoder.in_position) != 0)
+		{
+			status = JAMC_IO_ERROR;
+		}
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_init_array_cache
+(
+	JAMS_HEAP_RECORD *heap_record
+)
+
+/*																			*/
+/*	Description:	Prepares a cached Boolean array for its first use.		*/
+/*					For ACA data, the decoder is set to the start of the	*/
+/*					data, the snapshot points are spread evenly over it,	*/
+/*					and the window is left empty.  Data in the other		*/
+/*					formats is decoded in full.								*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	JAMS_ARRAY_CACHE *cache = (JAMS_ARRAY_CACHE *) heap_record->data;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	heap_record->pending = FALSE;
+	cache->full_record = NULL;
+	cache->window_begin = 0L;
+	cache->window_end = 0L;
+	cache->used_statement = 0L;
+
+	/* a snapshot costs as much memory as the history it keeps */
+	cache->snapshot_interval = ((heap_record->dimension >> 3) + 1L) /
+		(JAMC_ACA_SNAPSHOT_COUNT + 1);
+	if (cache->snapshot_interval < JAMC_ACA_HISTORY_SIZE)
+	{
+		cache->snapshot_interval = JAMC_ACA_HISTORY_SIZE;
+	}
+
+	if (heap_record->rep == JAM_BOOL_COMPRESSED)
+	{
+		status = jam_find_bool_data_position(heap_record->rep,
+			heap_record->position, &cache->in_begin);
+
+		if (status == JAMC_SUCCESS)
+		{
+			status = jam_restart_aca_data(heap_record);
+		}
+
+		if ((status == JAMC_SUCCESS) &&
+			(jam_seek(jam_current_file_position) != 0))
+		{
+			status = JAMC_IO_ERROR;
+		}
+	}
+	else
+	{
+		status = jam_decode_full_array(heap_record);
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_fill_array_window
+(
+	JAMS_HEAP_RECORD *heap_record,
+	long first
+)
+
+/*																			*/
+/*	Description:	Refills the window of a cached array, starting at the	*/
+/*					word which holds element first.  Bytes still in the		*/
+/*					history of the decoder are copied from there; the		*/
+/*					decoder continues from its checkpoint if the window		*/
+/*					is further on, and goes back to a snapshot or to the	*/
+/*					beginning of the data otherwise.  The file is left at	*/
+/*					the current file position.								*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	int value = 0;
+	long byte = 0L;
+	long begin_byte = 0L;
+	long end_byte = 0L;
+	long word = 0L;
+	long begin = first & ~0x1fL;
+	long end = begin + (JAMC_ARRAY_CACHE_SIZE * 8L);
+	JAMS_ARRAY_CACHE *cache = (JAMS_ARRAY_CACHE *) heap_record->data;
+	JAMS_ACA_DECODER *decoder = &cache->decoder;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	if (end > heap_record->dimension) end = heap_record->dimension;
+
+	begin_byte = begin >> 3;
+	end_byte = (end >> 3) + ((end & 7) ? 1 : 0);
+
+	/* an invalid window is never used again, even if this refill fails */
+	cache->window_begin = 0L;
+	cache->window_end = 0L;
+
+	if (begin_byte < decoder->out_count - JAMC_ACA_HISTORY_SIZE)
+	{
+		/* the window starts before the history -- go back */
+		status = jam_rewind_aca_data(heap_record, begin_byte);
+	}
+	else if (jam_seek(decoder->in_position) != 0)
+	{
+		status = JAMC_IO_ERROR;
+	}
+
+	while ((status == JAMC_SUCCESS) && (decoder->out_count < begin_byte))
+	{
+		jam_read_aca_byte(cache, &status);
+	}
+
+	for (word = 0L; word < (JAMC_ARRAY_CACHE_SIZE + 3) / 4; ++word)
+	{
+		cache->window[word] = 0L;
+	}
+
+	for (byte = begin_byte; (status == JAMC_SUCCESS) && (byte < end_byte);
+		++byte)
+	{
+		if (byte < decoder->out_count)
+		{
+			value = decoder->history[byte % JAMC_ACA_HISTORY_SIZE];
+		}
+		else
+		{
+			value = jam_read_aca_byte(cache, &status);
+		}
+
+		cache->window[(byte - begin_byte) >> 2] |=
+			((long) value) << (((byte - begin_byte) & 3) * 8);
+	}
+
+	if (status == JAMC_SUCCESS)
+	{
+		cache->window_begin = begin;
+		cache->window_end = end;
+
+		if (jam_seek(jam_current_file_position) != 0)
+		{
+			status = JAMC_IO_ERROR;
+		}
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_get_array_data
+(
+	JAMS_HEAP_RECORD *heap_record,
+	long *start_index,
+	long *stop_index,
+	long **data
+)
+
+/*																			*/
+/*	Description:	Gets the data of an array, to read the elements from	*/
+/*					start_index to stop_index, in either order.  For a		*/
+/*					cached array, the data is the window, refilled if		*/
+/*					needed, and both indices are changed to index the		*/
+/*					window.  The window keeps all the elements used by the	*/
+/*					current statement, so that the data of an earlier		*/
+/*					argument is still valid.  If they do not fit, the		*/
+/*					array is decoded in full.								*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	long first = (*start_index < *stop_index) ? *start_index : *stop_index;
+	long last = (*start_index < *stop_index) ? *stop_index : *start_index;
+	JAMS_ARRAY_CACHE *cache = NULL;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	if (!heap_record->cached)
+	{
+		status = jam_decode_array_data(heap_record);
+		*data = heap_record->data;
+	}
+	else
+	{
+		cache = (JAMS_ARRAY_CACHE *) heap_record->data;
+
+		if (heap_record->pending)
+		{
+			status = jam_init_array_cache(heap_record);
+		}
+
+		if ((status == JAMC_SUCCESS) &&
+			((first < 0L) || (last >= heap_record->dimension)))
+		{
+			status = JAMC_BOUNDS_ERROR;
+		}
+
+		if ((status == JAMC_SUCCESS) && (cache->full_record == NULL))
+		{
+			if (cache->used_statement == jam_statement_count)
+			{
+				if (cache->used_begin < first) first = cache->used_begin;
+				if (cache->used_end > last) last = cache->used_end;
+			}
+
+			if (last - (first & ~0x1fL) >= JAMC_ARRAY_CACHE_SIZE * 8L)
+			{
+				status = jam_decode_full_array(heap_record);
+			}
+			else if ((first < cache->window_begin) ||
+				(last >= cache->window_end))
+			{
+				status = jam_fill_array_window(heap_record, first);
+			}
+
+			cache->used_statement = jam_statement_count;
+			cache->used_begin = first;
+			cache->used_end = last;
+		}
+
+		if ((status == JAMC_SUCCESS) && (cache->full_record != NULL))
+		{
+			*data = cache->full_record->data;
+		}
+		else if (status == JAMC_SUCCESS)
+		{
+			*data = cache->window;
+			*start_index -= cache->window_begin;
+			*stop_index -= cache->window_begin;
+		}
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_get_whole_array_data
+(
+	JAMS_HEAP_RECORD *heap_record,
+	long **data
+)
+
+/*																			*/
+/*	Description:	Gets the data of a whole array, to be written to or		*/
+/*					used from its first element.  A cached array is			*/
+/*					decoded in full.										*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	JAMS_ARRAY_CACHE *cache = NULL;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	if (!heap_record->cached)
+	{
+		status = jam_decode_array_data(heap_record);
+		*data = heap_record->data;
+	}
+	else
+	{
+		cache = (JAMS_ARRAY_CACHE *) heap_record->data;
+
+		if (heap_record->pending)
+		{
+			status = jam_init_array_cache(heap_record);
+		}
+
+		if ((status == JAMC_SUCCESS) && (cache->full_record == NULL))
+		{
+			status = jam_decode_full_array(heap_record);
+		}
+
+		if (status == JAMC_SUCCESS)
+		{
+			*data = cache->full_record->data;
+		}
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_decode_array
+(
+	JAMS_CONTEXT *context,
+	JAMS_ARRAY_REQUEST *request,
+	long *data
+)
+
+/*																			*/
+/*	Description:	Decodes the data of an initialized Boolean array which	*/
+/*					was passed to the prefetch() function of an array		*/
+/*					share.  May be called on any thread, with a context of	*/
+/*					its own whose user data reads the same program; the		*/
+/*					context is used only to read the file.					*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	long index = 0L;
+	JAMS_CONTEXT *previous = jam_set_context(context);
+	JAMS_HEAP_RECORD *heap_record = NULL;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	heap_record = (JAMS_HEAP_RECORD *) jam_malloc((unsigned int)
+		(sizeof(JAMS_HEAP_RECORD) + (request->words * sizeof(long))));
+
+	if (heap_record == NULL)
 	{
-		/*
-		*	Uncompress the data
-		*/
-		in_size = (address >> 3) + ((address & 7) ? 1 : 0);
-		uncompressed_length = jam_uncompress(
-			in, in_size, (char *)heap_data, out_size, jam_version);
+		status = JAMC_OUT_OF_MEMORY;
+	}
+	else
+	{
+		heap_record->next = NULL;
+		heap_record->symbol_record = NULL;
+		heap_record->rep = (JAME_BOOLEAN_REP) request->representation;
+		heap_record->cached = FALSE;
+		heap_record->pending = TRUE;
+		heap_record->dimension = request->dimension;
+		heap_record->position = request->position;
 
-		if (uncompressed_length != out_size)
+		for (index = 0L; index <= request->words; ++index)
 		{
-			status = JAMC_SYNTAX_ERROR;
+			heap_record->data[index] = 0L;
 		}
-		else
-		{
-			/* convert data from bytes into 32-bit words */
-			out_size = (heap_record->dimension >> 5) +
-				((heap_record->dimension & 0x1f) ? 1 : 0);
-			ch_data = (char *)heap_data;
 
-			for (word = 0; word < out_size; ++word)
-			{
-				heap_data[word] =
-					((((long) ch_data[(word * 4) + 3]) & 0xff) << 24L) |
-					((((long) ch_data[(word * 4) + 2]) & 0xff) << 16L) |
-					((((long) ch_data[(word * 4) + 1]) & 0xff) << 8L) |
-					(((long) ch_data[word * 4]) & 0xff);
-			}
+		jam_version = request->version;
+		jam_current_file_position = 0L;
+
+		status = jam_decode_array_data(heap_record);
+
+		for (index = 0L; (status == JAMC_SUCCESS) &&
+			(index < request->words); ++index)
+		{
+			data[index] = heap_record->data[index];
 		}
+
+		jam_free(heap_record);
 	}
 
-	if (in != NULL) jam_free_temp_workspace(in);
+	jam_set_context(previous);
 
 	return (status);
 }
@@ -1271,40 +2044,29 @@ JAM_RETURN_TYPE jam_read_bool_compressed
 /****************************************************************************/
 /*																			*/
 
-JAM_RETURN_TYPE jam_read_boolean_array_data
+JAME_BOOLEAN_REP jam_get_boolean_rep
 (
-	JAMS_HEAP_RECORD *heap_record,
-	char *statement_buffer
+	char *statement_buffer,
+	int version,
+	int *data_offset
 )
 
 /*																			*/
-/*	Description:	Reads Boolean array initialization data.  If it is all	*/
-/*					present in the statement buffer, then it is extracted	*/
-/*					from the buffer.  If the array initialization data did	*/
-/*					not fit into the statement buffer, it is read directly	*/
-/*					from the input stream.  Five formats of Boolean array	*/
-/*					initialization data are supported:  comma-separated		*/
-/*					values (the default), and BIN, HEX, RLC, and ACA.		*/
+/*	Description:	Finds the representation of Boolean array				*/
+/*					initialization data from its first characters, as		*/
+/*					they are written in the given version of the language.	*/
+/*					The offset of the data itself is passed back.			*/
 /*																			*/
-/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*	Returns:		Representation, or JAM_ILLEGAL_REP if not recognized	*/
 /*																			*/
 /****************************************************************************/
 {
 	int index = 0;
-	int ch = 0;
 	int rep = 0;
 	int length = 0;
-	int data_offset = 0;
-	long position = 0L;
-	long data_position = 0L;
-	BOOL done = FALSE;
-	BOOL comment = FALSE;
-	BOOL found_equal = FALSE;
-	BOOL found_space = FALSE;
-	BOOL found_keyword = FALSE;
-	BOOL data_complete = FALSE;
 	JAME_BOOLEAN_REP representation = JAM_ILLEGAL_REP;
-	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	*data_offset = 0;
 
 	while ((jam_isspace(statement_buffer[index])) &&
 		(index < JAMC_MAX_STATEMENT_LENGTH))
@@ -1315,22 +2077,22 @@ JAM_RETURN_TYPE jam_read_boolean_array_data
 	/*
 	*	Figure out which data representation scheme is used
 	*/
-	if (jam_version == 2)
+	if (version == 2)
 	{
 		if (statement_buffer[index] == JAMC_POUND_CHAR)
 		{
 			representation = JAM_BOOL_BINARY;
-			data_offset = index + 1;
+			*data_offset = index + 1;
 		}
 		else if (statement_buffer[index] == JAMC_DOLLAR_CHAR)
 		{
 			representation = JAM_BOOL_HEX;
-			data_offset = index + 1;
+			*data_offset = index + 1;
 		}
 		else if (statement_buffer[index] == JAMC_AT_CHAR)
 		{
 			representation = JAM_BOOL_COMPRESSED;
-			data_offset = index + 1;
+			*data_offset = index + 1;
 		}
 	}
 	else if (jam_isdigit(statement_buffer[index]))
@@ -1339,7 +2101,7 @@ JAM_RETURN_TYPE jam_read_boolean_array_data
 		*	First character is digit -- assume comma separated list
 		*/
 		representation = JAM_BOOL_COMMA_SEP;
-		data_offset = index;
+		*data_offset = index;
 	}
 	else if (jam_isalpha(statement_buffer[index]))
 	{
@@ -1359,9 +2121,48 @@ JAM_RETURN_TYPE jam_read_boolean_array_data
 			}
 		}
 
-		data_offset = index + length;
+		*data_offset = index + length;
 	}
 
+	return (representation);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_read_boolean_array_data
+(
+	JAMS_HEAP_RECORD *heap_record,
+	char *statement_buffer
+)
+
+/*																			*/
+/*	Description:	Reads Boolean array initialization data.  Five formats	*/
+/*					of Boolean array initialization data are supported:		*/
+/*					comma-separated values (the default), and BIN, HEX,		*/
+/*					RLC, and ACA.  Data in the last four formats does not	*/
+/*					depend on the state of the program, so it is only		*/
+/*					checked here, and the position of the statement is		*/
+/*					recorded.  The data is decoded by						*/
+/*					jam_decode_array_data() when the array is first used.	*/
+/*					A comma-separated list of expressions is evaluated		*/
+/*					now: it is extracted from the statement buffer if it	*/
+/*					is all present there, or else read directly from the	*/
+/*					input stream.											*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	int index = 0;
+	int data_offset = 0;
+	JAME_BOOLEAN_REP representation = JAM_ILLEGAL_REP;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	representation = jam_get_boolean_rep(statement_buffer, jam_version,
+		&data_offset);
+	index = data_offset;
+
 	if (representation == JAM_ILLEGAL_REP)
 	{
 		status = JAMC_SYNTAX_ERROR;
@@ -1382,227 +2183,48 @@ JAM_RETURN_TYPE jam_read_boolean_array_data
 		}
 	}
 
-	/*
-	*	See if all the initialization data is present in the statement buffer
-	*/
-	if ((status == JAMC_SUCCESS) && !heap_record->cached)
+	if ((status == JAMC_SUCCESS) && (representation != JAM_BOOL_COMMA_SEP))
 	{
-		while ((statement_buffer[index] != JAMC_NULL_CHAR) &&
-			(statement_buffer[index] != JAMC_SEMICOLON_CHAR) &&
-			(index < JAMC_MAX_STATEMENT_LENGTH))
-		{
-			++index;	/* look for semicolon */
-		}
+		/* bad data must stop the program before it goes on */
+		status = jam_check_bool_data(representation,
+			heap_record->dimension, jam_current_statement_position);
+	}
 
-		if (statement_buffer[index] == JAMC_SEMICOLON_CHAR)
-		{
-			data_complete = TRUE;
-		}
+	if (status == JAMC_SUCCESS)
+	{
+		heap_record->position = jam_current_statement_position;
+		heap_record->pending = TRUE;
 	}
 
-	/*
-	*	If data is not all present in the statement buffer, or if data
-	*	will be cached, find the position of the data in the input file
-	*/
-	if ((status == JAMC_SUCCESS) && ((!data_complete) || heap_record->cached))
+	if ((status == JAMC_SUCCESS) && (representation == JAM_BOOL_COMMA_SEP))
 	{
 		/*
-		*	Get position offset of initialization data
+		*	See if all the initialization data is present in the
+		*	statement buffer
 		*/
-		if (jam_seek(jam_current_statement_position) == 0)
-		{
-			position = jam_current_statement_position;
-		}
-		else status = JAMC_IO_ERROR;
-
-		while ((status == JAMC_SUCCESS) && !done)
-		{
-			ch = jam_getc();
-
-			if ((!comment) && (ch == JAMC_COMMENT_CHAR))
-			{
-				/* beginning of comment */
-				comment = TRUE;
-			}
-
-			if ((!comment) && (!found_equal) && (ch == JAMC_EQUAL_CHAR))
-			{
-				/* found the equal sign */
-				found_equal = TRUE;
-			}
-
-			if ((!comment) && found_equal && (!found_space) &&
-				jam_isspace((char)ch))
-			{
-				/* found the space after the equal sign */
-				found_space = TRUE;
-			}
-
-			if ((!comment) && found_equal && found_space)
-			{
-				if (representation == JAM_BOOL_COMMA_SEP)
-				{
-					if (jam_isdigit((char)ch))
-					{
-						/* found the first character of the data area */
-						done = TRUE;
-						data_position = position;
-					}
-				}
-				else	/* other representations */
-				{
-					if ((jam_version == 2) && (!found_keyword) &&
-						((ch == JAMC_POUND_CHAR) ||
-						(ch == JAMC_DOLLAR_CHAR) ||
-						(ch == JAMC_AT_CHAR)))
-					{
-						found_keyword = TRUE;
-						done = TRUE;
-						data_position = position + 1;
-					}
-
-					if ((jam_version != 2) && (!found_keyword) &&
-						(jam_isalpha((char)ch)))
-					{
-						/* found the first char of the representation keyword */
-						found_keyword = TRUE;
-					}
-
-					if ((jam_version != 2) && found_keyword &&
-						(jam_isspace((char)ch)))
-					{
-						/* found the first character of the data area */
-						done = TRUE;
-						data_position = position;
-					}
-				}
-
-			}
-
-			if ((!comment) && (ch == JAMC_SEMICOLON_CHAR))
-			{
-				/* end of statement */
-				done = TRUE;
-			}
-
-			if (ch == EOF)
-			{
-				/* end of file */
-				done = TRUE;
-				status = JAMC_UNEXPECTED_END;
-			}
-
-			if (comment &&
-				((ch == JAMC_NEWLINE_CHAR) || (ch == JAMC_RETURN_CHAR)))
-			{
-				/* end of comment */
-				comment = FALSE;
-			}
-
-			++position;	/* position of next character to be read */
-		}
-
-		if (status == JAMC_SUCCESS)
+		while ((statement_buffer[index] != JAMC_NULL_CHAR) &&
+			(statement_buffer[index] != JAMC_SEMICOLON_CHAR) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
 		{
-			heap_record->position = data_position;
+			++index;	/* look for semicolon */
 		}
 
-		/*
-		*	If data will not be cached, read it in from the file now.
-		*/
-		if ((status == JAMC_SUCCESS) && !heap_record->cached)
+		if (heap_record->cached)
 		{
-			/*
-			*	Data is present, and will not be cached.  Read it in.
-			*/
-			switch (representation)
-			{
-			case JAM_BOOL_COMMA_SEP:
-				status = jam_read_bool_comma_sep(heap_record);
-				break;
-
-			case JAM_BOOL_BINARY:
-				status = jam_read_bool_binary(heap_record);
-				break;
-
-			case JAM_BOOL_HEX:
-				status = jam_read_bool_hex(heap_record);
-				break;
-
-			case JAM_BOOL_RUN_LENGTH:
-				status = jam_read_bool_run_length(heap_record);
-				break;
-
-			case JAM_BOOL_COMPRESSED:
-				status = jam_read_bool_compressed(heap_record);
-				break;
-
-			default:
-				status = JAMC_INTERNAL_ERROR;
-			}
+			/* decoded in full now, since the values may change later */
+			status = jam_init_array_cache(heap_record);
 		}
-
-		/*
-		*	Restore file pointer to position of next statement
-		*/
-		if (status == JAMC_SUCCESS)
+		else if (statement_buffer[index] == JAMC_SEMICOLON_CHAR)
 		{
-			if (jam_seek(jam_next_statement_position) == 0)
-			{
-				jam_current_file_position = jam_next_statement_position;
-			}
-			else status = JAMC_IO_ERROR;
-		}
-	}
+			heap_record->pending = FALSE;
 
-	if ((status == JAMC_SUCCESS) && data_complete && !heap_record->cached)
-	{
-		/*
-		*	Data is present, and will not be cached.  Extract it from buffer.
-		*/
-		switch (representation)
-		{
-		case JAM_BOOL_COMMA_SEP:
 			status = jam_extract_bool_comma_sep(
 				heap_record, &statement_buffer[data_offset]);
-			break;
-
-		case JAM_BOOL_BINARY:
-			status = jam_extract_bool_binary(
-				heap_record, &statement_buffer[data_offset]);
-			break;
-
-		case JAM_BOOL_HEX:
-			status = jam_extract_bool_hex(
-				heap_record, &statement_buffer[data_offset]);
-			break;
-
-		case JAM_BOOL_RUN_LENGTH:
-			status = jam_extract_bool_run_length(
-				heap_record, &statement_buffer[data_offset]);
-			break;
-
-		case JAM_BOOL_COMPRESSED:
-			status = jam_extract_bool_compressed(
-				heap_record, &statement_buffer[data_offset]);
-			break;
-
-		default:
-			status = JAMC_INTERNAL_ERROR;
 		}
-	}
-
-	/* in Jam 2.0, Boolean arrays in BIN and HEX format are reversed */
-	if ((status == JAMC_SUCCESS) && (jam_version == 2) &&
-		(representation == JAM_BOOL_BINARY))
-	{
-		status = jam_reverse_boolean_array_bin(heap_record);
-	}
-
-	if ((status == JAMC_SUCCESS) && (jam_version == 2) &&
-		(representation == JAM_BOOL_HEX))
-	{
-		status = jam_reverse_boolean_array_hex(heap_record);
+		else
+		{
+			status = jam_decode_array_data(heap_record);
+		}
 	}
 
 	return (status);
@@ -2007,6 +2629,8 @@ JAM_RETURN_TYPE jam_get_array_value
 	JAM_RETURN_TYPE status = JAMC_SUCCESS;
 	JAMS_HEAP_RECORD *heap_record = NULL;
 	long *heap_data = NULL;
+	long first = 0L;
+	long last = 0L;
 
 	if ((symbol_record == NULL) ||
 		((symbol_record->type != JAM_INTEGER_ARRAY_WRITABLE) &&
@@ -2033,7 +2657,14 @@ JAM_RETURN_TYPE jam_get_array_value
 
 		if (status == JAMC_SUCCESS)
 		{
-			heap_data = &heap_record->data[0];
+			first = index;
+			last = index;
+			status = jam_get_array_data(heap_record, &first, &last,
+				&heap_data);
+		}
+
+		if (status == JAMC_SUCCESS)
+		{
 
 			if ((symbol_record->type == JAM_INTEGER_ARRAY_WRITABLE) ||
 				(symbol_record->type == JAM_INTEGER_ARRAY_INITIALIZED))
@@ -2053,18 +2684,9 @@ JAM_RETURN_TYPE jam_get_array_value
 			else if ((symbol_record->type == JAM_BOOLEAN_ARRAY_WRITABLE) ||
 				(symbol_record->type == JAM_BOOLEAN_ARRAY_INITIALIZED))
 			{
-				if (!heap_record->cached)
-				{
-					*value = (heap_data[index >> 5] & (1L << (index & 0x1f)))
-						? 1 : 0;
-				}
-				else
-				{
-					/* get data from cache */
-
-					/* cache not implemented yet! */
-					status = JAMC_INTERNAL_ERROR;
-				}
+				/* for a cached array, first is the index in the window */
+				*value = (heap_data[first >> 5] & (1L << (first & 0x1f)))
+					? 1 : 0;
 			}
 			else
 			{
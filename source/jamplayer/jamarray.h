@@ -29,6 +29,32 @@ JAM_RETURN_TYPE jam_read_integer_array_data
 	char *statement_buffer
 );
 
+JAM_RETURN_TYPE jam_decode_array_data
+(
+	JAMS_HEAP_RECORD *heap_record
+);
+
+JAM_RETURN_TYPE jam_get_array_data
+(
+	JAMS_HEAP_RECORD *heap_record,
+	long *start_index,
+	long *stop_index,
+	long **data
+);
+
+JAM_RETURN_TYPE jam_get_whole_array_data
+(
+	JAMS_HEAP_RECORD *heap_record,
+	long **data
+);
+
+JAME_BOOLEAN_REP jam_get_boolean_rep
+(
+	char *statement_buffer,
+	int version,
+	int *data_offset
+);
+
 JAM_RETURN_TYPE jam_get_array_value
 (
 	JAMS_SYMBOL_RECORD *symbol_record,
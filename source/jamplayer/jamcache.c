@@ -0,0 +1,744 @@
+/****************************************************************************/
+/*																			*/
+/*	Module:			jamcache.c												*/
+/*																			*/
+/*	Description:	Cache of decoded arrays and of the program index,		*/
+/*					kept between runs in a file of the cache directory		*/
+/*					named by the SHA-256 hash of the program.  The file		*/
+/*					is mapped into memory and checked before it is used,	*/
+/*					and is replaced as a whole with rename() when a run		*/
+/*					adds to it, so a reader never sees a partly written		*/
+/*					file.  The files used least recently are removed to		*/
+/*					keep the directory within its size limit.  A file		*/
+/*					which fails the checks is removed.  The file is only	*/
+/*					read by a player built for the same word size and		*/
+/*					byte order.												*/
+/*																			*/
+/****************************************************************************/
+
+#include "jamport.h"
+
+#if PORT == OPENBMC_AST
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include "jamexprt.h"
+#include "jamcache.h"
+
+/****************************************************************************/
+/*																			*/
+/*	Constant definitions													*/
+/*																			*/
+/****************************************************************************/
+
+#define BOOL int
+#define TRUE 1
+#define FALSE 0
+
+#define CACHE_MAGIC				"JAMCACHE"
+#define CACHE_FORMAT			1L
+#define CACHE_BYTE_ORDER		0x01020304L
+#define CACHE_SUFFIX			".jdc"
+#define CACHE_HASH_SIZE			32
+
+/****************************************************************************/
+/*																			*/
+/*	Type definitions														*/
+/*																			*/
+/****************************************************************************/
+
+struct cache_header
+{
+	char magic[8];
+	long format;
+	long long_size;				/* sizeof(long) */
+	long byte_order;			/* CACHE_BYTE_ORDER */
+	long file_length;
+	long program_length;
+	unsigned char hash[CACHE_HASH_SIZE];
+	unsigned char content_hash[CACHE_HASH_SIZE];	/* of the rest */
+	long crc_result;			/* from jam_check_crc() */
+	long expected_crc;
+	long actual_crc;
+	long index_length;			/* bytes, padded to a whole long */
+	long array_count;			/* then position, words and data of each */
+};
+
+/****************************************************************************/
+/*																			*/
+/*	Global variables														*/
+/*																			*/
+/****************************************************************************/
+
+char *jam_cache_directory = NULL;
+long jam_cache_limit = 0L;
+BOOL jam_cache_verbose = FALSE;
+char *jam_cache_path = NULL;
+unsigned char jam_program_hash[CACHE_HASH_SIZE];
+struct cache_header *jam_cache_file = NULL;	/* mapped file, if valid */
+char *jam_saved_index = NULL;				/* index made by this run */
+long jam_saved_index_length = 0L;
+pthread_mutex_t jam_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+char *jam_cache_index_load(long *length);
+void jam_cache_index_save(char *image, long length);
+
+JAMS_INDEX_STORE jam_cache_index =
+{
+	jam_cache_index_load,
+	jam_cache_index_save
+};
+
+/************************************************************************
+*
+*	jam_sha256_init(), jam_sha256_update(), jam_sha256_final() -- Compute the SHA-256
+*	hash of a stream of bytes (FIPS 180-4)
+*
+*	Values are kept in unsigned longs, masked to 32 bits, so that this
+*	works whatever the size of a long.
+*/
+static const unsigned long jam_sha256_k[64] =
+{
+	0x428a2f98UL, 0x71374491UL, 0xb5c0fbcfUL, 0xe9b5dba5UL,
+	0x3956c25bUL, 0x59f111f1UL, 0x923f82a4UL, 0xab1c5ed5UL,
+	0xd807aa98UL, 0x12835b01UL, 0x243185beUL, 0x550c7dc3UL,
+	0x72be5d74UL, 0x80deb1feUL, 0x9bdc06a7UL, 0xc19bf174UL,
+	0xe49b69c1UL, 0xefbe4786UL, 0x0fc19dc6UL, 0x240ca1ccUL,
+	0x2de92c6fUL, 0x4a7484aaUL, 0x5cb0a9dcUL, 0x76f988daUL,
+	0x983e5152UL, 0xa831c66dUL, 0xb00327c8UL, 0xbf597fc7UL,
+	0xc6e00bf3UL, 0xd5a79147UL, 0x06ca6351UL, 0x14292967UL,
+	0x27b70a85UL, 0x2e1b2138UL, 0x4d2c6dfcUL, 0x53380d13UL,
+	0x650a7354UL, 0x766a0abbUL, 0x81c2c92eUL, 0x92722c85UL,
+	0xa2bfe8a1UL, 0xa81a664bUL, 0xc24b8b70UL, 0xc76c51a3UL,
+	0xd192e819UL, 0xd6990624UL, 0xf40e3585UL, 0x106aa070UL,
+	0x19a4c116UL, 0x1e376c08UL, 0x2748774cUL, 0x34b0bcb5UL,
+	0x391c0cb3UL, 0x4ed8aa4aUL, 0x5b9cca4fUL, 0x682e6ff3UL,
+	0x748f82eeUL, 0x78a5636fUL, 0x84c87814UL, 0x8cc70208UL,
+	0x90befffaUL, 0xa4506cebUL, 0xbef9a3f7UL, 0xc67178f2UL
+};
+
+#define SHA256_MASK 0xffffffffUL
+#define SHA256_ROTR(x, n) ((((x) >> (n)) | ((x) << (32 - (n)))) & SHA256_MASK)
+
+void jam_sha256_block(unsigned long *state, unsigned char *block)
+{
+	unsigned long w[64];
+	unsigned long v[8];
+	unsigned long s0 = 0UL;
+	unsigned long s1 = 0UL;
+	unsigned long t1 = 0UL;
+	unsigned long t2 = 0UL;
+	int i = 0;
+
+	for (i = 0; i < 16; ++i)
+	{
+		w[i] = ((unsigned long) block[4 * i] << 24) |
+			((unsigned long) block[4 * i + 1] << 16) |
+			((unsigned long) block[4 * i + 2] << 8) |
+			(unsigned long) block[4 * i + 3];
+	}
+
+	for (i = 16; i < 64; ++i)
+	{
+		s0 = SHA256_ROTR(w[i - 15], 7) ^ SHA256_ROTR(w[i - 15], 18) ^
+			(w[i - 15] >> 3);
+		s1 = SHA256_ROTR(w[i - 2], 17) ^ SHA256_ROTR(w[i - 2], 19) ^
+			(w[i - 2] >> 10);
+		w[i] = (w[i - 16] + s0 + w[i - 7] + s1) & SHA256_MASK;
+	}
+
+	for (i = 0; i < 8; ++i) v[i] = state[i];
+
+	for (i = 0; i < 64; ++i)
+	{
+		s1 = SHA256_ROTR(v[4], 6) ^ SHA256_ROTR(v[4], 11) ^
+			SHA256_ROTR(v[4], 25);
+		t1 = (v[7] + s1 + ((v[4] & v[5]) ^ (~v[4] & v[6])) +
+			jam_sha256_k[i] + w[i]) & SHA256_MASK;
+		s0 = SHA256_ROTR(v[0], 2) ^ SHA256_ROTR(v[0], 13) ^
+			SHA256_ROTR(v[0], 22);
+		t2 = (s0 + ((v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]))) &
+			SHA256_MASK;
+
+		v[7] = v[6];
+		v[6] = v[5];
+		v[5] = v[4];
+		v[4] = (v[3] + t1) & SHA256_MASK;
+		v[3] = v[2];
+		v[2] = v[1];
+		v[1] = v[0];
+		v[0] = (t1 + t2) & SHA256_MASK;
+	}
+
+	for (i = 0; i < 8; ++i) state[i] = (state[i] + v[i]) & SHA256_MASK;
+}
+
+struct sha256_state
+{
+	unsigned long state[8];
+	unsigned char block[64];
+	long length;				/* bytes hashed so far */
+};
+
+void jam_sha256_init(struct sha256_state *hash)
+{
+	static const unsigned long initial[8] =
+	{
+		0x6a09e667UL, 0xbb67ae85UL, 0x3c6ef372UL, 0xa54ff53aUL,
+		0x510e527fUL, 0x9b05688cUL, 0x1f83d9abUL, 0x5be0cd19UL
+	};
+	int i = 0;
+
+	for (i = 0; i < 8; ++i) hash->state[i] = initial[i];
+	hash->length = 0L;
+}
+
+void jam_sha256_update(struct sha256_state *hash, unsigned char *data,
+	long length)
+{
+	long done = 0L;
+	int used = (int) (hash->length & 63L);
+	int count = 0;
+
+	hash->length += length;
+
+	while (done < length)
+	{
+		if ((used == 0) && (length - done >= 64L))
+		{
+			jam_sha256_block(hash->state, &data[done]);
+			done += 64L;
+		}
+		else
+		{
+			count = 64 - used;
+			if (count > length - done) count = (int) (length - done);
+			memcpy(&hash->block[used], &data[done], (size_t) count);
+			used += count;
+			done += count;
+
+			if (used == 64)
+			{
+				jam_sha256_block(hash->state, hash->block);
+				used = 0;
+			}
+		}
+	}
+}
+
+void jam_sha256_final(struct sha256_state *hash, unsigned char *digest)
+{
+	unsigned long long bits = (unsigned long long) hash->length << 3;
+	int used = (int) (hash->length & 63L);
+	int i = 0;
+
+	/* pad with a 1 bit, zeros and the length in bits */
+	hash->block[used++] = 0x80;
+	memset(&hash->block[used], 0, (size_t) (64 - used));
+
+	if (used > 56)
+	{
+		jam_sha256_block(hash->state, hash->block);
+		memset(hash->block, 0, sizeof(hash->block));
+	}
+
+	for (i = 0; i < 8; ++i)
+	{
+		hash->block[63 - i] = (unsigned char) (bits >> (8 * i));
+	}
+
+	jam_sha256_block(hash->state, hash->block);
+
+	for (i = 0; i < CACHE_HASH_SIZE; ++i)
+	{
+		digest[i] = (unsigned char)
+			(hash->state[i / 4] >> (24 - 8 * (i % 4)));
+	}
+}
+
+/************************************************************************
+*
+*	jam_cache_open() -- Map the cache file of the program, if there is one
+*
+*	Returns TRUE if a valid file was found.  Its arrays are given to
+*	add_array(), and its index is given to the interpreter by
+*	jam_cache_index_load().  The file is marked as just used.  The cache
+*	directory is kept within limit bytes by jam_cache_write().
+*/
+int jam_cache_open
+(
+	char *directory,
+	long limit,
+	int verbose,
+	char *program,
+	long program_length,
+	JAM_CACHE_ADD_ARRAY add_array
+)
+{
+	struct stat sbuf;
+	struct cache_header *header = NULL;
+	struct sha256_state hash;
+	unsigned char content_hash[CACHE_HASH_SIZE];
+	char *map = NULL;
+	long *record = NULL;
+	long offset = 0L;
+	long count = 0L;
+	BOOL valid = FALSE;
+	int fd = -1;
+	int i = 0;
+
+	jam_cache_directory = directory;
+	jam_cache_limit = limit;
+	jam_cache_verbose = verbose;
+
+	jam_sha256_init(&hash);
+	jam_sha256_update(&hash, (unsigned char *) program, program_length);
+	jam_sha256_final(&hash, jam_program_hash);
+
+	jam_cache_path = (char *) jam_malloc((unsigned int) (strlen(jam_cache_directory) +
+		2 * CACHE_HASH_SIZE + strlen(CACHE_SUFFIX) + 2));
+
+	if (jam_cache_path != NULL)
+	{
+		offset = sprintf(jam_cache_path, "%s/", jam_cache_directory);
+
+		for (i = 0; i < CACHE_HASH_SIZE; ++i)
+		{
+			offset += sprintf(&jam_cache_path[offset], "%02x", jam_program_hash[i]);
+		}
+
+		strcpy(&jam_cache_path[offset], CACHE_SUFFIX);
+
+		fd = open(jam_cache_path, O_RDONLY);
+	}
+
+	if ((fd >= 0) && (fstat(fd, &sbuf) == 0) &&
+		(sbuf.st_size >= (off_t) sizeof(struct cache_header)) &&
+		(sbuf.st_size <= (off_t) jam_cache_limit))
+	{
+		map = (char *) mmap(NULL, (size_t) sbuf.st_size, PROT_READ,
+			MAP_PRIVATE, fd, 0);
+
+		if (map == (char *) MAP_FAILED) map = NULL;
+	}
+
+	if (fd >= 0) close(fd);
+
+	if (map != NULL)
+	{
+		header = (struct cache_header *) map;
+
+		valid = (memcmp(header->magic, CACHE_MAGIC, 8) == 0) &&
+			(header->format == CACHE_FORMAT) &&
+			(header->long_size == (long) sizeof(long)) &&
+			(header->byte_order == CACHE_BYTE_ORDER) &&
+			(header->file_length == (long) sbuf.st_size) &&
+			(header->program_length == program_length) &&
+			(memcmp(header->hash, jam_program_hash, CACHE_HASH_SIZE) == 0) &&
+			(header->index_length >= 0L) &&
+			(header->index_length % (long) sizeof(long) == 0L) &&
+			(header->index_length <= header->file_length -
+				(long) sizeof(struct cache_header)) &&
+			(header->array_count >= 0L);
+
+		/* the arrays must fill the rest of the file exactly */
+		offset = (long) sizeof(struct cache_header) + header->index_length;
+
+		for (count = 0L; valid && (count < header->array_count); ++count)
+		{
+			record = (long *) &map[offset];
+
+			valid = (header->file_length - offset >=
+					2L * (long) sizeof(long)) &&
+				(record[0] >= 0L) && (record[0] < program_length) &&
+				(record[1] > 0L) &&
+				(record[1] <= ((header->file_length - offset) /
+					(long) sizeof(long)) - 2L);
+
+			if (valid) offset += (2L + record[1]) * (long) sizeof(long);
+		}
+
+		if (offset != header->file_length) valid = FALSE;
+
+		if (valid)
+		{
+			jam_sha256_init(&hash);
+			jam_sha256_update(&hash, (unsigned char *) &header[1],
+				header->file_length - (long) sizeof(struct cache_header));
+			jam_sha256_final(&hash, content_hash);
+
+			valid = (memcmp(header->content_hash, content_hash,
+				CACHE_HASH_SIZE) == 0);
+		}
+
+		if (!valid)
+		{
+			munmap(map, (size_t) sbuf.st_size);
+			unlink(jam_cache_path);
+
+			if (jam_cache_verbose)
+			{
+				printf("Cache file %s is not valid, removed\n", jam_cache_path);
+			}
+		}
+	}
+
+	if (valid)
+	{
+		jam_cache_file = header;
+		utimes(jam_cache_path, NULL);
+
+		offset = (long) sizeof(struct cache_header) + header->index_length;
+
+		for (count = 0L; count < header->array_count; ++count)
+		{
+			record = (long *) &map[offset];
+			add_array(record[0], record[1], &record[2]);
+			offset += (2L + record[1]) * (long) sizeof(long);
+		}
+
+		if (jam_cache_verbose)
+		{
+			printf("Cache file %s: %ld arrays%s\n", jam_cache_path,
+				header->array_count,
+				(header->index_length > 0L) ? " and program index" : "");
+		}
+	}
+
+	return (valid);
+}
+
+/************************************************************************
+*
+*	jam_cache_index_load() -- Give the interpreter the index in the cache file
+*/
+char *jam_cache_index_load(long *length)
+{
+	char *image = NULL;
+
+	if ((jam_cache_file != NULL) && (jam_cache_file->index_length > 0L))
+	{
+		image = (char *) &jam_cache_file[1];
+		*length = jam_cache_file->index_length;
+	}
+
+	return (image);
+}
+
+/************************************************************************
+*
+*	jam_cache_index_save() -- Keep an index made by the interpreter
+*
+*	Every chain makes the same index, so only the first one is kept.
+*/
+void jam_cache_index_save(char *image, long length)
+{
+	pthread_mutex_lock(&jam_cache_mutex);
+
+	if ((jam_saved_index == NULL) && (length % (long) sizeof(long) == 0L))
+	{
+		jam_saved_index = (char *) jam_malloc((unsigned int) length);
+
+		if (jam_saved_index != NULL)
+		{
+			memcpy(jam_saved_index, image, (size_t) length);
+			jam_saved_index_length = length;
+		}
+	}
+
+	pthread_mutex_unlock(&jam_cache_mutex);
+}
+
+/************************************************************************
+*
+*	jam_cache_file_name() -- Check if a file name is that of a cache file
+*/
+BOOL jam_cache_file_name(char *name)
+{
+	BOOL match = (strlen(name) == 2 * CACHE_HASH_SIZE + strlen(CACHE_SUFFIX));
+	int i = 0;
+
+	for (i = 0; match && (i < 2 * CACHE_HASH_SIZE); ++i)
+	{
+		if (!isxdigit((unsigned char) name[i])) match = FALSE;
+	}
+
+	return (match && (strcmp(&name[2 * CACHE_HASH_SIZE], CACHE_SUFFIX) == 0));
+}
+
+/************************************************************************
+*
+*	jam_cache_trim() -- Keep the cache directory within its size limit
+*
+*	Removes the cache files used least recently, one at a time, until the
+*	files left fit in the limit.  Other files are neither counted nor
+*	removed.
+*/
+void jam_cache_trim(void)
+{
+	DIR *dir = NULL;
+	struct dirent *dir_entry = NULL;
+	struct stat sbuf;
+	size_t path_size = strlen(jam_cache_directory) +
+		2 * CACHE_HASH_SIZE + strlen(CACHE_SUFFIX) + 2;
+	char *path = (char *) jam_malloc((unsigned int) path_size);
+	char *oldest = (char *) jam_malloc((unsigned int) path_size);
+	time_t oldest_time = 0;
+	long total = 0L;
+	BOOL removed = TRUE;
+
+	while (removed && (path != NULL) && (oldest != NULL) &&
+		((dir = opendir(jam_cache_directory)) != NULL))
+	{
+		removed = FALSE;
+		total = 0L;
+		oldest[0] = '\0';
+
+		while ((dir_entry = readdir(dir)) != NULL)
+		{
+			if (jam_cache_file_name(dir_entry->d_name))
+			{
+				sprintf(path, "%s/%s", jam_cache_directory, dir_entry->d_name);
+
+				if ((stat(path, &sbuf) == 0) && S_ISREG(sbuf.st_mode))
+				{
+					total += (long) sbuf.st_size;
+
+					if ((oldest[0] == '\0') || (sbuf.st_mtime < oldest_time))
+					{
+						strcpy(oldest, path);
+						oldest_time = sbuf.st_mtime;
+					}
+				}
+			}
+		}
+
+		closedir(dir);
+
+		if ((total > jam_cache_limit) && (oldest[0] != '\0') &&
+			(unlink(oldest) == 0))
+		{
+			if (jam_cache_verbose) printf("Cache file %s removed\n", oldest);
+			removed = TRUE;
+		}
+	}
+
+	if (path != NULL) jam_free(path);
+	if (oldest != NULL) jam_free(oldest);
+}
+
+/************************************************************************
+*
+*	jam_cache_put() -- Write part of a cache file and add it to its hash
+*/
+BOOL jam_cache_put(FILE *fp, struct sha256_state *hash, char *data,
+	long length)
+{
+	jam_sha256_update(hash, (unsigned char *) data, length);
+
+	return ((length == 0L) || (fwrite(data, (size_t) length, 1, fp) == 1));
+}
+
+/************************************************************************
+*
+*	jam_cache_write() -- Write a new cache file for the program
+*
+*	Written only if this run made the index, or decoded arrays which the
+*	cache file does not hold yet.  The new file holds the index and every
+*	array decoded or loaded, and takes the place of the old one.  A file
+*	which would not fit in the size limit is not written.  The directory
+*	is then trimmed to the limit.  Nothing is done if no cache file could
+*	be named by jam_cache_open().
+*/
+void jam_cache_write
+(
+	long program_length,
+	JAM_RETURN_TYPE crc_result,
+	unsigned short expected_crc,
+	unsigned short actual_crc,
+	JAM_CACHE_NEXT_ARRAY next_array
+)
+{
+	struct cache_header header;
+	struct sha256_state hash;
+	void *cursor = NULL;
+	long *data = NULL;
+	long position = 0L;
+	long words = 0L;
+	int cached = FALSE;
+	char *index = jam_saved_index;
+	long index_length = jam_saved_index_length;
+	char *temp_path = NULL;
+	long file_length = (long) sizeof(struct cache_header);
+	long array_count = 0L;
+	BOOL changed = (jam_saved_index != NULL);
+	BOOL ok = TRUE;
+	FILE *fp = NULL;
+	int fd = -1;
+
+	if (jam_cache_path == NULL) return;
+
+	if ((index == NULL) && (jam_cache_file != NULL))
+	{
+		index = (char *) &jam_cache_file[1];
+		index_length = jam_cache_file->index_length;
+	}
+
+	while (next_array(&cursor, &position, &words, &cached) != NULL)
+	{
+		file_length += (2L + words) * (long) sizeof(long);
+		++array_count;
+
+		if (!cached) changed = TRUE;
+	}
+
+	file_length += index_length;
+
+	if (changed && (file_length > jam_cache_limit))
+	{
+		if (jam_cache_verbose)
+		{
+			printf("Cache file of %ld Kbytes not written, limit is %ld Kbytes\n",
+				(file_length + 1023L) / 1024L, jam_cache_limit / 1024L);
+		}
+
+		changed = FALSE;
+	}
+
+	if (changed)
+	{
+		temp_path = (char *) jam_malloc((unsigned int) (strlen(jam_cache_path) + 24));
+	}
+
+	if (temp_path != NULL)
+	{
+		sprintf(temp_path, "%s.%ld.tmp", jam_cache_path, (long) getpid());
+
+		fd = open(temp_path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+		if (fd >= 0) fp = fdopen(fd, "wb");
+		if ((fp == NULL) && (fd >= 0)) close(fd);
+	}
+
+	if (fp != NULL)
+	{
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, CACHE_MAGIC, 8);
+		header.format = CACHE_FORMAT;
+		header.long_size = (long) sizeof(long);
+		header.byte_order = CACHE_BYTE_ORDER;
+		header.file_length = file_length;
+		header.program_length = program_length;
+		memcpy(header.hash, jam_program_hash, CACHE_HASH_SIZE);
+		header.crc_result = (long) crc_result;
+		header.expected_crc = (long) expected_crc;
+		header.actual_crc = (long) actual_crc;
+		header.index_length = index_length;
+		header.array_count = array_count;
+
+		/* the header is written again when the contents are hashed */
+		jam_sha256_init(&hash);
+		ok = (fwrite(&header, sizeof(header), 1, fp) == 1) &&
+			jam_cache_put(fp, &hash, index, index_length);
+
+		cursor = NULL;
+		while (ok &&
+			((data = next_array(&cursor, &position, &words, &cached)) != NULL))
+		{
+			ok = jam_cache_put(fp, &hash, (char *) &position,
+					(long) sizeof(long)) &&
+				jam_cache_put(fp, &hash, (char *) &words,
+					(long) sizeof(long)) &&
+				jam_cache_put(fp, &hash, (char *) data,
+					words * (long) sizeof(long));
+		}
+
+		jam_sha256_final(&hash, header.content_hash);
+
+		ok = ok && (fseek(fp, 0L, SEEK_SET) == 0) &&
+			(fwrite(&header, sizeof(header), 1, fp) == 1);
+
+		/* the file must be complete on disk before it replaces the old one */
+		if (fflush(fp) != 0) ok = FALSE;
+		if (fsync(fileno(fp)) != 0) ok = FALSE;
+		if (fclose(fp) != 0) ok = FALSE;
+
+		if (ok && (rename(temp_path, jam_cache_path) == 0))
+		{
+			if (jam_cache_verbose)
+			{
+				printf("Cache file %s written: %ld arrays, %ld Kbytes\n",
+					jam_cache_path, array_count, (file_length + 1023L) / 1024L);
+			}
+		}
+		else
+		{
+			unlink(temp_path);
+			printf("Warning: can't write cache file %s\n", jam_cache_path);
+		}
+	}
+	else if (temp_path != NULL)
+	{
+		printf("Warning: can't write cache file %s\n", jam_cache_path);
+	}
+
+	if (temp_path != NULL) jam_free(temp_path);
+
+	jam_cache_trim();
+}
+
+/************************************************************************
+*
+*	jam_cache_crc() -- Give the CRC check made when the cache was made
+*
+*	Returns TRUE if a valid cache file is open.  The program is then the
+*	one checked when the file was written, so its CRC need not be checked
+*	again.
+*/
+int jam_cache_crc
+(
+	JAM_RETURN_TYPE *crc_result,
+	unsigned short *expected_crc,
+	unsigned short *actual_crc
+)
+{
+	if (jam_cache_file != NULL)
+	{
+		*crc_result = (JAM_RETURN_TYPE) jam_cache_file->crc_result;
+		*expected_crc = (unsigned short) jam_cache_file->expected_crc;
+		*actual_crc = (unsigned short) jam_cache_file->actual_crc;
+	}
+
+	return (jam_cache_file != NULL);
+}
+
+/************************************************************************
+*
+*	jam_cache_close() -- Unmap the cache file and free the cache data
+*/
+void jam_cache_close(void)
+{
+	if (jam_cache_file != NULL)
+	{
+		munmap((char *) jam_cache_file, (size_t) jam_cache_file->file_length);
+		jam_cache_file = NULL;
+	}
+
+	if (jam_cache_path != NULL) jam_free(jam_cache_path);
+	if (jam_saved_index != NULL) jam_free(jam_saved_index);
+	jam_cache_path = NULL;
+	jam_saved_index = NULL;
+}
+
+
+#endif /* PORT == OPENBMC_AST */
@@ -0,0 +1,74 @@
+/****************************************************************************/
+/*																			*/
+/*	Module:			jamcache.h												*/
+/*																			*/
+/*	Description:	Definitions of the cache of decoded arrays and of the	*/
+/*					program index, kept by the stub between runs			*/
+/*																			*/
+/****************************************************************************/
+
+#ifndef INC_JAMCACHE_H
+#define INC_JAMCACHE_H
+
+/****************************************************************************/
+/*																			*/
+/*	Type definitions														*/
+/*																			*/
+/****************************************************************************/
+
+/*
+*	The arrays are kept by the caller.  jam_cache_open() gives it each
+*	array of a valid cache file with add_array(); the data stays mapped
+*	until jam_cache_close().  jam_cache_write() asks for the arrays to be
+*	written with next_array(), starting with *cursor set to NULL, until it
+*	returns NULL.  *cached is set if the data came from the cache file.
+*/
+typedef void (*JAM_CACHE_ADD_ARRAY)(long position, long words, long *data);
+
+typedef long *(*JAM_CACHE_NEXT_ARRAY)(void **cursor, long *position,
+	long *words, int *cached);
+
+/****************************************************************************/
+/*																			*/
+/*	Global variables														*/
+/*																			*/
+/****************************************************************************/
+
+/* index store for jam_store_index(), backed by the cache file */
+extern JAMS_INDEX_STORE jam_cache_index;
+
+/****************************************************************************/
+/*																			*/
+/*	Function prototypes														*/
+/*																			*/
+/****************************************************************************/
+
+int jam_cache_open
+(
+	char *directory,
+	long limit,
+	int verbose,
+	char *program,
+	long program_length,
+	JAM_CACHE_ADD_ARRAY add_array
+);
+
+int jam_cache_crc
+(
+	JAM_RETURN_TYPE *crc_result,
+	unsigned short *expected_crc,
+	unsigned short *actual_crc
+);
+
+void jam_cache_write
+(
+	long program_length,
+	JAM_RETURN_TYPE crc_result,
+	unsigned short expected_crc,
+	unsigned short actual_crc,
+	JAM_CACHE_NEXT_ARRAY next_array
+);
+
+void jam_cache_close(void);
+
+#endif /* INC_JAMCACHE_H */
@@ -0,0 +1,1366 @@
+/****************************************************************************/
+/*																			*/
+/*	Module:			jamcode.c												*/
+/*																			*/
+/*	Description:	Functions to manage the compiled program code.  The		*/
+/*					compiled statements, with their operations, are kept in	*/
+/*					a hash table keyed by file position.  Each one is		*/
+/*					linked to the statement which follows it and to the		*/
+/*					statement it last jumped to, so that straight-line		*/
+/*					code, loops and repeated calls need no table lookups at	*/
+/*					all.  The total size is bounded by the code limit of	*/
+/*					the context; statements are swept out to stay under it.	*/
+/*					Compiled expressions and decoded literal arrays are		*/
+/*					kept with the statement they belong to, and go with it.	*/
+/*					The program index, keyed by name, holds the position	*/
+/*					of each label and each ACTION, PROCEDURE and DATA		*/
+/*					statement in the program.								*/
+/*																			*/
+/****************************************************************************/
+
+#include "jamexprt.h"
+#include "jamdefs.h"
+#include "jamsym.h"
+#include "jamstack.h"
+#include "jamheap.h"
+#include "jamjtag.h"
+#include "jamcode.h"
+#include "jamutil.h"
+#include "jamctx.h"
+
+/****************************************************************************/
+/*																			*/
+
+void jam_init_code(void)
+
+/*																			*/
+/*	Description:	Creates an empty table of compiled statements.  When	*/
+/*					the program runs in a fixed workspace, the code limit	*/
+/*					is zero, or no memory is available, no table is made	*/
+/*					and every statement is read from the program text.		*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	int hash = 0;
+
+	jam_code_table = NULL;
+	jam_last_instruction = NULL;
+	jam_code_size = 0L;
+	jam_code_hits = 0L;
+	jam_code_misses = 0L;
+	jam_code_operations = 0L;
+
+	if ((jam_workspace == NULL) && (jam_code_limit > 0L))
+	{
+		jam_code_table = (JAMS_INSTRUCTION **) jam_malloc(
+			JAMC_CODE_HASH_SIZE * sizeof(JAMS_INSTRUCTION *));
+
+		if (jam_code_table != NULL)
+		{
+			for (hash = 0; hash < JAMC_CODE_HASH_SIZE; ++hash)
+			{
+				jam_code_table[hash] = NULL;
+			}
+		}
+	}
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_free_instruction
+(
+	JAMS_INSTRUCTION *instruction
+)
+
+/*																			*/
+/*	Description:	Frees a compiled statement, its expressions, its		*/
+/*					literal arrays, the names it looked up and the			*/
+/*					operations of the statements after THEN.				*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	JAMS_EXPRESSION *expression = NULL;
+	JAMS_EXPRESSION *next_expression = NULL;
+	JAMS_LITERAL *literal = NULL;
+	JAMS_LITERAL *next_literal = NULL;
+	JAMS_SYMBOL_REF *symbol = NULL;
+	JAMS_SYMBOL_REF *next_symbol = NULL;
+	JAMS_OPERATION *operation = NULL;
+	JAMS_OPERATION *next_operation = NULL;
+
+	expression = instruction->expressions;
+
+	while (expression != NULL)
+	{
+		next_expression = expression->next;
+		jam_free(expression);
+		expression = next_expression;
+	}
+
+	literal = instruction->literals;
+
+	while (literal != NULL)
+	{
+		next_literal = literal->next;
+		jam_free(literal);
+		literal = next_literal;
+	}
+
+	symbol = instruction->symbols;
+
+	while (symbol != NULL)
+	{
+		next_symbol = symbol->next;
+		jam_free(symbol);
+		symbol = next_symbol;
+	}
+
+	operation = instruction->operation.then;
+
+	while (operation != NULL)
+	{
+		next_operation = operation->then;
+		jam_free(operation);
+		operation = next_operation;
+	}
+
+	jam_free(instruction);
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_free_code(void)
+
+/*																			*/
+/*	Description:	Frees all compiled statements and the table.			*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	int hash = 0;
+	JAMS_INSTRUCTION *instruction = NULL;
+	JAMS_INSTRUCTION *next_instruction = NULL;
+
+	if (jam_code_table != NULL)
+	{
+		for (hash = 0; hash < JAMC_CODE_HASH_SIZE; ++hash)
+		{
+			instruction = jam_code_table[hash];
+
+			while (instruction != NULL)
+			{
+				next_instruction = instruction->next;
+				jam_free_instruction(instruction);
+				instruction = next_instruction;
+			}
+		}
+
+		jam_free(jam_code_table);
+		jam_code_table = NULL;
+	}
+
+	jam_last_instruction = NULL;
+	jam_code_size = 0L;
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_sweep_code
+(
+	long needed
+)
+
+/*																			*/
+/*	Description:	Makes room for a new compiled statement of the given	*/
+/*					size.  Statements not used since the last sweep are		*/
+/*					freed first; if that is not enough, all of them are.	*/
+/*					Successor and branch links are cleared, since they may	*/
+/*					point to freed statements, and are rebuilt as the		*/
+/*					program runs.											*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	int hash = 0;
+	BOOL flush = FALSE;
+	JAMS_INSTRUCTION *instruction = NULL;
+	JAMS_INSTRUCTION **link = NULL;
+
+	do
+	{
+		for (hash = 0; hash < JAMC_CODE_HASH_SIZE; ++hash)
+		{
+			link = &jam_code_table[hash];
+
+			while (*link != NULL)
+			{
+				instruction = *link;
+
+				if (flush || !instruction->referenced)
+				{
+					*link = instruction->next;
+					jam_code_size -= instruction->size;
+					jam_free_instruction(instruction);
+				}
+				else
+				{
+					instruction->referenced = FALSE;
+					instruction->successor = NULL;
+					instruction->branch = NULL;
+					link = &instruction->next;
+				}
+			}
+		}
+
+		flush = !flush;
+	}
+	while (flush && (jam_code_size + needed > jam_code_limit));
+
+	jam_last_instruction = NULL;
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAMS_INSTRUCTION *jam_find_instruction
+(
+	long read_position
+)
+
+/*																			*/
+/*	Description:	Looks for the statement compiled from the given file	*/
+/*					position.  When reading continues where the last		*/
+/*					statement found or added ended, its successor link is	*/
+/*					used instead of the hash table.  When the last			*/
+/*					statement jumped, its branch link is used if it			*/
+/*					jumped to the same place the time before.				*/
+/*																			*/
+/*	Returns:		Pointer to compiled statement, or NULL if not found		*/
+/*																			*/
+/****************************************************************************/
+{
+	JAMS_INSTRUCTION *instruction = NULL;
+	BOOL sequential = FALSE;
+
+	if (jam_code_table != NULL)
+	{
+		sequential = (jam_last_instruction != NULL) &&
+			(jam_last_instruction->next_statement_position == read_position);
+
+		if (sequential && (jam_last_instruction->successor != NULL))
+		{
+			instruction = jam_last_instruction->successor;
+		}
+		else if ((!sequential) && (jam_last_instruction != NULL) &&
+			(jam_last_instruction->branch != NULL) &&
+			(jam_last_instruction->branch->read_position == read_position))
+		{
+			instruction = jam_last_instruction->branch;
+		}
+		else
+		{
+			instruction = jam_code_table[read_position % JAMC_CODE_HASH_SIZE];
+
+			while ((instruction != NULL) &&
+				(instruction->read_position != read_position))
+			{
+				instruction = instruction->next;
+			}
+
+			if (sequential)
+			{
+				jam_last_instruction->successor = instruction;
+			}
+			else if (jam_last_instruction != NULL)
+			{
+				jam_last_instruction->branch = instruction;
+			}
+		}
+
+		/* on a miss, keep the last one so that the new statement is linked */
+		if (instruction != NULL)
+		{
+			instruction->referenced = TRUE;
+			jam_last_instruction = instruction;
+			++jam_code_hits;
+		}
+		else
+		{
+			++jam_code_misses;
+		}
+	}
+
+	return (instruction);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAMS_INSTRUCTION *jam_add_instruction
+(
+	long read_position,
+	char *statement_buffer,
+	JAME_INSTRUCTION code
+)
+
+/*																			*/
+/*	Description:	Compiles the statement which jam_get_statement() has	*/
+/*					just read from the given file position.					*/
+/*																			*/
+/*	Returns:		Pointer to compiled statement, or NULL if there is no	*/
+/*					table, no memory, or the statement is larger than the	*/
+/*					code limit												*/
+/*																			*/
+/****************************************************************************/
+{
+	int hash = (int) (read_position % JAMC_CODE_HASH_SIZE);
+	long size = 0L;
+	JAMS_INSTRUCTION *instruction = NULL;
+
+	size = (long) sizeof(JAMS_INSTRUCTION) + jam_strlen(statement_buffer);
+
+	if ((jam_code_table != NULL) && (size <= jam_code_limit))
+	{
+		if (jam_code_size + size > jam_code_limit) jam_sweep_code(size);
+
+		instruction = (JAMS_INSTRUCTION *) jam_malloc((unsigned int) size);
+
+		if (instruction != NULL)
+		{
+			jam_code_size += size;
+			instruction->size = size;
+			instruction->referenced = FALSE;
+			instruction->successor = NULL;
+			instruction->branch = NULL;
+			instruction->expressions = NULL;
+			instruction->literals = NULL;
+			instruction->symbols = NULL;
+			instruction->operation.then = NULL;
+			instruction->operation.symbol_record = NULL;
+			instruction->operation.operands[0] = NULL;
+			instruction->operation.operands[1] = NULL;
+			instruction->operation.operands[2] = NULL;
+			instruction->operation.opcode = JAM_OP_NONE;
+			instruction->operation.type = JAM_ILLEGAL_EXPR_TYPE;
+			instruction->operation.let = FALSE;
+			instruction->operation.text_index = 0;
+			instruction->code = code;
+			instruction->read_position = read_position;
+			instruction->statement_position = jam_current_statement_position;
+			instruction->next_statement_position = jam_next_statement_position;
+			jam_strcpy(instruction->text, statement_buffer);
+
+			instruction->next = jam_code_table[hash];
+			jam_code_table[hash] = instruction;
+
+			if ((jam_last_instruction != NULL) &&
+				(jam_last_instruction->next_statement_position ==
+					read_position))
+			{
+				jam_last_instruction->successor = instruction;
+			}
+			else if (jam_last_instruction != NULL)
+			{
+				jam_last_instruction->branch = instruction;
+			}
+		}
+
+		jam_last_instruction = instruction;
+	}
+
+	return (instruction);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAMS_INSTRUCTION *jam_current_instruction(void)
+
+/*																			*/
+/*	Description:	Finds the compiled form of the statement being			*/
+/*					executed.  This is the statement last found or added,	*/
+/*					unless the statement was not compiled.					*/
+/*																			*/
+/*	Returns:		Pointer to compiled statement, or NULL if none			*/
+/*																			*/
+/****************************************************************************/
+{
+	JAMS_INSTRUCTION *instruction = NULL;
+
+	if ((jam_last_instruction != NULL) &&
+		(jam_last_instruction->statement_position ==
+			jam_current_statement_position))
+	{
+		instruction = jam_last_instruction;
+	}
+
+	return (instruction);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAMS_EXPRESSION *jam_find_expression
+(
+	JAMS_INSTRUCTION *instruction,
+	char *text
+)
+
+/*																			*/
+/*	Description:	Looks for an expression of the given statement which	*/
+/*					has been compiled.										*/
+/*																			*/
+/*	Returns:		Pointer to compiled expression, or NULL if not found	*/
+/*																			*/
+/****************************************************************************/
+{
+	JAMS_EXPRESSION *expression = NULL;
+
+	if (instruction != NULL)
+	{
+		expression = instruction->expressions;
+
+		while ((expression != NULL) &&
+			(jam_strcmp(expression->text, text) != 0))
+		{
+			expression = expression->next;
+		}
+	}
+
+	return (expression);
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_add_expression
+(
+	JAMS_INSTRUCTION *instruction,
+	char *text,
+	JAMS_EXPRESSION_STEP *steps,
+	int step_count
+)
+
+/*																			*/
+/*	Description:	Keeps the steps taken to evaluate an expression of the	*/
+/*					given statement.  Nothing is kept if that would take	*/
+/*					the code over its limit; statements are not swept		*/
+/*					here, since the statement itself could be swept out.	*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	int i = 0;
+	long offset = 0L;
+	long size = 0L;
+	JAMS_EXPRESSION *expression = NULL;
+
+	/* the steps follow the text, aligned for the long values in them */
+	offset = (long) sizeof(JAMS_EXPRESSION) + jam_strlen(text);
+	offset = (offset + (long) sizeof(long) - 1L) & ~((long) sizeof(long) - 1L);
+	size = offset + (long) (step_count * sizeof(JAMS_EXPRESSION_STEP));
+
+	if ((instruction != NULL) && (jam_code_size + size <= jam_code_limit))
+	{
+		expression = (JAMS_EXPRESSION *) jam_malloc((unsigned int) size);
+
+		if (expression != NULL)
+		{
+			jam_code_size += size;
+			instruction->size += size;
+			expression->steps =
+				(JAMS_EXPRESSION_STEP *) (((char *) expression) + offset);
+			expression->step_count = step_count;
+			for (i = 0; i < step_count; ++i)
+			{
+				expression->steps[i] = steps[i];
+			}
+			jam_strcpy(expression->text, text);
+
+			expression->next = instruction->expressions;
+			instruction->expressions = expression;
+		}
+	}
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAMS_LITERAL *jam_find_literal
+(
+	JAMS_INSTRUCTION *instruction,
+	char kind,
+	char *text
+)
+
+/*																			*/
+/*	Description:	Looks for a literal array of the given statement which	*/
+/*					has been decoded.										*/
+/*																			*/
+/*	Returns:		Pointer to decoded literal, or NULL if not found		*/
+/*																			*/
+/****************************************************************************/
+{
+	JAMS_LITERAL *literal = NULL;
+
+	if (instruction != NULL)
+	{
+		literal = instruction->literals;
+
+		while ((literal != NULL) &&
+			((literal->kind != kind) || (jam_strcmp(literal->text, text) != 0)))
+		{
+			literal = literal->next;
+		}
+	}
+
+	return (literal);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAMS_LITERAL *jam_add_literal
+(
+	JAMS_INSTRUCTION *instruction,
+	char kind,
+	char *text,
+	long *data,
+	long length
+)
+
+/*																			*/
+/*	Description:	Keeps a copy of the decoded data of a literal array of	*/
+/*					the given statement, which has the given number of		*/
+/*					bits, 32 to each long.  As for expressions, nothing is	*/
+/*					kept if that would take the code over its limit.		*/
+/*																			*/
+/*	Returns:		Pointer to decoded literal, or NULL if not kept			*/
+/*																			*/
+/****************************************************************************/
+{
+	long i = 0L;
+	long long_count = (length + 31L) >> 5;
+	long offset = 0L;
+	long size = 0L;
+	JAMS_LITERAL *literal = NULL;
+
+	/* the data follows the text, aligned */
+	offset = (long) sizeof(JAMS_LITERAL) + jam_strlen(text);
+	offset = (offset + (long) sizeof(long) - 1L) & ~((long) sizeof(long) - 1L);
+	size = offset + (long) (long_count * sizeof(long));
+
+	if ((instruction != NULL) && (jam_code_size + size <= jam_code_limit))
+	{
+		literal = (JAMS_LITERAL *) jam_malloc((unsigned int) size);
+
+		if (literal != NULL)
+		{
+			jam_code_size += size;
+			instruction->size += size;
+			literal->data = (long *) (((char *) literal) + offset);
+			literal->length = length;
+			literal->kind = kind;
+			for (i = 0L; i < long_count; ++i)
+			{
+				literal->data[i] = data[i];
+			}
+			jam_strcpy(literal->text, text);
+
+			literal->next = instruction->literals;
+			instruction->literals = literal;
+		}
+	}
+
+	return (literal);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_find_symbol
+(
+	char *name,
+	JAMS_SYMBOL_RECORD **symbol_record
+)
+
+/*																			*/
+/*	Description:	Looks up a name used by the statement being executed.	*/
+/*					A compiled statement keeps the symbol record found		*/
+/*					the first time, so that later executions of it do not	*/
+/*					search the symbol table or check the scope of the name	*/
+/*					again.  Nothing is kept while a USES list is checked,	*/
+/*					since scope is not checked then, or if that would take	*/
+/*					the code over its limit.								*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else as for					*/
+/*					jam_get_symbol_record()									*/
+/*																			*/
+/****************************************************************************/
+{
+	long size = 0L;
+	JAMS_INSTRUCTION *instruction = NULL;
+	JAMS_SYMBOL_REF *symbol = NULL;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	if (!jam_checking_uses_list)
+	{
+		instruction = jam_current_instruction();
+	}
+
+	if (instruction != NULL)
+	{
+		symbol = instruction->symbols;
+
+		while ((symbol != NULL) && ((symbol->name[0] != name[0]) ||
+			(jam_strcmp(symbol->name, name) != 0)))
+		{
+			symbol = symbol->next;
+		}
+	}
+
+	if (symbol != NULL)
+	{
+		/* a scan may still owe this symbol its captured data */
+		jam_jtag_symbol_access(symbol->symbol_record);
+		*symbol_record = symbol->symbol_record;
+	}
+	else
+	{
+		status = jam_get_symbol_record(name, symbol_record);
+
+		size = (long) sizeof(JAMS_SYMBOL_REF) + jam_strlen(name);
+
+		if ((status == JAMC_SUCCESS) && (instruction != NULL) &&
+			(jam_code_size + size <= jam_code_limit))
+		{
+			symbol = (JAMS_SYMBOL_REF *) jam_malloc((unsigned int) size);
+
+			if (symbol != NULL)
+			{
+				jam_code_size += size;
+				instruction->size += size;
+				symbol->symbol_record = *symbol_record;
+				jam_strcpy(symbol->name, name);
+
+				symbol->next = instruction->symbols;
+				instruction->symbols = symbol;
+			}
+		}
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAMS_OPERATION *jam_add_operation
+(
+	JAMS_INSTRUCTION *instruction,
+	int text_index
+)
+
+/*																			*/
+/*	Description:	Makes the operation for the statement after THEN in an	*/
+/*					IF statement, whose text begins at the given index in	*/
+/*					the text of the compiled statement.  The operation is	*/
+/*					not yet translated.  As for expressions, nothing is		*/
+/*					made if that would take the code over its limit.		*/
+/*																			*/
+/*	Returns:		Pointer to new operation, or NULL if none was made		*/
+/*																			*/
+/****************************************************************************/
+{
+	long size = (long) sizeof(JAMS_OPERATION);
+	JAMS_OPERATION *operation = NULL;
+
+	if (jam_code_size + size <= jam_code_limit)
+	{
+		operation = (JAMS_OPERATION *) jam_malloc((unsigned int) size);
+
+		if (operation != NULL)
+		{
+			jam_code_size += size;
+			instruction->size += size;
+			operation->then = NULL;
+			operation->symbol_record = NULL;
+			operation->operands[0] = NULL;
+			operation->operands[1] = NULL;
+			operation->operands[2] = NULL;
+			operation->opcode = JAM_OP_NONE;
+			operation->type = JAM_ILLEGAL_EXPR_TYPE;
+			operation->let = FALSE;
+			operation->text_index = text_index;
+		}
+	}
+
+	return (operation);
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_export_code_statistics(void)
+
+/*																			*/
+/*	Description:	Exports the number of statements taken from the			*/
+/*					compiled code, the number read from the program text	*/
+/*					and the number run as operations, without the text,		*/
+/*					if the program was compiled.							*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	if (jam_code_table != NULL)
+	{
+		jam_export_integer("JAM_STATEMENT_CACHE_HITS", jam_code_hits);
+		jam_export_integer("JAM_STATEMENT_CACHE_MISSES", jam_code_misses);
+		jam_export_integer("JAM_COMPILED_OPERATIONS", jam_code_operations);
+	}
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_init_index(void)
+
+/*																			*/
+/*	Description:	Creates an empty program index.  No index is made when	*/
+/*					the program runs in a fixed workspace.					*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, JAMC_OUT_OF_MEMORY if the		*/
+/*					index was wanted but could not be made					*/
+/*																			*/
+/****************************************************************************/
+{
+	int hash = 0;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	jam_index_table = NULL;
+	jam_index_blocks = NULL;
+	jam_last_index_block = NULL;
+
+	if (jam_workspace == NULL)
+	{
+		jam_index_table = (JAMS_INDEX_ENTRY **) jam_malloc(
+			JAMC_MAX_SYMBOL_COUNT * sizeof(JAMS_INDEX_ENTRY *));
+
+		if (jam_index_table == NULL)
+		{
+			status = JAMC_OUT_OF_MEMORY;
+		}
+		else
+		{
+			for (hash = 0; hash < JAMC_MAX_SYMBOL_COUNT; ++hash)
+			{
+				jam_index_table[hash] = NULL;
+			}
+		}
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_free_index(void)
+
+/*																			*/
+/*	Description:	Frees all entries of the program index and the index,	*/
+/*					and any arrays not yet prefetched.						*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	int hash = 0;
+	JAMS_INDEX_ENTRY *entry = NULL;
+	JAMS_INDEX_ENTRY *next_entry = NULL;
+	JAMS_PREFETCH_ENTRY *prefetch = NULL;
+
+	while (jam_prefetch_list != NULL)
+	{
+		prefetch = jam_prefetch_list;
+		jam_prefetch_list = prefetch->next;
+		jam_free(prefetch);
+	}
+
+	jam_last_prefetch = NULL;
+	jam_index_blocks = NULL;
+	jam_last_index_block = NULL;
+
+	if (jam_index_table != NULL)
+	{
+		for (hash = 0; hash < JAMC_MAX_SYMBOL_COUNT; ++hash)
+		{
+			entry = jam_index_table[hash];
+
+			while (entry != NULL)
+			{
+				next_entry = entry->next;
+				jam_free(entry);
+				entry = next_entry;
+			}
+		}
+
+		jam_free(jam_index_table);
+		jam_index_table = NULL;
+	}
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_add_index_entry
+(
+	JAME_INDEX_TYPE type,
+	char *name,
+	long position,
+	long block_begin
+)
+
+/*																			*/
+/*	Description:	Adds a name found in the program to the index.  The		*/
+/*					same name may be added more than once.  Names must be	*/
+/*					added in the order of the file, with the USES list of	*/
+/*					an ACTION or PROCEDURE after its name; a USES entry		*/
+/*					which does not follow the name of its statement is of	*/
+/*					no use and is left out.									*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	int hash = 0;
+	JAMS_INDEX_ENTRY *entry = NULL;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	if (jam_strlen(name) > JAMC_MAX_NAME_LENGTH)
+	{
+		status = JAMC_ILLEGAL_SYMBOL;
+	}
+	else if ((jam_index_table != NULL) && ((type != JAM_INDEX_USES) ||
+		((jam_last_index_block != NULL) &&
+		(jam_last_index_block->position == position))))
+	{
+		entry = (JAMS_INDEX_ENTRY *) jam_malloc(sizeof(JAMS_INDEX_ENTRY));
+
+		if (entry == NULL)
+		{
+			status = JAMC_OUT_OF_MEMORY;
+		}
+		else
+		{
+			hash = jam_hash(name);
+			entry->type = type;
+			entry->position = position;
+			entry->block_begin = block_begin;
+			entry->reachable = FALSE;
+			entry->next_block = NULL;
+			entry->uses = NULL;
+			entry->next_use = NULL;
+			entry->next_work = NULL;
+			jam_strcpy(entry->name, name);
+			entry->next = jam_index_table[hash];
+			jam_index_table[hash] = entry;
+
+			if (type == JAM_INDEX_USES)
+			{
+				entry->next_use = jam_last_index_block->uses;
+				jam_last_index_block->uses = entry;
+			}
+			else if (type != JAM_INDEX_LABEL)
+			{
+				if (jam_last_index_block == NULL)
+				{
+					jam_index_blocks = entry;
+				}
+				else
+				{
+					jam_last_index_block->next_block = entry;
+				}
+
+				jam_last_index_block = entry;
+			}
+		}
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAMS_INDEX_ENTRY *jam_find_index_entry
+(
+	JAME_INDEX_TYPE type,
+	char *name,
+	long after
+)
+
+/*																			*/
+/*	Description:	Finds the first statement after the given position		*/
+/*					which has the given name.  -1 finds the first one in	*/
+/*					the program.											*/
+/*																			*/
+/*	Returns:		Pointer to index entry, or NULL if not found			*/
+/*																			*/
+/****************************************************************************/
+{
+	JAMS_INDEX_ENTRY *entry = NULL;
+	JAMS_INDEX_ENTRY *first_entry = NULL;
+
+	if (jam_index_table != NULL)
+	{
+		entry = jam_index_table[jam_hash(name)];
+
+		while (entry != NULL)
+		{
+			if ((entry->type == type) &&
+				(entry->position > after) &&
+				((first_entry == NULL) ||
+					(entry->position < first_entry->position)) &&
+				(jam_strcmp(entry->name, name) == 0))
+			{
+				first_entry = entry;
+			}
+
+			entry = entry->next;
+		}
+	}
+
+	return (first_entry);
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_save_index_entry
+(
+	JAMS_INDEX_IMAGE_ENTRY *image_entry,
+	JAMS_INDEX_ENTRY *entry
+)
+
+/*																			*/
+/*	Description:	Copies an entry of the program index into an image.		*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	image_entry->type = (long) entry->type;
+	image_entry->position = entry->position;
+	image_entry->block_begin = entry->block_begin;
+	jam_strcpy(image_entry->name, entry->name);
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_save_index(void)
+
+/*																			*/
+/*	Description:	Passes an image of the complete program index, and of	*/
+/*					the arrays to prefetch, to the save() function of the	*/
+/*					index store.  Nothing is saved if there is no store		*/
+/*					or not enough memory for the image.						*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	int hash = 0;
+	long length = 0L;
+	char *image = NULL;
+	JAMS_INDEX_IMAGE *header = NULL;
+	JAMS_INDEX_IMAGE_ENTRY *image_entry = NULL;
+	JAMS_INDEX_IMAGE_ARRAY *image_array = NULL;
+	JAMS_INDEX_ENTRY *entry = NULL;
+	JAMS_INDEX_ENTRY *use = NULL;
+	JAMS_PREFETCH_ENTRY *prefetch = NULL;
+	long entry_count = 0L;
+	long prefetch_count = 0L;
+
+	if ((jam_index_store != NULL) && (jam_index_table != NULL))
+	{
+		for (hash = 0; hash < JAMC_MAX_SYMBOL_COUNT; ++hash)
+		{
+			for (entry = jam_index_table[hash]; entry != NULL;
+				entry = entry->next)
+			{
+				++entry_count;
+			}
+		}
+
+		for (prefetch = jam_prefetch_list; prefetch != NULL;
+			prefetch = prefetch->next)
+		{
+			++prefetch_count;
+		}
+
+		length = (long) sizeof(JAMS_INDEX_IMAGE) +
+			(entry_count * (long) sizeof(JAMS_INDEX_IMAGE_ENTRY)) +
+			(prefetch_count * (long) sizeof(JAMS_INDEX_IMAGE_ARRAY));
+
+		image = (char *) jam_malloc((unsigned int) length);
+	}
+
+	if (image != NULL)
+	{
+		header = (JAMS_INDEX_IMAGE *) image;
+		header->magic = JAMC_INDEX_IMAGE_MAGIC;
+		header->program_size = jam_program_size;
+		header->entry_count = entry_count;
+		header->prefetch_count = prefetch_count;
+
+		image_entry = (JAMS_INDEX_IMAGE_ENTRY *) &header[1];
+
+		/* each block before its USES list, so that they are linked again */
+		for (entry = jam_index_blocks; entry != NULL;
+			entry = entry->next_block)
+		{
+			jam_save_index_entry(image_entry++, entry);
+
+			for (use = entry->uses; use != NULL; use = use->next_use)
+			{
+				jam_save_index_entry(image_entry++, use);
+			}
+		}
+
+		for (hash = 0; hash < JAMC_MAX_SYMBOL_COUNT; ++hash)
+		{
+			for (entry = jam_index_table[hash]; entry != NULL;
+				entry = entry->next)
+			{
+				if (entry->type == JAM_INDEX_LABEL)
+				{
+					jam_save_index_entry(image_entry++, entry);
+				}
+			}
+		}
+
+		image_array = (JAMS_INDEX_IMAGE_ARRAY *) image_entry;
+
+		for (prefetch = jam_prefetch_list; prefetch != NULL;
+			prefetch = prefetch->next)
+		{
+			image_array->block = prefetch->block;
+			image_array->request = prefetch->request;
+			++image_array;
+		}
+
+		jam_index_store->save(image, length);
+
+		jam_free(image);
+	}
+}
+
+/****************************************************************************/
+/*																			*/
+
+BOOL jam_load_index(void)
+
+/*																			*/
+/*	Description:	Makes the program index from an image taken from the	*/
+/*					load() function of the index store, so that the			*/
+/*					program need not be read to make it.  An image which	*/
+/*					does not fit the program, or is not consistent, is		*/
+/*					not used.												*/
+/*																			*/
+/*	Returns:		TRUE if the index was made from the image				*/
+/*																			*/
+/****************************************************************************/
+{
+	int index = 0;
+	long count = 0L;
+	long length = 0L;
+	char *image = NULL;
+	JAMS_INDEX_IMAGE *header = NULL;
+	JAMS_INDEX_IMAGE_ENTRY *image_entry = NULL;
+	JAMS_INDEX_IMAGE_ARRAY *image_array = NULL;
+	BOOL terminated = FALSE;
+	BOOL loaded = FALSE;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	if (jam_index_store != NULL)
+	{
+		image = jam_index_store->load(&length);
+	}
+
+	if ((image != NULL) && (length >= (long) sizeof(JAMS_INDEX_IMAGE)))
+	{
+		header = (JAMS_INDEX_IMAGE *) image;
+
+		if ((header->magic == JAMC_INDEX_IMAGE_MAGIC) &&
+			(header->program_size == jam_program_size) &&
+			(header->entry_count >= 0L) &&
+			(header->prefetch_count >= 0L) &&
+			(header->entry_count <= length /
+				(long) sizeof(JAMS_INDEX_IMAGE_ENTRY)) &&
+			(header->prefetch_count <= length /
+				(long) sizeof(JAMS_INDEX_IMAGE_ARRAY)) &&
+			(length == (long) sizeof(JAMS_INDEX_IMAGE) +
+				(header->entry_count *
+					(long) sizeof(JAMS_INDEX_IMAGE_ENTRY)) +
+				(header->prefetch_count *
+					(long) sizeof(JAMS_INDEX_IMAGE_ARRAY))))
+		{
+			status = jam_init_index();
+			loaded = (status == JAMC_SUCCESS) && (jam_index_table != NULL);
+		}
+	}
+
+	if (loaded)
+	{
+		image_entry = (JAMS_INDEX_IMAGE_ENTRY *) &header[1];
+
+		for (count = 0L; (count < header->entry_count) &&
+			(status == JAMC_SUCCESS); ++count)
+		{
+			terminated = FALSE;
+
+			for (index = 0; index <= JAMC_MAX_NAME_LENGTH; ++index)
+			{
+				if (image_entry->name[index] == JAMC_NULL_CHAR)
+				{
+					terminated = TRUE;
+				}
+			}
+
+			if ((!terminated) || (image_entry->type < JAM_INDEX_LABEL) ||
+				(image_entry->type > JAM_INDEX_USES))
+			{
+				status = JAMC_SYNTAX_ERROR;
+			}
+			else
+			{
+				status = jam_add_index_entry(
+					(JAME_INDEX_TYPE) image_entry->type, image_entry->name,
+					image_entry->position, image_entry->block_begin);
+			}
+
+			++image_entry;
+		}
+
+		image_array = (JAMS_INDEX_IMAGE_ARRAY *) image_entry;
+
+		for (count = 0L; (count < header->prefetch_count) &&
+			(status == JAMC_SUCCESS); ++count)
+		{
+			status = jam_add_prefetch_entry(image_array->block,
+				&image_array->request);
+
+			++image_array;
+		}
+
+		if (status != JAMC_SUCCESS)
+		{
+			/* the program will be read to make the index instead */
+			jam_free_index();
+			loaded = FALSE;
+		}
+	}
+
+	return (loaded);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_add_prefetch_entry
+(
+	long block,
+	JAMS_ARRAY_REQUEST *request
+)
+
+/*																			*/
+/*	Description:	Records an initialized Boolean array found by the		*/
+/*					index, to be prefetched by jam_prefetch_arrays(), with	*/
+/*					the index entry of the block it is in.  Arrays must be	*/
+/*					added in the order of the file, after the entries of	*/
+/*					their blocks, so that the entry is found by going on	*/
+/*					from the block of the last array.						*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	JAMS_PREFETCH_ENTRY *entry = NULL;
+	JAMS_INDEX_ENTRY *block_entry = jam_index_blocks;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	entry = (JAMS_PREFETCH_ENTRY *) jam_malloc(sizeof(JAMS_PREFETCH_ENTRY));
+
+	if (entry == NULL)
+	{
+		status = JAMC_OUT_OF_MEMORY;
+	}
+	else
+	{
+		if ((jam_last_prefetch != NULL) &&
+			(jam_last_prefetch->block_entry != NULL) &&
+			(jam_last_prefetch->block_entry->position <= block))
+		{
+			block_entry = jam_last_prefetch->block_entry;
+		}
+
+		while ((block_entry != NULL) && (block_entry->position < block))
+		{
+			block_entry = block_entry->next_block;
+		}
+
+		if ((block == -1L) || (block_entry == NULL) ||
+			(block_entry->position != block) ||
+			(block_entry->type == JAM_INDEX_ACTION))
+		{
+			block_entry = NULL;
+		}
+
+		entry->next = NULL;
+		entry->block_entry = block_entry;
+		entry->block = block;
+		entry->request = *request;
+
+		/* keep the order of the file, so arrays used first are queued first */
+		if (jam_last_prefetch == NULL)
+		{
+			jam_prefetch_list = entry;
+		}
+		else
+		{
+			jam_last_prefetch->next = entry;
+		}
+
+		jam_last_prefetch = entry;
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_mark_reachable_blocks
+(
+	void
+)
+
+/*																			*/
+/*	Description:	Marks the selected action, and every PROCEDURE and		*/
+/*					DATA block it can reach through procedure and USES		*/
+/*					lists, as reachable.  A procedure can only call the		*/
+/*					procedures in its USES list, so this finds all the		*/
+/*					blocks which the action may use, and a few more if		*/
+/*					optional procedures are not run.  Each block is			*/
+/*					visited once, from a list of the blocks marked but not	*/
+/*					yet visited.											*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	int i = 0;
+	JAMS_INDEX_ENTRY *entry = NULL;
+	JAMS_INDEX_ENTRY *use = NULL;
+	JAMS_INDEX_ENTRY *target = NULL;
+	JAMS_INDEX_ENTRY *work = NULL;
+	static const JAME_INDEX_TYPE target_types[] =
+		{ JAM_INDEX_PROCEDURE, JAM_INDEX_DATA };
+
+	for (entry = jam_index_blocks; entry != NULL; entry = entry->next_block)
+	{
+		entry->reachable = (entry->type == JAM_INDEX_ACTION) &&
+			(jam_action != NULL) && (jam_stricmp(entry->name, jam_action) == 0);
+
+		if (entry->reachable)
+		{
+			entry->next_work = work;
+			work = entry;
+		}
+	}
+
+	while (work != NULL)
+	{
+		entry = work;
+		work = entry->next_work;
+
+		for (use = entry->uses; use != NULL; use = use->next_use)
+		{
+			for (i = 0; i < 2; ++i)
+			{
+				target = jam_find_index_entry(target_types[i], use->name, -1L);
+
+				if ((target != NULL) && !target->reachable)
+				{
+					target->reachable = TRUE;
+					target->next_work = work;
+					work = target;
+				}
+			}
+		}
+	}
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_prefetch_arrays
+(
+	void
+)
+
+/*																			*/
+/*	Description:	Passes the initialized arrays found by the index to		*/
+/*					the prefetch() function of the array share.  Called		*/
+/*					once the language version of the program is known, as	*/
+/*					the index cannot tell how the data is to be decoded		*/
+/*					before then.  In a Jam 2.0 program, only arrays in		*/
+/*					blocks which the selected action can reach are passed.	*/
+/*					Arrays which are to be cached are left out, since		*/
+/*					their whole data is not kept anyway.					*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	JAMS_PREFETCH_ENTRY *entry = NULL;
+
+	if ((jam_version == 2) && (jam_index_table != NULL))
+	{
+		jam_mark_reachable_blocks();
+	}
+
+	while (jam_prefetch_list != NULL)
+	{
+		entry = jam_prefetch_list;
+		jam_prefetch_list = entry->next;
+
+		if ((entry->request.version == jam_version) &&
+			(jam_array_share != NULL) &&
+			(jam_array_share->prefetch != NULL) &&
+			((entry->block == -1L) || ((entry->block_entry != NULL) &&
+				entry->block_entry->reachable)) &&
+			!(jam_array_cache && ((long) (entry->request.words *
+				sizeof(long)) > (long) sizeof(JAMS_ARRAY_CACHE))))
+		{
+			jam_array_share->prefetch(&entry->request);
+		}
+
+		jam_free(entry);
+	}
+
+	jam_last_prefetch = NULL;
+}
@@ -0,0 +1,385 @@
+/****************************************************************************/
+/*																			*/
+/*	Module:			jamcode.h												*/
+/*																			*/
+/*	Description:	Definitions for the compiled program code.  Each		*/
+/*					statement is kept the first time it is read, so that	*/
+/*					later executions need not read it again from the		*/
+/*					program text.  Expressions in a kept statement are		*/
+/*					compiled, and its literal arrays decoded, when first	*/
+/*					used, and the symbol record of each name it looks up	*/
+/*					is kept.  Assignments, FOR, NEXT, IF, GOTO and CALL		*/
+/*					(Jam 1.1) statements are then translated into an		*/
+/*					operation which holds these records, and run without	*/
+/*					the text; other statements are still run by their		*/
+/*					handlers from the preprocessed text.  The program		*/
+/*					index holds the position of every label and block,		*/
+/*					found before the program runs.							*/
+/*																			*/
+/****************************************************************************/
+
+#ifndef INC_JAMCODE_H
+#define INC_JAMCODE_H
+
+/****************************************************************************/
+/*																			*/
+/*	Constant definitions													*/
+/*																			*/
+/****************************************************************************/
+
+/* number of hash chains for compiled statements */
+#define JAMC_CODE_HASH_SIZE 1021
+
+/* default number of bytes of compiled statements kept at one time */
+#define JAMC_DEFAULT_CODE_LIMIT 1048576L
+
+/* largest number of steps in one compiled expression */
+#define JAMC_MAX_EXPRESSION_STEPS 512
+
+/* first word of an image of the program index, "JID2" */
+#define JAMC_INDEX_IMAGE_MAGIC 0x4A494432L
+
+/****************************************************************************/
+/*																			*/
+/*	Type definitions														*/
+/*																			*/
+/****************************************************************************/
+
+/*
+*	One step of a compiled expression.  action is a production of the
+*	expression grammar, or one of the JAMC_STEP codes of jamexp.c.  value
+*	holds a decoded constant, or a pointer to the symbol record of a name.
+*/
+typedef struct
+{
+	int action;
+	JAME_EXPRESSION_TYPE type;
+	long value;
+
+} JAMS_EXPRESSION_STEP;
+
+/*
+*	A compiled expression: the steps taken by the lexer and parser when it
+*	was first evaluated, replayed to evaluate it again.  It belongs to the
+*	compiled statement it was found in, and is found by its text.
+*/
+typedef struct JAMS_EXPRESSION_STRUCT
+{
+	struct JAMS_EXPRESSION_STRUCT *next;		/* next in same statement */
+	JAMS_EXPRESSION_STEP *steps;
+	int step_count;
+	char text[1];				/* expression text */
+
+} JAMS_EXPRESSION;
+
+/*
+*	A literal Boolean array of a compiled statement, decoded the first time
+*	the statement runs.  kind is the '#', '$' or '@' which introduces it.
+*	The data is shared by all executions of the statement and must not be
+*	written to.
+*/
+typedef struct JAMS_LITERAL_STRUCT
+{
+	struct JAMS_LITERAL_STRUCT *next;			/* next in same statement */
+	long *data;
+	long length;				/* number of bits */
+	char kind;
+	char text[1];				/* literal text */
+
+} JAMS_LITERAL;
+
+/*
+*	A name looked up by a compiled statement, with the symbol record found
+*	the first time the statement ran.  Symbols are not removed while the
+*	program runs, so the record stays valid as long as the statement.
+*/
+typedef struct JAMS_SYMBOL_REF_STRUCT
+{
+	struct JAMS_SYMBOL_REF_STRUCT *next;		/* next in same statement */
+	struct JAMS_SYMBOL_STRUCT *symbol_record;
+	char name[1];				/* symbol name */
+
+} JAMS_SYMBOL_REF;
+
+/* operations of a compiled statement -- those run without the text */
+/* follow JAM_OP_TEXT */
+typedef enum
+{
+	JAM_OP_NONE = 0,		/* not yet translated */
+	JAM_OP_PENDING,			/* run once from the text, then translated */
+	JAM_OP_TEXT,			/* run from the text by its handler */
+	JAM_OP_ASSIGN,			/* variable = expression */
+	JAM_OP_ASSIGN_ELEMENT,	/* array[expression] = expression */
+	JAM_OP_FOR,
+	JAM_OP_NEXT,
+	JAM_OP_IF,
+	JAM_OP_GOTO,
+	JAM_OP_CALL				/* CALL of a label in Jam 1.1 */
+
+} JAME_OPCODE;
+
+/*
+*	The translated form of a statement.  symbol_record is the variable
+*	assigned or iterated, or the label jumped to, and operands are the
+*	compiled expressions of the statement in the order they are evaluated:
+*	the value, or the index and the value, of an assignment, the start,
+*	stop and step of a FOR (no step means a step of one), or the condition
+*	of an IF.  For an IF, then is the operation of the statement after
+*	THEN, whose text begins at text_index in the statement text.  A
+*	statement is translated the second time it runs, when the records it
+*	needs have been found; one which cannot be is run from the text.
+*/
+typedef struct JAMS_OPERATION_STRUCT
+{
+	struct JAMS_OPERATION_STRUCT *then;			/* statement after THEN */
+	struct JAMS_SYMBOL_STRUCT *symbol_record;
+	JAMS_EXPRESSION *operands[3];
+	JAME_OPCODE opcode;
+	JAME_EXPRESSION_TYPE type;	/* type of the variable assigned */
+	BOOL let;					/* assignment written with LET */
+	int text_index;
+
+} JAMS_OPERATION;
+
+/*
+*	A compiled statement.  It is found by the file position where reading
+*	of the statement begins, and holds the preprocessed text, the decoded
+*	instruction code, the positions set by jam_get_statement() and its
+*	operation.  It is linked to the statement read after it in sequence,
+*	and to the statement read after it the last time it jumped (GOTO, CALL,
+*	RETURN, NEXT, or an IF around one of them), so that the next statement
+*	is usually found without the hash table.  The referenced flag is set on
+*	each use, and statements not used since the last sweep are the first
+*	to go when the code reaches its limit.
+*/
+typedef struct JAMS_INSTRUCTION_STRUCT
+{
+	struct JAMS_INSTRUCTION_STRUCT *next;		/* next in hash chain */
+	struct JAMS_INSTRUCTION_STRUCT *successor;	/* statement which follows */
+	struct JAMS_INSTRUCTION_STRUCT *branch;		/* where it last jumped to */
+	JAMS_EXPRESSION *expressions;				/* compiled expressions */
+	JAMS_LITERAL *literals;						/* decoded literal arrays */
+	JAMS_SYMBOL_REF *symbols;					/* names looked up */
+	JAMS_OPERATION operation;
+	JAME_INSTRUCTION code;
+	BOOL referenced;
+	long size;					/* bytes allocated, with expressions */
+	long read_position;
+	long statement_position;
+	long next_statement_position;
+	char text[1];				/* preprocessed statement text */
+
+} JAMS_INSTRUCTION;
+
+/* kinds of names in the program index */
+typedef enum
+{
+	JAM_INDEX_LABEL = 0,
+	JAM_INDEX_ACTION,
+	JAM_INDEX_PROCEDURE,
+	JAM_INDEX_DATA,
+	JAM_INDEX_USES
+
+} JAME_INDEX_TYPE;
+
+/*
+*	A label, or the name of an ACTION, PROCEDURE or DATA statement, with
+*	the position of the statement.  block_begin is the position of the last
+*	ENDPROC statement before it, which limits a GOTO in a Jam 2.0 program
+*	to labels inside the same procedure.  A USES entry is a name in the
+*	procedure list of an ACTION, or in the USES list of a PROCEDURE, at
+*	the position of that statement.  The ACTION, PROCEDURE and DATA entries
+*	are also linked in the order of the file, and each one to the USES
+*	entries of its statement.
+*/
+typedef struct JAMS_INDEX_STRUCT
+{
+	struct JAMS_INDEX_STRUCT *next;				/* next in hash chain */
+	struct JAMS_INDEX_STRUCT *next_block;		/* next block in the file */
+	struct JAMS_INDEX_STRUCT *uses;				/* first of its USES list */
+	struct JAMS_INDEX_STRUCT *next_use;			/* next in same USES list */
+	struct JAMS_INDEX_STRUCT *next_work;		/* next block to visit */
+	JAME_INDEX_TYPE type;
+	long position;
+	long block_begin;
+	BOOL reachable;		/* the selected action can reach this block */
+	char name[JAMC_MAX_NAME_LENGTH + 1];
+
+} JAMS_INDEX_ENTRY;
+
+/*
+*	An initialized Boolean array found by the index, to be passed to the
+*	prefetch() function of the array share once the language version is
+*	known.  block is the position of the PROCEDURE or DATA statement of the
+*	declaration, or -1 outside any block, and block_entry is the index
+*	entry of that statement, or NULL if it has none.
+*/
+typedef struct JAMS_PREFETCH_STRUCT
+{
+	struct JAMS_PREFETCH_STRUCT *next;
+	JAMS_INDEX_ENTRY *block_entry;
+	long block;
+	JAMS_ARRAY_REQUEST request;
+
+} JAMS_PREFETCH_ENTRY;
+
+/*
+*	The image of the program index given to the index store: this header,
+*	then entry_count index entries, each ACTION, PROCEDURE and DATA entry
+*	in the order of the file followed by its USES entries, and then the
+*	labels, then prefetch_count arrays to prefetch in the order they were
+*	found.  It is only read back by a player built
+*	the same way, running the same program.
+*/
+typedef struct
+{
+	long magic;
+	long program_size;
+	long entry_count;
+	long prefetch_count;
+
+} JAMS_INDEX_IMAGE;
+
+typedef struct
+{
+	long type;
+	long position;
+	long block_begin;
+	char name[JAMC_MAX_NAME_LENGTH + 1];
+
+} JAMS_INDEX_IMAGE_ENTRY;
+
+typedef struct
+{
+	long block;
+	JAMS_ARRAY_REQUEST request;
+
+} JAMS_INDEX_IMAGE_ARRAY;
+
+/****************************************************************************/
+/*																			*/
+/*	Function prototypes														*/
+/*																			*/
+/****************************************************************************/
+
+void jam_init_code
+(
+	void
+);
+
+void jam_free_code
+(
+	void
+);
+
+JAMS_INSTRUCTION *jam_find_instruction
+(
+	long read_position
+);
+
+JAMS_INSTRUCTION *jam_add_instruction
+(
+	long read_position,
+	char *statement_buffer,
+	JAME_INSTRUCTION code
+);
+
+JAMS_INSTRUCTION *jam_current_instruction
+(
+	void
+);
+
+JAMS_EXPRESSION *jam_find_expression
+(
+	JAMS_INSTRUCTION *instruction,
+	char *text
+);
+
+void jam_add_expression
+(
+	JAMS_INSTRUCTION *instruction,
+	char *text,
+	JAMS_EXPRESSION_STEP *steps,
+	int step_count
+);
+
+JAMS_LITERAL *jam_find_literal
+(
+	JAMS_INSTRUCTION *instruction,
+	char kind,
+	char *text
+);
+
+JAMS_LITERAL *jam_add_literal
+(
+	JAMS_INSTRUCTION *instruction,
+	char kind,
+	char *text,
+	long *data,
+	long length
+);
+
+JAM_RETURN_TYPE jam_find_symbol
+(
+	char *name,
+	struct JAMS_SYMBOL_STRUCT **symbol_record
+);
+
+JAMS_OPERATION *jam_add_operation
+(
+	JAMS_INSTRUCTION *instruction,
+	int text_index
+);
+
+void jam_export_code_statistics
+(
+	void
+);
+
+JAM_RETURN_TYPE jam_init_index
+(
+	void
+);
+
+void jam_free_index
+(
+	void
+);
+
+JAM_RETURN_TYPE jam_add_index_entry
+(
+	JAME_INDEX_TYPE type,
+	char *name,
+	long position,
+	long block_begin
+);
+
+JAMS_INDEX_ENTRY *jam_find_index_entry
+(
+	JAME_INDEX_TYPE type,
+	char *name,
+	long after
+);
+
+void jam_save_index
+(
+	void
+);
+
+BOOL jam_load_index
+(
+	void
+);
+
+JAM_RETURN_TYPE jam_add_prefetch_entry
+(
+	long block,
+	JAMS_ARRAY_REQUEST *request
+);
+
+void jam_prefetch_arrays
+(
+	void
+);
+
+#endif /* INC_JAMCODE_H */
@@ -56,21 +56,27 @@ short jam_bits_required(short n)
 /****************************************************************************/
 /*																			*/
 
-short jam_read_packed(char *buffer, long length, short bits)
+short jam_read_packed
+(
+	JAMS_PACKED_CURSOR *cursor,
+	char *buffer,
+	long length,
+	short bits
+)
 
 /*																			*/
 /*	Description:	Read the next value from the input array "buffer".		*/
 /*					Read only "bits" bits from the array. The amount of		*/
 /*					bits that have already been read from "buffer" is		*/
-/*					stored internally to this function.					 	*/
+/*					stored in "cursor".										*/
 /*																			*/
 /*	Returns:		Up to 16 bit value. -1 if buffer overrun.				*/
 /*																			*/
 /****************************************************************************/
 {
 	short			result = -1;
-	static long		index = 0L;
-	static short	bits_avail = 0;
+	long			index = cursor->index;
+	short			bits_avail = cursor->bits_avail;
 	short			shift = 0;
 
 	/* If buffer is NULL then initialize. */
@@ -106,6 +112,9 @@ short jam_read_packed(char *buffer, long length, short bits)
 		}
 	}
 
+	cursor->index = index;
+	cursor->bits_avail = bits_avail;
+
 	return (result);
 }
 
@@ -134,16 +143,17 @@ long jam_uncompress
 	long	i, j, data_length = 0L;
 	short	offset, length;
 	long	match_data_length = MATCH_DATA_LENGTH;
+	JAMS_PACKED_CURSOR cursor = { 0L, 0 };
 
 	if (version == 2) --match_data_length;
 	
-	jam_read_packed(NULL, 0, 0);
+	jam_read_packed(&cursor, NULL, 0, 0);
 	for (i = 0; i < out_length; ++i) out[i] = 0;
 
-	/* Read number of bytes in data. */
-	for (i = 0; (size_t) i < sizeof (in_length); ++i)
+	/* Read number of bytes in data (always a 32-bit field). */
+	for (i = 0; i < 4; ++i)
 	{
-		data_length = data_length | ((long) jam_read_packed(in, in_length, CHAR_BITS) << (long) (i * CHAR_BITS));
+		data_length = data_length | ((long) jam_read_packed(&cursor, in, in_length, CHAR_BITS) << (long) (i * CHAR_BITS));
 	}
 
 	if (data_length > out_length) data_length = -1L;
@@ -153,13 +163,13 @@ long jam_uncompress
 		while (i < data_length)
 		{
 			/* A 0 bit indicates literal data. */
-			if (jam_read_packed(in, in_length, 1) == 0)
+			if (jam_read_packed(&cursor, in, in_length, 1) == 0)
 			{
 				for (j = 0; j < DATA_BLOB_LENGTH; ++j)
 				{
 					if (i < data_length)
 					{
-						out[i] = (char) jam_read_packed(in, in_length, CHAR_BITS);
+						out[i] = (char) jam_read_packed(&cursor, in, in_length, CHAR_BITS);
 						i++;
 					}
 				}
@@ -167,8 +177,8 @@ long jam_uncompress
 			else
 			{
 				/* A 1 bit indicates offset/length to follow. */
-				offset = jam_read_packed(in, in_length, jam_bits_required((short) (i > match_data_length ? match_data_length : i)));
-				length = jam_read_packed(in, in_length, CHAR_BITS);
+				offset = jam_read_packed(&cursor, in, in_length, jam_bits_required((short) (i > match_data_length ? match_data_length : i)));
+				length = jam_read_packed(&cursor, in, in_length, CHAR_BITS);
 
 				for (j = 0; j < length; ++j)
 				{
@@ -12,6 +12,27 @@
 #ifndef INC_JAMCOMP_H
 #define INC_JAMCOMP_H
 
+/* read position in the packed input data */
+typedef struct JAMS_PACKED_CURSOR_STRUCT
+{
+	long	index;		/* byte being read */
+	short	bits_avail;	/* bits not yet read from that byte */
+
+} JAMS_PACKED_CURSOR;
+
+short jam_bits_required
+(
+	short n
+);
+
+short jam_read_packed
+(
+	JAMS_PACKED_CURSOR *cursor,
+	char *buffer,
+	long length,
+	short bits
+);
+
 long jam_uncompress
 (
 	char *in, 
@@ -11,7 +11,50 @@
 #include "jamexprt.h"
 #include "jamdefs.h"
 #include "jamexec.h"
+#include "jamsym.h"
+#include "jamstack.h"
+#include "jamheap.h"
+#include "jamjtag.h"
 #include "jamutil.h"
+#include "jamload.h"
+#include "jamctx.h"
+
+/* change of the CRC shift register for each value of the low byte */
+static const unsigned short jam_crc_table[256] =
+{
+	0x0000, 0x1189, 0x2312, 0x329b, 0x4624, 0x57ad, 0x6536, 0x74bf,
+	0x8c48, 0x9dc1, 0xaf5a, 0xbed3, 0xca6c, 0xdbe5, 0xe97e, 0xf8f7,
+	0x1081, 0x0108, 0x3393, 0x221a, 0x56a5, 0x472c, 0x75b7, 0x643e,
+	0x9cc9, 0x8d40, 0xbfdb, 0xae52, 0xdaed, 0xcb64, 0xf9ff, 0xe876,
+	0x2102, 0x308b, 0x0210, 0x1399, 0x6726, 0x76af, 0x4434, 0x55bd,
+	0xad4a, 0xbcc3, 0x8e58, 0x9fd1, 0xeb6e, 0xfae7, 0xc87c, 0xd9f5,
+	0x3183, 0x200a, 0x1291, 0x0318, 0x77a7, 0x662e, 0x54b5, 0x453c,
+	0xbdcb, 0xac42, 0x9ed9, 0x8f50, 0xfbef, 0xea66, 0xd8fd, 0xc974,
+	0x4204, 0x538d, 0x6116, 0x709f, 0x0420, 0x15a9, 0x2732, 0x36bb,
+	0xce4c, 0xdfc5, 0xed5e, 0xfcd7, 0x8868, 0x99e1, 0xab7a, 0xbaf3,
+	0x5285, 0x430c, 0x7197, 0x601e, 0x14a1, 0x0528, 0x37b3, 0x263a,
+	0xdecd, 0xcf44, 0xfddf, 0xec56, 0x98e9, 0x8960, 0xbbfb, 0xaa72,
+	0x6306, 0x728f, 0x4014, 0x519d, 0x2522, 0x34ab, 0x0630, 0x17b9,
+	0xef4e, 0xfec7, 0xcc5c, 0xddd5, 0xa96a, 0xb8e3, 0x8a78, 0x9bf1,
+	0x7387, 0x620e, 0x5095, 0x411c, 0x35a3, 0x242a, 0x16b1, 0x0738,
+	0xffcf, 0xee46, 0xdcdd, 0xcd54, 0xb9eb, 0xa862, 0x9af9, 0x8b70,
+	0x8408, 0x9581, 0xa71a, 0xb693, 0xc22c, 0xd3a5, 0xe13e, 0xf0b7,
+	0x0840, 0x19c9, 0x2b52, 0x3adb, 0x4e64, 0x5fed, 0x6d76, 0x7cff,
+	0x9489, 0x8500, 0xb79b, 0xa612, 0xd2ad, 0xc324, 0xf1bf, 0xe036,
+	0x18c1, 0x0948, 0x3bd3, 0x2a5a, 0x5ee5, 0x4f6c, 0x7df7, 0x6c7e,
+	0xa50a, 0xb483, 0x8618, 0x9791, 0xe32e, 0xf2a7, 0xc03c, 0xd1b5,
+	0x2942, 0x38cb, 0x0a50, 0x1bd9, 0x6f66, 0x7eef, 0x4c74, 0x5dfd,
+	0xb58b, 0xa402, 0x9699, 0x8710, 0xf3af, 0xe226, 0xd0bd, 0xc134,
+	0x39c3, 0x284a, 0x1ad1, 0x0b58, 0x7fe7, 0x6e6e, 0x5cf5, 0x4d7c,
+	0xc60c, 0xd785, 0xe51e, 0xf497, 0x8028, 0x91a1, 0xa33a, 0xb2b3,
+	0x4a44, 0x5bcd, 0x6956, 0x78df, 0x0c60, 0x1de9, 0x2f72, 0x3efb,
+	0xd68d, 0xc704, 0xf59f, 0xe416, 0x90a9, 0x8120, 0xb3bb, 0xa232,
+	0x5ac5, 0x4b4c, 0x79d7, 0x685e, 0x1ce1, 0x0d68, 0x3ff3, 0x2e7a,
+	0xe70e, 0xf687, 0xc41c, 0xd595, 0xa12a, 0xb0a3, 0x8238, 0x93b1,
+	0x6b46, 0x7acf, 0x4854, 0x59dd, 0x2d62, 0x3ceb, 0x0e70, 0x1ff9,
+	0xf78f, 0xe606, 0xd49d, 0xc514, 0xb1ab, 0xa022, 0x92b9, 0x8330,
+	0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78
+};
 
 /****************************************************************************/
 /*																			*/
@@ -41,29 +84,15 @@ void jam_crc_update
 /*																			*/
 /*	Description:	This function updates crc shift register by shifting	*/
 /*					in the new data bits.  Must be called for each bytes in */
-/*					the order that they appear in the data stream.			*/
+/*					the order that they appear in the data stream.  All		*/
+/*					eight bits are shifted in at once, using jam_crc_table.	*/
 /*																			*/
 /*	Returns:		Nothing													*/
 /*																			*/
 /****************************************************************************/
 {
-	int bit, feedback;
-	unsigned short shift_register_copy;
-
-	shift_register_copy = *shift_register;	/* copy it to local variable */
-
-	for (bit = 0; bit < 8; bit++)	/* compute for each bit */
-	{
-		feedback = (data ^ shift_register_copy) & 0x01;
-		shift_register_copy >>= 1;	/* shift the shift register */
-		if (feedback)
-		{
-			shift_register_copy ^= 0x8408;	/* invert selected bits */
-		}
-		data >>= 1;		/* get the next bit of input_byte */
-	}
-
-	*shift_register = shift_register_copy;
+	*shift_register = (unsigned short) ((*shift_register >> 8) ^
+		jam_crc_table[(*shift_register ^ data) & 0xff]);
 }
 
 /****************************************************************************/
@@ -97,184 +126,237 @@ int jam_hexchar(int ch)
 /****************************************************************************/
 /*																			*/
 
-JAM_RETURN_TYPE jam_check_crc
+void jam_crc_scan_init
 (
-	char *program,
-	long program_size,
-	unsigned short *expected_crc,
-	unsigned short *actual_crc
+	JAMS_CRC_SCAN *scan
 )
 
 /*																			*/
-/*	Description:	This function reads the entire input stream and			*/
-/*					computes the CRC of everything up to the CRC statement	*/
-/*					itself (and the preceding new-line, if applicable).		*/
-/*					Carriage return characters (0x0d) which are followed	*/
-/*					by new-line characters (0x0a) are ignored, so the CRC	*/
-/*					will not change when the file is converted from MS-DOS	*/
-/*					text format (with CR-LF) to UNIX text format (only LF)	*/
-/*					and visa-versa.											*/
+/*	Description:	Prepares a CRC check, before the first character of		*/
+/*					the program is given to jam_crc_scan_char().			*/
 /*																			*/
-/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*	Returns:		Nothing													*/
 /*																			*/
 /****************************************************************************/
 {
-	BOOL comment = FALSE;
-	BOOL quoted_string = FALSE;
-	BOOL in_statement = FALSE;
-	BOOL in_instruction = FALSE;
-	BOOL found_expected_crc = FALSE;
-	int ch = 0;
-	long position = 0L;
-	long left_quote_position = -1L;
-	unsigned short crc_shift_register = 0;
-	unsigned short crc_shift_register_backup[4] = {0};
-	int ch_queue[4] = {0};
-	unsigned short tmp_expected_crc = 0;
-	unsigned short tmp_actual_crc = 0;
-	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+	int i = 0;
 
-	jam_program = program;
-	jam_program_size = program_size;
+	scan->state = JAMC_CRC_SCANNING;
+	jam_crc_init(&scan->shift_register);
 
-	status = jam_seek(0);
+	for (i = 0; i < 4; ++i)
+	{
+		scan->shift_register_backup[i] = 0;
+		scan->ch_queue[i] = 0;
+	}
 
-	jam_crc_init(&crc_shift_register);
+	scan->comment = FALSE;
+	scan->quoted_string = FALSE;
+	scan->in_statement = FALSE;
+	scan->in_instruction = FALSE;
+	scan->left_quote_position = -1L;
+	scan->digit_count = 0;
+	scan->found_expected_crc = FALSE;
+	scan->expected_crc = 0;
+	scan->status = JAMC_SUCCESS;
+}
 
-	while ((status == JAMC_SUCCESS) && (!found_expected_crc))
-	{
-		ch = jam_getc();
+/****************************************************************************/
+/*																			*/
+
+void jam_crc_scan_char
+(
+	JAMS_CRC_SCAN *scan,
+	int ch,
+	long position
+)
 
-		if ((ch != EOF) && (ch != JAMC_RETURN_CHAR))
+/*																			*/
+/*	Description:	Gives the next character of the program, or EOF, to		*/
+/*					the CRC check.  The CRC is computed over everything up	*/
+/*					to the CRC statement itself (and the preceding			*/
+/*					new-line, if applicable).  Carriage return characters	*/
+/*					(0x0d) are ignored, so the CRC will not change when the	*/
+/*					file is converted between MS-DOS and UNIX text format.	*/
+/*					Characters given after the check is done are ignored.	*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	switch (scan->state)
+	{
+	case JAMC_CRC_SCANNING:
+		if (ch == EOF)
+		{
+			/* end of file, and no CRC statement */
+			scan->status = JAMC_UNEXPECTED_END;
+			scan->state = JAMC_CRC_DONE;
+		}
+		else if (ch != JAMC_RETURN_CHAR)
 		{
-			jam_crc_update(&crc_shift_register, ch);
+			jam_crc_update(&scan->shift_register, ch);
 
-			if ((!comment) && (!quoted_string))
+			if ((!scan->comment) && (!scan->quoted_string))
 			{
 				if (ch == JAMC_COMMENT_CHAR)
 				{
 					/* beginning of comment */
-					comment = TRUE;
+					scan->comment = TRUE;
 				}
 				else if (ch == JAMC_QUOTE_CHAR)
 				{
 					/* beginning of quoted string */
-					quoted_string = TRUE;
-					left_quote_position = position;
+					scan->quoted_string = TRUE;
+					scan->left_quote_position = position;
 				}
 			}
 
 			/*
 			*	Check if this is the CRC statement
 			*/
-			if ((!comment) && (!quoted_string) &&
-				in_statement && in_instruction &&
-				(jam_isspace((char) ch_queue[3])) &&
-				(ch_queue[2] == 'C') &&
-				(ch_queue[1] == 'R') &&
-				(ch_queue[0] == 'C') &&
+			if ((!scan->comment) && (!scan->quoted_string) &&
+				scan->in_statement && scan->in_instruction &&
+				(jam_isspace((char) scan->ch_queue[3])) &&
+				(scan->ch_queue[2] == 'C') &&
+				(scan->ch_queue[1] == 'R') &&
+				(scan->ch_queue[0] == 'C') &&
 				(jam_isspace((char) ch)))
 			{
-				status = JAMC_SYNTAX_ERROR;
-				crc_shift_register = crc_shift_register_backup[3];
-
-				/* skip over any additional white space */
-				do { ch = jam_getc(); } while
-					((ch != EOF) && (jam_isspace((char) ch)));
-
-				if (jam_is_hex_char((char) ch))
+				scan->shift_register = scan->shift_register_backup[3];
+				scan->state = JAMC_CRC_BEFORE_VALUE;
+			}
+			else
+			{
+				/* check if we are reading the instruction name */
+				if ((!scan->comment) && (!scan->quoted_string) &&
+					(!scan->in_statement) && (jam_is_name_char((char) ch)))
 				{
-					/* get remaining three characters of CRC */
-					ch_queue[2] = jam_getc();
-					ch_queue[1] = jam_getc();
-					ch_queue[0] = jam_getc();
-
-					if ((jam_is_hex_char((char) ch_queue[2])) &&
-						(jam_is_hex_char((char) ch_queue[1])) &&
-						(jam_is_hex_char((char) ch_queue[0])))
-					{
-						tmp_expected_crc = (unsigned short)
-							((jam_hexchar(ch) << 12) |
-							(jam_hexchar(ch_queue[2]) << 8) |
-							(jam_hexchar(ch_queue[1]) << 4) |
-							jam_hexchar(ch_queue[0]));
-
-						/* skip over any additional white space */
-						do { ch = jam_getc(); } while
-							((ch != EOF) && (jam_isspace((char) ch)));
-
-						if (ch == JAMC_SEMICOLON_CHAR)
-						{
-							status = JAMC_SUCCESS;
-							found_expected_crc = TRUE;
-						}
-					}
+					scan->in_statement = TRUE;
+					scan->in_instruction = TRUE;
 				}
-			}
 
-			/* check if we are reading the instruction name */
-			if ((!comment) && (!quoted_string) && (!in_statement) &&
-				(jam_is_name_char((char) ch)))
-			{
-				in_statement = TRUE;
-				in_instruction = TRUE;
-			}
+				/* check if we are finished reading the instruction name */
+				if ((!scan->comment) && (!scan->quoted_string) &&
+					scan->in_statement && scan->in_instruction &&
+					(!jam_is_name_char((char) ch)))
+				{
+					scan->in_instruction = FALSE;
+				}
 
-			/* check if we are finished reading the instruction name */
-			if ((!comment) && (!quoted_string) && in_statement &&
-				in_instruction && (!jam_is_name_char((char) ch)))
-			{
-				in_instruction = FALSE;
-			}
+				if ((!scan->comment) && (!scan->quoted_string) &&
+					scan->in_statement && (ch == JAMC_SEMICOLON_CHAR))
+				{
+					/* end of statement */
+					scan->in_statement = FALSE;
+				}
 
-			if ((!comment) && (!quoted_string) && in_statement &&
-				(ch == JAMC_SEMICOLON_CHAR))
-			{
-				/* end of statement */
-				in_statement = FALSE;
-			}
+				if (scan->comment &&
+					((ch == JAMC_NEWLINE_CHAR) || (ch == JAMC_RETURN_CHAR)))
+				{
+					/* end of comment */
+					scan->comment = FALSE;
+				}
+				else if (scan->quoted_string && (ch == JAMC_QUOTE_CHAR) &&
+					(position > scan->left_quote_position))
+				{
+					/* end of quoted string */
+					scan->quoted_string = FALSE;
+				}
 
-			if (comment &&
-				((ch == JAMC_NEWLINE_CHAR) || (ch == JAMC_RETURN_CHAR)))
-			{
-				/* end of comment */
-				comment = FALSE;
-			}
-			else if (quoted_string && (ch == JAMC_QUOTE_CHAR) &&
-				(position > left_quote_position))
-			{
-				/* end of quoted string */
-				quoted_string = FALSE;
+				scan->ch_queue[3] = scan->ch_queue[2];
+				scan->ch_queue[2] = scan->ch_queue[1];
+				scan->ch_queue[1] = scan->ch_queue[0];
+				scan->ch_queue[0] = ch;
+
+				scan->shift_register_backup[3] =
+					scan->shift_register_backup[2];
+				scan->shift_register_backup[2] =
+					scan->shift_register_backup[1];
+				scan->shift_register_backup[1] =
+					scan->shift_register_backup[0];
+				scan->shift_register_backup[0] = scan->shift_register;
 			}
 		}
+		break;
 
-		if (ch == EOF)
+	case JAMC_CRC_BEFORE_VALUE:
+	case JAMC_CRC_AFTER_VALUE:
+		if ((ch != EOF) && jam_isspace((char) ch))
 		{
-			/* end of file */
-			status = JAMC_UNEXPECTED_END;
+			/* skip over any additional white space */
 		}
+		else if ((scan->state == JAMC_CRC_BEFORE_VALUE) &&
+			(ch != EOF) && jam_is_hex_char((char) ch))
+		{
+			/* first of the four characters of the CRC */
+			scan->expected_crc = (unsigned short) jam_hexchar(ch);
+			scan->digit_count = 1;
+			scan->state = JAMC_CRC_VALUE;
+		}
+		else if ((scan->state == JAMC_CRC_AFTER_VALUE) &&
+			(ch == JAMC_SEMICOLON_CHAR))
+		{
+			scan->found_expected_crc = TRUE;
+			scan->state = JAMC_CRC_DONE;
+		}
+		else
+		{
+			scan->status = JAMC_SYNTAX_ERROR;
+			scan->state = JAMC_CRC_DONE;
+		}
+		break;
 
-		++position;	/* position of next character to be read */
+	case JAMC_CRC_VALUE:
+		if ((ch != EOF) && jam_is_hex_char((char) ch))
+		{
+			scan->expected_crc = (unsigned short)
+				((scan->expected_crc << 4) | jam_hexchar(ch));
 
-		if (ch != JAMC_RETURN_CHAR)
+			if (++scan->digit_count == 4)
+			{
+				scan->state = JAMC_CRC_AFTER_VALUE;
+			}
+		}
+		else
 		{
-			ch_queue[3] = ch_queue[2];
-			ch_queue[2] = ch_queue[1];
-			ch_queue[1] = ch_queue[0];
-			ch_queue[0] = ch;
-
-			crc_shift_register_backup[3] = crc_shift_register_backup[2];
-			crc_shift_register_backup[2] = crc_shift_register_backup[1];
-			crc_shift_register_backup[1] = crc_shift_register_backup[0];
-			crc_shift_register_backup[0] = crc_shift_register;
+			scan->status = JAMC_SYNTAX_ERROR;
+			scan->state = JAMC_CRC_DONE;
 		}
+		break;
+
+	default:
+		break;
 	}
+}
 
-	tmp_actual_crc = jam_get_crc_value(&crc_shift_register);
+/****************************************************************************/
+/*																			*/
 
-	if (found_expected_crc && (expected_crc != NULL))
+JAM_RETURN_TYPE jam_crc_scan_result
+(
+	JAMS_CRC_SCAN *scan,
+	unsigned short *expected_crc,
+	unsigned short *actual_crc
+)
+
+/*																			*/
+/*	Description:	Gives the result of a CRC check, once the whole			*/
+/*					program (and EOF) was given to jam_crc_scan_char().		*/
+/*					The expected CRC is only set if the CRC statement was	*/
+/*					found.													*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, JAMC_CRC_ERROR if the CRC		*/
+/*					does not match, else appropriate error code				*/
+/*																			*/
+/****************************************************************************/
+{
+	unsigned short tmp_actual_crc = jam_get_crc_value(&scan->shift_register);
+	JAM_RETURN_TYPE status = scan->status;
+
+	if (scan->found_expected_crc && (expected_crc != NULL))
 	{
-		*expected_crc = tmp_expected_crc;
+		*expected_crc = scan->expected_crc;
 	}
 
 	if (actual_crc != NULL)
@@ -282,11 +364,61 @@ JAM_RETURN_TYPE jam_check_crc
 		*actual_crc = tmp_actual_crc;
 	}
 
-	if (found_expected_crc && (status == JAMC_SUCCESS) &&
-		(tmp_expected_crc != tmp_actual_crc))
+	if (scan->found_expected_crc && (status == JAMC_SUCCESS) &&
+		(scan->expected_crc != tmp_actual_crc))
 	{
 		status = JAMC_CRC_ERROR;
 	}
 
 	return (status);
 }
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_check_crc
+(
+	char *program,
+	long program_size,
+	unsigned short *expected_crc,
+	unsigned short *actual_crc
+)
+
+/*																			*/
+/*	Description:	Checks the CRC of the program.  The CRC is computed		*/
+/*					by the program loader, with jam_crc_scan_char(), in		*/
+/*					the same pass that makes the rest of the program		*/
+/*					descriptor; the program is only read here if it was		*/
+/*					not loaded yet.											*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	jam_enter_context();
+
+	jam_program = program;
+	jam_program_size = program_size;
+
+	status = jam_scan_program();
+
+	if (status == JAMC_SUCCESS)
+	{
+		status = jam_program_info.crc_status;
+
+		if (((status == JAMC_SUCCESS) || (status == JAMC_CRC_ERROR)) &&
+			(expected_crc != NULL))
+		{
+			*expected_crc = jam_program_info.expected_crc;
+		}
+
+		if (actual_crc != NULL)
+		{
+			*actual_crc = jam_program_info.actual_crc;
+		}
+	}
+
+	return (status);
+}
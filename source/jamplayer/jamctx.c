@@ -0,0 +1,356 @@
+/****************************************************************************/
+/*																			*/
+/*	Module:			jamctx.c												*/
+/*																			*/
+/*	Description:	Interpreter context management.  Each thread has its	*/
+/*					own current context, so that several JAM programs can	*/
+/*					run in one process on different threads.  A thread		*/
+/*					which never selects a context uses a private default	*/
+/*					one, which gives the original single program behavior.	*/
+/*																			*/
+/****************************************************************************/
+
+#include "jamexprt.h"
+#include "jamdefs.h"
+#include "jamsym.h"
+#include "jamstack.h"
+#include "jamheap.h"
+#include "jamjtag.h"
+#include "jamcode.h"
+#include "jamload.h"
+#include "jamctx.h"
+
+/****************************************************************************/
+/*																			*/
+/*	Global variables														*/
+/*																			*/
+/****************************************************************************/
+
+/* context of the program running on this thread */
+JAM_THREAD JAMS_CONTEXT *jam_context = NULL;
+
+/* used when the thread has not selected a context */
+JAM_THREAD JAMS_CONTEXT jam_thread_context;
+JAM_THREAD BOOL jam_thread_context_ready = FALSE;
+
+/****************************************************************************/
+/*																			*/
+
+void jam_init_context(JAMS_CONTEXT *context, void *user_data)
+
+/*																			*/
+/*	Description:	Sets every field of a context to its initial value.		*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	int i = 0;
+
+	context->user_data = user_data;
+	context->array_share = NULL;
+	context->index_store = NULL;
+
+	context->workspace = NULL;
+	context->workspace_size = 0L;
+	context->program = NULL;
+	context->program_size = 0L;
+	context->current_file_position = 0L;
+	context->current_statement_position = 0L;
+	context->next_statement_position = 0L;
+	context->statement_buffer_size = 0;
+	context->action = NULL;
+	context->init_list = NULL;
+	for (i = 0; i < JAMC_MAX_LITERAL_ARRAYS; ++i)
+	{
+		context->literal_array_buffer[i] = 0L;
+		context->literal_aca_buffer[i] = NULL;
+	}
+	context->vector_signal_count = 0;
+	context->version = 0;
+	context->phase = JAM_UNKNOWN_PHASE;
+	context->current_block = NULL;
+	context->checking_uses_list = FALSE;
+	context->statement_count = 0L;
+
+	context->statement_pool = NULL;
+	context->statement_pool_count = 0;
+	context->statement_pool_depth = 0;
+	context->statement_pool_peak = 0;
+	context->statement_pool_allocations = 0L;
+
+	context->program_info.crc_status = JAMC_SUCCESS;
+	context->program_info.expected_crc = 0;
+	context->program_info.actual_crc = 0;
+	context->program_info.statement_length = 0L;
+	context->program_info.statement_count = 0L;
+	context->program_info.note_count = 0L;
+	context->program_info.index_count = 0L;
+	context->program_info.load_time = 0L;
+	context->program_loaded = FALSE;
+	context->load_status = JAMC_SUCCESS;
+	context->loaded_program = NULL;
+	context->loaded_program_size = 0L;
+	context->note_positions = NULL;
+	context->direct_scan = FALSE;
+
+	context->code_table = NULL;
+	context->last_instruction = NULL;
+	context->code_limit = JAMC_DEFAULT_CODE_LIMIT;
+	context->code_size = 0L;
+	context->code_hits = 0L;
+	context->code_misses = 0L;
+	context->code_operations = 0L;
+	context->index_table = NULL;
+	context->index_blocks = NULL;
+	context->last_index_block = NULL;
+	context->prefetch_list = NULL;
+	context->last_prefetch = NULL;
+
+	context->symbol_table = NULL;
+	context->symbol_table_size = 0L;
+	context->symbol_count = 0L;
+	context->symbol_bottom = NULL;
+
+	context->stack = NULL;
+
+	context->heap = NULL;
+	context->heap_top = NULL;
+	context->heap_records = 0L;
+	context->array_cache = FALSE;
+
+	context->jtag_state = JAM_ILLEGAL_JTAG_STATE;
+	context->drstop_state = IDLE;
+	context->irstop_state = IDLE;
+	context->dr_preamble = 0;
+	context->dr_postamble = 0;
+	context->ir_preamble = 0;
+	context->ir_postamble = 0;
+	context->dr_length = 0;
+	context->ir_length = 0;
+	context->dr_preamble_data = NULL;
+	context->dr_postamble_data = NULL;
+	context->ir_preamble_data = NULL;
+	context->ir_postamble_data = NULL;
+	context->dr_buffer = NULL;
+	context->ir_buffer = NULL;
+	context->jtag_capture_count = 0;
+	context->jtag_target_lookup = FALSE;
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAMS_CONTEXT *jam_create_context(void *user_data)
+
+/*																			*/
+/*	Description:	Allocates a new context.  The user data pointer can be	*/
+/*					read back by the I/O functions with						*/
+/*					jam_get_context_data() while the context is in use.		*/
+/*																			*/
+/*	Returns:		Pointer to the context, or NULL if out of memory		*/
+/*																			*/
+/****************************************************************************/
+{
+	JAMS_CONTEXT *context = NULL;
+
+	context = (JAMS_CONTEXT *) jam_malloc(sizeof(JAMS_CONTEXT));
+
+	if (context != NULL)
+	{
+		jam_init_context(context, user_data);
+	}
+
+	return (context);
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_free_context(JAMS_CONTEXT *context)
+
+/*																			*/
+/*	Description:	Frees a context made by jam_create_context(), with		*/
+/*					the program descriptor made by the loader.  If it is	*/
+/*					the current context of the calling thread, the thread	*/
+/*					goes back to its default context.						*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	JAMS_CONTEXT *previous = jam_context;
+
+	if (context != NULL)
+	{
+		jam_context = context;
+		jam_free_program_info();
+
+		jam_context = (previous == context) ? NULL : previous;
+
+		jam_free(context);
+	}
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAMS_CONTEXT *jam_set_context(JAMS_CONTEXT *context)
+
+/*																			*/
+/*	Description:	Selects the context used by the interpreter functions	*/
+/*					called on this thread.  NULL selects the default		*/
+/*					context of the thread.  A context must not be in use	*/
+/*					on two threads at the same time.						*/
+/*																			*/
+/*	Returns:		The previous context, or NULL for the default			*/
+/*																			*/
+/****************************************************************************/
+{
+	JAMS_CONTEXT *previous = jam_context;
+
+	if (previous == &jam_thread_context) previous = NULL;
+
+	jam_context = context;
+
+	return (previous);
+}
+
+/****************************************************************************/
+/*																			*/
+
+void *jam_get_context_data(void)
+
+/*																			*/
+/*	Description:	Gets the user data of the current context, for use		*/
+/*					by jam_getc(), jam_seek(), jam_jtag_io() and the other	*/
+/*					I/O functions.											*/
+/*																			*/
+/*	Returns:		User data pointer, or NULL for the default context		*/
+/*																			*/
+/****************************************************************************/
+{
+	return ((jam_context == NULL) ? NULL : jam_context->user_data);
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_share_arrays(JAMS_CONTEXT *context, JAMS_ARRAY_SHARE *share)
+
+/*																			*/
+/*	Description:	Lets a context take initialized array data from a		*/
+/*					store shared with other contexts running the same		*/
+/*					program, instead of decoding it again.  NULL stops		*/
+/*					the sharing.											*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	if (context != NULL) context->array_share = share;
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_store_index(JAMS_CONTEXT *context, JAMS_INDEX_STORE *store)
+
+/*																			*/
+/*	Description:	Lets a context take the program index from a store		*/
+/*					kept between runs of the same program, instead of		*/
+/*					reading the whole program to make it, and pass each		*/
+/*					index it makes to the store.  NULL stops this.			*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	if (context != NULL) context->index_store = store;
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_set_code_limit(JAMS_CONTEXT *context, long size)
+
+/*																			*/
+/*	Description:	Sets the number of bytes of compiled statements that	*/
+/*					the context keeps while a program runs.  Zero turns		*/
+/*					compiling off, so that every statement is read from		*/
+/*					the program text.  Takes effect at the next				*/
+/*					jam_execute().											*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	if ((context != NULL) && (size >= 0L)) context->code_limit = size;
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_set_array_cache(JAMS_CONTEXT *context, int enable)
+
+/*																			*/
+/*	Description:	Turns array caching on or off for a context.  With		*/
+/*					caching on, a large initialized Boolean array keeps		*/
+/*					only a window of JAMC_ARRAY_CACHE_SIZE bytes of its		*/
+/*					decoded data, refilled from the program as needed.		*/
+/*					Only used with dynamic memory, not in a workspace.		*/
+/*					Takes effect at the next jam_execute().					*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	if (context != NULL) context->array_cache = enable;
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_set_direct_scan(JAMS_CONTEXT *context, int enable)
+
+/*																			*/
+/*	Description:	Tells the context that the program passed to			*/
+/*					jam_execute() and jam_get_note() is the same text		*/
+/*					that jam_getc() returns, so statements can be scanned	*/
+/*					directly in that memory instead of one character at		*/
+/*					a time through jam_getc().  Must stay off if the		*/
+/*					program is read from a stream.  Takes effect at the		*/
+/*					next jam_execute().										*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	if (context != NULL) context->direct_scan = enable;
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_enter_context(void)
+
+/*																			*/
+/*	Description:	Called by the entry points of the interpreter.  Makes	*/
+/*					sure that the thread has a current context, setting up	*/
+/*					the default context on first use.						*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	if (jam_context == NULL)
+	{
+		if (!jam_thread_context_ready)
+		{
+			jam_init_context(&jam_thread_context, NULL);
+			jam_thread_context_ready = TRUE;
+		}
+
+		jam_context = &jam_thread_context;
+	}
+}
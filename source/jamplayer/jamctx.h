@@ -0,0 +1,227 @@
+/****************************************************************************/
+/*																			*/
+/*	Module:			jamctx.h												*/
+/*																			*/
+/*	Description:	Definition of the interpreter context.  All state of	*/
+/*					a running JAM program is kept in a JAMS_CONTEXT, which	*/
+/*					the interpreter reaches through the context pointer of	*/
+/*					the calling thread.  The usual global variable names	*/
+/*					are defined below as aliases for the context fields.	*/
+/*																			*/
+/****************************************************************************/
+
+#ifndef INC_JAMCTX_H
+#define INC_JAMCTX_H
+
+/****************************************************************************/
+/*																			*/
+/*	Constant definitions													*/
+/*																			*/
+/****************************************************************************/
+
+/* number of buffers for constant literal array data */
+#define JAMC_MAX_LITERAL_ARRAYS 4
+
+/* call depths added to the statement buffer pool when it is full */
+#define JAMC_STATEMENT_POOL_GROWTH 8
+
+/****************************************************************************/
+/*																			*/
+/*	Type definitions														*/
+/*																			*/
+/****************************************************************************/
+
+struct JAMS_CONTEXT_STRUCT
+{
+	/* data supplied by the caller of jam_create_context() */
+	void *user_data;
+
+	/* decoded array data shared with other contexts, or NULL */
+	JAMS_ARRAY_SHARE *array_share;
+
+	/* store of the program index kept between runs, or NULL */
+	JAMS_INDEX_STORE *index_store;
+
+	/* program and workspace (jamexec.c) */
+	char *workspace;
+	long workspace_size;
+	char *program;
+	long program_size;
+	long current_file_position;
+	long current_statement_position;
+	long next_statement_position;
+	int statement_buffer_size;
+	char *action;
+	char **init_list;
+	long literal_array_buffer[JAMC_MAX_LITERAL_ARRAYS];
+	long *literal_aca_buffer[JAMC_MAX_LITERAL_ARRAYS];
+	int vector_signal_count;
+	int version;
+	JAME_PHASE_TYPE phase;
+	JAMS_SYMBOL_RECORD *current_block;
+	BOOL checking_uses_list;
+	long statement_count;
+
+	/* statement buffers of procedure and data block calls, by call depth */
+	char **statement_pool;
+	int statement_pool_count;
+	int statement_pool_depth;
+	int statement_pool_peak;
+	long statement_pool_allocations;
+
+	/* program descriptor made by the loader (jamload.c) */
+	JAMS_PROGRAM_INFO program_info;
+	BOOL program_loaded;
+	JAM_RETURN_TYPE load_status;
+	char *loaded_program;
+	long loaded_program_size;
+	long *note_positions;
+	BOOL direct_scan;
+
+	/* compiled statements (jamcode.c) */
+	struct JAMS_INSTRUCTION_STRUCT **code_table;
+	struct JAMS_INSTRUCTION_STRUCT *last_instruction;
+	long code_limit;
+	long code_size;
+	long code_hits;
+	long code_misses;
+	long code_operations;
+	struct JAMS_INDEX_STRUCT **index_table;
+	struct JAMS_INDEX_STRUCT *index_blocks;
+	struct JAMS_INDEX_STRUCT *last_index_block;
+	struct JAMS_PREFETCH_STRUCT *prefetch_list;
+	struct JAMS_PREFETCH_STRUCT *last_prefetch;
+
+	/* symbol table (jamsym.c) */
+	JAMS_SYMBOL_RECORD **symbol_table;
+	long symbol_table_size;
+	long symbol_count;
+	void *symbol_bottom;
+
+	/* stack (jamstack.c) */
+	JAMS_STACK_RECORD *stack;
+
+	/* heap (jamheap.c) */
+	JAMS_HEAP_RECORD *heap;
+	void *heap_top;
+	long heap_records;
+	BOOL array_cache;
+
+	/* JTAG state, padding and pending captures (jamjtag.c) */
+	JAME_JTAG_STATE jtag_state;
+	JAME_JTAG_STATE drstop_state;
+	JAME_JTAG_STATE irstop_state;
+	int dr_preamble;
+	int dr_postamble;
+	int ir_preamble;
+	int ir_postamble;
+	int dr_length;
+	int ir_length;
+	long *dr_preamble_data;
+	long *dr_postamble_data;
+	long *ir_preamble_data;
+	long *ir_postamble_data;
+	char *dr_buffer;
+	char *ir_buffer;
+	JAMS_JTAG_CAPTURE jtag_captures[JAMC_MAX_JTAG_CAPTURES];
+	int jtag_capture_count;
+	BOOL jtag_target_lookup;
+};
+
+/****************************************************************************/
+/*																			*/
+/*	Global variables														*/
+/*																			*/
+/****************************************************************************/
+
+extern JAM_THREAD JAMS_CONTEXT *jam_context;
+
+#define jam_array_share					(jam_context->array_share)
+#define jam_index_store					(jam_context->index_store)
+#define jam_workspace					(jam_context->workspace)
+#define jam_workspace_size				(jam_context->workspace_size)
+#define jam_program						(jam_context->program)
+#define jam_program_size				(jam_context->program_size)
+#define jam_current_file_position		(jam_context->current_file_position)
+#define jam_current_statement_position	(jam_context->current_statement_position)
+#define jam_next_statement_position		(jam_context->next_statement_position)
+#define jam_statement_buffer_size		(jam_context->statement_buffer_size)
+#define jam_action						(jam_context->action)
+#define jam_init_list					(jam_context->init_list)
+#define jam_literal_array_buffer		(jam_context->literal_array_buffer)
+#define jam_literal_aca_buffer			(jam_context->literal_aca_buffer)
+#define jam_vector_signal_count			(jam_context->vector_signal_count)
+#define jam_version						(jam_context->version)
+#define jam_phase						(jam_context->phase)
+#define jam_current_block				(jam_context->current_block)
+#define jam_checking_uses_list			(jam_context->checking_uses_list)
+#define jam_statement_count				(jam_context->statement_count)
+#define jam_statement_pool				(jam_context->statement_pool)
+#define jam_statement_pool_count		(jam_context->statement_pool_count)
+#define jam_statement_pool_depth		(jam_context->statement_pool_depth)
+#define jam_statement_pool_peak			(jam_context->statement_pool_peak)
+#define jam_statement_pool_allocations	(jam_context->statement_pool_allocations)
+#define jam_program_info				(jam_context->program_info)
+#define jam_program_loaded				(jam_context->program_loaded)
+#define jam_load_status					(jam_context->load_status)
+#define jam_loaded_program				(jam_context->loaded_program)
+#define jam_loaded_program_size			(jam_context->loaded_program_size)
+#define jam_note_positions				(jam_context->note_positions)
+#define jam_direct_scan					(jam_context->direct_scan)
+
+#define jam_code_table					(jam_context->code_table)
+#define jam_last_instruction			(jam_context->last_instruction)
+#define jam_code_limit					(jam_context->code_limit)
+#define jam_code_size					(jam_context->code_size)
+#define jam_code_hits					(jam_context->code_hits)
+#define jam_code_misses					(jam_context->code_misses)
+#define jam_code_operations				(jam_context->code_operations)
+#define jam_index_table					(jam_context->index_table)
+#define jam_index_blocks				(jam_context->index_blocks)
+#define jam_last_index_block			(jam_context->last_index_block)
+#define jam_prefetch_list				(jam_context->prefetch_list)
+#define jam_last_prefetch				(jam_context->last_prefetch)
+
+#define jam_symbol_table				(jam_context->symbol_table)
+#define jam_symbol_table_size			(jam_context->symbol_table_size)
+#define jam_symbol_count				(jam_context->symbol_count)
+#define jam_symbol_bottom				(jam_context->symbol_bottom)
+
+#define jam_stack						(jam_context->stack)
+
+#define jam_heap						(jam_context->heap)
+#define jam_heap_top					(jam_context->heap_top)
+#define jam_heap_records				(jam_context->heap_records)
+#define jam_array_cache					(jam_context->array_cache)
+
+#define jam_jtag_state					(jam_context->jtag_state)
+#define jam_drstop_state				(jam_context->drstop_state)
+#define jam_irstop_state				(jam_context->irstop_state)
+#define jam_dr_preamble					(jam_context->dr_preamble)
+#define jam_dr_postamble				(jam_context->dr_postamble)
+#define jam_ir_preamble					(jam_context->ir_preamble)
+#define jam_ir_postamble				(jam_context->ir_postamble)
+#define jam_dr_length					(jam_context->dr_length)
+#define jam_ir_length					(jam_context->ir_length)
+#define jam_dr_preamble_data			(jam_context->dr_preamble_data)
+#define jam_dr_postamble_data			(jam_context->dr_postamble_data)
+#define jam_ir_preamble_data			(jam_context->ir_preamble_data)
+#define jam_ir_postamble_data			(jam_context->ir_postamble_data)
+#define jam_dr_buffer					(jam_context->dr_buffer)
+#define jam_ir_buffer					(jam_context->ir_buffer)
+#define jam_jtag_captures				(jam_context->jtag_captures)
+#define jam_jtag_capture_count			(jam_context->jtag_capture_count)
+#define jam_jtag_target_lookup			(jam_context->jtag_target_lookup)
+
+/****************************************************************************/
+/*																			*/
+/*	Function prototypes														*/
+/*																			*/
+/****************************************************************************/
+
+void jam_enter_context
+(
+	void
+);
+
+#endif /* INC_JAMCTX_H */
@@ -27,6 +27,7 @@
 
 /* maximum quantities of some items */
 #define JAMC_MAX_SYMBOL_COUNT 1021	/* should be a prime number */
+#define JAMC_SYMBOL_TABLE_SIZE 512	/* first size, must be a power of two */
 #define JAMC_MAX_NESTING_DEPTH 128
 
 /* maximum JTAG IR and DR lengths (in bits) */
@@ -37,18 +38,25 @@
 #define JAMC_MAX_JTAG_DR_POSTAMBLE 1024
 #define JAMC_MAX_JTAG_DR_LENGTH    2048
 
-/* memory needed for JTAG buffers (in bytes) */
-#define JAMC_JTAG_BUFFER_SIZE   (( \
+/* memory needed for JTAG buffers (in bytes) -- preamble and postamble */
+/* data are arrays of long holding 32 bits each, scan buffers are char */
+#define JAMC_JTAG_BUFFER_SIZE   ((( \
 	JAMC_MAX_JTAG_IR_PREAMBLE   + \
 	JAMC_MAX_JTAG_IR_POSTAMBLE  + \
-	JAMC_MAX_JTAG_IR_LENGTH     + \
 	JAMC_MAX_JTAG_DR_PREAMBLE   + \
-	JAMC_MAX_JTAG_DR_POSTAMBLE  + \
-	JAMC_MAX_JTAG_DR_LENGTH     ) / 8)
+	JAMC_MAX_JTAG_DR_POSTAMBLE  ) / 32) * sizeof(long) + (( \
+	JAMC_MAX_JTAG_IR_LENGTH     + \
+	JAMC_MAX_JTAG_DR_LENGTH     ) / 8))
 
 /* size (in bytes) of cache buffer for initialized arrays */
 #define JAMC_ARRAY_CACHE_SIZE 1024
 
+/* bytes of uncompressed ACA data which a match may refer back to */
+#define JAMC_ACA_HISTORY_SIZE 8192
+
+/* copies of the ACA decoder kept for each cached array, to go back to */
+#define JAMC_ACA_SNAPSHOT_COUNT 4
+
 /* character length limits */
 #define JAMC_MAX_STATEMENT_LENGTH ((const int) jam_statement_buffer_size)
 #define JAMC_MAX_NAME_LENGTH 32
@@ -152,22 +160,4 @@ typedef enum
 
 } JAME_PHASE_TYPE;
 
-/****************************************************************************/
-/*																			*/
-/*	Global variables														*/
-/*																			*/
-/****************************************************************************/
-
-extern char *jam_workspace;
-
-extern long jam_workspace_size;
-
-extern char *jam_program;
-
-extern long jam_program_size;
-
-extern char **jam_init_list;
-
-extern JAME_PHASE_TYPE jam_phase;
-
 #endif /* INC_JAMDEFS_H */
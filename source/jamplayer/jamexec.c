@@ -4,11 +4,14 @@
 /*																			*/
 /*					Copyright (C) Altera Corporation 1997					*/
 /*																			*/
-/*	Description:	Contains the main entry point jam_execute(), and		*/
-/*					other functions to implement the main execution loop.	*/
-/*					This loop repeatedly calls jam_get_statement() and		*/
-/*					jam_execute_statement() to process statements in		*/
-/*					the JAM source file.									*/
+/*	Description:	Contains the main entry point jam_execute(), and other	*/
+/*					functions to implement the main execution loop.  This	*/
+/*					loop repeatedly calls jam_run_statement() to fetch and	*/
+/*					process statements in the JAM source file.  Statements	*/
+/*					are compiled the first time they are read (see			*/
+/*					jamcode.c); the common ones are then translated into	*/
+/*					operations which are run by jam_run_operation() without	*/
+/*					the text.												*/
 /*																			*/
 /*	Revisions:		2.4	fixed bug when spaces were present in array			*/
 /*					assignments												*/
@@ -33,131 +36,498 @@
 #include "jamarray.h"
 #include "jamjtag.h"
 #include "jamcomp.h"
+#include "jamcode.h"
+#include "jamload.h"
+#include "jamctx.h"
+
+/* function prototypes for forward reference */
+JAM_RETURN_TYPE jam_process_data(char *statement_buffer);
+JAM_RETURN_TYPE jam_process_procedure(char *statement_buffer);
+JAM_RETURN_TYPE jam_process_wait(char *statement_buffer);
+JAM_RETURN_TYPE jam_execute_statement(char *statement_buffer,
+	JAME_INSTRUCTION instruction_code, BOOL *done,
+	BOOL *reuse_statement_buffer, int *exit_code);
+JAM_RETURN_TYPE jam_run_statement(char *statement_buffer,
+	BOOL *reuse_statement_buffer, BOOL *done, int *exit_code);
+void jam_translate_statement(JAMS_INSTRUCTION *instruction,
+	JAMS_OPERATION *operation);
+
+/* prototype for external function in jamarray.c */
+extern int jam_6bit_char(int ch);
+
+/* prototype for external function in jamsym.c */
+extern BOOL jam_check_init_list(char *name, long *value);
 
 /****************************************************************************/
 /*																			*/
-/*	Global variables														*/
+
+JAM_RETURN_TYPE jam_init_statement_buffer
+(
+	char **statement_buffer,
+	unsigned int *statement_buffer_size
+)
+
+/*																			*/
+/*	Description:	Allocates a statement buffer big enough for the			*/
+/*					longest statement of the program, not counting the		*/
+/*					initialization data of Boolean arrays, which is read	*/
+/*					from the input stream when the array is used.  The		*/
+/*					length is taken from the program descriptor, so the		*/
+/*					program is only read if it was not loaded yet.			*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
 /*																			*/
 /****************************************************************************/
+{
+	long length = 0L;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
 
-/* pointer to memory buffer for variable, symbol and stack storage */
-char *jam_workspace = NULL;
+	status = jam_scan_program();
 
-/* size of available memory buffer */
-long jam_workspace_size = 0L;
+	if (status == JAMC_SUCCESS)
+	{
+		status = jam_load_status;
+		length = jam_program_info.statement_length;
+	}
+
+	if ((status == JAMC_SUCCESS) && (length != 0L))
+	{
+		/* one more byte for the null after a statement that was cut short */
+		*statement_buffer = (char *) jam_malloc((unsigned int) (length + 1025));
+
+		if (*statement_buffer == NULL)
+		{
+			status = JAMC_OUT_OF_MEMORY;
+		}
+		else
+		{
+			if (jam_statement_buffer_size != (int) (length + 1024))
+			{
+				jam_statement_buffer_size = (int) (length + 1024);
+				jam_export_integer("JAM_STATEMENT_BUFFER_SIZE", jam_statement_buffer_size);
+			}
 
-/* pointer to Jam program text */
-char *jam_program = NULL;
+			*statement_buffer_size = jam_statement_buffer_size;
+		}
+	}
 
-/* size of program buffer */
-long jam_program_size = 0L;
+	return (status);
+}
 
-/* current position in input stream */
-long jam_current_file_position = 0L;
+/****************************************************************************/
+/*																			*/
 
-/* position in input stream of the beginning of the current statement */
-long jam_current_statement_position = 0L;
+void jam_free_statement_buffer
+(
+	char **statement_buffer,
+	unsigned int *statement_buffer_size
+)
 
-/* position of the beginning of the next statement (the one after the */
-/* current statement, but not necessarily the next one to be executed) */
-long jam_next_statement_position = 0L;
+/*																			*/
+/*	Description:	This function reads a full statement from the input		*/
+/*					stream, preprocesses it to remove comments, and stores	*/
+/*					it in a buffer.  If the statement is an array			*/
+/*					declaration the initialization data is not stored in	*/
+/*					the buffer but must be read from the input stream when	*/
+/*					the array is used.										*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	if (statement_buffer && *statement_buffer)
+	{
+		jam_free(*statement_buffer);
+		*statement_buffer = 0;
+		*statement_buffer_size = 0;
+	}
+}
 
-int jam_statement_buffer_size = 0L;
+/****************************************************************************/
+/*																			*/
 
-/* name of desired action (Jam 2.0 only) */
-char *jam_action = NULL;
+JAM_RETURN_TYPE jam_get_pooled_statement_buffer
+(
+	char **statement_buffer,
+	unsigned int *statement_buffer_size
+)
 
-/* pointer to initialization list */
-char **jam_init_list = NULL;
+/*																			*/
+/*	Description:	Gets a statement buffer for a procedure or data block	*/
+/*					call from the pool of the context.  The pool keeps one	*/
+/*					buffer for each call depth, which is allocated the		*/
+/*					first time that depth is reached and then used by		*/
+/*					every later call at the same depth, so a call does not	*/
+/*					allocate a buffer the size of the longest statement.	*/
+/*					Each buffer taken must be given back with				*/
+/*					jam_release_pooled_statement_buffer().					*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	int index = 0;
+	char **new_pool = NULL;
+	unsigned int size = 0;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
 
-/* buffer for constant literal boolean array data */
-#define JAMC_MAX_LITERAL_ARRAYS 4
-long jam_literal_array_buffer[JAMC_MAX_LITERAL_ARRAYS];
+	*statement_buffer = NULL;
+	*statement_buffer_size = 0;
 
-/* buffer for constant literal ACA array data */
-long *jam_literal_aca_buffer[JAMC_MAX_LITERAL_ARRAYS];
+	if (jam_statement_pool_depth >= jam_statement_pool_count)
+	{
+		new_pool = (char **) jam_malloc((unsigned int)
+			((jam_statement_pool_count + JAMC_STATEMENT_POOL_GROWTH) *
+			sizeof(char *)));
 
-/* number of vector signals */
-int jam_vector_signal_count = 0;
+		if (new_pool == NULL)
+		{
+			status = JAMC_OUT_OF_MEMORY;
+		}
+		else
+		{
+			for (index = 0; index < jam_statement_pool_count +
+				JAMC_STATEMENT_POOL_GROWTH; ++index)
+			{
+				new_pool[index] = (index < jam_statement_pool_count) ?
+					jam_statement_pool[index] : NULL;
+			}
 
-/* version of Jam language used:  0 = unknown */
-int jam_version = 0;
+			if (jam_statement_pool != NULL) jam_free(jam_statement_pool);
+			jam_statement_pool = new_pool;
+			jam_statement_pool_count += JAMC_STATEMENT_POOL_GROWTH;
+		}
+	}
 
-/* phase of Jam execution */
-JAME_PHASE_TYPE jam_phase = JAM_UNKNOWN_PHASE;
+	if ((status == JAMC_SUCCESS) &&
+		(jam_statement_pool[jam_statement_pool_depth] == NULL))
+	{
+		status = jam_init_statement_buffer(
+			&jam_statement_pool[jam_statement_pool_depth], &size);
 
-/* current procedure or data block */
-JAMS_SYMBOL_RECORD *jam_current_block = NULL;
+		if (jam_statement_pool[jam_statement_pool_depth] != NULL)
+		{
+			++jam_statement_pool_allocations;
+		}
+	}
 
-/* this global flag indicates that we are processing the items in */
-/* the "uses" list for a procedure, executing the data blocks if */
-/* they have not yet been initialized, but not calling any procedures */
-BOOL jam_checking_uses_list = FALSE;
+	if ((status == JAMC_SUCCESS) &&
+		(jam_statement_pool[jam_statement_pool_depth] != NULL))
+	{
+		*statement_buffer = jam_statement_pool[jam_statement_pool_depth];
+		*statement_buffer_size = (unsigned int) jam_statement_buffer_size;
 
-/* function prototypes for forward reference */
-JAM_RETURN_TYPE jam_process_data(char *statement_buffer);
-JAM_RETURN_TYPE jam_process_procedure(char *statement_buffer);
-JAM_RETURN_TYPE jam_process_wait(char *statement_buffer);
-JAM_RETURN_TYPE jam_execute_statement(char *statement_buffer, BOOL *done,
-	BOOL *reuse_statement_buffer, int *exit_code);
+		++jam_statement_pool_depth;
 
-/* prototype for external function in jamarray.c */
-extern int jam_6bit_char(int ch);
+		if (jam_statement_pool_depth > jam_statement_pool_peak)
+		{
+			jam_statement_pool_peak = jam_statement_pool_depth;
+		}
+	}
 
-/* prototype for external function in jamsym.c */
-extern BOOL jam_check_init_list(char *name, long *value);
+	return (status);
+}
 
 /****************************************************************************/
 /*																			*/
 
-JAM_RETURN_TYPE jam_init_statement_buffer
+void jam_release_pooled_statement_buffer
 (
 	char **statement_buffer,
 	unsigned int *statement_buffer_size
 )
 
+/*																			*/
+/*	Description:	Gives a statement buffer taken with						*/
+/*					jam_get_pooled_statement_buffer() back to the pool.		*/
+/*					Buffers are given back in the reverse order.  Nothing	*/
+/*					is done if no buffer was taken.							*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	if ((*statement_buffer != NULL) && (jam_statement_pool_depth > 0))
+	{
+		--jam_statement_pool_depth;
+		*statement_buffer = NULL;
+		*statement_buffer_size = 0;
+	}
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_free_statement_pool
+(
+	void
+)
+
+/*																			*/
+/*	Description:	Frees the statement buffers of the pool at the end of	*/
+/*					a run.  In a build with MEM_TRACKER, the deepest		*/
+/*					nesting of calls and the number of buffers allocated	*/
+/*					are exported first.										*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	int index = 0;
+
+#if defined(MEM_TRACKER)
+	if (jam_statement_pool_allocations != 0L)
+	{
+		jam_export_integer("JAM_STATEMENT_POOL_PEAK_DEPTH",
+			(long) jam_statement_pool_peak);
+		jam_export_integer("JAM_STATEMENT_POOL_ALLOCATIONS",
+			jam_statement_pool_allocations);
+	}
+#endif /* MEM_TRACKER */
+
+	for (index = 0; index < jam_statement_pool_count; ++index)
+	{
+		if (jam_statement_pool[index] != NULL)
+		{
+			jam_free(jam_statement_pool[index]);
+		}
+	}
+
+	if (jam_statement_pool != NULL) jam_free(jam_statement_pool);
+
+	jam_statement_pool = NULL;
+	jam_statement_pool_count = 0;
+	jam_statement_pool_depth = 0;
+	jam_statement_pool_peak = 0;
+	jam_statement_pool_allocations = 0L;
+}
+
+/*
+*	Classes of characters for scanning a program in memory: characters
+*	which end a comment, end a quoted string, or change the state of the
+*	statement, white space, and the characters which start a Boolean array
+*	or a literal ACA array.  0xff is EOF where char is signed.
+*/
+#define JAMC_SCAN_COMMENT_END	0x01
+#define JAMC_SCAN_QUOTE_END		0x02
+#define JAMC_SCAN_STATE			0x04
+#define JAMC_SCAN_SPACE			0x08
+#define JAMC_SCAN_MARK			0x10
+
+static const unsigned char jam_scan_class[256] =
+{
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x08, 0x09, 0x00, 0x00, 0x09, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x08, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x04,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x04, 0x04, 0x00, 0x00, 0x00, 0x00,
+	0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07
+};
+
+/****************************************************************************/
+/*																			*/
+
+long jam_find_scan_stop
+(
+	char *program,
+	long position,
+	long program_size,
+	int stop_class
+)
+
+/*																			*/
+/*	Description:	Finds the first character from position on in the		*/
+/*					program in memory which is in one of the classes of		*/
+/*					stop_class.  jam_get_statement() skips or copies		*/
+/*					everything before it as one run.						*/
+/*																			*/
+/*	Returns:		Position of the character, or program_size if there is	*/
+/*					none													*/
+/*																			*/
+/****************************************************************************/
+{
+	while ((position < program_size) &&
+		((jam_scan_class[(unsigned char) program[position]] & stop_class) == 0))
+	{
+		++position;
+	}
+
+	return (position);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_get_statement
+(
+	char *statement_buffer,
+	char *label_buffer
+)
+
 /*																			*/
 /*	Description:	This function reads a full statement from the input		*/
 /*					stream, preprocesses it to remove comments, and stores	*/
 /*					it in a buffer.  If the statement is an array			*/
 /*					declaration the initialization data is not stored in	*/
 /*					the buffer but must be read from the input stream when	*/
-/*					the array is used.										*/
+/*					the array is used.  If the program is in memory (see	*/
+/*					jam_set_direct_scan()) it is read there, and runs of	*/
+/*					characters which cannot change the state, such as		*/
+/*					comments and array data, are skipped or copied whole.	*/
+/*					The file is then left at the end of the statement, as	*/
+/*					if it had been read with jam_getc().					*/
 /*																			*/
 /*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
 /*																			*/
 /****************************************************************************/
 {
 	int index = 0;
+	int label_index = 0;
 	int ch = 0;
 	int last_ch = 0;
-	unsigned int max_index = jam_statement_buffer_size;
-	char tmp_statement_buffer[32] = { 0 };
 	BOOL comment = FALSE;
 	BOOL quoted_string = FALSE;
 	BOOL boolean_array_data = FALSE;
 	BOOL literal_aca_array = FALSE;
 	BOOL label_found = FALSE;
-	BOOL done = (max_index != 0);
+	BOOL done = FALSE;
 	long position = jam_current_file_position;
 	long first_char_position = -1L;
+	long semicolon_position = -1L;
 	long left_quote_position = -1L;
+	long run_end = 0L;
+	char *program = jam_direct_scan ? jam_program : NULL;
+	long program_size = jam_program_size;
+	BOOL bracket_found = FALSE;
 	JAM_RETURN_TYPE status = JAMC_SUCCESS;
 
-#if 0
 	label_buffer[0] = JAMC_NULL_CHAR;
-#endif
 	statement_buffer[0] = JAMC_NULL_CHAR;
 
-	if (!done)
-	{
-		jam_seek(0);
-	}
-
 	while (!done)
 	{
+		if ((program != NULL) && (position < program_size))
+		{
+			run_end = position;
+
+			if (comment)
+			{
+				/* the rest of the comment is not looked at */
+				run_end = jam_find_scan_stop(program, position,
+					program_size, JAMC_SCAN_COMMENT_END);
+			}
+			else if (index >= JAMC_MAX_STATEMENT_LENGTH)
+			{
+				/* buffer is full -- only look for the next change of state */
+				run_end = jam_find_scan_stop(program, position, program_size,
+					quoted_string ? JAMC_SCAN_QUOTE_END : JAMC_SCAN_STATE);
+			}
+			else if ((!literal_aca_array) && ((!quoted_string) ||
+				((index >= 7) && (first_char_position != -1L))))
+			{
+				/*
+				*	Copy a run of characters which are all saved: the
+				*	inside of a quoted string, or a word or array data
+				*	up to the next white space or change of state
+				*/
+				run_end = jam_find_scan_stop(program, position, program_size,
+					quoted_string ? JAMC_SCAN_QUOTE_END :
+					(boolean_array_data ? (JAMC_SCAN_STATE | JAMC_SCAN_SPACE) :
+					(JAMC_SCAN_STATE | JAMC_SCAN_SPACE | JAMC_SCAN_MARK)));
+
+				if (run_end - position > JAMC_MAX_STATEMENT_LENGTH - index)
+				{
+					run_end = position + (JAMC_MAX_STATEMENT_LENGTH - index);
+				}
+
+				if ((run_end > position) && (first_char_position == -1L))
+				{
+					first_char_position = position;
+				}
+
+				bracket_found = FALSE;
+
+				if (quoted_string || boolean_array_data)
+				{
+					while (position < run_end)
+					{
+						ch = (int) program[position++];
+						if (ch == JAMC_RBRACKET_CHAR) bracket_found = TRUE;
+						statement_buffer[index++] = (char) ch;
+					}
+				}
+				else
+				{
+					while (position < run_end)
+					{
+						ch = (int) program[position++];
+						statement_buffer[index++] = (char)
+							(((ch >= 'a') && (ch <= 'z')) ?
+							(ch - ('a' - 'A')) : ch);
+					}
+				}
+
+				/* a right bracket in a quoted string counts as well */
+				if (bracket_found && (!boolean_array_data) &&
+					(jam_strncmp(statement_buffer, "BOOLEAN", 7) == 0))
+				{
+					boolean_array_data = TRUE;
+				}
+			}
+
+			if (run_end > position)
+			{
+				/* characters of the run were passed over without saving */
+				ch = (int) program[run_end - 1];
+
+				if ((!comment) && (!quoted_string) &&
+					((ch == JAMC_TAB_CHAR) ||
+					(ch == JAMC_NEWLINE_CHAR) ||
+					(ch == JAMC_RETURN_CHAR)))
+				{
+					ch = JAMC_SPACE_CHAR;
+				}
+
+				position = run_end;
+			}
+		}
+
 		last_ch = ch;
-		ch = jam_getc();
+
+		if (program == NULL)
+		{
+			ch = jam_getc();
+		}
+		else
+		{
+			ch = (position < program_size) ? (int) program[position] : EOF;
+		}
 
 		if ((!comment) && (!quoted_string))
 		{
@@ -183,7 +553,6 @@ JAM_RETURN_TYPE jam_init_statement_buffer
 				}
 				else if (index <= JAMC_MAX_NAME_LENGTH)
 				{
-#if 0
 					/* copy label into label_buffer */
 					for (label_index = 0; label_index < index; label_index++)
 					{
@@ -191,7 +560,6 @@ JAM_RETURN_TYPE jam_init_statement_buffer
 							statement_buffer[label_index];
 					}
 					label_buffer[index] = JAMC_NULL_CHAR;
-#endif
 					label_found = TRUE;
 
 					/* delete label from statement_buffer */
@@ -216,21 +584,23 @@ JAM_RETURN_TYPE jam_init_statement_buffer
 			}
 		}
 
-		/* include the character in the current count */
-		if ((!comment) &&
+		/* save character in statement_buffer */
+		if ((!comment) && (index < JAMC_MAX_STATEMENT_LENGTH) &&
 			((first_char_position != -1L) || (ch != JAMC_SPACE_CHAR)) &&
 			(quoted_string ||
 				(ch != JAMC_SPACE_CHAR) || (last_ch != JAMC_SPACE_CHAR)))
 		{
 			/* save the character */
-			/* convert to upper case */
-			if (index < 31)
+			/* convert to upper case except quotes and boolean arrays */
+			if (quoted_string || boolean_array_data || literal_aca_array)
+			{
+				statement_buffer[index] = (char) ch;
+			}
+			else
 			{
-				tmp_statement_buffer[index] = (char)
+				statement_buffer[index] = (char)
 					(((ch >= 'a') && (ch <= 'z')) ? (ch - ('a' - 'A')) : ch);
-				tmp_statement_buffer[index + 1] = JAMC_NULL_CHAR;
 			}
-
 			++index;
 			if (first_char_position == -1L) first_char_position = position;
 
@@ -239,9 +609,9 @@ JAM_RETURN_TYPE jam_init_statement_buffer
 			*	statement is a Boolean array declaration statement.
 			*/
 			if ((!boolean_array_data) && (ch == JAMC_RBRACKET_CHAR)
-				&& (tmp_statement_buffer[0] == 'B'))
+				&& (statement_buffer[0] == 'B'))
 			{
-				if (jam_strncmp(tmp_statement_buffer, "BOOLEAN", 7) == 0)
+				if (jam_strncmp(statement_buffer, "BOOLEAN", 7) == 0)
 				{
 					boolean_array_data = TRUE;
 				}
@@ -271,23 +641,15 @@ JAM_RETURN_TYPE jam_init_statement_buffer
 		if ((!comment) && (!quoted_string) && (ch == JAMC_SEMICOLON_CHAR))
 		{
 			/* end of statement */
-			if (!boolean_array_data && (index > (int) max_index))
-			{
-				max_index = (unsigned int) index;
-			}
-			first_char_position = -1L;
-			left_quote_position = -1L;
-			label_found = FALSE;
-			ch = 0;
-			boolean_array_data = FALSE;
-			literal_aca_array = FALSE;
-			index = 0;
+			done = TRUE;
+			semicolon_position = position;
 		}
 
 		if (ch == EOF)
 		{
 			/* end of file */
 			done = TRUE;
+			status = JAMC_UNEXPECTED_END;
 		}
 
 		if (comment &&
@@ -306,255 +668,30 @@ JAM_RETURN_TYPE jam_init_statement_buffer
 		++position;	/* position of next character to be read */
 	}
 
-	if ((status == JAMC_SUCCESS) && (max_index != 0))
+	if (index < JAMC_MAX_STATEMENT_LENGTH)
 	{
-		*statement_buffer = (char *) jam_malloc((unsigned int) (max_index + 1024));
-
-		if (*statement_buffer == NULL)
-		{
-			status = JAMC_OUT_OF_MEMORY;
-		}
-		else
-		{
-			if (jam_statement_buffer_size == 0)
-			{
-				jam_seek(jam_current_file_position);
-				jam_current_statement_position = jam_current_file_position;
-				jam_statement_buffer_size = max_index + 1024;
-				jam_export_integer("JAM_STATEMENT_BUFFER_SIZE", jam_statement_buffer_size);
-			}
-
-			*statement_buffer_size = jam_statement_buffer_size;
-		}
+		statement_buffer[index] = JAMC_NULL_CHAR;
 	}
-
-	return (status);
-}
-
-/****************************************************************************/
-/*																			*/
-
-void jam_free_statement_buffer
-(
-	char **statement_buffer,
-	unsigned int *statement_buffer_size
-)
-
-/*																			*/
-/*	Description:	This function reads a full statement from the input		*/
-/*					stream, preprocesses it to remove comments, and stores	*/
-/*					it in a buffer.  If the statement is an array			*/
-/*					declaration the initialization data is not stored in	*/
-/*					the buffer but must be read from the input stream when	*/
-/*					the array is used.										*/
-/*																			*/
-/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
-/*																			*/
-/****************************************************************************/
-{
-	if (statement_buffer && *statement_buffer)
+	else
 	{
-		jam_free(*statement_buffer);
-		*statement_buffer = 0;
-		*statement_buffer_size = 0;
+		statement_buffer[JAMC_MAX_STATEMENT_LENGTH] = JAMC_NULL_CHAR;
 	}
-}
-
-/****************************************************************************/
-/*																			*/
-
-JAM_RETURN_TYPE jam_get_statement
-(
-	char *statement_buffer,
-	char *label_buffer
-)
-
-/*																			*/
-/*	Description:	This function reads a full statement from the input		*/
-/*					stream, preprocesses it to remove comments, and stores	*/
-/*					it in a buffer.  If the statement is an array			*/
-/*					declaration the initialization data is not stored in	*/
-/*					the buffer but must be read from the input stream when	*/
-/*					the array is used.										*/
-/*																			*/
-/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
-/*																			*/
-/****************************************************************************/
-{
-	int index = 0;
-	int label_index = 0;
-	int ch = 0;
-	int last_ch = 0;
-	BOOL comment = FALSE;
-	BOOL quoted_string = FALSE;
-	BOOL boolean_array_data = FALSE;
-	BOOL literal_aca_array = FALSE;
-	BOOL label_found = FALSE;
-	BOOL done = FALSE;
-	long position = jam_current_file_position;
-	long first_char_position = -1L;
-	long semicolon_position = -1L;
-	long left_quote_position = -1L;
-	JAM_RETURN_TYPE status = JAMC_SUCCESS;
 
-	label_buffer[0] = JAMC_NULL_CHAR;
-	statement_buffer[0] = JAMC_NULL_CHAR;
+	jam_current_file_position = position;
 
-	while (!done)
+	if (program != NULL)
 	{
-		last_ch = ch;
-		ch = jam_getc();
-
-		if ((!comment) && (!quoted_string))
-		{
-			if (ch == JAMC_COMMENT_CHAR)
-			{
-				/* beginning of comment */
-				comment = TRUE;
-			}
-			else if (ch == JAMC_QUOTE_CHAR)
-			{
-				/* beginning of quoted string */
-				quoted_string = TRUE;
-				left_quote_position = position;
-			}
-			else if (ch == JAMC_COLON_CHAR)
-			{
-				/* statement contains a label */
-				if (label_found)
-				{
-					/* multiple labels found */
-					status = JAMC_SYNTAX_ERROR;
-					done = TRUE;
-				}
-				else if (index <= JAMC_MAX_NAME_LENGTH)
-				{
-					/* copy label into label_buffer */
-					for (label_index = 0; label_index < index; label_index++)
-					{
-						label_buffer[label_index] =
-							statement_buffer[label_index];
-					}
-					label_buffer[index] = JAMC_NULL_CHAR;
-					label_found = TRUE;
-
-					/* delete label from statement_buffer */
-					index = 0;
-					statement_buffer[0] = JAMC_NULL_CHAR;
-					first_char_position = -1L;
-					ch = JAMC_SPACE_CHAR;
-				}
-				else
-				{
-					/* label name was too long */
-					status = JAMC_ILLEGAL_SYMBOL;
-					done = TRUE;
-				}
-			}
-			else if ((ch == JAMC_TAB_CHAR) ||
-				(ch == JAMC_NEWLINE_CHAR) ||
-				(ch == JAMC_RETURN_CHAR))
-			{
-				/* convert tab, CR, LF to space character */
-				ch = JAMC_SPACE_CHAR;
-			}
-		}
-
-		/* save character in statement_buffer */
-		if ((!comment) && (index < JAMC_MAX_STATEMENT_LENGTH) &&
-			((first_char_position != -1L) || (ch != JAMC_SPACE_CHAR)) &&
-			(quoted_string ||
-				(ch != JAMC_SPACE_CHAR) || (last_ch != JAMC_SPACE_CHAR)))
-		{
-			/* save the character */
-			/* convert to upper case except quotes and boolean arrays */
-			if (quoted_string || boolean_array_data || literal_aca_array)
-			{
-				statement_buffer[index] = (char) ch;
-			}
-			else
-			{
-				statement_buffer[index] = (char)
-					(((ch >= 'a') && (ch <= 'z')) ? (ch - ('a' - 'A')) : ch);
-			}
-			++index;
-			if (first_char_position == -1L) first_char_position = position;
-
-			/*
-			*	Whenever we see a right bracket character, check if the
-			*	statement is a Boolean array declaration statement.
-			*/
-			if ((!boolean_array_data) && (ch == JAMC_RBRACKET_CHAR)
-				&& (statement_buffer[0] == 'B'))
-			{
-				if (jam_strncmp(statement_buffer, "BOOLEAN", 7) == 0)
-				{
-					boolean_array_data = TRUE;
-				}
-			}
-
-			/*
-			*	Check for literal ACA array assignment
-			*/
-			if ((!quoted_string) && (!boolean_array_data) &&
-				(!literal_aca_array) && (ch == JAMC_AT_CHAR))
-			{
-				/* this is the beginning of a literal ACA array */
-				literal_aca_array = TRUE;
-			}
-
-			if (literal_aca_array &&
-				(!jam_isalnum((char) ch)) &&
-				(ch != JAMC_AT_CHAR) &&
-				(ch != JAMC_UNDERSCORE_CHAR) &&
-				(ch != JAMC_SPACE_CHAR))
-			{
-				/* this is the end of the literal ACA array */
-				literal_aca_array = FALSE;
-			}
-		}
-
-		if ((!comment) && (!quoted_string) && (ch == JAMC_SEMICOLON_CHAR))
-		{
-			/* end of statement */
-			done = TRUE;
-			semicolon_position = position;
-		}
-
-		if (ch == EOF)
-		{
-			/* end of file */
-			done = TRUE;
-			status = JAMC_UNEXPECTED_END;
-		}
-
-		if (comment &&
-			((ch == JAMC_NEWLINE_CHAR) || (ch == JAMC_RETURN_CHAR)))
+		/* leave the file where jam_getc() would have left it */
+		if (position < program_size)
 		{
-			/* end of comment */
-			comment = FALSE;
+			jam_seek(position);
 		}
-		else if (quoted_string && (ch == JAMC_QUOTE_CHAR) &&
-			(position > left_quote_position))
+		else if ((program_size > 0L) && (jam_seek(program_size - 1L) == 0))
 		{
-			/* end of quoted string */
-			quoted_string = FALSE;
+			jam_getc();
 		}
-
-		++position;	/* position of next character to be read */
-	}
-
-	if (index < JAMC_MAX_STATEMENT_LENGTH)
-	{
-		statement_buffer[index] = JAMC_NULL_CHAR;
-	}
-	else
-	{
-		statement_buffer[JAMC_MAX_STATEMENT_LENGTH] = JAMC_NULL_CHAR;
 	}
 
-	jam_current_file_position = position;
-
 	if (first_char_position != -1L)
 	{
 		jam_current_statement_position = first_char_position;
@@ -702,36 +839,163 @@ JAME_INSTRUCTION jam_get_instruction
 /****************************************************************************/
 /*																			*/
 
-int jam_skip_instruction_name
+BOOL jam_has_array_data
 (
-	char *statement_buffer
+	char *statement_buffer,
+	JAME_INSTRUCTION instruction_code
 )
 
 /*																			*/
-/*	Description:	This function skips over the first "word" in the		*/
-/*					statement buffer, which is assumed to be the name of	*/
-/*					the instruction, and returns the index of the next		*/
-/*					non-white-space character in the buffer.				*/
+/*	Description:	Checks if a statement is a BOOLEAN or INTEGER array		*/
+/*					declaration with initialization data.					*/
 /*																			*/
-/*	Returns:		index of statement text after instruction name			*/
+/*	Returns:		TRUE if the statement declares initialized array data	*/
 /*																			*/
 /****************************************************************************/
 {
 	int index = 0;
+	BOOL array = FALSE;
+	BOOL data = FALSE;
 
-	while ((jam_isspace(statement_buffer[index])) &&
-		(index < JAMC_MAX_STATEMENT_LENGTH))
+	if ((instruction_code == JAM_BOOLEAN_INSTR) ||
+		(instruction_code == JAM_INTEGER_INSTR))
 	{
-		++index;	/* skip over white space */
+		while ((!data) && (statement_buffer[index] != JAMC_NULL_CHAR))
+		{
+			if (statement_buffer[index] == JAMC_LBRACKET_CHAR) array = TRUE;
+			if (array && (statement_buffer[index] == JAMC_EQUAL_CHAR))
+			{
+				data = TRUE;
+			}
+			++index;
+		}
 	}
 
-	while ((jam_is_name_char(statement_buffer[index])) &&
-		(index < JAMC_MAX_STATEMENT_LENGTH))
-	{
-		++index;	/* skip over instruction name */
-	}
+	return (data);
+}
 
-	while ((jam_isspace(statement_buffer[index])) &&
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_fetch_statement
+(
+	char *statement_buffer,
+	JAME_INSTRUCTION *instruction_code,
+	JAMS_INSTRUCTION **compiled
+)
+
+/*																			*/
+/*	Description:	Gets the next statement to be executed and its			*/
+/*					instruction code.  If the statement has been compiled	*/
+/*					already, it is translated the first time it is found	*/
+/*					(see jam_translate_statement()); if it has an			*/
+/*					operation, the compiled statement is returned in		*/
+/*					compiled and the statement buffer is left empty, else	*/
+/*					the text is copied from the compiled code.  Otherwise	*/
+/*					it is read with jam_get_statement(), its label is		*/
+/*					added to the symbol table, and it is compiled for the	*/
+/*					next time.  Array declarations with initialization		*/
+/*					data are never compiled: the data may not fit in the	*/
+/*					statement buffer, in which case it is read again from	*/
+/*					the file, and it is decoded only once anyway.			*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	long read_position = jam_current_file_position;
+	char label_buffer[JAMC_MAX_NAME_LENGTH + 1];
+	JAMS_INSTRUCTION *instruction = NULL;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	*compiled = NULL;
+
+	instruction = jam_find_instruction(read_position);
+
+	/* the file must be left where reading of the statement would leave it */
+	if ((instruction != NULL) &&
+		(jam_seek(instruction->next_statement_position) == 0))
+	{
+		jam_current_file_position = instruction->next_statement_position;
+		jam_current_statement_position = instruction->statement_position;
+		jam_next_statement_position = instruction->next_statement_position;
+		*instruction_code = instruction->code;
+
+		if (instruction->operation.opcode == JAM_OP_NONE)
+		{
+			jam_translate_statement(instruction, &instruction->operation);
+		}
+
+		if (instruction->operation.opcode == JAM_OP_TEXT)
+		{
+			jam_strcpy(statement_buffer, instruction->text);
+		}
+		else
+		{
+			statement_buffer[0] = JAMC_NULL_CHAR;
+			*compiled = instruction;
+		}
+	}
+	else
+	{
+		status = jam_get_statement(statement_buffer, label_buffer);
+
+		if ((status == JAMC_SUCCESS) && (label_buffer[0] != JAMC_NULL_CHAR))
+		{
+			status = jam_add_symbol(JAM_LABEL, label_buffer, 0L,
+				jam_current_statement_position);
+		}
+
+		if (status == JAMC_SUCCESS)
+		{
+			*instruction_code = jam_get_instruction(statement_buffer);
+
+			if ((instruction == NULL) &&
+				(jam_strlen(statement_buffer) < JAMC_MAX_STATEMENT_LENGTH) &&
+				(!jam_has_array_data(statement_buffer, *instruction_code)))
+			{
+				jam_add_instruction(read_position, statement_buffer,
+					*instruction_code);
+			}
+		}
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+int jam_skip_instruction_name
+(
+	char *statement_buffer
+)
+
+/*																			*/
+/*	Description:	This function skips over the first "word" in the		*/
+/*					statement buffer, which is assumed to be the name of	*/
+/*					the instruction, and returns the index of the next		*/
+/*					non-white-space character in the buffer.				*/
+/*																			*/
+/*	Returns:		index of statement text after instruction name			*/
+/*																			*/
+/****************************************************************************/
+{
+	int index = 0;
+
+	while ((jam_isspace(statement_buffer[index])) &&
+		(index < JAMC_MAX_STATEMENT_LENGTH))
+	{
+		++index;	/* skip over white space */
+	}
+
+	while ((jam_is_name_char(statement_buffer[index])) &&
+		(index < JAMC_MAX_STATEMENT_LENGTH))
+	{
+		++index;	/* skip over instruction name */
+	}
+
+	while ((jam_isspace(statement_buffer[index])) &&
 		(index < JAMC_MAX_STATEMENT_LENGTH))
 	{
 		++index;	/* skip over white space */
@@ -743,48 +1007,1027 @@ int jam_skip_instruction_name
 /****************************************************************************/
 /*																			*/
 
-int jam_find_keyword
+JAM_RETURN_TYPE jam_index_uses_list
 (
-	char *buffer,
-	char *keyword
+	char *statement_buffer,
+	JAME_INSTRUCTION instruction_code
+)
+
+/*																			*/
+/*	Description:	Adds the names in the procedure list of an ACTION		*/
+/*					statement, or in the USES list of a PROCEDURE			*/
+/*					statement, to the program index, so that the blocks		*/
+/*					which an action can reach may be found before it runs.	*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	int index = jam_skip_instruction_name(statement_buffer);
+	int name_begin = 0;
+	char save_ch = 0;
+	BOOL quoted = FALSE;
+	BOOL found = FALSE;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	if (instruction_code == JAM_ACTION_INSTR)
+	{
+		/* the procedure list follows the equal sign */
+		while ((!found) && (statement_buffer[index] != JAMC_NULL_CHAR) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			if (statement_buffer[index] == JAMC_QUOTE_CHAR) quoted = !quoted;
+			if ((!quoted) && (statement_buffer[index] == JAMC_EQUAL_CHAR))
+			{
+				found = TRUE;
+			}
+			++index;
+		}
+	}
+	else
+	{
+		while ((jam_is_name_char(statement_buffer[index])) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;	/* skip over procedure name */
+		}
+
+		while ((jam_isspace(statement_buffer[index])) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;	/* skip over white space */
+		}
+
+		if ((jam_strncmp(&statement_buffer[index], "USES", 4) == 0) &&
+			(jam_isspace(statement_buffer[index + 4])))
+		{
+			index += 4;
+			found = TRUE;
+		}
+	}
+
+	while (found && (status == JAMC_SUCCESS) &&
+		(statement_buffer[index] != JAMC_NULL_CHAR) &&
+		(statement_buffer[index] != JAMC_SEMICOLON_CHAR) &&
+		(index < JAMC_MAX_STATEMENT_LENGTH))
+	{
+		while ((jam_isspace(statement_buffer[index])) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;	/* skip over white space */
+		}
+
+		name_begin = index;
+
+		while ((jam_is_name_char(statement_buffer[index])) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;	/* skip over name */
+		}
+
+		if ((index > name_begin) &&
+			(index - name_begin <= JAMC_MAX_NAME_LENGTH))
+		{
+			save_ch = statement_buffer[index];
+			statement_buffer[index] = JAMC_NULL_CHAR;
+			status = jam_add_index_entry(JAM_INDEX_USES,
+				&statement_buffer[name_begin],
+				jam_current_statement_position, -1L);
+			statement_buffer[index] = save_ch;
+		}
+
+		/* skip OPTIONAL or RECOMMENDED, up to the next name */
+		while ((statement_buffer[index] != JAMC_NULL_CHAR) &&
+			(statement_buffer[index] != JAMC_COMMA_CHAR) &&
+			(statement_buffer[index] != JAMC_SEMICOLON_CHAR) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;
+		}
+
+		if (statement_buffer[index] == JAMC_COMMA_CHAR) ++index;
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_index_array_data
+(
+	char *statement_buffer,
+	long block
+)
+
+/*																			*/
+/*	Description:	Records a BOOLEAN array declaration with BIN, HEX,		*/
+/*					RLC or ACA data, and a constant dimension, to be		*/
+/*					prefetched.  Which version of the language the data		*/
+/*					is written for is taken from its syntax, and checked	*/
+/*					when the version of the program is known.				*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	int index = jam_skip_instruction_name(statement_buffer);
+	int data_offset = 0;
+	long dimension = 0L;
+	JAME_BOOLEAN_REP representation = JAM_ILLEGAL_REP;
+	JAMS_ARRAY_REQUEST request;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	while ((jam_is_name_char(statement_buffer[index])) &&
+		(index < JAMC_MAX_STATEMENT_LENGTH))
+	{
+		++index;	/* skip over array name */
+	}
+
+	while ((jam_isspace(statement_buffer[index])) &&
+		(index < JAMC_MAX_STATEMENT_LENGTH))
+	{
+		++index;	/* skip over white space */
+	}
+
+	if (statement_buffer[index] == JAMC_LBRACKET_CHAR)
+	{
+		++index;
+
+		while ((jam_isspace(statement_buffer[index])) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;	/* skip over white space */
+		}
+
+		while ((jam_isdigit(statement_buffer[index])) &&
+			(dimension < 0x7fffffffL / 10L) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			dimension = (dimension * 10L) + (statement_buffer[index] - '0');
+			++index;
+		}
+
+		while ((jam_isspace(statement_buffer[index])) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;	/* skip over white space */
+		}
+	}
+
+	/* a dimension which is an expression is not known until the program runs */
+	if ((dimension > 0L) && (statement_buffer[index] == JAMC_RBRACKET_CHAR))
+	{
+		++index;
+
+		while ((jam_isspace(statement_buffer[index])) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;	/* skip over white space */
+		}
+
+		if (statement_buffer[index] == JAMC_EQUAL_CHAR)
+		{
+			request.version = 2;
+			representation = jam_get_boolean_rep(
+				&statement_buffer[index + 1], 2, &data_offset);
+
+			if (representation == JAM_ILLEGAL_REP)
+			{
+				request.version = 1;
+				representation = jam_get_boolean_rep(
+					&statement_buffer[index + 1], 1, &data_offset);
+			}
+		}
+	}
+
+	/* a list of expressions depends on the state of the program */
+	if ((representation != JAM_ILLEGAL_REP) &&
+		(representation != JAM_BOOL_COMMA_SEP))
+	{
+		request.position = jam_current_statement_position;
+		request.words = (dimension >> 5) + ((dimension & 0x1f) ? 1 : 0);
+		request.dimension = dimension;
+		request.representation = (int) representation;
+
+		status = jam_add_prefetch_entry(block, &request);
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_index_statement
+(
+	char *statement_buffer,
+	char *label_buffer,
+	long *block_begin,
+	long *array_block
+)
+
+/*																			*/
+/*	Description:	Records the label of a statement, and the name of an	*/
+/*					ACTION, PROCEDURE or DATA statement, in the program		*/
+/*					index, with the arrays to prefetch and the blocks each	*/
+/*					ACTION and PROCEDURE uses.  Called by the program		*/
+/*					loader for each statement, in the order of the file.	*/
+/*					block_begin and array_block carry the enclosing			*/
+/*					blocks from one statement to the next.					*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	int index = 0;
+	int name_begin = 0;
+	char save_ch = 0;
+	JAME_INSTRUCTION instruction_code = JAM_ILLEGAL_INSTR;
+	JAME_INDEX_TYPE index_type = JAM_INDEX_LABEL;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	if (label_buffer[0] != JAMC_NULL_CHAR)
+	{
+		status = jam_add_index_entry(JAM_INDEX_LABEL, label_buffer,
+			jam_current_statement_position, *block_begin);
+	}
+
+	if (status == JAMC_SUCCESS)
+	{
+		instruction_code = jam_get_instruction(statement_buffer);
+
+		switch (instruction_code)
+		{
+		case JAM_ACTION_INSTR:
+			index_type = JAM_INDEX_ACTION;
+			break;
+
+		case JAM_PROCEDURE_INSTR:
+			index_type = JAM_INDEX_PROCEDURE;
+			break;
+
+		case JAM_DATA_INSTR:
+			index_type = JAM_INDEX_DATA;
+			break;
+
+		case JAM_ENDPROC_INSTR:
+			*block_begin = jam_current_statement_position;
+			index_type = JAM_INDEX_LABEL;
+			break;
+
+		default:
+			index_type = JAM_INDEX_LABEL;
+			break;
+		}
+	}
+
+	if ((status == JAMC_SUCCESS) && (index_type != JAM_INDEX_LABEL))
+	{
+		/*
+		*	Get the block name.  A name which is not valid cannot be
+		*	the target of a reference, so it is left out.  The name
+		*	goes in before the USES list, which is linked to it.
+		*/
+		index = jam_skip_instruction_name(statement_buffer);
+		name_begin = index;
+
+		while ((jam_is_name_char(statement_buffer[index])) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;	/* skip over block name */
+		}
+
+		if ((index > name_begin) &&
+			(index - name_begin <= JAMC_MAX_NAME_LENGTH))
+		{
+			save_ch = statement_buffer[index];
+			statement_buffer[index] = JAMC_NULL_CHAR;
+			status = jam_add_index_entry(index_type,
+				&statement_buffer[name_begin],
+				jam_current_statement_position, *block_begin);
+			statement_buffer[index] = save_ch;
+		}
+	}
+
+	if (status == JAMC_SUCCESS)
+	{
+		/*
+		*	Record the arrays to prefetch, with the block each is in,
+		*	and the blocks each ACTION and PROCEDURE uses
+		*/
+		if ((instruction_code == JAM_PROCEDURE_INSTR) ||
+			(instruction_code == JAM_DATA_INSTR))
+		{
+			*array_block = jam_current_statement_position;
+		}
+		else if ((instruction_code == JAM_ENDPROC_INSTR) ||
+			(instruction_code == JAM_ENDDATA_INSTR))
+		{
+			*array_block = -1L;
+		}
+
+		if ((instruction_code == JAM_ACTION_INSTR) ||
+			(instruction_code == JAM_PROCEDURE_INSTR))
+		{
+			status = jam_index_uses_list(statement_buffer,
+				instruction_code);
+		}
+		else if ((instruction_code == JAM_BOOLEAN_INSTR) &&
+			jam_has_array_data(statement_buffer, instruction_code))
+		{
+			status = jam_index_array_data(statement_buffer,
+				*array_block);
+		}
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_index_program
+(
+	void
+)
+
+/*																			*/
+/*	Description:	Makes sure the program index is ready before the		*/
+/*					program runs.  The index records the position of		*/
+/*					every label and of every ACTION, PROCEDURE and DATA		*/
+/*					statement, so forward references can be found without	*/
+/*					searching the file.  It is made by the program loader	*/
+/*					in the pass which checks the CRC, or taken from the		*/
+/*					index store; the program is only read again if an		*/
+/*					earlier run has used up the index.  No index is kept	*/
+/*					in a fixed workspace, and if the program cannot be		*/
+/*					read to the end, or there is not enough memory,			*/
+/*					forward references are searched for as before.  The		*/
+/*					time taken by the loader is exported.					*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	if (jam_workspace != NULL)
+	{
+		/* made by a loader which ran before the workspace was given */
+		jam_free_index();
+	}
+	else if (jam_index_table == NULL)
+	{
+		jam_program_loaded = FALSE;
+		(void) jam_scan_program();
+	}
+
+	if (jam_index_table != NULL)
+	{
+		jam_export_integer("JAM_INDEX_MICROSECONDS",
+			(long) jam_program_info.load_time);
+	}
+
+	jam_seek(0L);
+	jam_current_file_position = 0L;
+	jam_current_statement_position = 0L;
+	jam_next_statement_position = 0L;
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_read_indexed_block
+(
+	JAMS_INDEX_ENTRY *entry,
+	char *statement_buffer,
+	char *block_name,
+	JAMS_SYMBOL_RECORD **symbol_record
+)
+
+/*																			*/
+/*	Description:	Reads the PROCEDURE or DATA statement of a block found	*/
+/*					in the program index, and adds the block to the symbol	*/
+/*					table as a search through the file would have done on	*/
+/*					reaching the statement.									*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	char label_buffer[JAMC_MAX_NAME_LENGTH + 1];
+	JAM_RETURN_TYPE status = JAMC_IO_ERROR;
+
+	if (jam_seek(entry->position) == 0)
+	{
+		jam_current_file_position = entry->position;
+		status = jam_get_statement(statement_buffer, label_buffer);
+	}
+
+	if (status == JAMC_SUCCESS)
+	{
+		if (entry->type == JAM_INDEX_PROCEDURE)
+		{
+			status = jam_process_procedure(statement_buffer);
+		}
+		else
+		{
+			status = jam_process_data(statement_buffer);
+		}
+	}
+
+	if (status == JAMC_SUCCESS)
+	{
+		status = jam_find_symbol(block_name, symbol_record);
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+int jam_find_keyword
+(
+	char *buffer,
+	char *keyword
+)
+
+/*																			*/
+/*	Description:	This function searches in the statement buffer for the	*/
+/*					specified keyword.										*/
+/*																			*/
+/*	Returns:		index of keyword in buffer, or -1 if keyword not found	*/
+/*																			*/
+/****************************************************************************/
+{
+	BOOL found = FALSE;
+	int index = 0;
+	int buffer_length = jam_strlen(buffer);
+	int keyword_length = jam_strlen(keyword);
+
+	/* look at beginning of string */
+	if ((buffer[0] == keyword[0]) &&
+		(jam_strncmp(buffer, keyword, keyword_length) == 0) &&
+		(!jam_is_name_char(buffer[keyword_length])))
+	{
+		found = TRUE;
+	}
+
+	/* look inside string */
+	while ((!found) && (index + keyword_length <= buffer_length))
+	{
+		if ((buffer[index + 1] == keyword[0]) &&
+			(!jam_is_name_char(buffer[index])) &&
+			(jam_strncmp(&buffer[index + 1], keyword, keyword_length) == 0) &&
+			(!jam_is_name_char(buffer[index + keyword_length + 1])))
+		{
+			found = TRUE;
+		}
+
+		++index;
+	}
+
+	return (found ? index : -1);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAMS_EXPRESSION *jam_translate_expression
+(
+	JAMS_INSTRUCTION *instruction,
+	char *statement,
+	int expr_begin,
+	int expr_end
+)
+
+/*																			*/
+/*	Description:	Finds the compiled form of the expression between the	*/
+/*					given indexes in the text of a statement.  The text		*/
+/*					must be the same as the handler of the statement		*/
+/*					passes to jam_evaluate_expression(), so that the		*/
+/*					expression compiled when the statement last ran is		*/
+/*					found.													*/
+/*																			*/
+/*	Returns:		Pointer to compiled expression, or NULL if not found	*/
+/*																			*/
+/****************************************************************************/
+{
+	char save_ch = statement[expr_end];
+	JAMS_EXPRESSION *expression = NULL;
+
+	statement[expr_end] = JAMC_NULL_CHAR;
+	expression = jam_find_expression(instruction, &statement[expr_begin]);
+	statement[expr_end] = save_ch;
+
+	return (expression);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_translate_symbol
+(
+	char *statement,
+	int name_begin,
+	int name_end,
+	JAMS_SYMBOL_RECORD **symbol_record
+)
+
+/*																			*/
+/*	Description:	Looks up the name between the given indexes in the		*/
+/*					text of a statement, as its handler does.				*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else as for jam_find_symbol()	*/
+/*																			*/
+/****************************************************************************/
+{
+	char save_ch = statement[name_end];
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	statement[name_end] = JAMC_NULL_CHAR;
+	status = jam_find_symbol(&statement[name_begin], symbol_record);
+	statement[name_end] = save_ch;
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+BOOL jam_translate_assignment
+(
+	JAMS_INSTRUCTION *instruction,
+	JAMS_OPERATION *operation,
+	char *statement
+)
+
+/*																			*/
+/*	Description:	Translates an assignment to an integer or Boolean		*/
+/*					variable, or to one element of a writable array, as		*/
+/*					jam_process_assignment() reads it.  Assignments to a	*/
+/*					whole array or a range of elements are not translated.	*/
+/*																			*/
+/*	Returns:		TRUE if the statement was translated					*/
+/*																			*/
+/****************************************************************************/
+{
+	int index = 0;
+	int variable_begin = 0;
+	int variable_end = 0;
+	int dim_begin = 0;
+	int dim_end = 0;
+	int expr_begin = 0;
+	int expr_end = 0;
+	int bracket_count = 0;
+	BOOL translated = FALSE;
+	JAMS_SYMBOL_RECORD *symbol_record = NULL;
+
+	if (operation->let)
+	{
+		index = jam_skip_instruction_name(statement);
+	}
+
+	if (jam_isalpha(statement[index]))
+	{
+		/* locate variable name */
+		variable_begin = index;
+		while ((jam_is_name_char(statement[index])) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;	/* skip over variable name */
+		}
+		variable_end = index;
+
+		while ((jam_isspace(statement[index])) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;	/* skip over white space */
+		}
+
+		translated = (jam_translate_symbol(statement, variable_begin,
+			variable_end, &symbol_record) == JAMC_SUCCESS);
+	}
+
+	if (translated && (statement[index] == JAMC_LBRACKET_CHAR))
+	{
+		/* array element, by the same rules as the handler */
+		++index;
+		dim_begin = index;
+		while ((jam_isspace(statement[dim_begin])) &&
+			(dim_begin < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++dim_begin;	/* skip over white space */
+		}
+		while (((statement[index] != JAMC_RBRACKET_CHAR) ||
+			(bracket_count > 0)) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			if (statement[index] == JAMC_LBRACKET_CHAR)
+			{
+				++bracket_count;
+			}
+			else if (statement[index] == JAMC_RBRACKET_CHAR)
+			{
+				--bracket_count;
+			}
+
+			++index;	/* find matching bracket */
+		}
+		if (statement[index] == JAMC_RBRACKET_CHAR)
+		{
+			dim_end = index;
+		}
+
+		/* not a whole array or a range of elements */
+		translated = (dim_end > dim_begin);
+		for (index = dim_begin; translated && (index < dim_end); ++index)
+		{
+			if ((statement[index] == JAMC_PERIOD_CHAR) &&
+				(statement[index + 1] == JAMC_PERIOD_CHAR))
+			{
+				translated = FALSE;
+			}
+		}
+
+		index = dim_end + 1;
+		while ((jam_isspace(statement[index])) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;	/* skip over white space */
+		}
+
+		if (translated &&
+			(symbol_record->type == JAM_INTEGER_ARRAY_WRITABLE))
+		{
+			operation->type = JAM_INTEGER_EXPR;
+		}
+		else if (translated &&
+			(symbol_record->type == JAM_BOOLEAN_ARRAY_WRITABLE))
+		{
+			operation->type = JAM_BOOLEAN_EXPR;
+		}
+		else
+		{
+			translated = FALSE;
+		}
+
+		if (translated)
+		{
+			operation->opcode = JAM_OP_ASSIGN_ELEMENT;
+			operation->operands[0] = jam_translate_expression(
+				instruction, statement, dim_begin, dim_end);
+			translated = (operation->operands[0] != NULL);
+		}
+	}
+	else if (translated)
+	{
+		if (symbol_record->type == JAM_INTEGER_SYMBOL)
+		{
+			operation->type = JAM_INTEGER_EXPR;
+		}
+		else if (symbol_record->type == JAM_BOOLEAN_SYMBOL)
+		{
+			operation->type = JAM_BOOLEAN_EXPR;
+		}
+		else
+		{
+			translated = FALSE;
+		}
+
+		operation->opcode = JAM_OP_ASSIGN;
+	}
+
+	if (translated && (statement[index] == JAMC_EQUAL_CHAR))
+	{
+		expr_begin = index + 1;
+		while ((jam_isspace(statement[expr_begin])) &&
+			(expr_begin < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++expr_begin;	/* skip over white space */
+		}
+		while ((statement[index] != JAMC_NULL_CHAR) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;
+		}
+		while ((statement[index] != JAMC_SEMICOLON_CHAR) && (index > 0))
+		{
+			--index;
+		}
+		expr_end = index;
+
+		if (expr_end > expr_begin)
+		{
+			/* the value is the last operand */
+			index = (operation->opcode == JAM_OP_ASSIGN) ? 0 : 1;
+			operation->operands[index] = jam_translate_expression(
+				instruction, statement, expr_begin, expr_end);
+			translated = (operation->operands[index] != NULL);
+		}
+		else
+		{
+			translated = FALSE;
+		}
+	}
+	else
+	{
+		translated = FALSE;
+	}
+
+	operation->symbol_record = symbol_record;
+
+	return (translated);
+}
+
+/****************************************************************************/
+/*																			*/
+
+BOOL jam_translate_for
+(
+	JAMS_INSTRUCTION *instruction,
+	JAMS_OPERATION *operation,
+	char *statement
+)
+
+/*																			*/
+/*	Description:	Translates a FOR statement, as jam_process_for() reads	*/
+/*					it.														*/
+/*																			*/
+/*	Returns:		TRUE if the statement was translated					*/
+/*																			*/
+/****************************************************************************/
+{
+	int index = 0;
+	int variable_begin = 0;
+	int variable_end = 0;
+	int expr_begin = 0;
+	int expr_end = 0;
+	BOOL step = FALSE;
+	BOOL translated = FALSE;
+
+	index = jam_skip_instruction_name(statement);
+
+	if (jam_isalpha(statement[index]))
+	{
+		/* locate variable name */
+		variable_begin = index;
+		while ((jam_is_name_char(statement[index])) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;	/* skip over variable name */
+		}
+		variable_end = index;
+
+		while ((jam_isspace(statement[index])) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;	/* skip over white space */
+		}
+
+		if (statement[index] == JAMC_EQUAL_CHAR)
+		{
+			/* start value */
+			expr_begin = index + 1;
+			expr_end = jam_find_keyword(&statement[expr_begin], "TO");
+
+			if (expr_end > 0)
+			{
+				expr_end += expr_begin;
+				operation->operands[0] = jam_translate_expression(
+					instruction, statement, expr_begin, expr_end);
+				translated = (operation->operands[0] != NULL);
+				index = expr_end + 2;	/* step over "TO" */
+			}
+		}
+	}
+
+	if (translated)
+	{
+		/* stop value, and the step value if there is one */
+		while ((jam_isspace(statement[index])) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;	/* skip over white space */
+		}
+
+		expr_begin = index;
+		expr_end = jam_find_keyword(&statement[expr_begin], "STEP");
+
+		if (expr_end > 0)
+		{
+			step = TRUE;
+			expr_end += expr_begin;
+			operation->operands[1] = jam_translate_expression(
+				instruction, statement, expr_begin, expr_end);
+			translated = (operation->operands[1] != NULL);
+			index = expr_end + 4;	/* step over "STEP" */
+
+			while ((jam_isspace(statement[index])) &&
+				(index < JAMC_MAX_STATEMENT_LENGTH))
+			{
+				++index;	/* skip over white space */
+			}
+
+			expr_begin = index;
+		}
+
+		expr_end = 0;
+		while ((statement[index] != JAMC_NULL_CHAR) &&
+			(statement[index] != JAMC_SEMICOLON_CHAR) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;
+		}
+
+		if (statement[index] == JAMC_SEMICOLON_CHAR)
+		{
+			expr_end = index;
+		}
+
+		translated = translated && (expr_end > expr_begin);
+
+		if (translated)
+		{
+			index = step ? 2 : 1;
+			operation->operands[index] = jam_translate_expression(
+				instruction, statement, expr_begin, expr_end);
+			translated = (operation->operands[index] != NULL);
+		}
+	}
+
+	/* the iterator must be an integer */
+	if (translated)
+	{
+		translated = (jam_translate_symbol(statement, variable_begin,
+			variable_end, &operation->symbol_record) == JAMC_SUCCESS) &&
+			(operation->symbol_record->type == JAM_INTEGER_SYMBOL);
+	}
+
+	operation->opcode = JAM_OP_FOR;
+
+	return (translated);
+}
+
+/****************************************************************************/
+/*																			*/
+
+BOOL jam_translate_name
+(
+	JAMS_OPERATION *operation,
+	char *statement,
+	JAME_SYMBOL_TYPE symbol_type
+)
+
+/*																			*/
+/*	Description:	Translates a NEXT, GOTO or CALL statement, which names	*/
+/*					a symbol of the given type and nothing else, as			*/
+/*					jam_process_next() and jam_process_call_or_goto() read	*/
+/*					it.														*/
+/*																			*/
+/*	Returns:		TRUE if the statement was translated					*/
+/*																			*/
+/****************************************************************************/
+{
+	int index = 0;
+	int name_begin = 0;
+	int name_end = 0;
+	BOOL translated = FALSE;
+
+	index = jam_skip_instruction_name(statement);
+
+	if (jam_isalpha(statement[index]))
+	{
+		/* locate name */
+		name_begin = index;
+		while ((jam_is_name_char(statement[index])) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;	/* skip over name */
+		}
+		name_end = index;
+
+		while ((jam_isspace(statement[index])) &&
+			(index < JAMC_MAX_STATEMENT_LENGTH))
+		{
+			++index;	/* skip over white space */
+		}
+
+		translated = (statement[index] == JAMC_SEMICOLON_CHAR) &&
+			(jam_translate_symbol(statement, name_begin, name_end,
+				&operation->symbol_record) == JAMC_SUCCESS) &&
+			(operation->symbol_record->type == symbol_type);
+	}
+
+	return (translated);
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_translate_statement
+(
+	JAMS_INSTRUCTION *instruction,
+	JAMS_OPERATION *operation
 )
 
 /*																			*/
-/*	Description:	This function searches in the statement buffer for the	*/
-/*					specified keyword.										*/
+/*	Description:	Translates a compiled statement, or the statement		*/
+/*					after THEN in one, into an operation, after it has run	*/
+/*					once from the text.  The symbols it uses are looked up	*/
+/*					as its handler would look them up now, and its			*/
+/*					expressions are those compiled when it last ran.  If	*/
+/*					the statement is not one which can be translated, or	*/
+/*					anything it needs is not found, it is left to run from	*/
+/*					the text.  Jam 2.0 CALL statements, which call a		*/
+/*					procedure, are not translated.							*/
 /*																			*/
-/*	Returns:		index of keyword in buffer, or -1 if keyword not found	*/
+/*	Returns:		Nothing													*/
 /*																			*/
 /****************************************************************************/
 {
-	BOOL found = FALSE;
 	int index = 0;
-	int buffer_length = jam_strlen(buffer);
-	int keyword_length = jam_strlen(keyword);
+	int expr_begin = 0;
+	int then_index = 0;
+	char *statement = &instruction->text[operation->text_index];
+	JAME_INSTRUCTION code = instruction->code;
+	BOOL translated = FALSE;
 
-	/* look at beginning of string */
-	if ((buffer[0] == keyword[0]) &&
-		(jam_strncmp(buffer, keyword, keyword_length) == 0) &&
-		(!jam_is_name_char(buffer[keyword_length])))
+	if (operation != &instruction->operation)
 	{
-		found = TRUE;
+		code = jam_get_instruction(statement);
 	}
 
-	/* look inside string */
-	while ((!found) && (index + keyword_length <= buffer_length))
+	switch (code)
 	{
-		if ((buffer[index + 1] == keyword[0]) &&
-			(!jam_is_name_char(buffer[index])) &&
-			(jam_strncmp(&buffer[index + 1], keyword, keyword_length) == 0) &&
-			(!jam_is_name_char(buffer[index + keyword_length + 1])))
+	case JAM_LET_INSTR:
+		operation->let = TRUE;
+		translated = jam_translate_assignment(instruction, operation,
+			statement);
+		break;
+
+	case JAM_ILLEGAL_INSTR:
+		/* an assignment without LET, in Jam 2.0 */
+		translated = (jam_version == 2) &&
+			jam_translate_assignment(instruction, operation, statement);
+		break;
+
+	case JAM_FOR_INSTR:
+		translated = jam_translate_for(instruction, operation, statement);
+		break;
+
+	case JAM_NEXT_INSTR:
+		operation->opcode = JAM_OP_NEXT;
+		translated = jam_translate_name(operation, statement,
+			JAM_INTEGER_SYMBOL);
+		break;
+
+	case JAM_GOTO_INSTR:
+		operation->opcode = JAM_OP_GOTO;
+		translated = jam_translate_name(operation, statement, JAM_LABEL);
+		break;
+
+	case JAM_CALL_INSTR:
+		operation->opcode = JAM_OP_CALL;
+		translated = (jam_version != 2) &&
+			jam_translate_name(operation, statement, JAM_LABEL);
+		break;
+
+	case JAM_IF_INSTR:
+		expr_begin = jam_skip_instruction_name(statement);
+		then_index = jam_find_keyword(&statement[expr_begin], "THEN");
+
+		if (then_index > 0)
 		{
-			found = TRUE;
+			operation->opcode = JAM_OP_IF;
+			operation->operands[0] = jam_translate_expression(instruction,
+				statement, expr_begin, expr_begin + then_index);
+
+			index = expr_begin + then_index + 4;
+			while ((jam_isspace(statement[index])) &&
+				(index < JAMC_MAX_STATEMENT_LENGTH))
+			{
+				++index;	/* skip over white space */
+			}
+
+			/* the statement after THEN is translated when it runs */
+			if (operation->operands[0] != NULL)
+			{
+				operation->then = jam_add_operation(instruction,
+					operation->text_index + index);
+				translated = (operation->then != NULL);
+			}
 		}
+		break;
 
-		++index;
+	default:
+		break;
 	}
 
-	return (found ? index : -1);
+	if (!translated)
+	{
+		operation->opcode = JAM_OP_TEXT;
+	}
 }
 
 /****************************************************************************/
@@ -1028,7 +2271,10 @@ JAM_RETURN_TYPE jam_convert_literal_binary
 
 		if (rev_index > 1)
 		{
-			long_ptr = (long *) (((long) statement_buffer) & 0xfffffffcL);
+			/* round up: a long may need more than 4-byte alignment */
+			long_ptr = (long *)
+				((((unsigned long) statement_buffer) + sizeof(long) - 1) &
+				~(unsigned long) (sizeof(long) - 1));
 		}
 		else if (arg < JAMC_MAX_LITERAL_ARRAYS)
 		{
@@ -1042,7 +2288,8 @@ JAM_RETURN_TYPE jam_convert_literal_binary
 
 	if (status == JAMC_SUCCESS)
 	{
-		for (i = 0; i < rev_index; ++i)
+		/* last word first -- a long may be wider than its four bytes */
+		for (i = rev_index - 1; i >= 0; --i)
 		{
 			j = i * 4;
 			long_ptr[i] = (
@@ -1177,7 +2424,10 @@ JAM_RETURN_TYPE jam_convert_literal_array
 
 		if (rev_index > 1)
 		{
-			long_ptr = (long *) (((long) statement_buffer) & 0xfffffffcL);
+			/* round up: a long may need more than 4-byte alignment */
+			long_ptr = (long *)
+				((((unsigned long) statement_buffer) + sizeof(long) - 1) &
+				~(unsigned long) (sizeof(long) - 1));
 		}
 		else if (arg < JAMC_MAX_LITERAL_ARRAYS)
 		{
@@ -1191,7 +2441,8 @@ JAM_RETURN_TYPE jam_convert_literal_array
 
 	if (status == JAMC_SUCCESS)
 	{
-		for (i = 0; i < rev_index; ++i)
+		/* last word first -- a long may be wider than its four bytes */
+		for (i = rev_index - 1; i >= 0; --i)
 		{
 			j = i * 4;
 			long_ptr[i] = (
@@ -1322,7 +2573,8 @@ JAM_RETURN_TYPE jam_convert_literal_aca
 		}
 #else
 		buffer = jam_malloc(uncompressed_length + 4);
-		long_ptr = (long *) jam_malloc(uncompressed_length + 4);
+		long_ptr = (long *) jam_malloc(
+			((uncompressed_length + 3) / 4 + 1) * sizeof(long));
 #endif
 
 		if ((buffer == NULL) || (long_ptr == NULL))
@@ -1361,6 +2613,11 @@ JAM_RETURN_TYPE jam_convert_literal_aca
 				(((long)buffer[j    ]       ) & 0x000000ffL));
 		}
 
+		/* the buffer of the last statement to use this argument is done */
+		if (jam_literal_aca_buffer[arg] != NULL)
+		{
+			jam_free(jam_literal_aca_buffer[arg]);
+		}
 		jam_literal_aca_buffer[arg] = long_ptr;
 
 		if (output_buffer != NULL) *output_buffer = long_ptr;
@@ -1378,6 +2635,80 @@ JAM_RETURN_TYPE jam_convert_literal_aca
 /****************************************************************************/
 /*																			*/
 
+JAM_RETURN_TYPE jam_get_literal_array
+(
+	char *statement_buffer,
+	char kind,
+	long **literal_array_data,
+	long *length,
+	int arg
+)
+
+/*																			*/
+/*	Description:	Gets the data of a literal Boolean array.  kind is the	*/
+/*					'#', '$' or '@' which introduces it; a Jam 1.1 literal	*/
+/*					is hexadecimal.  In a compiled statement, the data		*/
+/*					decoded the first time is kept and returned from then	*/
+/*					on, and must not be written to.  Otherwise the text is	*/
+/*					decoded in the buffer, overwriting it.					*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	char *text = NULL;
+	JAMS_INSTRUCTION *instruction = jam_current_instruction();
+	JAMS_LITERAL *literal = jam_find_literal(instruction, kind, statement_buffer);
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	if (literal != NULL)
+	{
+		*literal_array_data = literal->data;
+		*length = literal->length;
+	}
+	else
+	{
+		/* keep the text, since decoding overwrites it */
+		if (instruction != NULL)
+		{
+			text = (char *) jam_malloc(jam_strlen(statement_buffer) + 1);
+
+			if (text != NULL) jam_strcpy(text, statement_buffer);
+		}
+
+		if (kind == JAMC_POUND_CHAR)
+		{
+			status = jam_convert_literal_binary(statement_buffer,
+				literal_array_data, length, arg);
+		}
+		else if (kind == JAMC_AT_CHAR)
+		{
+			status = jam_convert_literal_aca(statement_buffer,
+				literal_array_data, length, arg);
+		}
+		else
+		{
+			status = jam_convert_literal_array(statement_buffer,
+				literal_array_data, length, arg);
+		}
+
+		if ((status == JAMC_SUCCESS) && (text != NULL))
+		{
+			literal = jam_add_literal(instruction, kind, text,
+				*literal_array_data, *length);
+
+			if (literal != NULL) *literal_array_data = literal->data;
+		}
+
+		if (text != NULL) jam_free(text);
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
 JAM_RETURN_TYPE jam_get_array_argument
 (
 	char *statement_buffer,
@@ -1441,8 +2772,8 @@ JAM_RETURN_TYPE jam_get_array_argument
 		expr_end = index;
 		save_ch = statement_buffer[expr_end];
 		statement_buffer[expr_end] = JAMC_NULL_CHAR;
-		status = jam_convert_literal_binary(&statement_buffer[expr_begin],
-			literal_array_data, &literal_array_length, arg);
+		status = jam_get_literal_array(&statement_buffer[expr_begin],
+			JAMC_POUND_CHAR, literal_array_data, &literal_array_length, arg);
 		statement_buffer[expr_end] = save_ch;
 
 		*start_index = 0L;
@@ -1475,8 +2806,8 @@ JAM_RETURN_TYPE jam_get_array_argument
 		expr_end = index;
 		save_ch = statement_buffer[expr_end];
 		statement_buffer[expr_end] = JAMC_NULL_CHAR;
-		status = jam_convert_literal_array(&statement_buffer[expr_begin],
-			literal_array_data, &literal_array_length, arg);
+		status = jam_get_literal_array(&statement_buffer[expr_begin],
+			JAMC_DOLLAR_CHAR, literal_array_data, &literal_array_length, arg);
 		statement_buffer[expr_end] = save_ch;
 
 		*start_index = 0L;
@@ -1508,8 +2839,8 @@ JAM_RETURN_TYPE jam_get_array_argument
 		expr_end = index;
 		save_ch = statement_buffer[expr_end];
 		statement_buffer[expr_end] = JAMC_NULL_CHAR;
-		status = jam_convert_literal_aca(&statement_buffer[expr_begin],
-			literal_array_data, &literal_array_length, arg);
+		status = jam_get_literal_array(&statement_buffer[expr_begin],
+			JAMC_AT_CHAR, literal_array_data, &literal_array_length, arg);
 		statement_buffer[expr_end] = save_ch;
 
 		*start_index = 0L;
@@ -1582,8 +2913,8 @@ JAM_RETURN_TYPE jam_get_array_argument
 		expr_end = index;
 		save_ch = statement_buffer[expr_end];
 		statement_buffer[expr_end] = JAMC_NULL_CHAR;
-		status = jam_convert_literal_array(&statement_buffer[expr_begin],
-			literal_array_data, &literal_array_length, arg);
+		status = jam_get_literal_array(&statement_buffer[expr_begin],
+			JAMC_DOLLAR_CHAR, literal_array_data, &literal_array_length, arg);
 		statement_buffer[expr_end] = save_ch;
 
 		*start_index = 0L;
@@ -1612,7 +2943,7 @@ JAM_RETURN_TYPE jam_get_array_argument
 
 			save_ch = statement_buffer[expr_end];
 			statement_buffer[expr_end] = JAMC_NULL_CHAR;
-			status = jam_get_symbol_record(&statement_buffer[expr_begin],
+			status = jam_find_symbol(&statement_buffer[expr_begin],
 				&tmp_symbol_rec);
 			statement_buffer[expr_end] = save_ch;
 
@@ -1792,11 +3123,13 @@ JAM_RETURN_TYPE jam_process_uses_item
 	BOOL reuse_statement_buffer = FALSE;
 	JAMS_SYMBOL_RECORD *tmp_current_block = jam_current_block;
 	JAME_PHASE_TYPE tmp_phase = jam_phase;
+	JAMS_INDEX_ENTRY *index_entry = NULL;
 	BOOL done = FALSE;
 	int exit_code = 0;
 
 
-	status = jam_init_statement_buffer(&statement_buffer, &statement_buffer_size);
+	status = jam_get_pooled_statement_buffer(&statement_buffer,
+		&statement_buffer_size);
 
 	if ((status == JAMC_SUCCESS) && jam_isalpha(block_name[index]))
 	{
@@ -1814,7 +3147,7 @@ JAM_RETURN_TYPE jam_process_uses_item
 		block_name[index] = JAMC_NULL_CHAR;
 		jam_strcpy(block_buffer, block_name);
 		block_name[index] = save_ch;
-		status = jam_get_symbol_record(block_buffer, &symbol_record);
+		status = jam_find_symbol(block_buffer, &symbol_record);
 
 		if ((status == JAMC_SUCCESS) &&
 			((symbol_record->type == JAM_PROCEDURE_BLOCK) ||
@@ -1829,13 +3162,36 @@ JAM_RETURN_TYPE jam_process_uses_item
 		{
 			/*
 			*	Block name is not defined... may be a forward reference.
-			*	Search through the file to find the symbol.
+			*	Find the block in the program index, or if there is no
+			*	index, search through the file to find the symbol.
 			*/
 			current_position = jam_current_statement_position;
 
 			status = JAMC_SUCCESS;
 
-			while ((!found) && (status == JAMC_SUCCESS))
+			index_entry = jam_find_index_entry(JAM_INDEX_DATA,
+				block_buffer, -1L);
+
+			if (index_entry == NULL)
+			{
+				index_entry = jam_find_index_entry(JAM_INDEX_PROCEDURE,
+					block_buffer, -1L);
+			}
+
+			if (index_entry != NULL)
+			{
+				status = jam_read_indexed_block(index_entry,
+					statement_buffer, block_buffer, &symbol_record);
+
+				if (status == JAMC_SUCCESS)
+				{
+					found = TRUE;
+					block_position = symbol_record->position;
+				}
+			}
+
+			while ((!found) && (status == JAMC_SUCCESS) &&
+				(jam_index_table == NULL))
 			{
 				/*
 				*	Get statements without executing them
@@ -1868,7 +3224,7 @@ JAM_RETURN_TYPE jam_process_uses_item
 						/* check if this is the block we want to process */
 						if (status == JAMC_SUCCESS)
 						{
-							status = jam_get_symbol_record(block_buffer,
+							status = jam_find_symbol(block_buffer,
 								&symbol_record);
 
 							if (status == JAMC_SUCCESS)
@@ -1890,7 +3246,7 @@ JAM_RETURN_TYPE jam_process_uses_item
 						/* check if this is the block we want to process */
 						if (status == JAMC_SUCCESS)
 						{
-							status = jam_get_symbol_record(block_buffer,
+							status = jam_find_symbol(block_buffer,
 								&symbol_record);
 
 							if (status == JAMC_SUCCESS)
@@ -1985,49 +3341,20 @@ JAM_RETURN_TYPE jam_process_uses_item
 			*/
 			while ((!(done)) && (!enddata) && (status == JAMC_SUCCESS))
 			{
-				if (!reuse_statement_buffer)
-				{
-					status = jam_get_statement
-					(
-						statement_buffer,
-						label_buffer
-					);
-
-					if ((status == JAMC_SUCCESS)
-						&& (label_buffer[0] != JAMC_NULL_CHAR))
-					{
-						status = jam_add_symbol
-						(
-							JAM_LABEL,
-							label_buffer,
-							0L,
-							jam_current_statement_position
-						);
-					}
-				}
-				else
-				{
-					/* statement buffer will be reused -- clear the flag */
-					reuse_statement_buffer = FALSE;
-				}
+				status = jam_run_statement
+				(
+					statement_buffer,
+					&reuse_statement_buffer,
+					&done,
+					&exit_code
+				);
 
-				if (status == JAMC_SUCCESS)
+				if ((status == JAMC_SUCCESS) &&
+					(jam_get_instruction(statement_buffer)
+						== JAM_ENDDATA_INSTR) &&
+					(jam_peek_stack_record() == original_stack_position))
 				{
-					status = jam_execute_statement
-					(
-						statement_buffer,
-						&done,
-						&reuse_statement_buffer,
-						&exit_code
-					);
-
-					if ((status == JAMC_SUCCESS) &&
-						(jam_get_instruction(statement_buffer)
-							== JAM_ENDDATA_INSTR) &&
-						(jam_peek_stack_record() == original_stack_position))
-					{
-						enddata = TRUE;
-					}
+					enddata = TRUE;
 				}
 			}
 
@@ -2045,7 +3372,8 @@ JAM_RETURN_TYPE jam_process_uses_item
 	jam_current_block = tmp_current_block;
 	jam_phase = tmp_phase;
 
-	jam_free_statement_buffer(&statement_buffer, &statement_buffer_size);
+	jam_release_pooled_statement_buffer(&statement_buffer,
+		&statement_buffer_size);
 
 	return (status);
 }
@@ -2158,9 +3486,11 @@ JAM_RETURN_TYPE jam_call_procedure
 	JAMS_HEAP_RECORD *heap_record = NULL;
 	JAMS_SYMBOL_RECORD *tmp_current_block = jam_current_block;
 	JAME_PHASE_TYPE tmp_phase = jam_phase;
+	JAMS_INDEX_ENTRY *index_entry = NULL;
 
 
-	status = jam_init_statement_buffer(&statement_buffer, &statement_buffer_size);
+	status = jam_get_pooled_statement_buffer(&statement_buffer,
+		&statement_buffer_size);
 
 	if ((status == JAMC_SUCCESS) && jam_isalpha(procedure_name[index]))
 	{
@@ -2178,7 +3508,7 @@ JAM_RETURN_TYPE jam_call_procedure
 		procedure_name[index] = JAMC_NULL_CHAR;
 		jam_strcpy(procedure_buffer, procedure_name);
 		procedure_name[index] = save_ch;
-		status = jam_get_symbol_record(procedure_buffer, &symbol_record);
+		status = jam_find_symbol(procedure_buffer, &symbol_record);
 
 		if ((status == JAMC_SUCCESS) &&
 			(symbol_record->type == JAM_PROCEDURE_BLOCK))
@@ -2192,13 +3522,30 @@ JAM_RETURN_TYPE jam_call_procedure
 		{
 			/*
 			*	Label is not defined... may be a forward reference.
-			*	Search through the file to find the symbol.
+			*	Find the procedure in the program index, or if there is
+			*	no index, search through the file to find the symbol.
 			*/
 			current_position = jam_current_statement_position;
 
 			status = JAMC_SUCCESS;
 
-			while ((!found) && (status == JAMC_SUCCESS))
+			index_entry = jam_find_index_entry(JAM_INDEX_PROCEDURE,
+				procedure_buffer, -1L);
+
+			if (index_entry != NULL)
+			{
+				status = jam_read_indexed_block(index_entry,
+					statement_buffer, procedure_buffer, &symbol_record);
+
+				if (status == JAMC_SUCCESS)
+				{
+					found = TRUE;
+					proc_position = symbol_record->position;
+				}
+			}
+
+			while ((!found) && (status == JAMC_SUCCESS) &&
+				(jam_index_table == NULL))
 			{
 				/*
 				*	Get statements without executing them
@@ -2235,7 +3582,7 @@ JAM_RETURN_TYPE jam_call_procedure
 						/* check if this is the procedure we want to call */
 						if (status == JAMC_SUCCESS)
 						{
-							status = jam_get_symbol_record(procedure_buffer,
+							status = jam_find_symbol(procedure_buffer,
 								&symbol_record);
 
 							if (status == JAMC_SUCCESS)
@@ -2317,55 +3664,27 @@ JAM_RETURN_TYPE jam_call_procedure
 	*/
 	while ((!(*done)) && (!endproc) && (status == JAMC_SUCCESS))
 	{
-		if (!reuse_statement_buffer)
-		{
-			status = jam_get_statement
-			(
-				statement_buffer,
-				label_buffer
-			);
-
-			if ((status == JAMC_SUCCESS)
-				&& (label_buffer[0] != JAMC_NULL_CHAR))
-			{
-				status = jam_add_symbol
-				(
-					JAM_LABEL,
-					label_buffer,
-					0L,
-					jam_current_statement_position
-				);
-			}
-		}
-		else
-		{
-			/* statement buffer will be reused -- clear the flag */
-			reuse_statement_buffer = FALSE;
-		}
+		status = jam_run_statement
+		(
+			statement_buffer,
+			&reuse_statement_buffer,
+			done,
+			exit_code
+		);
 
-		if (status == JAMC_SUCCESS)
+		if ((status == JAMC_SUCCESS) &&
+			(jam_get_instruction(statement_buffer) == JAM_ENDPROC_INSTR) &&
+			(jam_peek_stack_record() == original_stack_position))
 		{
-			status = jam_execute_statement
-			(
-				statement_buffer,
-				done,
-				&reuse_statement_buffer,
-				exit_code
-			);
-
-			if ((status == JAMC_SUCCESS) &&
-				(jam_get_instruction(statement_buffer) == JAM_ENDPROC_INSTR) &&
-				(jam_peek_stack_record() == original_stack_position))
-			{
-				endproc = TRUE;
-			}
+			endproc = TRUE;
 		}
 	}
 
 	jam_current_block = tmp_current_block;
 	jam_phase = tmp_phase;
 
-	jam_free_statement_buffer(&statement_buffer, &statement_buffer_size);
+	jam_release_pooled_statement_buffer(&statement_buffer,
+		&statement_buffer_size);
 
 	return (status);
 }
@@ -2861,7 +4180,7 @@ JAM_RETURN_TYPE jam_process_boolean
 				/* get a pointer to the symbol record */
 				if (status == JAMC_SUCCESS)
 				{
-					status = jam_get_symbol_record(
+					status = jam_find_symbol(
 						&statement_buffer[variable_begin], &symbol_record);
 				}
 				statement_buffer[variable_end] = save_ch;
@@ -3008,6 +4327,8 @@ JAM_RETURN_TYPE jam_process_call_or_goto
 	long return_position = jam_next_statement_position;
 	char label_buffer[JAMC_MAX_NAME_LENGTH + 1];
 	char goto_label[JAMC_MAX_NAME_LENGTH + 1];
+	long block_position = -1L;
+	JAMS_INDEX_ENTRY *index_entry = NULL;
 	BOOL found = FALSE;
 
 	if (jam_version == 0) jam_version = 1;
@@ -3056,7 +4377,7 @@ JAM_RETURN_TYPE jam_process_call_or_goto
 			*/
 			save_ch = statement_buffer[label_end];
 			statement_buffer[label_end] = JAMC_NULL_CHAR;
-			status = jam_get_symbol_record(
+			status = jam_find_symbol(
 				&statement_buffer[label_begin], &symbol_record);
 
 			if ((status == JAMC_SUCCESS) &&
@@ -3071,13 +4392,42 @@ JAM_RETURN_TYPE jam_process_call_or_goto
 			{
 				/*
 				*	Label is not defined... may be a forward reference.
-				*	Search through the file to find the symbol.
+				*	Find the label in the program index, or if there is
+				*	no index, search through the file to find the symbol.
+				*	In Jam 2.0, only labels inside the current procedure
+				*	can be used.
 				*/
 				current_position = jam_current_statement_position;
 
 				status = JAMC_SUCCESS;
 
-				while ((!found) && (status == JAMC_SUCCESS))
+				if ((jam_version == 2) && (jam_current_block != NULL))
+				{
+					block_position = jam_current_block->position;
+				}
+				else if (jam_version == 2)
+				{
+					block_position = current_position;
+				}
+
+				index_entry = jam_find_index_entry(JAM_INDEX_LABEL,
+					goto_label, block_position);
+
+				if ((index_entry != NULL) && ((jam_version != 2) ||
+					(index_entry->block_begin < block_position)))
+				{
+					status = jam_add_symbol(JAM_LABEL, goto_label, 0L,
+						index_entry->position);
+
+					if (status == JAMC_SUCCESS)
+					{
+						found = TRUE;
+						goto_position = index_entry->position;
+					}
+				}
+
+				while ((!found) && (status == JAMC_SUCCESS) &&
+					(jam_index_table == NULL))
 				{
 					/*
 					*	Get statements without executing them
@@ -3231,7 +4581,7 @@ JAM_RETURN_TYPE jam_process_data
 			/* get a pointer to the symbol record */
 			if (status == JAMC_SUCCESS)
 			{
-				status = jam_get_symbol_record(
+				status = jam_find_symbol(
 					&statement_buffer[name_begin], &symbol_record);
 			}
 			statement_buffer[name_end] = save_ch;
@@ -3270,7 +4620,7 @@ JAM_RETURN_TYPE jam_process_drscan_compare
 
 /*																			*/
 /*	Description:	Processes the arguments for the COMPARE version of the	*/
-/*					DRSCAN statement.  Calls jam_swap_dr() to access the	*/
+/*					DRSCAN statement.  Calls jam_compare_dr() to access the	*/
 /*					JTAG hardware interface.								*/
 /*																			*/
 /*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
@@ -3280,21 +4630,15 @@ JAM_RETURN_TYPE jam_process_drscan_compare
 
 /* syntax: DRSCAN <length> [, <data>] [COMPARE <array>, <mask>, <result>] ; */
 
-	int bit = 0;
 	int index = 0;
 	int expr_begin = 0;
 	int expr_end = 0;
 	int delimiter = 0;
-	int actual = 0;
-	int expected = 0;
-	int mask = 0;
 	long comp_start_index = 0L;
 	long comp_stop_index = 0L;
 	long mask_start_index = 0L;
 	long mask_stop_index = 0L;
 	char save_ch = 0;
-	long *temp_array = NULL;
-	BOOL result = TRUE;
 	JAMS_SYMBOL_RECORD *symbol_record = NULL;
 	JAMS_HEAP_RECORD *heap_record = NULL;
 	long *comp_data = NULL;
@@ -3350,7 +4694,8 @@ JAM_RETURN_TYPE jam_process_drscan_compare
 
 			if (heap_record != NULL)
 			{
-				comp_data = heap_record->data;
+				status = jam_get_array_data(heap_record,
+					&comp_start_index, &comp_stop_index, &comp_data);
 			}
 			else
 			{
@@ -3419,7 +4764,8 @@ JAM_RETURN_TYPE jam_process_drscan_compare
 
 			if (heap_record != NULL)
 			{
-				mask_data = heap_record->data;
+				status = jam_get_array_data(heap_record,
+					&mask_start_index, &mask_stop_index, &mask_data);
 			}
 			else
 			{
@@ -3462,8 +4808,10 @@ JAM_RETURN_TYPE jam_process_drscan_compare
 	{
 		save_ch = statement_buffer[expr_end];
 		statement_buffer[expr_end] = JAMC_NULL_CHAR;
-		status = jam_get_symbol_record(&statement_buffer[expr_begin],
+		jam_jtag_capture_target(TRUE);
+		status = jam_find_symbol(&statement_buffer[expr_begin],
 			&symbol_record);
+		jam_jtag_capture_target(FALSE);
 		statement_buffer[expr_end] = save_ch;
 
 		if ((status == JAMC_SUCCESS) &&
@@ -3474,50 +4822,16 @@ JAM_RETURN_TYPE jam_process_drscan_compare
 	}
 
 	/*
-	*	Find some free memory on the heap
-	*/
-	if (status == JAMC_SUCCESS)
-	{
-		temp_array = jam_get_temp_workspace((count_value >> 3) + 4);
-
-		if (temp_array == NULL)
-		{
-			status = JAMC_OUT_OF_MEMORY;
-		}
-	}
-
-	/*
-	*	Do the JTAG operation, saving the result in temp_array
-	*/
-	if (status == JAMC_SUCCESS)
-	{
-		status = jam_swap_dr(count_value, in_data, in_index, temp_array, 0);
-	}
-
-	/*
-	*	Mask the data and do the comparison
+	*	Do the JTAG operation and the masked comparison -- the result is
+	*	set by the time the result variable is used
 	*/
 	if (status == JAMC_SUCCESS)
 	{
-		for (bit = 0; (bit < count_value) && result; ++bit)
-		{
-			actual = temp_array[bit >> 5] & (1L << (bit & 0x1f)) ? 1 : 0;
-			expected = comp_data[(bit + comp_start_index) >> 5]
-				& (1L << ((bit + comp_start_index) & 0x1f)) ? 1 : 0;
-			mask = mask_data[(bit + mask_start_index) >> 5]
-				& (1L << ((bit + mask_start_index) & 0x1f)) ? 1 : 0;
-
-			if ((actual & mask) != (expected & mask))
-			{
-				result = FALSE;
-			}
-		}
-
-		symbol_record->value = result ? 1L : 0L;
+		status = jam_compare_dr(count_value, in_data, in_index,
+			comp_data, comp_start_index, mask_data, mask_start_index,
+			symbol_record);
 	}
 
-	if (temp_array != NULL) jam_free_temp_workspace(temp_array);
-
 	return (status);
 }
 
@@ -3574,9 +4888,11 @@ JAM_RETURN_TYPE jam_process_drscan_capture
 	{
 		save_ch = statement_buffer[expr_end];
 		statement_buffer[expr_end] = JAMC_NULL_CHAR;
+		jam_jtag_capture_target(TRUE);
 		status = jam_get_array_argument(&statement_buffer[expr_begin],
 			&symbol_record, &literal_array_data,
 			&start_index, &stop_index, 1);
+		jam_jtag_capture_target(FALSE);
 		statement_buffer[expr_end] = save_ch;
 	}
 
@@ -3600,7 +4916,7 @@ JAM_RETURN_TYPE jam_process_drscan_capture
 
 			if (heap_record != NULL)
 			{
-				tdi_data = heap_record->data;
+				status = jam_get_whole_array_data(heap_record, &tdi_data);
 			}
 			else
 			{
@@ -3619,7 +4935,7 @@ JAM_RETURN_TYPE jam_process_drscan_capture
 	if (status == JAMC_SUCCESS)
 	{
 		status = jam_swap_dr(count_value, in_data, in_index,
-			tdi_data, start_index);
+			tdi_data, start_index, symbol_record);
 	}
 
 	return (status);
@@ -3746,7 +5062,8 @@ JAM_RETURN_TYPE jam_process_drscan
 
 			if (heap_record != NULL)
 			{
-				tdi_data = heap_record->data;
+				status = jam_get_array_data(heap_record,
+					&start_index, &stop_index, &tdi_data);
 			}
 			else
 			{
@@ -4333,7 +5650,7 @@ JAM_RETURN_TYPE jam_process_for
 		status = JAMC_SYNTAX_ERROR;
 		save_ch = statement_buffer[variable_end];
 		statement_buffer[variable_end] = JAMC_NULL_CHAR;
-		status = jam_get_symbol_record(&statement_buffer[variable_begin],
+		status = jam_find_symbol(&statement_buffer[variable_begin],
 			&symbol_record);
 
 		if ((status == JAMC_SUCCESS) &&
@@ -4347,10 +5664,7 @@ JAM_RETURN_TYPE jam_process_for
 			/*
 			*	Set the variable to the start value
 			*/
-			status = jam_set_symbol_value(
-				JAM_INTEGER_SYMBOL,
-				&statement_buffer[variable_begin],
-				start_value);
+			symbol_record->value = start_value;
 		}
 		statement_buffer[variable_end] = save_ch;
 	}
@@ -4661,7 +5975,7 @@ JAM_RETURN_TYPE jam_process_integer
 				/* get a pointer to the symbol record */
 				if (status == JAMC_SUCCESS)
 				{
-					status = jam_get_symbol_record(
+					status = jam_find_symbol(
 						&statement_buffer[variable_begin], &symbol_record);
 				}
 				statement_buffer[variable_end] = save_ch;
@@ -4786,7 +6100,7 @@ JAM_RETURN_TYPE jam_process_irscan_compare
 
 /*																			*/
 /*	Description:	Processes the arguments for the COMPARE version of the	*/
-/*					IRSCAN statement.  Calls jam_swap_ir() to access the	*/
+/*					IRSCAN statement.  Calls jam_compare_ir() to access the	*/
 /*					JTAG hardware interface.								*/
 /*																			*/
 /*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
@@ -4796,21 +6110,15 @@ JAM_RETURN_TYPE jam_process_irscan_compare
 
 /* syntax: IRSCAN <length> [, <data>] [COMPARE <array>, <mask>, <result>] ; */
 
-	int bit = 0;
 	int index = 0;
 	int expr_begin = 0;
 	int expr_end = 0;
 	int delimiter = 0;
-	int actual = 0;
-	int expected = 0;
-	int mask = 0;
 	long comp_start_index = 0L;
 	long comp_stop_index = 0L;
 	long mask_start_index = 0L;
 	long mask_stop_index = 0L;
 	char save_ch = 0;
-	long *temp_array = NULL;
-	BOOL result = TRUE;
 	JAMS_SYMBOL_RECORD *symbol_record = NULL;
 	JAMS_HEAP_RECORD *heap_record = NULL;
 	long *comp_data = NULL;
@@ -4866,7 +6174,8 @@ JAM_RETURN_TYPE jam_process_irscan_compare
 
 			if (heap_record != NULL)
 			{
-				comp_data = heap_record->data;
+				status = jam_get_array_data(heap_record,
+					&comp_start_index, &comp_stop_index, &comp_data);
 			}
 			else
 			{
@@ -4935,7 +6244,8 @@ JAM_RETURN_TYPE jam_process_irscan_compare
 
 			if (heap_record != NULL)
 			{
-				mask_data = heap_record->data;
+				status = jam_get_array_data(heap_record,
+					&mask_start_index, &mask_stop_index, &mask_data);
 			}
 			else
 			{
@@ -4978,61 +6288,29 @@ JAM_RETURN_TYPE jam_process_irscan_compare
 	{
 		save_ch = statement_buffer[expr_end];
 		statement_buffer[expr_end] = JAMC_NULL_CHAR;
-		status = jam_get_symbol_record(&statement_buffer[expr_begin],
+		jam_jtag_capture_target(TRUE);
+		status = jam_find_symbol(&statement_buffer[expr_begin],
 			&symbol_record);
+		jam_jtag_capture_target(FALSE);
 		statement_buffer[expr_end] = save_ch;
 
-		if ((status == JAMC_SUCCESS) &&
-			(symbol_record->type != JAM_BOOLEAN_SYMBOL))
-		{
-			status = JAMC_TYPE_MISMATCH;
-		}
-	}
-
-	/*
-	*	Find some free memory on the heap
-	*/
-	if (status == JAMC_SUCCESS)
-	{
-		temp_array = jam_get_temp_workspace((count_value >> 3) + 4);
-
-		if (temp_array == NULL)
-		{
-			status = JAMC_OUT_OF_MEMORY;
-		}
-	}
-
-	/*
-	*	Do the JTAG operation, saving the result in temp_array
-	*/
-	if (status == JAMC_SUCCESS)
-	{
-		status = jam_swap_ir(count_value, in_data, in_index, temp_array, 0);
-	}
-
-	/*
-	*	Mask the data and do the comparison
-	*/
-	if (status == JAMC_SUCCESS)
-	{
-		for (bit = 0; (bit < count_value) && result; ++bit)
-		{
-			actual = temp_array[bit >> 5] & (1L << (bit & 0x1f)) ? 1 : 0;
-			expected = comp_data[(bit + comp_start_index) >> 5]
-				& (1L << ((bit + comp_start_index) & 0x1f)) ? 1 : 0;
-			mask = mask_data[(bit + mask_start_index) >> 5]
-				& (1L << ((bit + mask_start_index) & 0x1f)) ? 1 : 0;
-
-			if ((actual & mask) != (expected & mask))
-			{
-				result = FALSE;
-			}
-		}
-
-		symbol_record->value = result ? 1L : 0L;
+		if ((status == JAMC_SUCCESS) &&
+			(symbol_record->type != JAM_BOOLEAN_SYMBOL))
+		{
+			status = JAMC_TYPE_MISMATCH;
+		}
 	}
 
-	if (temp_array != NULL) jam_free_temp_workspace(temp_array);
+	/*
+	*	Do the JTAG operation and the masked comparison -- the result is
+	*	set by the time the result variable is used
+	*/
+	if (status == JAMC_SUCCESS)
+	{
+		status = jam_compare_ir(count_value, in_data, in_index,
+			comp_data, comp_start_index, mask_data, mask_start_index,
+			symbol_record);
+	}
 
 	return (status);
 }
@@ -5090,9 +6368,11 @@ JAM_RETURN_TYPE jam_process_irscan_capture
 	{
 		save_ch = statement_buffer[expr_end];
 		statement_buffer[expr_end] = JAMC_NULL_CHAR;
+		jam_jtag_capture_target(TRUE);
 		status = jam_get_array_argument(&statement_buffer[expr_begin],
 			&symbol_record, &literal_array_data,
 			&start_index, &stop_index, 1);
+		jam_jtag_capture_target(FALSE);
 		statement_buffer[expr_end] = save_ch;
 	}
 
@@ -5116,7 +6396,7 @@ JAM_RETURN_TYPE jam_process_irscan_capture
 
 			if (heap_record != NULL)
 			{
-				tdi_data = heap_record->data;
+				status = jam_get_whole_array_data(heap_record, &tdi_data);
 			}
 			else
 			{
@@ -5135,7 +6415,7 @@ JAM_RETURN_TYPE jam_process_irscan_capture
 	if (status == JAMC_SUCCESS)
 	{
 		status = jam_swap_ir(count_value, in_data, in_index,
-			tdi_data, start_index);
+			tdi_data, start_index, symbol_record);
 	}
 
 	return (status);
@@ -5262,7 +6542,8 @@ JAM_RETURN_TYPE jam_process_irscan
 
 			if (heap_record != NULL)
 			{
-				tdi_data = heap_record->data;
+				status = jam_get_array_data(heap_record,
+					&start_index, &stop_index, &tdi_data);
 			}
 			else
 			{
@@ -5479,7 +6760,7 @@ BOOL jam_check_assignment
 		save_ch = statement_buffer[variable_end];
 		statement_buffer[variable_end] = JAMC_NULL_CHAR;
 
-		if (jam_get_symbol_record(&statement_buffer[variable_begin],
+		if (jam_find_symbol(&statement_buffer[variable_begin],
 			&symbol_record) == JAMC_SUCCESS)
 		{
 			if ((symbol_record->type == JAM_INTEGER_SYMBOL) ||
@@ -5650,7 +6931,7 @@ JAM_RETURN_TYPE jam_process_assignment
 				/* get pointer to symbol record */
 				save_ch = statement_buffer[variable_end];
 				statement_buffer[variable_end] = JAMC_NULL_CHAR;
-				status = jam_get_symbol_record(
+				status = jam_find_symbol(
 					&statement_buffer[variable_begin], &symbol_record);
 				statement_buffer[variable_end] = save_ch;
 
@@ -5689,7 +6970,8 @@ JAM_RETURN_TYPE jam_process_assignment
 					}
 					else
 					{
-						dest_heap_data = heap_record->data;
+						status = jam_get_whole_array_data(heap_record,
+							&dest_heap_data);
 					}
 				}
 			}
@@ -5760,7 +7042,7 @@ JAM_RETURN_TYPE jam_process_assignment
 			*/
 			save_ch = statement_buffer[variable_end];
 			statement_buffer[variable_end] = JAMC_NULL_CHAR;
-			status = jam_get_symbol_record(
+			status = jam_find_symbol(
 				&statement_buffer[variable_begin], &symbol_record);
 			statement_buffer[variable_end] = save_ch;
 
@@ -5852,7 +7134,11 @@ JAM_RETURN_TYPE jam_process_assignment
 									}
 									else
 									{
-										source_heap_data = heap_record->data;
+										status = jam_get_array_data(
+											heap_record,
+											&source_subrange_begin,
+											&source_subrange_end,
+											&source_heap_data);
 									}
 								}
 								else
@@ -6015,7 +7301,7 @@ JAM_RETURN_TYPE jam_process_next
 			*/
 			save_ch = statement_buffer[variable_end];
 			statement_buffer[variable_end] = JAMC_NULL_CHAR;
-			status = jam_get_symbol_record(
+			status = jam_find_symbol(
 				&statement_buffer[variable_begin], &symbol_record);
 			statement_buffer[variable_end] = save_ch;
 
@@ -6325,7 +7611,7 @@ JAM_RETURN_TYPE jam_process_pop
 				/* get pointer to symbol record */
 				save_ch = statement_buffer[variable_end];
 				statement_buffer[variable_end] = JAMC_NULL_CHAR;
-				status = jam_get_symbol_record(
+				status = jam_find_symbol(
 					&statement_buffer[variable_begin], &symbol_record);
 				statement_buffer[variable_end] = save_ch;
 
@@ -6364,7 +7650,8 @@ JAM_RETURN_TYPE jam_process_pop
 					}
 					else
 					{
-						heap_data = &heap_record->data[0];
+						status = jam_get_whole_array_data(heap_record,
+							&heap_data);
 					}
 				}
 			}
@@ -6381,7 +7668,7 @@ JAM_RETURN_TYPE jam_process_pop
 				*/
 				save_ch = statement_buffer[variable_end];
 				statement_buffer[variable_end] = JAMC_NULL_CHAR;
-				status = jam_get_symbol_record(
+				status = jam_find_symbol(
 					&statement_buffer[variable_begin], &symbol_record);
 				statement_buffer[variable_end] = save_ch;
 
@@ -6624,7 +7911,8 @@ JAM_RETURN_TYPE jam_process_pre_post
 
 						if (heap_record != NULL)
 						{
-							padding_data = heap_record->data;
+							status = jam_get_array_data(heap_record,
+								&start_index, &stop_index, &padding_data);
 						}
 						else
 						{
@@ -6983,7 +8271,7 @@ JAM_RETURN_TYPE jam_process_procedure
 			/* get a pointer to the symbol record */
 			if (status == JAMC_SUCCESS)
 			{
-				status = jam_get_symbol_record(
+				status = jam_find_symbol(
 					&statement_buffer[procname_begin], &symbol_record);
 			}
 			statement_buffer[procname_end] = save_ch;
@@ -7475,7 +8763,8 @@ JAM_RETURN_TYPE jam_process_vector_capture
 
 			if (heap_record != NULL)
 			{
-				capture_buffer = heap_record->data;
+				status = jam_get_whole_array_data(heap_record,
+					&capture_buffer);
 			}
 			else
 			{
@@ -7596,7 +8885,8 @@ JAM_RETURN_TYPE jam_process_vector_compare
 
 			if (heap_record != NULL)
 			{
-				comp_data = heap_record->data;
+				status = jam_get_array_data(heap_record,
+					&comp_start_index, &comp_stop_index, &comp_data);
 			}
 			else
 			{
@@ -7665,7 +8955,8 @@ JAM_RETURN_TYPE jam_process_vector_compare
 
 			if (heap_record != NULL)
 			{
-				mask_data = heap_record->data;
+				status = jam_get_array_data(heap_record,
+					&mask_start_index, &mask_stop_index, &mask_data);
 			}
 			else
 			{
@@ -7708,7 +8999,7 @@ JAM_RETURN_TYPE jam_process_vector_compare
 	{
 		save_ch = statement_buffer[expr_end];
 		statement_buffer[expr_end] = JAMC_NULL_CHAR;
-		status = jam_get_symbol_record(&statement_buffer[expr_begin],
+		status = jam_find_symbol(&statement_buffer[expr_begin],
 			&symbol_record);
 		statement_buffer[expr_end] = save_ch;
 
@@ -7724,7 +9015,8 @@ JAM_RETURN_TYPE jam_process_vector_compare
 	*/
 	if (status == JAMC_SUCCESS)
 	{
-		temp_array = jam_get_temp_workspace((signal_count >> 3) + 4);
+		temp_array = jam_get_temp_workspace(
+			((signal_count >> 5) + 1) * (long) sizeof(long));
 
 		if (temp_array == NULL)
 		{
@@ -7848,7 +9140,7 @@ JAM_RETURN_TYPE jam_process_vector
 
 			if (heap_record != NULL)
 			{
-				dir_vector = heap_record->data;
+				status = jam_get_whole_array_data(heap_record, &dir_vector);
 			}
 			else
 			{
@@ -7904,7 +9196,7 @@ JAM_RETURN_TYPE jam_process_vector
 
 			if (heap_record != NULL)
 			{
-				data_vector = heap_record->data;
+				status = jam_get_whole_array_data(heap_record, &data_vector);
 			}
 			else
 			{
@@ -8370,6 +9662,7 @@ void jam_free_literal_aca_buffers(void)
 JAM_RETURN_TYPE jam_execute_statement
 (
 	char *statement_buffer,
+	JAME_INSTRUCTION instruction_code,
 	BOOL *done,
 	BOOL *reuse_statement_buffer,
 	int *exit_code
@@ -8383,10 +9676,10 @@ JAM_RETURN_TYPE jam_execute_statement
 /*																			*/
 /****************************************************************************/
 {
-	JAME_INSTRUCTION instruction_code = JAM_ILLEGAL_INSTR;
 	JAM_RETURN_TYPE status = JAMC_SUCCESS;
 
-	instruction_code = jam_get_instruction(statement_buffer);
+	/* cached arrays keep the elements used by one statement in the window */
+	++jam_statement_count;
 
 	switch (instruction_code)
 	{
@@ -8552,6 +9845,357 @@ JAM_RETURN_TYPE jam_execute_statement
 	}
 
 	jam_free_literal_aca_buffers();
+	/* arrays are prefetched as soon as it is known how to decode them */
+	if ((jam_prefetch_list != NULL) && (jam_version != 0))
+	{
+		jam_prefetch_arrays();
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_run_operation
+(
+	JAMS_INSTRUCTION *instruction,
+	JAMS_OPERATION *operation,
+	char *statement_buffer,
+	BOOL *reuse_statement_buffer
+)
+
+/*																			*/
+/*	Description:	Runs a translated statement.  Each operation does what	*/
+/*					the handler of the statement does, in the same order	*/
+/*					and with the same errors, using the symbol records and	*/
+/*					compiled expressions kept in the operation instead of	*/
+/*					reading them from the text.  When the condition of an	*/
+/*					IF is true, the statement after THEN is run from its	*/
+/*					operation, or else its text is left in the statement	*/
+/*					buffer to be run next, as jam_process_if() does.		*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	long value = 0L;
+	long index_value = 0L;
+	long stop_value = 0L;
+	long step_value = 1L;
+	long *heap_data = NULL;
+	JAME_EXPRESSION_TYPE expr_type = JAM_ILLEGAL_EXPR_TYPE;
+	JAMS_SYMBOL_RECORD *symbol_record = operation->symbol_record;
+	JAMS_HEAP_RECORD *heap_record = NULL;
+	JAMS_STACK_RECORD *stack_record = NULL;
+	JAMS_OPERATION *then = NULL;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	/* cached arrays keep the elements used by one statement in the window */
+	++jam_statement_count;
+	++jam_code_operations;
+
+	if ((jam_version == 2) && (jam_phase != JAM_PROCEDURE_PHASE))
+	{
+		return (JAMC_PHASE_ERROR);
+	}
+
+	switch (operation->opcode)
+	{
+	case JAM_OP_ASSIGN:
+		jam_jtag_symbol_access(symbol_record);
+
+		status = jam_evaluate_compiled_expression(operation->operands[0],
+			&value, &expr_type);
+
+		if ((status == JAMC_SUCCESS) && (expr_type != operation->type) &&
+			(expr_type != JAM_INT_OR_BOOL_EXPR))
+		{
+			status = JAMC_TYPE_MISMATCH;
+		}
+
+		if (status == JAMC_SUCCESS)
+		{
+			symbol_record->value = value;
+		}
+		break;
+
+	case JAM_OP_ASSIGN_ELEMENT:
+		jam_jtag_symbol_access(symbol_record);
+
+		heap_record = (JAMS_HEAP_RECORD *) symbol_record->value;
+		status = jam_get_whole_array_data(heap_record, &heap_data);
+
+		if (status == JAMC_SUCCESS)
+		{
+			status = jam_evaluate_compiled_expression(
+				operation->operands[0], &index_value, &expr_type);
+		}
+
+		if ((status == JAMC_SUCCESS) &&
+			(expr_type != JAM_INTEGER_EXPR) &&
+			(expr_type != JAM_INT_OR_BOOL_EXPR))
+		{
+			status = JAMC_TYPE_MISMATCH;
+		}
+
+		if (status == JAMC_SUCCESS)
+		{
+			status = jam_evaluate_compiled_expression(
+				operation->operands[1], &value, &expr_type);
+		}
+
+		if ((status == JAMC_SUCCESS) && (expr_type != operation->type) &&
+			(expr_type != JAM_INT_OR_BOOL_EXPR))
+		{
+			status = JAMC_TYPE_MISMATCH;
+		}
+
+		if ((status == JAMC_SUCCESS) &&
+			((index_value < 0) || (index_value >= heap_record->dimension)))
+		{
+			status = JAMC_BOUNDS_ERROR;
+		}
+
+		if (status == JAMC_SUCCESS)
+		{
+			if (operation->type == JAM_INTEGER_EXPR)
+			{
+				heap_data[index_value] = value;
+			}
+			else if (value == 0)
+			{
+				/* clear a single bit */
+				heap_data[index_value >> 5] &=
+					(~(unsigned long)(1L << (index_value & 0x1f)));
+			}
+			else
+			{
+				/* set a single bit */
+				heap_data[index_value >> 5] |=
+					(1L << (index_value & 0x1f));
+			}
+		}
+		break;
+
+	case JAM_OP_FOR:
+		status = jam_evaluate_compiled_expression(operation->operands[0],
+			&value, &expr_type);
+
+		if ((status == JAMC_SUCCESS) &&
+			(expr_type != JAM_INTEGER_EXPR) &&
+			(expr_type != JAM_INT_OR_BOOL_EXPR))
+		{
+			status = JAMC_TYPE_MISMATCH;
+		}
+
+		if (status == JAMC_SUCCESS)
+		{
+			status = jam_evaluate_compiled_expression(
+				operation->operands[1], &stop_value, &expr_type);
+		}
+
+		if ((status == JAMC_SUCCESS) &&
+			(expr_type != JAM_INTEGER_EXPR) &&
+			(expr_type != JAM_INT_OR_BOOL_EXPR))
+		{
+			status = JAMC_TYPE_MISMATCH;
+		}
+
+		if ((status == JAMC_SUCCESS) && (operation->operands[2] != NULL))
+		{
+			status = jam_evaluate_compiled_expression(
+				operation->operands[2], &step_value, &expr_type);
+
+			/* step value zero is illegal */
+			if ((status == JAMC_SUCCESS) && (step_value == 0))
+			{
+				status = JAMC_SYNTAX_ERROR;
+			}
+
+			if ((status == JAMC_SUCCESS) &&
+				(expr_type != JAM_INTEGER_EXPR) &&
+				(expr_type != JAM_INT_OR_BOOL_EXPR))
+			{
+				status = JAMC_TYPE_MISMATCH;
+			}
+		}
+
+		if (status == JAMC_SUCCESS)
+		{
+			jam_jtag_symbol_access(symbol_record);
+			symbol_record->value = value;
+
+			status = jam_push_fornext_record(symbol_record,
+				jam_next_statement_position, stop_value, step_value);
+		}
+		break;
+
+	case JAM_OP_NEXT:
+		jam_jtag_symbol_access(symbol_record);
+
+		stack_record = jam_peek_stack_record();
+
+		if ((stack_record == NULL) ||
+			(stack_record->type != JAM_STACK_FOR_NEXT) ||
+			(stack_record->iterator != symbol_record))
+		{
+			status = JAMC_NEXT_UNEXPECTED;
+		}
+		else if (((stack_record->step_value > 0) &&
+			(symbol_record->value >= stack_record->stop_value)) ||
+			((stack_record->step_value < 0) &&
+			(symbol_record->value <= stack_record->stop_value)))
+		{
+			/* loop has run to completion */
+			status = jam_pop_stack_record();
+		}
+		else
+		{
+			symbol_record->value += stack_record->step_value;
+
+			if (jam_seek(stack_record->for_position) == 0)
+			{
+				jam_current_file_position = stack_record->for_position;
+			}
+			else
+			{
+				status = JAMC_IO_ERROR;
+			}
+		}
+		break;
+
+	case JAM_OP_GOTO:
+	case JAM_OP_CALL:
+		if (operation->opcode == JAM_OP_CALL)
+		{
+			status = jam_push_callret_record(jam_next_statement_position);
+		}
+
+		if ((status == JAMC_SUCCESS) &&
+			(jam_seek(symbol_record->position) == 0))
+		{
+			jam_current_file_position = symbol_record->position;
+		}
+		else if (status == JAMC_SUCCESS)
+		{
+			status = JAMC_IO_ERROR;
+		}
+		break;
+
+	case JAM_OP_IF:
+		status = jam_evaluate_compiled_expression(operation->operands[0],
+			&value, &expr_type);
+
+		if ((status == JAMC_SUCCESS) &&
+			(expr_type != JAM_BOOLEAN_EXPR) &&
+			(expr_type != JAM_INT_OR_BOOL_EXPR))
+		{
+			status = JAMC_TYPE_MISMATCH;
+		}
+
+		if ((status == JAMC_SUCCESS) && value)
+		{
+			then = operation->then;
+
+			/* it is translated the second time it runs */
+			if (then->opcode == JAM_OP_PENDING)
+			{
+				jam_translate_statement(instruction, then);
+			}
+
+			if (then->opcode > JAM_OP_TEXT)
+			{
+				status = jam_run_operation(instruction, then,
+					statement_buffer, reuse_statement_buffer);
+			}
+			else
+			{
+				if (then->opcode == JAM_OP_NONE)
+				{
+					then->opcode = JAM_OP_PENDING;
+				}
+
+				jam_strcpy(statement_buffer,
+					&instruction->text[then->text_index]);
+				*reuse_statement_buffer = TRUE;
+			}
+		}
+		break;
+
+	default:
+		status = JAMC_INTERNAL_ERROR;
+		break;
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_run_statement
+(
+	char *statement_buffer,
+	BOOL *reuse_statement_buffer,
+	BOOL *done,
+	int *exit_code
+)
+
+/*																			*/
+/*	Description:	Gets the next statement and runs it, from its			*/
+/*					operation if it has been translated, or else by			*/
+/*					jam_execute_statement() from its text.  If the last		*/
+/*					statement left the statement after THEN in the			*/
+/*					statement buffer, that is run instead.  The statement	*/
+/*					buffer is left empty when an operation is run.			*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	JAME_INSTRUCTION instruction_code = JAM_ILLEGAL_INSTR;
+	JAMS_INSTRUCTION *instruction = NULL;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	if (!(*reuse_statement_buffer))
+	{
+		status = jam_fetch_statement
+		(
+			statement_buffer,
+			&instruction_code,
+			&instruction
+		);
+	}
+	else
+	{
+		/* statement buffer will be reused -- clear the flag */
+		*reuse_statement_buffer = FALSE;
+		instruction_code = jam_get_instruction(statement_buffer);
+	}
+
+	if ((status == JAMC_SUCCESS) && (instruction != NULL))
+	{
+		status = jam_run_operation
+		(
+			instruction,
+			&instruction->operation,
+			statement_buffer,
+			reuse_statement_buffer
+		);
+	}
+	else if (status == JAMC_SUCCESS)
+	{
+		status = jam_execute_statement
+		(
+			statement_buffer,
+			instruction_code,
+			done,
+			reuse_statement_buffer,
+			exit_code
+		);
+	}
+
 	return (status);
 }
 
@@ -8614,6 +10258,8 @@ JAM_RETURN_TYPE jam_execute
 /*					program.  It returns after execution has terminated.	*/
 /*					The program data is not passed into this function,		*/
 /*					but is accessed through the jam_getc() function.		*/
+/*					All state is kept in the context selected for the		*/
+/*					calling thread with jam_set_context().					*/
 /*																			*/
 /*	Return:			JAMC_SUCCESS for successful execution, otherwise one	*/
 /*					of the error codes listed in <jamexprt.h>				*/
@@ -8623,11 +10269,12 @@ JAM_RETURN_TYPE jam_execute
 	JAM_RETURN_TYPE status = JAMC_SUCCESS;
 	char *statement_buffer = NULL;
 	unsigned int statement_buffer_size = 0;
-	char label_buffer[JAMC_MAX_NAME_LENGTH + 1];
 	BOOL done = FALSE;
 	BOOL reuse_statement_buffer = FALSE;
 	int i = 0;
 
+	jam_enter_context();
+
 	jam_program = program;
 	jam_program_size = program_size;
 	jam_workspace = workspace;
@@ -8649,13 +10296,17 @@ JAM_RETURN_TYPE jam_execute
 	}
 
 	/*
-	*	Ensure that workspace is DWORD aligned
+	*	Ensure that workspace is aligned for long
 	*/
 	if (jam_workspace != NULL)
 	{
-		jam_workspace_size -= (((long)jam_workspace) & 3L);
-		jam_workspace_size &= (~3L);
-		jam_workspace = (char *) (((long)jam_workspace + 3L) & (~3L));
+		i = (int) (((unsigned long) jam_workspace) & (sizeof(long) - 1));
+		if (i != 0)
+		{
+			jam_workspace += sizeof(long) - i;
+			jam_workspace_size -= (long) (sizeof(long) - i);
+		}
+		jam_workspace_size &= ~((long) sizeof(long) - 1L);
 	}
 
 	/*
@@ -8680,6 +10331,7 @@ JAM_RETURN_TYPE jam_execute
 
 	if (status == JAMC_SUCCESS)
 	{
+		jam_init_code();
 		status = jam_seek(0L);
 	}
 
@@ -8688,46 +10340,23 @@ JAM_RETURN_TYPE jam_execute
 		status = jam_init_statement_buffer(&statement_buffer, &statement_buffer_size);
 	}
 
+	if (status == JAMC_SUCCESS)
+	{
+		jam_index_program();
+	}
+
 	/*
 	*	Get program statements and execute them
 	*/
 	while ((!done) && (status == JAMC_SUCCESS))
 	{
-		if (!reuse_statement_buffer)
-		{
-			status = jam_get_statement
-			(
-				statement_buffer,
-				label_buffer
-			);
-			if ((status == JAMC_SUCCESS)
-				&& (label_buffer[0] != JAMC_NULL_CHAR))
-			{
-				status = jam_add_symbol
-				(
-					JAM_LABEL,
-					label_buffer,
-					0L,
-					jam_current_statement_position
-				);
-			}
-		}
-		else
-		{
-			/* statement buffer will be reused -- clear the flag */
-			reuse_statement_buffer = FALSE;
-		}
-
-		if (status == JAMC_SUCCESS)
-		{
-			status = jam_execute_statement
-			(
-				statement_buffer,
-				&done,
-				&reuse_statement_buffer,
-				exit_code
-			);
-		}
+		status = jam_run_statement
+		(
+			statement_buffer,
+			&reuse_statement_buffer,
+			&done,
+			exit_code
+		);
 	}
 
 	if ((status != JAMC_SUCCESS) && (error_line != NULL))
@@ -8738,11 +10367,15 @@ JAM_RETURN_TYPE jam_execute
 
 	jam_free_literal_aca_buffers();
 	jam_free_jtag_padding_buffers(reset_jtag);
+	jam_export_code_statistics();
+	jam_free_code();
+	jam_free_index();
 	jam_free_heap();
 	jam_free_stack();
 	jam_free_symbol_table();
 
 	jam_free_statement_buffer(&statement_buffer, &statement_buffer_size);
+	jam_free_statement_pool();
 
 	if (format_version != NULL) *format_version = jam_version;
 
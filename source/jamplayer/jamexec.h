@@ -11,20 +11,6 @@
 #ifndef INC_JAMEXEC_H
 #define INC_JAMEXEC_H
 
-/****************************************************************************/
-/*																			*/
-/*	Global variables														*/
-/*																			*/
-/****************************************************************************/
-
-extern long jam_current_file_position;
-
-extern long jam_current_statement_position;
-
-extern long jam_next_statement_position;
-
-extern int jam_statement_buffer_size;
-
 /****************************************************************************/
 /*																			*/
 /*	Function Prototypes														*/
@@ -64,4 +50,12 @@ int jam_skip_instruction_name
 	char *statement_buffer
 );
 
+JAM_RETURN_TYPE jam_index_statement
+(
+	char *statement_buffer,
+	char *label_buffer,
+	long *block_begin,
+	long *array_block
+);
+
 #endif /* INC_JAMEXEC_H */
@@ -6,10 +6,14 @@
 #include "jamdefs.h"
 #include "jamexp.h"
 #include "jamsym.h"
+#include "jamstack.h"
 #include "jamheap.h"
+#include "jamjtag.h"
 #include "jamarray.h"
 #include "jamutil.h"
 #include "jamytab.h"
+#include "jamcode.h"
+#include "jamctx.h"
 
 
 /* ------------- LEXER DEFINITIONS -----------------------------------------*/
@@ -145,15 +149,35 @@ struct {
 #define NUM_KEYWORDS ((int) \
 	(sizeof(jam_keyword_table) / sizeof(jam_keyword_table[0])))
 
-char		jam_ch = '\0';		/* next character from input file */
-int			jam_strptr = 0;
-int			jam_token = 0;
-char		jam_token_buffer[MAX_BUFFER_LENGTH];
-int			jam_token_buffer_index;
-char		jam_parse_string[MAX_BUFFER_LENGTH];
-long		jam_parse_value = 0;
-int			jam_expression_type = 0;
-JAMS_SYMBOL_RECORD *jam_array_symbol_rec = NULL;
+/*
+*	Parser state lives only as long as one expression evaluation, so it is
+*	kept per thread rather than in the interpreter context.
+*/
+JAM_THREAD char		jam_ch = '\0';		/* next character from input file */
+JAM_THREAD int		jam_strptr = 0;
+JAM_THREAD int		jam_token = 0;
+JAM_THREAD char		jam_token_buffer[MAX_BUFFER_LENGTH];
+JAM_THREAD int		jam_token_buffer_index;
+JAM_THREAD char		jam_parse_string[MAX_BUFFER_LENGTH];
+JAM_THREAD long		jam_parse_value = 0;
+JAM_THREAD int		jam_expression_type = 0;
+JAM_THREAD JAMS_SYMBOL_RECORD *jam_array_symbol_rec = NULL;
+
+/*
+*	Steps recorded while an expression is parsed, kept as its compiled form
+*	if the parse succeeds.  Besides the grammar productions, a step may
+*	shift the last token, or set the value of the last token to a constant
+*	or to the current value of a symbol.  An expression of constants only
+*	is folded into one step which gives its value.
+*/
+#define JAMC_STEP_SHIFT		0
+#define JAMC_STEP_VALUE		(-1)
+#define JAMC_STEP_SYMBOL	(-2)
+#define JAMC_STEP_RESULT	(-3)
+
+JAM_THREAD BOOL		jam_exp_compiling = FALSE;
+JAM_THREAD int		jam_exp_step_count = 0;
+JAM_THREAD JAMS_EXPRESSION_STEP jam_exp_steps[JAMC_MAX_EXPRESSION_STEPS];
 
 #define YYMAXDEPTH 300  /* This fixes a stack depth problem on  */
                         /* all platforms.                       */
@@ -214,9 +238,9 @@ typedef struct EXP_STACK
 
 YYSTYPE jam_null_expression= {0,0,0,0,0};
 
-JAM_RETURN_TYPE jam_return_code = JAMC_SUCCESS;
+JAM_THREAD JAM_RETURN_TYPE jam_return_code = JAMC_SUCCESS;
 
-JAME_EXPRESSION_TYPE jam_expr_type = JAM_ILLEGAL_EXPR_TYPE;
+JAM_THREAD JAME_EXPRESSION_TYPE jam_expr_type = JAM_ILLEGAL_EXPR_TYPE;
 
 #define NULL_EXP jam_null_expression  /* .. for 1 operand operators */
 
@@ -226,6 +250,10 @@ JAME_EXPRESSION_TYPE jam_expr_type = JAM_ILLEGAL_EXPR_TYPE;
 
 int jam_yyparse(void);
 int jam_yylex(void);
+void jam_yyreduce(int jam_yym, YYSTYPE *jam_yypvt);
+void jam_exp_record(int action, JAME_EXPRESSION_TYPE type, long value);
+void jam_exp_fold(void);
+void jam_exp_replay(JAMS_EXPRESSION *expression);
 
 #define AND_TOK 257
 #define OR_TOK 258
@@ -253,7 +281,7 @@ int jam_yylex(void);
 #ifndef YYSTYPE
 #define YYSTYPE int
 #endif
-YYSTYPE jam_yylval, jam_yyval;
+JAM_THREAD YYSTYPE jam_yylval, jam_yyval;
 #define YYERRCODE 256
 
 /* # line 333 "jamexp.y" */
@@ -380,6 +408,9 @@ YYSTYPE jam_exp_eval(OPERATOR_TYPE otype, YYSTYPE op1, YYSTYPE op2)
 	long	tmp_val;
 	JAMS_SYMBOL_RECORD *symbol_rec;
 	JAMS_HEAP_RECORD *heap_rec;
+	long	*heap_data;
+	long	start_index;
+	long	stop_index;
 
 	rtn.child_otype = 0;
 	rtn.type = JAM_ILLEGAL_EXPR_TYPE;
@@ -824,8 +855,16 @@ YYSTYPE jam_exp_eval(OPERATOR_TYPE otype, YYSTYPE op1, YYSTYPE op2)
 
 					if (heap_rec != NULL)
 					{
-						rtn.val = jam_convert_bool_to_int(heap_rec->data,
-							op1.val, op2.val);
+						start_index = op1.val;
+						stop_index = op2.val;
+						jam_return_code = jam_get_array_data(heap_rec,
+							&start_index, &stop_index, &heap_data);
+
+						if (jam_return_code == JAMC_SUCCESS)
+						{
+							rtn.val = jam_convert_bool_to_int(heap_data,
+								start_index, stop_index);
+						}
 					}
 					rtn.type = JAM_INTEGER_EXPR;
 				}
@@ -847,8 +886,16 @@ YYSTYPE jam_exp_eval(OPERATOR_TYPE otype, YYSTYPE op1, YYSTYPE op2)
 
 					if (heap_rec != NULL)
 					{
-						rtn.val = jam_convert_bool_to_int(heap_rec->data,
-							heap_rec->dimension - 1, 0);
+						start_index = heap_rec->dimension - 1;
+						stop_index = 0L;
+						jam_return_code = jam_get_array_data(heap_rec,
+							&start_index, &stop_index, &heap_data);
+
+						if (jam_return_code == JAMC_SUCCESS)
+						{
+							rtn.val = jam_convert_bool_to_int(heap_data,
+								start_index, stop_index);
+						}
 					}
 					rtn.type = JAM_INTEGER_EXPR;
 				}
@@ -1158,6 +1205,62 @@ BOOL jam_constant_value(char *string, long *value)
 /************************************************************************/
 /*																   		*/
 
+void jam_exp_record(int action, JAME_EXPRESSION_TYPE type, long value)
+
+/*																   		*/
+/*	Adds a step to the compiled form of the expression being parsed.	*/
+/*	If there are too many steps, the expression is not compiled.		*/
+/*																   		*/
+{
+	if (jam_exp_compiling)
+	{
+		if (jam_exp_step_count < JAMC_MAX_EXPRESSION_STEPS)
+		{
+			jam_exp_steps[jam_exp_step_count].action = action;
+			jam_exp_steps[jam_exp_step_count].type = type;
+			jam_exp_steps[jam_exp_step_count].value = value;
+			++jam_exp_step_count;
+		}
+		else
+		{
+			jam_exp_compiling = FALSE;
+		}
+	}
+}
+
+
+/************************************************************************/
+/*																   		*/
+
+void jam_exp_fold(void)
+
+/*																   		*/
+/*	Called when the expression being parsed has been evaluated.  If it	*/
+/*	uses no symbols, its value can never change, so the recorded steps	*/
+/*	are replaced by one step which gives the value.						*/
+/*																   		*/
+{
+	int i = 0;
+	BOOL constant = TRUE;
+
+	for (i = 0; i < jam_exp_step_count; ++i)
+	{
+		if (jam_exp_steps[i].action == JAMC_STEP_SYMBOL) constant = FALSE;
+	}
+
+	if (constant)
+	{
+		jam_exp_steps[0].action = JAMC_STEP_RESULT;
+		jam_exp_steps[0].type = jam_expr_type;
+		jam_exp_steps[0].value = jam_parse_value;
+		jam_exp_step_count = 1;
+	}
+}
+
+
+/************************************************************************/
+/*																   		*/
+
 void jam_yyerror (char *msg)
 
 /*																   		*/
@@ -1173,6 +1276,8 @@ void jam_yyerror (char *msg)
 {
 	msg = msg; /* Avoid compiler warning about msg unused */
 
+	jam_exp_compiling = FALSE;
+
 	if (jam_return_code == JAMC_SUCCESS) jam_return_code = JAMC_SYNTAX_ERROR;
 }
 
@@ -1228,11 +1333,21 @@ int jam_yylex()
 		else
 		{
 			jam_return_code = JAMC_SYNTAX_ERROR;
+			jam_exp_compiling = FALSE;
 		}
 	}
 	else if (jam_token == IDENTIFIER_TOK)
 	{
-		jam_return_code = jam_get_symbol_record(jam_token_buffer, &symbol_rec);
+		/* a compiled expression keeps the record in its steps instead */
+		if (jam_exp_compiling)
+		{
+			jam_return_code = jam_get_symbol_record(
+				jam_token_buffer, &symbol_rec);
+		}
+		else
+		{
+			jam_return_code = jam_find_symbol(jam_token_buffer, &symbol_rec);
+		}
 
 		if (jam_return_code == JAMC_SUCCESS)
 		{
@@ -1269,6 +1384,8 @@ int jam_yylex()
 				break;
 			}
 		}
+
+		if (jam_return_code != JAMC_SUCCESS) jam_exp_compiling = FALSE;
 	}
 	else if (jam_token == '#')
 	{
@@ -1285,6 +1402,15 @@ int jam_yylex()
 	jam_yylval.loper = 0;
 	jam_yylval.roper = 0;
 
+	if (symbol_rec != NULL)
+	{
+		jam_exp_record(JAMC_STEP_SYMBOL, type, (long) symbol_rec);
+	}
+	else
+	{
+		jam_exp_record(JAMC_STEP_VALUE, type, val);
+	}
+
 	return jam_token;
 }
 
@@ -1318,13 +1444,41 @@ JAM_RETURN_TYPE jam_evaluate_expression
 /*		  since it is possible for, say, "2-2" to be success and   		*/
 /*		  return 0. 											   		*/
 /*																   		*/
+/*	In a compiled statement, the steps of the first successful parse	*/
+/*	are kept, and later evaluations replay them instead of parsing.		*/
+/*																   		*/
 {
-	jam_strcpy(jam_parse_string, expression);
-	jam_strptr = 0;
-	jam_token_buffer_index = 0;
+	JAMS_INSTRUCTION *instruction = jam_current_instruction();
+	JAMS_EXPRESSION *compiled = jam_find_expression(instruction, expression);
+
 	jam_return_code = JAMC_SUCCESS;
 
-	jam_yyparse();
+	if (compiled != NULL)
+	{
+		jam_exp_replay(compiled);
+	}
+	else
+	{
+		jam_strcpy(jam_parse_string, expression);
+		jam_strptr = 0;
+		jam_token_buffer_index = 0;
+
+		/* a pending '#' or '$' would change the meaning of the constants */
+		jam_exp_compiling = (instruction != NULL) && (jam_expression_type == 0);
+		jam_exp_step_count = 0;
+
+		if (jam_yyparse() != 0) jam_exp_compiling = FALSE;
+
+		if (jam_exp_compiling && (jam_return_code == JAMC_SUCCESS) &&
+			(jam_expression_type == 0))
+		{
+			jam_exp_fold();
+			jam_add_expression(instruction, expression,
+				jam_exp_steps, jam_exp_step_count);
+		}
+
+		jam_exp_compiling = FALSE;
+	}
 
 	if (jam_return_code == JAMC_SUCCESS)
 	{
@@ -1334,6 +1488,37 @@ JAM_RETURN_TYPE jam_evaluate_expression
 
 	return (jam_return_code);
 }
+
+
+/************************************************************************/
+/*																   		*/
+
+JAM_RETURN_TYPE jam_evaluate_compiled_expression
+(
+	JAMS_EXPRESSION *expression,
+	long *result,
+	JAME_EXPRESSION_TYPE *result_type
+)
+
+/*																   		*/
+/*	Evaluates an expression already compiled, as						*/
+/*	jam_evaluate_expression() does when it finds the compiled form, but	*/
+/*	without looking for it by its text.  This is used by the operations	*/
+/*	of compiled statements, which keep their expressions.				*/
+/*																   		*/
+{
+	jam_return_code = JAMC_SUCCESS;
+
+	jam_exp_replay(expression);
+
+	if (jam_return_code == JAMC_SUCCESS)
+	{
+		*result = jam_parse_value;
+		*result_type = jam_expr_type;
+	}
+
+	return (jam_return_code);
+}
 const int jam_yyexca[] = {
   -1, 1,
   0, -1,
@@ -1519,10 +1704,10 @@ const int jam_yydef[] = {
 #define YYACCEPT return(0)
 #define YYABORT return(1)
 
-YYSTYPE jam_yyv[YYMAXDEPTH];
-int token = -1; /* input token */
-int errct = 0;  /* error count */
-int errfl = 0;  /* error flag */
+JAM_THREAD YYSTYPE jam_yyv[YYMAXDEPTH];
+JAM_THREAD int token = -1; /* input token */
+JAM_THREAD int errct = 0;  /* error count */
+JAM_THREAD int errfl = 0;  /* error flag */
 
 int jam_yyparse()
 { int jam_yys[YYMAXDEPTH];
@@ -1561,6 +1746,7 @@ int jam_yyparse()
     if( jam_yychk[ jam_yyn=jam_yyact[ jam_yyn ] ] == token ){ /* valid shift */
       token = -1;
       jam_yyval = jam_yylval;
+      jam_exp_record(JAMC_STEP_SHIFT, JAM_ILLEGAL_EXPR_TYPE, 0L);
       jam_yystate = jam_yyn;
       if( errfl > 0 ) --errfl;
       goto jam_yystack;
@@ -1630,7 +1816,25 @@ int jam_yyparse()
 	  jam_yyn = jam_yyr1[jam_yyn];
 	  jam_yyj = jam_yypgo[jam_yyn] + *jam_yyps + 1;
 	  if( jam_yyj>=YYLAST || jam_yychk[ jam_yystate = jam_yyact[jam_yyj] ] != -jam_yyn ) jam_yystate = jam_yyact[jam_yypgo[jam_yyn]];
-	    switch(jam_yym){
+	  jam_exp_record(jam_yym, JAM_ILLEGAL_EXPR_TYPE, 0L);
+	  jam_yyreduce(jam_yym, jam_yypvt);
+	  goto jam_yystack;  /* stack new state and value */
+
+	}
+
+
+/************************************************************************/
+/*																   		*/
+
+void jam_yyreduce(int jam_yym, YYSTYPE *jam_yypvt)
+
+/*																   		*/
+/*	Applies the action of a production to the values on the stack,		*/
+/*	leaving the result in jam_yyval.  Used by jam_yyparse() and by		*/
+/*	jam_exp_replay().													*/
+/*																   		*/
+{
+	switch(jam_yym){
 	    	
 case 1:
 /* # line 288 "jamexp.y" */
@@ -1738,6 +1942,78 @@ case 36:
 /* # line 330 "jamexp.y" */
 {jam_yyval = CALC(ARRAY, jam_yypvt[-3], jam_yypvt[-1]);} break;
 	    }
-	    goto jam_yystack;  /* stack new state and value */
+}
+
 
+/************************************************************************/
+/*																   		*/
+
+void jam_exp_replay(JAMS_EXPRESSION *expression)
+
+/*																   		*/
+/*	Evaluates a compiled expression by replaying the steps of the		*/
+/*	parse that compiled it, on the parser's value stack.  Symbols are	*/
+/*	read as jam_yylex() reads them, so the value and the errors are		*/
+/*	the same as those of a new parse.									*/
+/*																   		*/
+{
+	int i = 0;
+	int action = 0;
+	JAMS_SYMBOL_RECORD *symbol_rec = NULL;
+	YYSTYPE *jam_yypv = &jam_yyv[0];
+	YYSTYPE *jam_yypvt = NULL;
+
+	*jam_yypv = jam_yyval;
+
+	for (i = 0; i < expression->step_count; ++i)
+	{
+		action = expression->steps[i].action;
+
+		if (action == JAMC_STEP_RESULT)
+		{
+			jam_parse_value = expression->steps[i].value;
+			jam_expr_type = expression->steps[i].type;
+		}
+		else if (action == JAMC_STEP_SHIFT)
+		{
+			jam_yyval = jam_yylval;
+			*(++jam_yypv) = jam_yyval;
+		}
+		else if (action == JAMC_STEP_VALUE)
+		{
+			jam_yylval = jam_null_expression;
+			jam_yylval.val = expression->steps[i].value;
+			jam_yylval.type = expression->steps[i].type;
+		}
+		else if (action == JAMC_STEP_SYMBOL)
+		{
+			symbol_rec = (JAMS_SYMBOL_RECORD *) expression->steps[i].value;
+			jam_jtag_symbol_access(symbol_rec);
+			jam_return_code = JAMC_SUCCESS;
+			jam_yylval = jam_null_expression;
+			jam_yylval.type = expression->steps[i].type;
+
+			if (symbol_rec->type == JAM_INTEGER_SYMBOL)
+			{
+				jam_yylval.val = symbol_rec->value;
+			}
+			else if (symbol_rec->type == JAM_BOOLEAN_SYMBOL)
+			{
+				jam_yylval.val = symbol_rec->value ? 1 : 0;
+			}
+			else
+			{
+				jam_yylval.val = (long) symbol_rec;
+				jam_array_symbol_rec = symbol_rec;
+			}
+		}
+		else
+		{
+			jam_yypvt = jam_yypv;
+			jam_yypv -= jam_yyr2[action];
+			jam_yyval = jam_yypv[1];
+			jam_yyreduce(action, jam_yypvt);
+			*(++jam_yypv) = jam_yyval;
+		}
 	}
+}
@@ -18,4 +18,14 @@ JAM_RETURN_TYPE jam_evaluate_expression
 	JAME_EXPRESSION_TYPE *result_type
 );
 
+/* defined in jamcode.h */
+struct JAMS_EXPRESSION_STRUCT;
+
+JAM_RETURN_TYPE jam_evaluate_compiled_expression
+(
+	struct JAMS_EXPRESSION_STRUCT *expression,
+	long *result,
+	JAME_EXPRESSION_TYPE *result_type
+);
+
 #endif /* INC_JAMEXP_H */
@@ -48,6 +48,89 @@
 #define JAMC_SCOPE_ERROR       23
 #define JAMC_ACTION_NOT_FOUND  24
 
+/****************************************************************************/
+/*																			*/
+/*	Type definitions														*/
+/*																			*/
+/****************************************************************************/
+
+/* storage class for per-thread variables, if the compiler supports them */
+#if defined(_MSC_VER)
+#define JAM_THREAD __declspec(thread)
+#elif defined(__GNUC__)
+#define JAM_THREAD __thread
+#else
+#define JAM_THREAD
+#endif
+
+/* interpreter context, defined in jamctx.h */
+typedef struct JAMS_CONTEXT_STRUCT JAMS_CONTEXT;
+
+/*
+*	An initialized Boolean array which a program will use, passed to the
+*	prefetch() function of an array share.  It can be decoded on another
+*	thread with jam_decode_array().
+*/
+typedef struct JAMS_ARRAY_REQUEST_STRUCT
+{
+	long position;			/* file position of the declaration */
+	long words;				/* size of the decoded data in longs */
+	long dimension;			/* number of elements */
+	int representation;		/* format of the data */
+	int version;			/* language version of the program */
+
+} JAMS_ARRAY_REQUEST;
+
+/*
+*	Optional store of decoded array data, shared by contexts that run the
+*	same program.  Arrays are identified by the file position of their
+*	declaration.  If find() returns NULL, the caller decodes the array
+*	itself and must then call store() with the data, or with NULL if the
+*	decoding failed.  find() may wait while another context is decoding
+*	the same array.  If prefetch() is not NULL, it is given each array
+*	which the program can reach, as soon as the program starts, so that
+*	the store can decode them in the background.
+*/
+typedef struct JAMS_ARRAY_SHARE_STRUCT
+{
+	long *(*find)(long position, long words);
+	void (*store)(long position, long words, long *data);
+	void (*prefetch)(JAMS_ARRAY_REQUEST *request);
+
+} JAMS_ARRAY_SHARE;
+
+/*
+*	Optional store of the program index, kept by the caller between runs
+*	of the same program.  load() returns the image of an index saved
+*	before, or NULL if there is none; the image is copied before load()
+*	returns to the interpreter, and is checked for consistency.  save() is
+*	given the image of each index newly made, to be copied if wanted.
+*/
+typedef struct JAMS_INDEX_STORE_STRUCT
+{
+	char *(*load)(long *length);
+	void (*save)(char *image, long length);
+
+} JAMS_INDEX_STORE;
+
+/*
+*	Description of a program, made by jam_load_program() in one pass over
+*	the program text.  jam_check_crc(), jam_get_note() and jam_execute()
+*	take what they need from it instead of reading the program again.
+*/
+typedef struct JAMS_PROGRAM_INFO_STRUCT
+{
+	JAM_RETURN_TYPE crc_status;	/* what jam_check_crc() returns */
+	unsigned short expected_crc;
+	unsigned short actual_crc;
+	long statement_length;		/* longest statement, without array data */
+	long statement_count;
+	long note_count;
+	long index_count;			/* labels and blocks in the program index */
+	unsigned long load_time;	/* microseconds taken by the pass */
+
+} JAMS_PROGRAM_INFO;
+
 /****************************************************************************/
 /*																			*/
 /*	Function Prototypes														*/
@@ -78,6 +161,13 @@ JAM_RETURN_TYPE jam_get_note
 	int length
 );
 
+JAM_RETURN_TYPE jam_load_program
+(
+	char *program,
+	long program_size,
+	JAMS_PROGRAM_INFO *info
+);
+
 JAM_RETURN_TYPE jam_check_crc
 (
 	char *program,
@@ -86,6 +176,63 @@ JAM_RETURN_TYPE jam_check_crc
 	unsigned short *actual_crc
 );
 
+JAMS_CONTEXT *jam_create_context
+(
+	void *user_data
+);
+
+void jam_free_context
+(
+	JAMS_CONTEXT *context
+);
+
+JAMS_CONTEXT *jam_set_context
+(
+	JAMS_CONTEXT *context
+);
+
+void *jam_get_context_data
+(
+	void
+);
+
+void jam_share_arrays
+(
+	JAMS_CONTEXT *context,
+	JAMS_ARRAY_SHARE *share
+);
+
+void jam_store_index
+(
+	JAMS_CONTEXT *context,
+	JAMS_INDEX_STORE *store
+);
+
+JAM_RETURN_TYPE jam_decode_array
+(
+	JAMS_CONTEXT *context,
+	JAMS_ARRAY_REQUEST *request,
+	long *data
+);
+
+void jam_set_code_limit
+(
+	JAMS_CONTEXT *context,
+	long size
+);
+
+void jam_set_array_cache
+(
+	JAMS_CONTEXT *context,
+	int enable
+);
+
+void jam_set_direct_scan
+(
+	JAMS_CONTEXT *context,
+	int enable
+);
+
 int jam_getc
 (
 	void
@@ -103,6 +250,40 @@ int jam_jtag_io
 	int read_tdo
 );
 
+int jam_jtag_shift
+(
+	int count,
+	char *tdi,
+	char *tdo
+);
+
+int jam_jtag_tms_sequence
+(
+	int count,
+	int tms_bits
+);
+
+int jam_jtag_idle_clocks
+(
+	int tms,
+	long cycles
+);
+
+void jam_jtag_flush
+(
+	void
+);
+
+int jam_jtag_xfer
+(
+	int ir_scan,
+	int start_state,
+	int end_state,
+	int count,
+	char *tdi,
+	char *tdo
+);
+
 void jam_message
 (
 	char *message_text
@@ -126,6 +307,11 @@ void jam_delay
 	long microseconds
 );
 
+unsigned long jam_get_microseconds
+(
+	void
+);
+
 int jam_vector_map
 (
 	int signal_count,
@@ -19,18 +19,7 @@
 #include "jamheap.h"
 #include "jamjtag.h"
 #include "jamutil.h"
-
-/****************************************************************************/
-/*																			*/
-/*	Global variables														*/
-/*																			*/
-/****************************************************************************/
-
-JAMS_HEAP_RECORD *jam_heap = NULL;
-
-void *jam_heap_top = NULL;
-
-long jam_heap_records = 0L;
+#include "jamctx.h"
 
 /****************************************************************************/
 /*																			*/
@@ -85,6 +74,7 @@ void jam_free_heap(void)
 	int record = 0;
 	JAMS_HEAP_RECORD *heap_ptr = NULL;
 	JAMS_HEAP_RECORD *tmp_heap_ptr = NULL;
+	JAMS_ARRAY_CACHE *cache = NULL;
 
 	if ((jam_heap != NULL) && (jam_workspace == NULL))
 	{
@@ -95,6 +85,19 @@ void jam_free_heap(void)
 			{
 				tmp_heap_ptr = heap_ptr;
 				heap_ptr = heap_ptr->next;
+
+				if (tmp_heap_ptr->cached)
+				{
+					cache = (JAMS_ARRAY_CACHE *) tmp_heap_ptr->data;
+
+					if (cache->full_record != NULL)
+					{
+						jam_free(cache->full_record);
+					}
+
+					jam_free_aca_snapshots(cache);
+				}
+
 				jam_free(tmp_heap_ptr);
 			}
 		}
@@ -104,6 +107,30 @@ void jam_free_heap(void)
 /****************************************************************************/
 /*																			*/
 
+void jam_free_aca_snapshots(JAMS_ARRAY_CACHE *cache)
+
+/*																			*/
+/*	Description:	Frees the copies of the ACA decoder of a cached array.	*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	int snapshot = 0;
+
+	for (snapshot = 0; snapshot < JAMC_ACA_SNAPSHOT_COUNT; ++snapshot)
+	{
+		if (cache->snapshots[snapshot] != NULL)
+		{
+			jam_free(cache->snapshots[snapshot]);
+			cache->snapshots[snapshot] = NULL;
+		}
+	}
+}
+
+/****************************************************************************/
+/*																			*/
+
 JAM_RETURN_TYPE jam_add_heap_record
 (
 	JAMS_SYMBOL_RECORD *symbol_record,
@@ -153,11 +180,12 @@ JAM_RETURN_TYPE jam_add_heap_record
 	case JAM_BOOLEAN_ARRAY_INITIALIZED:
 		space_needed = ((dimension >> 5) + ((dimension & 0x1f) ? 1 : 0)) *
 			sizeof(long);
-/*		if (space_needed > JAMC_ARRAY_CACHE_SIZE)	*/
-/*		{											*/
-/*			space_needed = JAMC_ARRAY_CACHE_SIZE;	*/
-/*			cached = TRUE;							*/
-/*		}											*/
+		if (jam_array_cache && (jam_workspace == NULL) &&
+			(space_needed > (long) sizeof(JAMS_ARRAY_CACHE)))
+		{
+			space_needed = sizeof(JAMS_ARRAY_CACHE);
+			cached = TRUE;
+		}
 		break;
 
 	case JAM_PROCEDURE_BLOCK:
@@ -219,6 +247,7 @@ JAM_RETURN_TYPE jam_add_heap_record
 		heap_ptr->symbol_record = symbol_record;
 		heap_ptr->dimension = dimension;
 		heap_ptr->cached = cached;
+		heap_ptr->pending = FALSE;
 		heap_ptr->position = 0L;
 
 		if (jam_workspace != NULL)
@@ -49,21 +49,57 @@ typedef struct JAMS_HEAP_STRUCT
 	JAMS_SYMBOL_RECORD *symbol_record;
 	JAME_BOOLEAN_REP rep;	/* data representation format */
 	BOOL cached;		/* TRUE if array data is cached */
+	BOOL pending;		/* TRUE if data is not decoded yet */
 	long dimension;		/* number of elements in array */
 	long position;		/* position in file of initialization data */
 	long data[1];		/* first word of data (or cache buffer) */
 
 } JAMS_HEAP_RECORD;
 
-/****************************************************************************/
-/*																			*/
-/*	Global variables														*/
-/*																			*/
-/****************************************************************************/
-
-extern JAMS_HEAP_RECORD *jam_heap;
-
-extern void *jam_heap_top;
+/*
+*	State of the ACA decoder of a cached Boolean array, with the last bytes
+*	it uncompressed, which a match may copy from.
+*/
+typedef struct
+{
+	long in_position;		/* position of next character to read */
+	unsigned long in_bits;	/* bits read but not used yet */
+	int in_bit_count;
+	int literal_count;		/* literal bytes still to read */
+	int match_count;		/* bytes still to copy from history */
+	int match_offset;
+	long out_count;			/* bytes uncompressed so far */
+	unsigned char history[JAMC_ACA_HISTORY_SIZE];
+
+} JAMS_ACA_DECODER;
+
+/*
+*	Data area of a cached Boolean array.  Only a window of the decoded data
+*	is kept, and it is refilled from the file when other elements are used.
+*	For ACA data, the state of the decoder after the last refill is kept as
+*	a checkpoint, and a refill further on continues from there.  Copies of
+*	the decoder are also kept at JAMC_ACA_SNAPSHOT_COUNT points spread over
+*	the data, as the decoder first passes them, so that a refill further
+*	back continues from the nearest one before it instead of uncompressing
+*	the data again from the start.  An array which is written to, or used
+*	in a range longer than the window, is decoded in full into an ordinary
+*	heap record of its own.
+*/
+typedef struct
+{
+	JAMS_HEAP_RECORD *full_record;	/* whole array, once decoded */
+	long window_begin;		/* index of first element in window */
+	long window_end;		/* index after last element in window */
+	long used_statement;	/* statement which last used the window */
+	long used_begin;		/* elements used by that statement */
+	long used_end;
+	long in_begin;			/* position in file of ACA data */
+	long snapshot_interval;	/* bytes uncompressed between snapshots */
+	JAMS_ACA_DECODER *snapshots[JAMC_ACA_SNAPSHOT_COUNT];
+	JAMS_ACA_DECODER decoder;
+	long window[(JAMC_ARRAY_CACHE_SIZE + 3) / 4];
+
+} JAMS_ARRAY_CACHE;
 
 /****************************************************************************/
 /*																			*/
@@ -81,6 +117,11 @@ void jam_free_heap
 	void
 );
 
+void jam_free_aca_snapshots
+(
+	JAMS_ARRAY_CACHE *cache
+);
+
 JAM_RETURN_TYPE jam_add_heap_record
 (
 	JAMS_SYMBOL_RECORD *symbol_record,
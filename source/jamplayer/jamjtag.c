@@ -20,35 +20,10 @@
 #include "jamdefs.h"
 #include "jamsym.h"
 #include "jamstack.h"
+#include "jamheap.h"
 #include "jamutil.h"
 #include "jamjtag.h"
-
-/*
-*	Global variable to store the current JTAG state
-*/
-JAME_JTAG_STATE jam_jtag_state = JAM_ILLEGAL_JTAG_STATE;
-
-/*
-*	Store current stop-state for DR and IR scan commands
-*/
-JAME_JTAG_STATE jam_drstop_state = IDLE;
-JAME_JTAG_STATE jam_irstop_state = IDLE;
-
-/*
-*	Store current padding values
-*/
-int jam_dr_preamble  = 0;
-int jam_dr_postamble = 0;
-int jam_ir_preamble  = 0;
-int jam_ir_postamble = 0;
-int jam_dr_length    = 0;
-int jam_ir_length    = 0;
-long *jam_dr_preamble_data  = NULL;
-long *jam_dr_postamble_data = NULL;
-long *jam_ir_preamble_data  = NULL;
-long *jam_ir_postamble_data = NULL;
-char *jam_dr_buffer         = NULL;
-char *jam_ir_buffer         = NULL;
+#include "jamctx.h"
 
 /*
 *	Table of JTAG state names
@@ -157,6 +132,7 @@ JAM_RETURN_TYPE jam_init_jtag(void)
 	jam_ir_postamble = 0;
 	jam_dr_length    = 0;
 	jam_ir_length    = 0;
+	jam_jtag_capture_count = 0;
 
 	if (jam_workspace != NULL)
 	{
@@ -558,20 +534,11 @@ void jam_jtag_reset_idle(void)
 /*																			*/
 /****************************************************************************/
 {
-	int i = 0;
-
 	/*
 	*	Go to Test Logic Reset (no matter what the starting state may be)
+	*	with five TMS-high clocks, then step to Run Test / Idle
 	*/
-	for (i = 0; i < 5; ++i)
-	{
-		jam_jtag_io(TMS_HIGH, TDI_LOW, IGNORE_TDO);
-	}
-
-	/*
-	*	Now step to Run Test / Idle
-	*/
-	jam_jtag_io(TMS_LOW, TDI_LOW, IGNORE_TDO);
+	jam_jtag_tms_sequence(6, 0x1f);
 
 	jam_jtag_state = IDLE;
 }
@@ -588,6 +555,7 @@ JAM_RETURN_TYPE jam_goto_jtag_state
 /****************************************************************************/
 {
 	int tms = 0;
+	int tms_bits = 0;
 	int count = 0;
 	JAM_RETURN_TYPE status = JAMC_SUCCESS;
 
@@ -618,6 +586,10 @@ JAM_RETURN_TYPE jam_goto_jtag_state
 	}
 	else
 	{
+		/*
+		*	Walk the path in memory first, then clock the whole TMS
+		*	sequence out at once
+		*/
 		while ((jam_jtag_state != state) && (count < 9))
 		{
 			/*
@@ -626,10 +598,7 @@ JAM_RETURN_TYPE jam_goto_jtag_state
 			tms = (jam_jtag_path_map[jam_jtag_state] & (1 << state)) ?
 				TMS_HIGH : TMS_LOW;
 
-			/*
-			*	Take a step
-			*/
-			jam_jtag_io(tms, TDI_LOW, IGNORE_TDO);
+			tms_bits |= (tms << count);
 
 			if (tms)
 			{
@@ -644,6 +613,8 @@ JAM_RETURN_TYPE jam_goto_jtag_state
 
 			++count;
 		}
+
+		jam_jtag_tms_sequence(count, tms_bits);
 	}
 
 	if (jam_jtag_state != state)
@@ -704,7 +675,6 @@ JAM_RETURN_TYPE jam_do_wait_cycles
 /****************************************************************************/
 {
 	int tms = 0;
-	long count = 0L;
 	JAM_RETURN_TYPE status = JAMC_SUCCESS;
 
 	if (jam_jtag_state != wait_state)
@@ -720,10 +690,7 @@ JAM_RETURN_TYPE jam_do_wait_cycles
 		*/
 		tms = (wait_state == RESET) ? TMS_HIGH : TMS_LOW;
 
-		for (count = 0L; count < cycles; count++)
-		{
-			jam_jtag_io(tms, TDI_LOW, IGNORE_TDO);
-		}
+		jam_jtag_idle_clocks(tms, cycles);
 	}
 
 	return (status);
@@ -772,75 +739,282 @@ JAM_RETURN_TYPE jam_do_wait_microseconds
 /****************************************************************************/
 /*																			*/
 
-void jam_jtag_concatenate_data
+unsigned long jam_jtag_get_data_bits
+(
+	long *data,
+	long index,
+	int count
+)
+
+/*																			*/
+/*	Description:	Reads up to 32 bits from an array of long, starting at	*/
+/*					any bit.  Each long holds 32 bits of the array.			*/
+/*																			*/
+/*	Returns:		the bits, first bit in bit 0							*/
+/*																			*/
+/****************************************************************************/
+{
+	int shift = (int) (index & 0x1f);
+	unsigned long bits = 0L;
+
+	bits = ((unsigned long) data[index >> 5] & 0xffffffffUL) >> shift;
+
+	if (shift + count > 32)
+	{
+		bits |= (unsigned long) data[(index >> 5) + 1] << (32 - shift);
+	}
+
+	if (count < 32)
+	{
+		bits &= (1UL << count) - 1UL;
+	}
+
+	return (bits & 0xffffffffUL);
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_jtag_set_data_bits
+(
+	long *data,
+	long index,
+	int count,
+	unsigned long bits
+)
+
+/*																			*/
+/*	Description:	Writes up to 32 bits into an array of long, starting	*/
+/*					at any bit.  Other bits of the array are kept.			*/
+/*																			*/
+/*	Returns:		nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	int shift = (int) (index & 0x1f);
+	int first = (shift + count > 32) ? 32 - shift : count;
+	unsigned long mask = 0L;
+
+	mask = (first < 32) ? ((1UL << first) - 1UL) : 0xffffffffUL;
+	data[index >> 5] = (long) (((unsigned long) data[index >> 5] &
+		~(mask << shift)) | ((bits & mask) << shift));
+
+	if (first < count)
+	{
+		/* the rest goes to the low bits of the next long */
+		mask = (1UL << (count - first)) - 1UL;
+		data[(index >> 5) + 1] = (long)
+			(((unsigned long) data[(index >> 5) + 1] & ~mask) |
+			((bits >> first) & mask));
+	}
+}
+
+/****************************************************************************/
+/*																			*/
+
+unsigned long jam_jtag_get_buffer_bits
 (
 	char *buffer,
-	long *preamble_data,
-	long preamble_count,
-	long *target_data,
-	long start_index,
-	long target_count,
-	long *postamble_data,
-	long postamble_count
+	long index,
+	int count
 )
 
 /*																			*/
-/*	Description:	Copies preamble data, target data, and postamble data	*/
-/*					into one buffer for IR or DR scans.  Note that buffer	*/
-/*					is an array of char, while other arrays are of long		*/
+/*	Description:	Reads up to 32 bits from a scan buffer, starting at		*/
+/*					any bit.  Only the bytes holding those bits are read.	*/
+/*																			*/
+/*	Returns:		the bits, first bit in bit 0							*/
+/*																			*/
+/****************************************************************************/
+{
+	unsigned char *bytes = (unsigned char *) &buffer[index >> 3];
+	int shift = (int) (index & 7);
+	int byte_count = (shift + count + 7) >> 3;
+	int i = 0;
+	unsigned long bits = 0L;
+
+	bits = (unsigned long) bytes[0] >> shift;
+
+	for (i = 1; i < byte_count; ++i)
+	{
+		bits |= (unsigned long) bytes[i] << ((8 * i) - shift);
+	}
+
+	if (count < 32)
+	{
+		bits &= (1UL << count) - 1UL;
+	}
+
+	return (bits & 0xffffffffUL);
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_jtag_set_buffer_bits
+(
+	char *buffer,
+	long index,
+	int count,
+	unsigned long bits
+)
+
+/*																			*/
+/*	Description:	Writes up to 32 bits into a scan buffer, starting at	*/
+/*					any bit.  Only partly covered bytes are read back.		*/
 /*																			*/
 /*	Returns:		nothing													*/
 /*																			*/
 /****************************************************************************/
 {
-	long i = 0L;
-	long j = 0L;
-	long k = 0L;
+	unsigned char *bytes = (unsigned char *) &buffer[index >> 3];
+	int shift = (int) (index & 7);
+	int bit = 0;
+	int byte_bits = 0;
+	unsigned int mask = 0;
 
-	for (i = 0L; i < preamble_count; ++i)
+	while (bit < count)
 	{
-		if (preamble_data[i >> 5] & (1L << (i & 0x1f)))
+		byte_bits = 8 - shift;
+		if (byte_bits > count - bit) byte_bits = count - bit;
+
+		if (byte_bits == 8)
 		{
-			buffer[i >> 3] |= (1 << (i & 7));
+			*bytes = (unsigned char) (bits >> bit);
 		}
 		else
 		{
-			buffer[i >> 3] &= ~(unsigned int) (1 << (i & 7));
+			mask = ((1U << byte_bits) - 1U) << shift;
+			*bytes = (unsigned char) ((*bytes & ~mask) |
+				(((unsigned int) (bits >> bit) << shift) & mask));
 		}
+
+		bit += byte_bits;
+		shift = 0;
+		++bytes;
 	}
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_jtag_copy_to_buffer
+(
+	char *buffer,
+	long buffer_index,
+	long *data,
+	long data_index,
+	long count
+)
 
-	j = start_index;
-	k = preamble_count + target_count;
-	for (; i < k; ++i, ++j)
+/*																			*/
+/*	Description:	Copies bits from an array of long into a scan buffer,	*/
+/*					32 bits at a time, with any source and destination		*/
+/*					bit offsets												*/
+/*																			*/
+/*	Returns:		nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	int chunk = 0;
+
+	while (count > 0L)
 	{
-		if (target_data[j >> 5] & (1L << (j & 0x1f)))
-		{
-			buffer[i >> 3] |= (1 << (i & 7));
-		}
-		else
-		{
-			buffer[i >> 3] &= ~(unsigned int) (1 << (i & 7));
-		}
+		chunk = (count > 32L) ? 32 : (int) count;
+
+		jam_jtag_set_buffer_bits(buffer, buffer_index, chunk,
+			jam_jtag_get_data_bits(data, data_index, chunk));
+
+		buffer_index += chunk;
+		data_index += chunk;
+		count -= chunk;
 	}
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_jtag_copy_from_buffer
+(
+	long *data,
+	long data_index,
+	char *buffer,
+	long buffer_index,
+	long count
+)
+
+/*																			*/
+/*	Description:	Copies bits from a scan buffer into an array of long,	*/
+/*					32 bits at a time, with any source and destination		*/
+/*					bit offsets.  Whole longs are stored without being		*/
+/*					read back.												*/
+/*																			*/
+/*	Returns:		nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	int chunk = 0;
 
-	j = 0L;
-	k = preamble_count + target_count + postamble_count;
-	for (; i < k; ++i, ++j)
+	while (count > 0L)
 	{
-		if (postamble_data[j >> 5] & (1L << (j & 0x1f)))
+		/* stay within one long of the destination */
+		chunk = 32 - (int) (data_index & 0x1f);
+		if (chunk > count) chunk = (int) count;
+
+		if (chunk == 32)
 		{
-			buffer[i >> 3] |= (1 << (i & 7));
+			data[data_index >> 5] = (long)
+				jam_jtag_get_buffer_bits(buffer, buffer_index, 32);
 		}
 		else
 		{
-			buffer[i >> 3] &= ~(unsigned int) (1 << (i & 7));
+			jam_jtag_set_data_bits(data, data_index, chunk,
+				jam_jtag_get_buffer_bits(buffer, buffer_index, chunk));
 		}
+
+		buffer_index += chunk;
+		data_index += chunk;
+		count -= chunk;
 	}
 }
 
 /****************************************************************************/
 /*																			*/
 
+void jam_jtag_concatenate_data
+(
+	char *buffer,
+	long *preamble_data,
+	long preamble_count,
+	long *target_data,
+	long start_index,
+	long target_count,
+	long *postamble_data,
+	long postamble_count
+)
+
+/*																			*/
+/*	Description:	Copies preamble data, target data, and postamble data	*/
+/*					into one buffer for IR or DR scans.  Note that buffer	*/
+/*					is an array of char, while other arrays are of long		*/
+/*																			*/
+/*	Returns:		nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	jam_jtag_copy_to_buffer(buffer, 0L,
+		preamble_data, 0L, preamble_count);
+
+	jam_jtag_copy_to_buffer(buffer, preamble_count,
+		target_data, start_index, target_count);
+
+	jam_jtag_copy_to_buffer(buffer, preamble_count + target_count,
+		postamble_data, 0L, postamble_count);
+}
+
+/****************************************************************************/
+/*																			*/
+
 void jam_jtag_extract_target_data
 (
 	char *buffer,
@@ -859,23 +1033,8 @@ void jam_jtag_extract_target_data
 /*																			*/
 /****************************************************************************/
 {
-	long i = 0L;
-	long j = 0L;
-	long k = 0L;
-
-	j = preamble_count;
-	k = start_index + target_count;
-	for (i = start_index; i < k; ++i, ++j)
-	{
-		if (buffer[j >> 3] & (1 << (j & 7)))
-		{
-			target_data[i >> 5] |= (1L << (i & 0x1f));
-		}
-		else
-		{
-			target_data[i >> 5] &= ~(unsigned long) (1L << (i & 0x1f));
-		}
-	}
+	jam_jtag_copy_from_buffer(target_data, start_index,
+		buffer, preamble_count, target_count);
 }
 
 int jam_jtag_drscan
@@ -886,63 +1045,65 @@ int jam_jtag_drscan
 	char *tdo
 )
 {
-	int i = 0;
-	int tdo_bit = 0;
 	int status = 1;
+	JAME_JTAG_STATE from_state = IDLE;
 
 	/*
-	*	First go to DRSHIFT state
+	*	A scan starting in DRPAUSE must update and capture a new scan,
+	*	so leave DRPAUSE here -- the JTAG driver would go straight back
+	*	to DRSHIFT and continue the paused scan.
 	*/
 	switch (start_state)
 	{
 	case 0:						/* IDLE */
-		jam_jtag_io(1, 0, 0);	/* DRSELECT */
-		jam_jtag_io(0, 0, 0);	/* DRCAPTURE */
-		jam_jtag_io(0, 0, 0);	/* DRSHIFT */
 		break;
 
 	case 1:						/* DRPAUSE */
-		jam_jtag_io(1, 0, 0);	/* DREXIT2 */
-		jam_jtag_io(1, 0, 0);	/* DRUPDATE */
-		jam_jtag_io(1, 0, 0);	/* DRSELECT */
-		jam_jtag_io(0, 0, 0);	/* DRCAPTURE */
-		jam_jtag_io(0, 0, 0);	/* DRSHIFT */
+		jam_jtag_tms_sequence(2, 0x3);	/* DREXIT2, DRUPDATE */
+		from_state = DRUPDATE;
 		break;
 
 	case 2:						/* IRPAUSE */
-		jam_jtag_io(1, 0, 0);	/* IREXIT2 */
-		jam_jtag_io(1, 0, 0);	/* IRUPDATE */
-		jam_jtag_io(1, 0, 0);	/* DRSELECT */
-		jam_jtag_io(0, 0, 0);	/* DRCAPTURE */
-		jam_jtag_io(0, 0, 0);	/* DRSHIFT */
+		from_state = IRPAUSE;
 		break;
 
 	default:
 		status = 0;
 	}
 
-	if (status)
+	/*
+	*	Let the JTAG hardware shift the whole scan if it can
+	*/
+	if (status &&
+		(jam_jtag_xfer(0, from_state, DRPAUSE, count, tdi, tdo) == 0))
 	{
-		/* loop in the SHIFT-DR state */
-		for (i = 0; i < count; i++)
-		{
-			tdo_bit = jam_jtag_io(
-				(i == count - 1),
-				tdi[i >> 3] & (1 << (i & 7)),
-				(tdo != NULL));
+		return (status);
+	}
 
-			if (tdo != NULL)
-			{
-				if (tdo_bit)
-				{
-					tdo[i >> 3] |= (1 << (i & 7));
-				}
-				else
-				{
-					tdo[i >> 3] &= ~(unsigned int) (1 << (i & 7));
-				}
-			}
-		}
+	/*
+	*	First go to DRSHIFT state
+	*/
+	switch (start_state)
+	{
+	case 0:						/* IDLE */
+	case 1:						/* DRUPDATE */
+		/* DRSELECT, DRCAPTURE, DRSHIFT */
+		jam_jtag_tms_sequence(3, 0x1);
+		break;
+
+	case 2:						/* IRPAUSE */
+		/* IREXIT2, IRUPDATE, DRSELECT, DRCAPTURE, DRSHIFT */
+		jam_jtag_tms_sequence(5, 0x7);
+		break;
+
+	default:
+		status = 0;
+	}
+
+	if (status)
+	{
+		/* shift the whole scan in the SHIFT-DR state */
+		jam_jtag_shift(count, tdi, tdo);
 
 		jam_jtag_io(0, 0, 0);	/* DRPAUSE */
 	}
@@ -958,34 +1119,37 @@ int jam_jtag_irscan
 	char *tdo
 )
 {
-	int i = 0;
-	int tdo_bit = 0;
 	int status = 1;
 
+	/*
+	*	Let the JTAG hardware shift the whole scan if it can
+	*/
+	if ((start_state >= 0) && (start_state <= 2) &&
+		(jam_jtag_xfer(1, (start_state == 0) ? IDLE :
+			((start_state == 1) ? DRPAUSE : IRPAUSE),
+			IRPAUSE, count, tdi, tdo) == 0))
+	{
+		return (status);
+	}
+
 	/*
 	*	First go to IRSHIFT state
 	*/
 	switch (start_state)
 	{
 	case 0:						/* IDLE */
-		jam_jtag_io(1, 0, 0);	/* DRSELECT */
-		jam_jtag_io(1, 0, 0);	/* IRSELECT */
-		jam_jtag_io(0, 0, 0);	/* IRCAPTURE */
-		jam_jtag_io(0, 0, 0);	/* IRSHIFT */
+		/* DRSELECT, IRSELECT, IRCAPTURE, IRSHIFT */
+		jam_jtag_tms_sequence(4, 0x3);
 		break;
 
 	case 1:						/* DRPAUSE */
-		jam_jtag_io(1, 0, 0);	/* DREXIT2 */
-		jam_jtag_io(1, 0, 0);	/* DRUPDATE */
-		jam_jtag_io(1, 0, 0);	/* DRSELECT */
-		jam_jtag_io(1, 0, 0);	/* IRSELECT */
-		jam_jtag_io(0, 0, 0);	/* IRCAPTURE */
-		jam_jtag_io(0, 0, 0);	/* IRSHIFT */
+		/* DREXIT2, DRUPDATE, DRSELECT, IRSELECT, IRCAPTURE, IRSHIFT */
+		jam_jtag_tms_sequence(6, 0xf);
 		break;
 
 	case 2:						/* IRPAUSE */
-		jam_jtag_io(1, 0, 0);	/* IREXIT2 */
-		jam_jtag_io(0, 0, 0);	/* IRSHIFT */
+		/* IREXIT2, IRSHIFT */
+		jam_jtag_tms_sequence(2, 0x1);
 		break;
 
 	default:
@@ -994,26 +1158,8 @@ int jam_jtag_irscan
 
 	if (status)
 	{
-		/* loop in the SHIFT-IR state */
-		for (i = 0; i < count; i++)
-		{
-			tdo_bit = jam_jtag_io(
-				(i == count - 1),
-				tdi[i >> 3] & (1 << (i & 7)),
-				(tdo != NULL));
-
-			if (tdo != NULL)
-			{
-				if (tdo_bit)
-				{
-					tdo[i >> 3] |= (1 << (i & 7));
-				}
-				else
-				{
-					tdo[i >> 3] &= ~(unsigned int) (1 << (i & 7));
-				}
-			}
-		}
+		/* shift the whole scan in the SHIFT-IR state */
+		jam_jtag_shift(count, tdi, tdo);
 
 		jam_jtag_io(0, 0, 0);	/* IRPAUSE */
 	}
@@ -1024,164 +1170,266 @@ int jam_jtag_irscan
 /****************************************************************************/
 /*																			*/
 
-JAM_RETURN_TYPE jam_do_irscan
+void jam_jtag_resolve_capture
 (
-	long count,
-	long *data,
-	long start_index
+	JAMS_JTAG_CAPTURE *capture
 )
 
 /*																			*/
-/*	Description:	Shifts data into instruction register					*/
+/*	Description:	Copies the TDO data of a captured scan to its target	*/
+/*					array, or compares it and sets the result variable		*/
 /*																			*/
-/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*	Returns:		nothing													*/
 /*																			*/
 /****************************************************************************/
 {
-	int start_code = 0;
-	int alloc_chars = 0;
-	int shift_count = (int) (jam_ir_preamble + count + jam_ir_postamble);
-	JAM_RETURN_TYPE status = JAMC_SUCCESS;
-	JAME_JTAG_STATE start_state = JAM_ILLEGAL_JTAG_STATE;
+	long bit = 0L;
+	int chunk = 0;
+	unsigned long actual = 0L;
+	unsigned long expected = 0L;
+	unsigned long mask = 0L;
+	BOOL result = TRUE;
+
+	if (capture->out_data != NULL)
+	{
+		jam_jtag_extract_target_data
+		(
+			capture->buffer,
+			capture->out_data,
+			capture->out_index,
+			capture->preamble,
+			capture->count
+		);
+	}
 
-	switch (jam_jtag_state)
+	if (capture->compare_data != NULL)
 	{
-	case JAM_ILLEGAL_JTAG_STATE:
-	case RESET:
-	case IDLE:
-		start_code = 0;
-		start_state = IDLE;
-		break;
+		for (bit = 0L; (bit < capture->count) && result; bit += chunk)
+		{
+			chunk = (capture->count - bit > 32L) ?
+				32 : (int) (capture->count - bit);
+			actual = jam_jtag_get_buffer_bits(capture->buffer,
+				capture->preamble + bit, chunk);
+			expected = jam_jtag_get_data_bits(capture->compare_data,
+				capture->compare_index + bit, chunk);
+			mask = jam_jtag_get_data_bits(capture->mask_data,
+				capture->mask_index + bit, chunk);
+
+			if (((actual ^ expected) & mask) != 0L)
+			{
+				result = FALSE;
+			}
+		}
 
-	case DRSELECT:
-	case DRCAPTURE:
-	case DRSHIFT:
-	case DREXIT1:
-	case DRPAUSE:
-	case DREXIT2:
-	case DRUPDATE:
-		start_code = 1;
-		start_state = DRPAUSE;
-		break;
+		capture->symbol->value = result ? 1L : 0L;
+	}
+}
 
-	case IRSELECT:
-	case IRCAPTURE:
-	case IRSHIFT:
-	case IREXIT1:
-	case IRPAUSE:
-	case IREXIT2:
-	case IRUPDATE:
-		start_code = 2;
-		start_state = IRPAUSE;
-		break;
+/****************************************************************************/
+/*																			*/
 
-	default:
-		status = JAMC_INTERNAL_ERROR;
-		break;
-	}
+void jam_resolve_jtag_captures(void)
 
-	if (status == JAMC_SUCCESS)
-	{
-		if (jam_jtag_state != start_state)
-		{
-			status = jam_goto_jtag_state(start_state);
-		}
-	}
+/*																			*/
+/*	Description:	Collects the TDO data of all captured scans that have	*/
+/*					not been resolved yet, in the order they were shifted	*/
+/*																			*/
+/*	Returns:		nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	int i = 0;
+	JAMS_JTAG_CAPTURE *capture = NULL;
 
-	if (status == JAMC_SUCCESS)
+	if (jam_jtag_capture_count > 0)
 	{
-		if (jam_workspace != NULL)
-		{
-			if (shift_count > JAMC_MAX_JTAG_IR_LENGTH)
-			{
-				status = JAMC_OUT_OF_MEMORY;
-			}
-		}
-		else if (shift_count > jam_ir_length)
+		/* the transport may still hold TDO data for these buffers */
+		jam_jtag_flush();
+
+		for (i = 0; i < jam_jtag_capture_count; ++i)
 		{
-			alloc_chars = (shift_count + 7) >> 3;
-			jam_free(jam_ir_buffer);
-			jam_ir_buffer = (char *) jam_malloc(alloc_chars);
+			capture = &jam_jtag_captures[i];
 
-			if (jam_ir_buffer == NULL)
-			{
-				status = JAMC_OUT_OF_MEMORY;
-			}
-			else
+			jam_jtag_resolve_capture(capture);
+
+			jam_free(capture->buffer);
+			if (capture->compare_copy != NULL)
 			{
-				jam_ir_length = alloc_chars * 8;
+				jam_free(capture->compare_copy);
 			}
 		}
+
+		jam_jtag_capture_count = 0;
 	}
+}
 
-	if (status == JAMC_SUCCESS)
+/****************************************************************************/
+/*																			*/
+
+void jam_jtag_symbol_access
+(
+	JAMS_SYMBOL_RECORD *symbol_record
+)
+
+/*																			*/
+/*	Description:	Called whenever a symbol is looked up.  If a captured	*/
+/*					scan still owes this symbol its data, all pending		*/
+/*					captures are resolved before the symbol is used.		*/
+/*																			*/
+/*	Returns:		nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	int i = 0;
+
+	if (jam_jtag_target_lookup)
 	{
-		/*
-		*	Copy preamble data, IR data, and postamble data into a buffer
-		*/
-		jam_jtag_concatenate_data
-		(
-			jam_ir_buffer,
-			jam_ir_preamble_data,
-			jam_ir_preamble,
-			data,
-			start_index,
-			count,
-			jam_ir_postamble_data,
-			jam_ir_postamble
-		);
+		/* the new capture is resolved after the pending ones anyway */
+		jam_jtag_target_lookup = FALSE;
+		return;
+	}
 
-		/*
-		*	Do the IRSCAN
-		*/
-		jam_jtag_irscan
-		(
-			start_code,
-			shift_count,
-			jam_ir_buffer,
-			NULL
-		);
+	for (i = 0; i < jam_jtag_capture_count; ++i)
+	{
+		if (jam_jtag_captures[i].symbol == symbol_record)
+		{
+			jam_resolve_jtag_captures();
+			break;
+		}
+	}
+}
 
-		/* jam_jtag_irscan() always ends in IRPAUSE state */
-		jam_jtag_state = IRPAUSE;
+/****************************************************************************/
+/*																			*/
+
+void jam_jtag_capture_target
+(
+	BOOL target
+)
+
+/*																			*/
+/*	Description:	Marks the next symbol lookup as the one for the target	*/
+/*					of a new capture -- the capture array or compare		*/
+/*					result.  A pending capture into the same symbol need	*/
+/*					not be resolved for it, since captures resolve in the	*/
+/*					order they were shifted.  Called with FALSE after the	*/
+/*					lookup, in case it failed.								*/
+/*																			*/
+/*	Returns:		nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	jam_jtag_target_lookup = target;
+}
+
+/****************************************************************************/
+/*																			*/
+
+BOOL jam_jtag_defer_capture
+(
+	JAMS_JTAG_CAPTURE *capture
+)
+
+/*																			*/
+/*	Description:	Adds a captured scan to the list of pending captures.	*/
+/*					Compare and mask data are copied, since the program		*/
+/*					may change those arrays before the capture resolves.	*/
+/*																			*/
+/*	Returns:		TRUE if the capture was deferred, FALSE if it must be	*/
+/*					resolved now											*/
+/*																			*/
+/****************************************************************************/
+{
+	long words = 0L;
+	long bit = 0L;
+	int chunk = 0;
+	long *copy = NULL;
+	BOOL deferred = FALSE;
+
+	if (jam_jtag_capture_count >= JAMC_MAX_JTAG_CAPTURES)
+	{
+		jam_resolve_jtag_captures();
 	}
 
-	if (status == JAMC_SUCCESS)
+	capture->compare_copy = NULL;
+
+	if (capture->compare_data != NULL)
 	{
-		if (jam_irstop_state != IRPAUSE)
+		words = (capture->count >> 5) + 1;
+		copy = (long *) jam_malloc((unsigned int)
+			(2 * words * (long) sizeof(long)));
+
+		if (copy != NULL)
 		{
-			status = jam_goto_jtag_state(jam_irstop_state);
+			for (bit = 0L; bit < capture->count; bit += 32L)
+			{
+				chunk = (capture->count - bit > 32L) ?
+					32 : (int) (capture->count - bit);
+				copy[bit >> 5] = (long) jam_jtag_get_data_bits(
+					capture->compare_data,
+					capture->compare_index + bit, chunk);
+				copy[words + (bit >> 5)] = (long) jam_jtag_get_data_bits(
+					capture->mask_data,
+					capture->mask_index + bit, chunk);
+			}
+
+			capture->compare_copy = copy;
+			capture->compare_data = copy;
+			capture->compare_index = 0L;
+			capture->mask_data = &copy[words];
+			capture->mask_index = 0L;
 		}
 	}
 
-	return (status);
+	if ((capture->compare_data == NULL) || (capture->compare_copy != NULL))
+	{
+		jam_jtag_captures[jam_jtag_capture_count] = *capture;
+		++jam_jtag_capture_count;
+		deferred = TRUE;
+	}
+
+	return (deferred);
 }
 
 /****************************************************************************/
 /*																			*/
 
-JAM_RETURN_TYPE jam_swap_ir
+JAM_RETURN_TYPE jam_jtag_swap
 (
+	int ir_scan,
 	long count,
 	long *in_data,
 	long in_index,
-	long *out_data,
-	long out_index
+	JAMS_JTAG_CAPTURE *capture
 )
 
 /*																			*/
-/*	Description:	Shifts data into instruction register, capturing output	*/
-/*					data													*/
+/*	Description:	Shifts data into the instruction or data register and	*/
+/*					captures the output data.  While the JTAG hardware		*/
+/*					can queue the scan, the output data is left with the	*/
+/*					transport, and only collected when the program uses		*/
+/*					the capture array or compare result.					*/
 /*																			*/
 /*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
 /*																			*/
 /****************************************************************************/
 {
+	int i = 0;
 	int start_code = 0;
 	int alloc_chars = 0;
-	int shift_count = (int) (jam_ir_preamble + count + jam_ir_postamble);
+	int preamble = ir_scan ? jam_ir_preamble : jam_dr_preamble;
+	int postamble = ir_scan ? jam_ir_postamble : jam_dr_postamble;
+	int shift_count = (int) (preamble + count + postamble);
+	int max_length = ir_scan ?
+		JAMC_MAX_JTAG_IR_LENGTH : JAMC_MAX_JTAG_DR_LENGTH;
+	int *length = ir_scan ? &jam_ir_length : &jam_dr_length;
+	char **buffer = ir_scan ? &jam_ir_buffer : &jam_dr_buffer;
+	char *scan_buffer = NULL;
 	JAM_RETURN_TYPE status = JAMC_SUCCESS;
 	JAME_JTAG_STATE start_state = JAM_ILLEGAL_JTAG_STATE;
+	JAME_JTAG_STATE pause_state = ir_scan ? IRPAUSE : DRPAUSE;
+	JAME_JTAG_STATE stop_state = ir_scan ?
+		jam_irstop_state : jam_drstop_state;
 
 	switch (jam_jtag_state)
 	{
@@ -1231,24 +1479,24 @@ JAM_RETURN_TYPE jam_swap_ir
 	{
 		if (jam_workspace != NULL)
 		{
-			if (shift_count > JAMC_MAX_JTAG_IR_LENGTH)
+			if (shift_count > max_length)
 			{
 				status = JAMC_OUT_OF_MEMORY;
 			}
 		}
-		else if (shift_count > jam_ir_length)
+		else if (shift_count > *length)
 		{
 			alloc_chars = (shift_count + 7) >> 3;
-			jam_free(jam_ir_buffer);
-			jam_ir_buffer = (char *) jam_malloc(alloc_chars);
+			jam_free(*buffer);
+			*buffer = (char *) jam_malloc(alloc_chars);
 
-			if (jam_ir_buffer == NULL)
+			if (*buffer == NULL)
 			{
 				status = JAMC_OUT_OF_MEMORY;
 			}
 			else
 			{
-				jam_ir_length = alloc_chars * 8;
+				*length = alloc_chars * 8;
 			}
 		}
 	}
@@ -1256,56 +1504,90 @@ JAM_RETURN_TYPE jam_swap_ir
 	if (status == JAMC_SUCCESS)
 	{
 		/*
-		*	Copy preamble data, IR data, and postamble data into a buffer
+		*	Copy preamble data, scan data, and postamble data into a buffer
 		*/
 		jam_jtag_concatenate_data
 		(
-			jam_ir_buffer,
-			jam_ir_preamble_data,
-			jam_ir_preamble,
+			*buffer,
+			ir_scan ? jam_ir_preamble_data : jam_dr_preamble_data,
+			preamble,
 			in_data,
 			in_index,
 			count,
-			jam_ir_postamble_data,
-			jam_ir_postamble
+			ir_scan ? jam_ir_postamble_data : jam_dr_postamble_data,
+			postamble
 		);
 
 		/*
-		*	Do the IRSCAN
+		*	A capture that can wait gets a buffer of its own, which the
+		*	transport fills in whenever it gets to the scan
 		*/
-		jam_jtag_irscan
-		(
-			start_code,
-			shift_count,
-			jam_ir_buffer,
-			jam_ir_buffer
-		);
+		alloc_chars = (shift_count + 7) >> 3;
+		if ((jam_workspace == NULL) && (capture->symbol != NULL))
+		{
+			scan_buffer = (char *) jam_malloc(alloc_chars);
+		}
 
-		/* jam_jtag_irscan() always ends in IRPAUSE state */
-		jam_jtag_state = IRPAUSE;
+		if (scan_buffer != NULL)
+		{
+			for (i = 0; i < alloc_chars; ++i)
+			{
+				scan_buffer[i] = (*buffer)[i];
+			}
+		}
+		else
+		{
+			scan_buffer = *buffer;
+		}
+
+		/*
+		*	Do the scan, which always ends in the pause state
+		*/
+		if (ir_scan)
+		{
+			jam_jtag_irscan(start_code, shift_count, scan_buffer, scan_buffer);
+		}
+		else
+		{
+			jam_jtag_drscan(start_code, shift_count, scan_buffer, scan_buffer);
+		}
+
+		jam_jtag_state = pause_state;
 	}
 
 	if (status == JAMC_SUCCESS)
 	{
-		if (jam_irstop_state != IRPAUSE)
+		if (stop_state != pause_state)
 		{
-			status = jam_goto_jtag_state(jam_irstop_state);
+			status = jam_goto_jtag_state(stop_state);
 		}
 	}
 
-	if (status == JAMC_SUCCESS)
+	if (scan_buffer != NULL)
 	{
-		/*
-		*	Now extract the returned data from the buffer
-		*/
-		jam_jtag_extract_target_data
-		(
-			jam_ir_buffer,
-			out_data,
-			out_index,
-			jam_ir_preamble,
-			count
-		);
+		capture->buffer = scan_buffer;
+		capture->preamble = preamble;
+		capture->count = count;
+
+		if ((status != JAMC_SUCCESS) || (scan_buffer == *buffer) ||
+			!jam_jtag_defer_capture(capture))
+		{
+			/*
+			*	Resolve now, after any earlier captures
+			*/
+			jam_resolve_jtag_captures();
+			jam_jtag_flush();
+
+			if (status == JAMC_SUCCESS)
+			{
+				jam_jtag_resolve_capture(capture);
+			}
+
+			if (scan_buffer != *buffer)
+			{
+				jam_free(scan_buffer);
+			}
+		}
 	}
 
 	return (status);
@@ -1314,7 +1596,7 @@ JAM_RETURN_TYPE jam_swap_ir
 /****************************************************************************/
 /*																			*/
 
-JAM_RETURN_TYPE jam_do_drscan
+JAM_RETURN_TYPE jam_do_irscan
 (
 	long count,
 	long *data,
@@ -1322,7 +1604,7 @@ JAM_RETURN_TYPE jam_do_drscan
 )
 
 /*																			*/
-/*	Description:	Shifts data into data register (ignoring output data)	*/
+/*	Description:	Shifts data into instruction register					*/
 /*																			*/
 /*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
 /*																			*/
@@ -1330,7 +1612,7 @@ JAM_RETURN_TYPE jam_do_drscan
 {
 	int start_code = 0;
 	int alloc_chars = 0;
-	int shift_count = (int) (jam_dr_preamble + count + jam_dr_postamble);
+	int shift_count = (int) (jam_ir_preamble + count + jam_ir_postamble);
 	JAM_RETURN_TYPE status = JAMC_SUCCESS;
 	JAME_JTAG_STATE start_state = JAM_ILLEGAL_JTAG_STATE;
 
@@ -1382,24 +1664,24 @@ JAM_RETURN_TYPE jam_do_drscan
 	{
 		if (jam_workspace != NULL)
 		{
-			if (shift_count > JAMC_MAX_JTAG_DR_LENGTH)
+			if (shift_count > JAMC_MAX_JTAG_IR_LENGTH)
 			{
 				status = JAMC_OUT_OF_MEMORY;
 			}
 		}
-		else if (shift_count > jam_dr_length)
+		else if (shift_count > jam_ir_length)
 		{
 			alloc_chars = (shift_count + 7) >> 3;
-			jam_free(jam_dr_buffer);
-			jam_dr_buffer = (char *) jam_malloc(alloc_chars);
+			jam_free(jam_ir_buffer);
+			jam_ir_buffer = (char *) jam_malloc(alloc_chars);
 
-			if (jam_dr_buffer == NULL)
+			if (jam_ir_buffer == NULL)
 			{
 				status = JAMC_OUT_OF_MEMORY;
 			}
 			else
 			{
-				jam_dr_length = alloc_chars * 8;
+				jam_ir_length = alloc_chars * 8;
 			}
 		}
 	}
@@ -1407,40 +1689,40 @@ JAM_RETURN_TYPE jam_do_drscan
 	if (status == JAMC_SUCCESS)
 	{
 		/*
-		*	Copy preamble data, DR data, and postamble data into a buffer
+		*	Copy preamble data, IR data, and postamble data into a buffer
 		*/
 		jam_jtag_concatenate_data
 		(
-			jam_dr_buffer,
-			jam_dr_preamble_data,
-			jam_dr_preamble,
+			jam_ir_buffer,
+			jam_ir_preamble_data,
+			jam_ir_preamble,
 			data,
 			start_index,
 			count,
-			jam_dr_postamble_data,
-			jam_dr_postamble
+			jam_ir_postamble_data,
+			jam_ir_postamble
 		);
 
 		/*
-		*	Do the DRSCAN
+		*	Do the IRSCAN
 		*/
-		jam_jtag_drscan
+		jam_jtag_irscan
 		(
 			start_code,
 			shift_count,
-			jam_dr_buffer,
+			jam_ir_buffer,
 			NULL
 		);
 
-		/* jam_jtag_drscan() always ends in DRPAUSE state */
-		jam_jtag_state = DRPAUSE;
+		/* jam_jtag_irscan() always ends in IRPAUSE state */
+		jam_jtag_state = IRPAUSE;
 	}
 
 	if (status == JAMC_SUCCESS)
 	{
-		if (jam_drstop_state != DRPAUSE)
+		if (jam_irstop_state != IRPAUSE)
 		{
-			status = jam_goto_jtag_state(jam_drstop_state);
+			status = jam_goto_jtag_state(jam_irstop_state);
 		}
 	}
 
@@ -1450,17 +1732,88 @@ JAM_RETURN_TYPE jam_do_drscan
 /****************************************************************************/
 /*																			*/
 
-JAM_RETURN_TYPE jam_swap_dr
+JAM_RETURN_TYPE jam_swap_ir
 (
 	long count,
 	long *in_data,
 	long in_index,
 	long *out_data,
-	long out_index
+	long out_index,
+	JAMS_SYMBOL_RECORD *symbol_record
 )
 
 /*																			*/
-/*	Description:	Shifts data into data register, capturing output data	*/
+/*	Description:	Shifts data into instruction register, capturing output	*/
+/*					data.  If symbol_record is given, the output data may	*/
+/*					arrive any time before that symbol is next used.		*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	JAMS_JTAG_CAPTURE capture;
+
+	capture.symbol = symbol_record;
+	capture.out_data = out_data;
+	capture.out_index = out_index;
+	capture.compare_data = NULL;
+	capture.compare_index = 0L;
+	capture.mask_data = NULL;
+	capture.mask_index = 0L;
+
+	return (jam_jtag_swap(1, count, in_data, in_index, &capture));
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_compare_ir
+(
+	long count,
+	long *in_data,
+	long in_index,
+	long *compare_data,
+	long compare_index,
+	long *mask_data,
+	long mask_index,
+	JAMS_SYMBOL_RECORD *symbol_record
+)
+
+/*																			*/
+/*	Description:	Shifts data into instruction register, and sets the		*/
+/*					Boolean result variable to whether the masked output	*/
+/*					data matches the compare data.  The result may be set	*/
+/*					any time before the result variable is next used.		*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	JAMS_JTAG_CAPTURE capture;
+
+	capture.symbol = symbol_record;
+	capture.out_data = NULL;
+	capture.out_index = 0L;
+	capture.compare_data = compare_data;
+	capture.compare_index = compare_index;
+	capture.mask_data = mask_data;
+	capture.mask_index = mask_index;
+
+	return (jam_jtag_swap(1, count, in_data, in_index, &capture));
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_do_drscan
+(
+	long count,
+	long *data,
+	long start_index
+)
+
+/*																			*/
+/*	Description:	Shifts data into data register (ignoring output data)	*/
 /*																			*/
 /*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
 /*																			*/
@@ -1552,8 +1905,8 @@ JAM_RETURN_TYPE jam_swap_dr
 			jam_dr_buffer,
 			jam_dr_preamble_data,
 			jam_dr_preamble,
-			in_data,
-			in_index,
+			data,
+			start_index,
 			count,
 			jam_dr_postamble_data,
 			jam_dr_postamble
@@ -1567,7 +1920,7 @@ JAM_RETURN_TYPE jam_swap_dr
 			start_code,
 			shift_count,
 			jam_dr_buffer,
-			jam_dr_buffer
+			NULL
 		);
 
 		/* jam_jtag_drscan() always ends in DRPAUSE state */
@@ -1582,27 +1935,85 @@ JAM_RETURN_TYPE jam_swap_dr
 		}
 	}
 
-	if (status == JAMC_SUCCESS)
-	{
-		/*
-		*	Now extract the returned data from the buffer
-		*/
-		jam_jtag_extract_target_data
-		(
-			jam_dr_buffer,
-			out_data,
-			out_index,
-			jam_dr_preamble,
-			count
-		);
-	}
-
 	return (status);
 }
 
 /****************************************************************************/
 /*																			*/
 
+JAM_RETURN_TYPE jam_swap_dr
+(
+	long count,
+	long *in_data,
+	long in_index,
+	long *out_data,
+	long out_index,
+	JAMS_SYMBOL_RECORD *symbol_record
+)
+
+/*																			*/
+/*	Description:	Shifts data into data register, capturing output		*/
+/*					data.  If symbol_record is given, the output data may	*/
+/*					arrive any time before that symbol is next used.		*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	JAMS_JTAG_CAPTURE capture;
+
+	capture.symbol = symbol_record;
+	capture.out_data = out_data;
+	capture.out_index = out_index;
+	capture.compare_data = NULL;
+	capture.compare_index = 0L;
+	capture.mask_data = NULL;
+	capture.mask_index = 0L;
+
+	return (jam_jtag_swap(0, count, in_data, in_index, &capture));
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_compare_dr
+(
+	long count,
+	long *in_data,
+	long in_index,
+	long *compare_data,
+	long compare_index,
+	long *mask_data,
+	long mask_index,
+	JAMS_SYMBOL_RECORD *symbol_record
+)
+
+/*																			*/
+/*	Description:	Shifts data into data register, and sets the Boolean	*/
+/*					result variable to whether the masked output data		*/
+/*					matches the compare data.  The result may be set any	*/
+/*					time before the result variable is next used.			*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	JAMS_JTAG_CAPTURE capture;
+
+	capture.symbol = symbol_record;
+	capture.out_data = NULL;
+	capture.out_index = 0L;
+	capture.compare_data = compare_data;
+	capture.compare_index = compare_index;
+	capture.mask_data = mask_data;
+	capture.mask_index = mask_index;
+
+	return (jam_jtag_swap(0, count, in_data, in_index, &capture));
+}
+
+/****************************************************************************/
+/*																			*/
+
 void jam_free_jtag_padding_buffers(int reset_jtag)
 
 /*																			*/
@@ -1612,6 +2023,9 @@ void jam_free_jtag_padding_buffers(int reset_jtag)
 /*																			*/
 /****************************************************************************/
 {
+	/* collect data of scans that were never looked at */
+	jam_resolve_jtag_captures();
+
 	/*
 	*	If the JTAG interface was used, reset it to TLR
 	*/
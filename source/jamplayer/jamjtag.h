@@ -47,6 +47,38 @@ typedef enum
 
 } JAME_JTAG_STATE;
 
+/* symbol records are defined in jamsym.h */
+struct JAMS_SYMBOL_STRUCT;
+
+/****************************************************************************/
+/*																			*/
+/*	Type definitions														*/
+/*																			*/
+/****************************************************************************/
+
+/*
+*	Captured scans whose output data has not been collected yet.  Each
+*	one owns the buffer it was shifted from, since the transport may only
+*	write TDO into it when its queue is flushed.
+*/
+typedef struct JAMS_JTAG_CAPTURE_STRUCT
+{
+	struct JAMS_SYMBOL_STRUCT *symbol;	/* capture array or compare result */
+	char *buffer;				/* scan buffer, receives TDO data */
+	int preamble;				/* padding bits ahead of the target */
+	long count;					/* number of target bits */
+	long *out_data;				/* CAPTURE array, or NULL */
+	long out_index;
+	long *compare_data;			/* COMPARE data, or NULL */
+	long compare_index;
+	long *mask_data;
+	long mask_index;
+	long *compare_copy;			/* compare and mask data, if copied */
+
+} JAMS_JTAG_CAPTURE;
+
+#define JAMC_MAX_JTAG_CAPTURES 32
+
 /****************************************************************************/
 /*																			*/
 /*	Function Prototypes														*/
@@ -131,7 +163,20 @@ JAM_RETURN_TYPE jam_swap_ir
 	long *in_data,
 	long in_index,
 	long *out_data,
-	long out_index
+	long out_index,
+	struct JAMS_SYMBOL_STRUCT *symbol_record
+);
+
+JAM_RETURN_TYPE jam_compare_ir
+(
+	long count,
+	long *in_data,
+	long in_index,
+	long *compare_data,
+	long compare_index,
+	long *mask_data,
+	long mask_index,
+	struct JAMS_SYMBOL_STRUCT *symbol_record
 );
 
 JAM_RETURN_TYPE jam_do_drscan
@@ -147,7 +192,35 @@ JAM_RETURN_TYPE jam_swap_dr
 	long *in_data,
 	long in_index,
 	long *out_data,
-	long out_index
+	long out_index,
+	struct JAMS_SYMBOL_STRUCT *symbol_record
+);
+
+JAM_RETURN_TYPE jam_compare_dr
+(
+	long count,
+	long *in_data,
+	long in_index,
+	long *compare_data,
+	long compare_index,
+	long *mask_data,
+	long mask_index,
+	struct JAMS_SYMBOL_STRUCT *symbol_record
+);
+
+void jam_resolve_jtag_captures
+(
+	void
+);
+
+void jam_jtag_capture_target
+(
+	int target
+);
+
+void jam_jtag_symbol_access
+(
+	struct JAMS_SYMBOL_STRUCT *symbol_record
 );
 
 void jam_free_jtag_padding_buffers
@@ -155,4 +228,52 @@ void jam_free_jtag_padding_buffers
 	int reset_jtag
 );
 
+unsigned long jam_jtag_get_data_bits
+(
+	long *data,
+	long index,
+	int count
+);
+
+void jam_jtag_set_data_bits
+(
+	long *data,
+	long index,
+	int count,
+	unsigned long bits
+);
+
+unsigned long jam_jtag_get_buffer_bits
+(
+	char *buffer,
+	long index,
+	int count
+);
+
+void jam_jtag_set_buffer_bits
+(
+	char *buffer,
+	long index,
+	int count,
+	unsigned long bits
+);
+
+void jam_jtag_copy_to_buffer
+(
+	char *buffer,
+	long buffer_index,
+	long *data,
+	long data_index,
+	long count
+);
+
+void jam_jtag_copy_from_buffer
+(
+	long *data,
+	long data_index,
+	char *buffer,
+	long buffer_index,
+	long count
+);
+
 #endif /* INC_JAMJTAG_H */
@@ -0,0 +1,535 @@
+/****************************************************************************/
+/*																			*/
+/*	Module:			jamload.c												*/
+/*																			*/
+/*	Description:	Program loader.  Reads the whole program once, and		*/
+/*					makes the program descriptor of the context in the		*/
+/*					same pass: the CRC check, the length of the longest		*/
+/*					statement, the positions of the NOTE statements, and	*/
+/*					the program index.  jam_check_crc(), jam_get_note()		*/
+/*					and jam_execute() use the descriptor, instead of each	*/
+/*					reading the program again.								*/
+/*																			*/
+/****************************************************************************/
+
+#include "jamexprt.h"
+#include "jamdefs.h"
+#include "jamexec.h"
+#include "jamsym.h"
+#include "jamstack.h"
+#include "jamheap.h"
+#include "jamjtag.h"
+#include "jamutil.h"
+#include "jamcode.h"
+#include "jamload.h"
+#include "jamctx.h"
+
+/****************************************************************************/
+/*																			*/
+
+BOOL jam_add_note_position
+(
+	long *note_capacity,
+	long statement_begin,
+	long statement_end
+)
+
+/*																			*/
+/*	Description:	Records the position of a NOTE statement.  The list		*/
+/*					holds two positions for each NOTE statement: where		*/
+/*					jam_get_statement() starts reading it, and the			*/
+/*					position just after its semicolon.						*/
+/*																			*/
+/*	Returns:		TRUE for success, FALSE if out of memory				*/
+/*																			*/
+/****************************************************************************/
+{
+	long index = 0L;
+	long *new_positions = NULL;
+	BOOL success = TRUE;
+
+	if (jam_program_info.note_count >= *note_capacity)
+	{
+		new_positions = (long *) jam_malloc((unsigned int)
+			(4L * (*note_capacity + 8L) * (long) sizeof(long)));
+
+		if (new_positions == NULL)
+		{
+			success = FALSE;
+		}
+		else
+		{
+			for (index = 0L; index < 2L * jam_program_info.note_count;
+				++index)
+			{
+				new_positions[index] = jam_note_positions[index];
+			}
+
+			if (jam_note_positions != NULL) jam_free(jam_note_positions);
+			jam_note_positions = new_positions;
+			*note_capacity = 2L * (*note_capacity + 8L);
+		}
+	}
+
+	if (success)
+	{
+		index = 2L * jam_program_info.note_count;
+		jam_note_positions[index] = statement_begin;
+		jam_note_positions[index + 1] = statement_end;
+		++jam_program_info.note_count;
+	}
+
+	return (success);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_scan_program
+(
+	void
+)
+
+/*																			*/
+/*	Description:	Makes the program descriptor of the current program,	*/
+/*					unless it was already made.  Every character of the		*/
+/*					program is given to the CRC check, and statements are	*/
+/*					preprocessed as jam_get_statement() does, to measure	*/
+/*					them and to add them to the program index.  The			*/
+/*					initialization data of Boolean arrays is counted but	*/
+/*					not kept.  A statement error is kept in the context,	*/
+/*					for jam_execute() to report, and the index is only		*/
+/*					kept if the whole program could be read.  The file		*/
+/*					position is left at the beginning of the program.		*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	int ch = 0;
+	int last_ch = 0;
+	int label_index = 0;
+	int hash = 0;
+	long i = 0L;
+	long index = 0L;
+	long position = 0L;
+	long first_char_position = -1L;
+	long left_quote_position = -1L;
+	long statement_begin = 0L;
+	long buffer_size = 0L;
+	long note_capacity = 0L;
+	long block_begin = -1L;
+	long array_block = -1L;
+	char *buffer = NULL;
+	char *new_buffer = NULL;
+	char label_buffer[JAMC_MAX_NAME_LENGTH + 1];
+	int save_statement_buffer_size = 0;
+	unsigned long start_time = 0L;
+	JAMS_INDEX_ENTRY *entry = NULL;
+	BOOL scanned = FALSE;
+	BOOL comment = FALSE;
+	BOOL quoted_string = FALSE;
+	BOOL boolean_array_data = FALSE;
+	BOOL literal_aca_array = FALSE;
+	BOOL label_found = FALSE;
+	BOOL indexing = FALSE;
+	BOOL loaded_index = FALSE;
+	BOOL done = FALSE;
+	JAMS_CRC_SCAN crc_scan;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	if (jam_program_loaded && (jam_loaded_program == jam_program) &&
+		(jam_loaded_program_size == jam_program_size))
+	{
+		/* the descriptor is already made */
+		done = TRUE;
+	}
+	else
+	{
+		jam_free_program_info();
+		start_time = jam_get_microseconds();
+		scanned = TRUE;
+
+		jam_crc_scan_init(&crc_scan);
+		jam_load_status = JAMC_SUCCESS;
+		label_buffer[0] = JAMC_NULL_CHAR;
+
+		buffer_size = JAMC_LOAD_BUFFER_SIZE;
+		buffer = (char *) jam_malloc((unsigned int) (buffer_size + 1L));
+
+		if (buffer == NULL)
+		{
+			status = JAMC_OUT_OF_MEMORY;
+		}
+		else
+		{
+			buffer[0] = JAMC_NULL_CHAR;
+		}
+
+		if ((status == JAMC_SUCCESS) && (jam_seek(0L) != 0))
+		{
+			status = JAMC_IO_ERROR;
+		}
+	}
+
+	if ((status == JAMC_SUCCESS) && !done)
+	{
+		/* a stored index is complete, and the statements need not add to it */
+		loaded_index = jam_load_index();
+
+		if (!loaded_index)
+		{
+			indexing = (jam_init_index() == JAMC_SUCCESS) &&
+				(jam_index_table != NULL);
+		}
+	}
+
+	while ((status == JAMC_SUCCESS) && !done)
+	{
+		last_ch = ch;
+		ch = jam_getc();
+
+		jam_crc_scan_char(&crc_scan, ch, position);
+
+		if (jam_load_status != JAMC_SUCCESS)
+		{
+			/* only the CRC is still wanted after a statement error */
+			ch = 0;
+		}
+		else if ((!comment) && (!quoted_string))
+		{
+			if (ch == JAMC_COMMENT_CHAR)
+			{
+				/* beginning of comment */
+				comment = TRUE;
+			}
+			else if (ch == JAMC_QUOTE_CHAR)
+			{
+				/* beginning of quoted string */
+				quoted_string = TRUE;
+				left_quote_position = position;
+			}
+			else if (ch == JAMC_COLON_CHAR)
+			{
+				/* statement contains a label */
+				if (label_found)
+				{
+					/* multiple labels found */
+					jam_load_status = JAMC_SYNTAX_ERROR;
+				}
+				else if (index <= JAMC_MAX_NAME_LENGTH)
+				{
+					/* copy label into label_buffer */
+					for (label_index = 0; label_index < index; label_index++)
+					{
+						label_buffer[label_index] = buffer[label_index];
+					}
+					label_buffer[index] = JAMC_NULL_CHAR;
+					label_found = TRUE;
+
+					/* delete label from statement */
+					index = 0L;
+					buffer[0] = JAMC_NULL_CHAR;
+					first_char_position = -1L;
+					ch = JAMC_SPACE_CHAR;
+				}
+				else
+				{
+					/* label name was too long */
+					jam_load_status = JAMC_ILLEGAL_SYMBOL;
+				}
+			}
+			else if ((ch == JAMC_TAB_CHAR) ||
+				(ch == JAMC_NEWLINE_CHAR) ||
+				(ch == JAMC_RETURN_CHAR))
+			{
+				/* convert tab, CR, LF to space character */
+				ch = JAMC_SPACE_CHAR;
+			}
+		}
+
+		/* include the character in the statement */
+		if ((jam_load_status == JAMC_SUCCESS) && (!comment) &&
+			((first_char_position != -1L) || (ch != JAMC_SPACE_CHAR)) &&
+			(quoted_string ||
+				(ch != JAMC_SPACE_CHAR) || (last_ch != JAMC_SPACE_CHAR)))
+		{
+			if ((index >= buffer_size) && !boolean_array_data)
+			{
+				new_buffer = (char *) jam_malloc(
+					(unsigned int) (2L * buffer_size + 1L));
+
+				if (new_buffer == NULL)
+				{
+					status = JAMC_OUT_OF_MEMORY;
+				}
+				else
+				{
+					for (i = 0L; i < index; ++i) new_buffer[i] = buffer[i];
+
+					jam_free(buffer);
+					buffer = new_buffer;
+					buffer_size *= 2L;
+				}
+			}
+
+			/* convert to upper case except quotes and boolean arrays */
+			if (index < buffer_size)
+			{
+				if (quoted_string || boolean_array_data || literal_aca_array)
+				{
+					buffer[index] = (char) ch;
+				}
+				else
+				{
+					buffer[index] = (char)
+						(((ch >= 'a') && (ch <= 'z')) ?
+						(ch - ('a' - 'A')) : ch);
+				}
+				buffer[index + 1] = JAMC_NULL_CHAR;
+			}
+
+			++index;
+			if (first_char_position == -1L) first_char_position = position;
+
+			/*
+			*	Whenever we see a right bracket character, check if the
+			*	statement is a Boolean array declaration statement.
+			*/
+			if ((!boolean_array_data) && (ch == JAMC_RBRACKET_CHAR)
+				&& (buffer[0] == 'B'))
+			{
+				if (jam_strncmp(buffer, "BOOLEAN", 7) == 0)
+				{
+					boolean_array_data = TRUE;
+				}
+			}
+
+			/*
+			*	Check for literal ACA array assignment
+			*/
+			if ((!quoted_string) && (!boolean_array_data) &&
+				(!literal_aca_array) && (ch == JAMC_AT_CHAR))
+			{
+				/* this is the beginning of a literal ACA array */
+				literal_aca_array = TRUE;
+			}
+
+			if (literal_aca_array &&
+				(!jam_isalnum((char) ch)) &&
+				(ch != JAMC_AT_CHAR) &&
+				(ch != JAMC_UNDERSCORE_CHAR) &&
+				(ch != JAMC_SPACE_CHAR))
+			{
+				/* this is the end of the literal ACA array */
+				literal_aca_array = FALSE;
+			}
+		}
+
+		if ((status == JAMC_SUCCESS) && (jam_load_status == JAMC_SUCCESS) &&
+			(!comment) && (!quoted_string) && (ch == JAMC_SEMICOLON_CHAR))
+		{
+			/* end of statement */
+			if (!boolean_array_data &&
+				(index > jam_program_info.statement_length))
+			{
+				jam_program_info.statement_length = index;
+			}
+			++jam_program_info.statement_count;
+
+			if (first_char_position != -1L)
+			{
+				jam_current_statement_position = first_char_position;
+			}
+			jam_next_statement_position = position + 1L;
+			jam_current_file_position = position + 1L;
+
+			if (jam_get_instruction(buffer) == JAM_NOTE_INSTR)
+			{
+				if (!jam_add_note_position(&note_capacity,
+					statement_begin, position + 1L))
+				{
+					status = JAMC_OUT_OF_MEMORY;
+				}
+			}
+
+			if (indexing)
+			{
+				/* the index functions look no further than the buffer */
+				save_statement_buffer_size = jam_statement_buffer_size;
+				jam_statement_buffer_size = (int) buffer_size;
+
+				if (jam_index_statement(buffer, label_buffer,
+					&block_begin, &array_block) != JAMC_SUCCESS)
+				{
+					jam_free_index();
+					indexing = FALSE;
+				}
+
+				jam_statement_buffer_size = save_statement_buffer_size;
+			}
+
+			statement_begin = position + 1L;
+			first_char_position = -1L;
+			left_quote_position = -1L;
+			label_found = FALSE;
+			label_buffer[0] = JAMC_NULL_CHAR;
+			ch = 0;
+			boolean_array_data = FALSE;
+			literal_aca_array = FALSE;
+			index = 0L;
+			buffer[0] = JAMC_NULL_CHAR;
+		}
+
+		if (ch == EOF)
+		{
+			/* end of file */
+			done = TRUE;
+		}
+
+		if (comment &&
+			((ch == JAMC_NEWLINE_CHAR) || (ch == JAMC_RETURN_CHAR)))
+		{
+			/* end of comment */
+			comment = FALSE;
+		}
+		else if (quoted_string && (ch == JAMC_QUOTE_CHAR) &&
+			(position > left_quote_position))
+		{
+			/* end of quoted string */
+			quoted_string = FALSE;
+		}
+
+		++position;	/* position of next character to be read */
+
+		/* after a statement error, stop once the CRC is known */
+		if ((jam_load_status != JAMC_SUCCESS) &&
+			(crc_scan.state == JAMC_CRC_DONE))
+		{
+			done = TRUE;
+		}
+	}
+
+	if (buffer != NULL) jam_free(buffer);
+
+	if ((status == JAMC_SUCCESS) && scanned)
+	{
+		/* the index is only complete if the end of the file was reached */
+		if (jam_load_status != JAMC_SUCCESS)
+		{
+			jam_free_index();
+		}
+		else if (indexing)
+		{
+			jam_save_index();
+		}
+
+		jam_program_info.crc_status = jam_crc_scan_result(&crc_scan,
+			&jam_program_info.expected_crc, &jam_program_info.actual_crc);
+
+		for (hash = 0; (jam_index_table != NULL) &&
+			(hash < JAMC_MAX_SYMBOL_COUNT); ++hash)
+		{
+			for (entry = jam_index_table[hash]; entry != NULL;
+				entry = entry->next)
+			{
+				++jam_program_info.index_count;
+			}
+		}
+
+		jam_program_info.load_time = jam_get_microseconds() - start_time;
+		jam_loaded_program = jam_program;
+		jam_loaded_program_size = jam_program_size;
+		jam_program_loaded = TRUE;
+	}
+	else if (status != JAMC_SUCCESS)
+	{
+		jam_free_program_info();
+	}
+
+	if (scanned)
+	{
+		jam_seek(0L);
+		jam_current_file_position = 0L;
+		jam_current_statement_position = 0L;
+		jam_next_statement_position = 0L;
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
+void jam_free_program_info
+(
+	void
+)
+
+/*																			*/
+/*	Description:	Frees the NOTE positions and the program index of the	*/
+/*					program descriptor, so that the next use of the			*/
+/*					descriptor reads the program again.						*/
+/*																			*/
+/*	Returns:		Nothing													*/
+/*																			*/
+/****************************************************************************/
+{
+	if (jam_note_positions != NULL)
+	{
+		jam_free(jam_note_positions);
+		jam_note_positions = NULL;
+	}
+
+	jam_free_index();
+
+	jam_program_loaded = FALSE;
+	jam_loaded_program = NULL;
+	jam_loaded_program_size = 0L;
+
+	jam_program_info.crc_status = JAMC_SUCCESS;
+	jam_program_info.expected_crc = 0;
+	jam_program_info.actual_crc = 0;
+	jam_program_info.statement_length = 0L;
+	jam_program_info.statement_count = 0L;
+	jam_program_info.note_count = 0L;
+	jam_program_info.index_count = 0L;
+	jam_program_info.load_time = 0L;
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_load_program
+(
+	char *program,
+	long program_size,
+	JAMS_PROGRAM_INFO *info
+)
+
+/*																			*/
+/*	Description:	Reads the program once and makes its descriptor, for	*/
+/*					jam_check_crc(), jam_get_note() and jam_execute() to	*/
+/*					use.  A copy of the descriptor is given to the caller	*/
+/*					if info is not NULL.									*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
+/*																			*/
+/****************************************************************************/
+{
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	jam_enter_context();
+
+	jam_program = program;
+	jam_program_size = program_size;
+
+	status = jam_scan_program();
+
+	if ((status == JAMC_SUCCESS) && (info != NULL))
+	{
+		*info = jam_program_info;
+	}
+
+	return (status);
+}
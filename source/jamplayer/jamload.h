@@ -0,0 +1,96 @@
+/****************************************************************************/
+/*																			*/
+/*	Module:			jamload.h												*/
+/*																			*/
+/*	Description:	Definitions for the program loader, which reads the		*/
+/*					whole program once and makes the program descriptor		*/
+/*					of the context: the CRC check, the longest statement,	*/
+/*					the NOTE fields and the program index.					*/
+/*																			*/
+/****************************************************************************/
+
+#ifndef INC_JAMLOAD_H
+#define INC_JAMLOAD_H
+
+/****************************************************************************/
+/*																			*/
+/*	Constant definitions													*/
+/*																			*/
+/****************************************************************************/
+
+/* bytes of statement text the loader keeps at first, more are added */
+#define JAMC_LOAD_BUFFER_SIZE 1024
+
+/* states of the CRC check, while reading the value of the CRC statement */
+#define JAMC_CRC_SCANNING		0
+#define JAMC_CRC_BEFORE_VALUE	1
+#define JAMC_CRC_VALUE			2
+#define JAMC_CRC_AFTER_VALUE	3
+#define JAMC_CRC_DONE			4
+
+/****************************************************************************/
+/*																			*/
+/*	Type definitions														*/
+/*																			*/
+/****************************************************************************/
+
+/*
+*	State of the CRC check, which is given the program one character at
+*	a time.  The CRC covers everything up to the CRC statement.  The last
+*	four characters and CRC values are kept, to take the CRC statement
+*	itself back out once it is recognized.
+*/
+typedef struct
+{
+	int state;
+	unsigned short shift_register;
+	unsigned short shift_register_backup[4];
+	int ch_queue[4];
+	BOOL comment;
+	BOOL quoted_string;
+	BOOL in_statement;
+	BOOL in_instruction;
+	long left_quote_position;
+	int digit_count;
+	BOOL found_expected_crc;
+	unsigned short expected_crc;
+	JAM_RETURN_TYPE status;
+
+} JAMS_CRC_SCAN;
+
+/****************************************************************************/
+/*																			*/
+/*	Function prototypes														*/
+/*																			*/
+/****************************************************************************/
+
+void jam_crc_scan_init
+(
+	JAMS_CRC_SCAN *scan
+);
+
+void jam_crc_scan_char
+(
+	JAMS_CRC_SCAN *scan,
+	int ch,
+	long position
+);
+
+JAM_RETURN_TYPE jam_crc_scan_result
+(
+	JAMS_CRC_SCAN *scan,
+	unsigned short *expected_crc,
+	unsigned short *actual_crc
+);
+
+JAM_RETURN_TYPE jam_scan_program
+(
+	void
+);
+
+void jam_free_program_info
+(
+	void
+);
+
+#endif /* INC_JAMLOAD_H */
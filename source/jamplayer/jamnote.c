@@ -11,7 +11,13 @@
 #include "jamexprt.h"
 #include "jamdefs.h"
 #include "jamexec.h"
+#include "jamsym.h"
+#include "jamstack.h"
+#include "jamheap.h"
+#include "jamjtag.h"
 #include "jamutil.h"
+#include "jamload.h"
+#include "jamctx.h"
 
 /****************************************************************************/
 /*																			*/
@@ -214,6 +220,8 @@ JAM_RETURN_TYPE jam_get_note
 /*					the key string provided.  If offset is not NULL, then	*/
 /*					the function finds the next note field of any key,		*/
 /*					starting at the offset specified by the offset pointer.	*/
+/*					Only the NOTE statements found by the program loader	*/
+/*					are read.												*/
 /*																			*/
 /*	Returns:		JAMC_SUCCESS for success, else appropriate error code	*/
 /*																			*/
@@ -228,12 +236,22 @@ JAM_RETURN_TYPE jam_get_note
 	long key_end = 0L;
 	long value_begin = 0L;
 	long value_end = 0L;
+	long note = 0L;
+	long start = 0L;
 	BOOL done = FALSE;
-	char *tmp_program = jam_program;
-	long tmp_program_size = jam_program_size;
-	long tmp_current_file_position = jam_current_file_position;
-	long tmp_current_statement_position = jam_current_statement_position;
-	long tmp_next_statement_position = jam_next_statement_position;
+	char *tmp_program = NULL;
+	long tmp_program_size = 0L;
+	long tmp_current_file_position = 0L;
+	long tmp_current_statement_position = 0L;
+	long tmp_next_statement_position = 0L;
+
+	jam_enter_context();
+
+	tmp_program = jam_program;
+	tmp_program_size = jam_program_size;
+	tmp_current_file_position = jam_current_file_position;
+	tmp_current_statement_position = jam_current_statement_position;
+	tmp_next_statement_position = jam_next_statement_position;
 
 	jam_program = program;
 	jam_program_size = program_size;
@@ -251,8 +269,7 @@ JAM_RETURN_TYPE jam_get_note
 			*	We will search for the first note with a specific key, and
 			*	return only the value
 			*/
-			status = jam_seek(0L);
-			jam_current_file_position = 0L;
+			start = 0L;
 		}
 		else
 		{
@@ -260,17 +277,36 @@ JAM_RETURN_TYPE jam_get_note
 			*	We will search for the next note, regardless of the key, and
 			*	return both the value and the key
 			*/
-			status = jam_seek(*offset);
-			jam_current_file_position = *offset;
+			start = *offset;
+		}
+
+		while ((note < jam_program_info.note_count) &&
+			(jam_note_positions[2L * note] < start))
+		{
+			++note;
 		}
 	}
 
 	/*
-	*	Get program statements and look for NOTE statements
+	*	Read the NOTE statements from the loader
 	*/
 	while ((!done) && (status == JAMC_SUCCESS))
 	{
-		status = jam_get_statement(statement_buffer, label_buffer);
+		if (note >= jam_program_info.note_count)
+		{
+			/* no more NOTE statements */
+			status = JAMC_UNEXPECTED_END;
+		}
+		else if (jam_seek(jam_note_positions[2L * note]) != 0)
+		{
+			status = JAMC_IO_ERROR;
+		}
+		else
+		{
+			jam_current_file_position = jam_note_positions[2L * note];
+			status = jam_get_statement(statement_buffer, label_buffer);
+			++note;
+		}
 
 		if (status == JAMC_SUCCESS)
 		{
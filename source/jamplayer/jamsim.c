@@ -0,0 +1,1113 @@
+/****************************************************************************/
+/*																			*/
+/*	Module:			jamsim.c												*/
+/*																			*/
+/*	Description:	Simulated JTAG chain.  A TAP state machine drives a		*/
+/*					chain of device models, so that Jam programs can be		*/
+/*					run, timed and regression tested without hardware.		*/
+/*																			*/
+/*					The chain is given with -j as a comma separated list	*/
+/*					of devices, starting with the device at TDI:			*/
+/*																			*/
+/*					bypass[:<ir length>]		BYPASS register only		*/
+/*					idcode:<id>[:<ir length>]	IDCODE and BYPASS			*/
+/*					epm7064s, epm7128s			MAX7000S ISP array			*/
+/*					epm9320						MAX9000 ISP array			*/
+/*					isplsi3256a					ispLSI ISP array			*/
+/*																			*/
+/*					The ISP parts start out erased, except for the			*/
+/*					silicon ID that the Altera programs read from the		*/
+/*					array.  Delays take no time on the simulated chain.		*/
+/*																			*/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "jamexprt.h"
+#include "jamjtag.h"
+#include "jamtrans.h"
+
+/****************************************************************************/
+/*																			*/
+/*	Constant definitions													*/
+/*																			*/
+/****************************************************************************/
+
+#define BOOL int
+#define TRUE 1
+#define FALSE 0
+
+#define JAMC_SIM_MAX_DEVICES	32
+
+/*
+*	Registers of a simulated device.  DATA holds the column data registers
+*	of the first half of a row, followed by those of the second half.
+*/
+#define JAMC_SIM_REG_BYPASS		0
+#define JAMC_SIM_REG_IDCODE		1
+#define JAMC_SIM_REG_ADDRESS	2
+#define JAMC_SIM_REG_DATA		3
+#define JAMC_SIM_DATA_HALF		5
+#define JAMC_SIM_REG_AUX		13
+#define JAMC_SIM_AUX_COUNT		7
+#define JAMC_SIM_REG_AUX2		20
+#define JAMC_SIM_REG_AUX3		21
+#define JAMC_SIM_REG_READ		22
+#define JAMC_SIM_MAX_REGISTERS	23
+
+/* state of the program/erase pulse */
+#define JAMC_SIM_PULSE_OFF		0
+#define JAMC_SIM_PULSE_PROGRAM	1
+#define JAMC_SIM_PULSE_ERASE	2
+
+/****************************************************************************/
+/*																			*/
+/*	Type definitions														*/
+/*																			*/
+/****************************************************************************/
+
+typedef enum
+{
+	JAM_SIM_GENERIC = 0,
+	JAM_SIM_MAX7000S = 1,
+	JAM_SIM_MAX9000 = 2,
+	JAM_SIM_ISPLSI = 3
+
+} JAME_SIM_FAMILY;
+
+typedef struct
+{
+	char *name;
+	JAME_SIM_FAMILY family;
+	int ir_length;
+	unsigned long idcode_opcode;
+	unsigned long idcode;
+	int address_length;
+	int data_length;		/* bits in each column data register */
+	int data_count;			/* column data registers in each half row */
+	int aux_length[3];		/* MAX9000 registers 02A, 032 and 02E */
+	int aux_count;			/* number of 02A registers */
+	char *silicon_id;		/* read from the ISP array by the programs */
+	int revision;
+
+} JAMS_SIM_PART;
+
+/*
+*	A programmed row of the ISP array.  Rows are found by the exact content
+*	of the address register and by the data register that programmed them,
+*	so the model needs no knowledge of the address decoding of each part.
+*	Rows that were never programmed read as erased (all ones).
+*/
+typedef struct JAMS_SIM_ROW_STRUCT
+{
+	struct JAMS_SIM_ROW_STRUCT *next;
+	unsigned long hash;
+	int reg;
+	BOOL factory;
+	unsigned char *address;
+	unsigned char *data;
+
+} JAMS_SIM_ROW;
+
+typedef struct
+{
+	JAMS_SIM_PART *part;
+	int ir_length;
+	unsigned long idcode;
+	unsigned long ir_shift;
+	unsigned long ir;
+	int selected;			/* register selected by the instruction */
+	int read_source;		/* data register a read instruction samples */
+	int read_token;			/* data register holding the column token */
+	BOOL broadcast;			/* update writes every data register of the half */
+	int pulse;
+	unsigned char *reg[JAMC_SIM_MAX_REGISTERS];
+	int reg_length[JAMC_SIM_MAX_REGISTERS];
+	BOOL reg_dirty[JAMC_SIM_MAX_REGISTERS];
+	JAMS_SIM_ROW *rows;
+
+} JAMS_SIM_DEVICE;
+
+/****************************************************************************/
+/*																			*/
+/*	Global variables														*/
+/*																			*/
+/****************************************************************************/
+
+JAMS_SIM_PART jam_sim_parts[] =
+{
+	{ "bypass", JAM_SIM_GENERIC, 2, 0L, 0L,
+		0, 0, 0, { 0, 0, 0 }, 0, NULL, 0 },
+	{ "idcode", JAM_SIM_GENERIC, 2, 0L, 0L,
+		0, 0, 0, { 0, 0, 0 }, 0, NULL, 0 },
+	{ "epm7064s", JAM_SIM_MAX7000S, 10, 0x059L, 0x070640DDL,
+		253, 160, 1, { 0, 0, 0 }, 0, "ALTERA96", 1 },
+	{ "epm7128s", JAM_SIM_MAX7000S, 10, 0x059L, 0x071280DDL,
+		273, 320, 1, { 0, 0, 0 }, 0, "ALTERA96", 0 },
+	{ "epm9320", JAM_SIM_MAX9000, 10, 0x059L, 0x093200DDL,
+		791, 160, 5, { 165, 64, 504 }, 4, "ALTERA94", 1 },
+	{ "isplsi3256a", JAM_SIM_ISPLSI, 5, 0x16L, 0x00000043L,
+		180, 338, 1, { 0, 0, 0 }, 0, NULL, 0 }
+};
+
+#define JAMC_SIM_PART_COUNT \
+	((int) (sizeof(jam_sim_parts) / sizeof(jam_sim_parts[0])))
+
+/*
+*	TAP state reached after one TCK with TMS high or low, respectively
+*/
+struct JAMS_SIM_MACHINE
+{
+	JAME_JTAG_STATE tms_high;
+	JAME_JTAG_STATE tms_low;
+} jam_sim_state_transitions[] =
+{
+/* RESET     */	{ RESET,	IDLE },
+/* IDLE      */	{ DRSELECT,	IDLE },
+/* DRSELECT  */	{ IRSELECT,	DRCAPTURE },
+/* DRCAPTURE */	{ DREXIT1,	DRSHIFT },
+/* DRSHIFT   */	{ DREXIT1,	DRSHIFT },
+/* DREXIT1   */	{ DRUPDATE,	DRPAUSE },
+/* DRPAUSE   */	{ DREXIT2,	DRPAUSE },
+/* DREXIT2   */	{ DRUPDATE,	DRSHIFT },
+/* DRUPDATE  */	{ DRSELECT,	IDLE },
+/* IRSELECT  */	{ RESET,	IRCAPTURE },
+/* IRCAPTURE */	{ IREXIT1,	IRSHIFT },
+/* IRSHIFT   */	{ IREXIT1,	IRSHIFT },
+/* IREXIT1   */	{ IRUPDATE,	IRPAUSE },
+/* IRPAUSE   */	{ IREXIT2,	IRPAUSE },
+/* IREXIT2   */	{ IRUPDATE,	IRSHIFT },
+/* IRUPDATE  */	{ DRSELECT,	IDLE }
+};
+
+/* each thread simulates its own chain */
+JAM_THREAD JAMS_SIM_DEVICE jam_sim_devices[JAMC_SIM_MAX_DEVICES];
+JAM_THREAD int jam_sim_device_count = 0;
+JAM_THREAD JAME_JTAG_STATE jam_sim_state = RESET;
+JAM_THREAD unsigned long jam_sim_clocks = 0L;
+
+/****************************************************************************/
+/*																			*/
+/*	ISP array																*/
+/*																			*/
+/****************************************************************************/
+
+unsigned long jam_sim_address_hash(JAMS_SIM_DEVICE *device)
+{
+	unsigned char *address = device->reg[JAMC_SIM_REG_ADDRESS];
+	unsigned long hash = 0L;
+	int i = 0;
+
+	for (i = 0; i < device->reg_length[JAMC_SIM_REG_ADDRESS]; ++i)
+	{
+		if (address[i]) hash = (hash * 31L) + (unsigned long) (i + 1);
+	}
+
+	return (hash);
+}
+
+JAMS_SIM_ROW *jam_sim_find_row(JAMS_SIM_DEVICE *device, int reg, BOOL create)
+{
+	JAMS_SIM_ROW *row = NULL;
+	unsigned char *address = device->reg[JAMC_SIM_REG_ADDRESS];
+	int address_length = device->reg_length[JAMC_SIM_REG_ADDRESS];
+	int length = device->reg_length[reg];
+	unsigned long hash = jam_sim_address_hash(device);
+
+	for (row = device->rows; row != NULL; row = row->next)
+	{
+		if ((row->reg == reg) && (row->hash == hash) &&
+			(memcmp(row->address, address, (size_t) address_length) == 0))
+		{
+			return (row);
+		}
+	}
+
+	if (create)
+	{
+		row = (JAMS_SIM_ROW *) jam_malloc(sizeof(JAMS_SIM_ROW));
+
+		if (row != NULL)
+		{
+			row->address = (unsigned char *) jam_malloc(
+				(unsigned int) address_length);
+			row->data = (unsigned char *) jam_malloc((unsigned int) length);
+
+			if ((row->address == NULL) || (row->data == NULL))
+			{
+				if (row->address != NULL) jam_free(row->address);
+				if (row->data != NULL) jam_free(row->data);
+				jam_free(row);
+				row = NULL;
+			}
+		}
+
+		if (row != NULL)
+		{
+			row->hash = hash;
+			row->reg = reg;
+			row->factory = FALSE;
+			memcpy(row->address, address, (size_t) address_length);
+			memset(row->data, 1, (size_t) length);
+			row->next = device->rows;
+			device->rows = row;
+		}
+	}
+
+	return (row);
+}
+
+void jam_sim_program_row(JAMS_SIM_DEVICE *device, int reg, int source)
+{
+	JAMS_SIM_ROW *row = jam_sim_find_row(device, reg, TRUE);
+	int i = 0;
+
+	/* programming can only clear cells */
+	if ((row != NULL) && !row->factory)
+	{
+		for (i = 0; i < device->reg_length[reg]; ++i)
+		{
+			row->data[i] &= device->reg[source][i];
+		}
+	}
+}
+
+void jam_sim_load_row(JAMS_SIM_DEVICE *device, int reg, int target)
+{
+	JAMS_SIM_ROW *row = jam_sim_find_row(device, reg, FALSE);
+
+	if (row != NULL)
+	{
+		memcpy(device->reg[target], row->data,
+			(size_t) device->reg_length[target]);
+	}
+	else
+	{
+		memset(device->reg[target], 1, (size_t) device->reg_length[target]);
+	}
+}
+
+void jam_sim_erase_rows(JAMS_SIM_DEVICE *device, BOOL all)
+{
+	JAMS_SIM_ROW **link = &device->rows;
+	JAMS_SIM_ROW *row = NULL;
+	unsigned char *address = device->reg[JAMC_SIM_REG_ADDRESS];
+	BOOL selected = FALSE;
+	int i = 0;
+
+	while ((row = *link) != NULL)
+	{
+		/* a row is erased if the address register selects all of its bits */
+		selected = !row->factory;
+		for (i = 0; selected && !all &&
+			(i < device->reg_length[JAMC_SIM_REG_ADDRESS]); ++i)
+		{
+			if (row->address[i] && !address[i]) selected = FALSE;
+		}
+
+		if (selected)
+		{
+			*link = row->next;
+			jam_free(row->address);
+			jam_free(row->data);
+			jam_free(row);
+		}
+		else
+		{
+			link = &row->next;
+		}
+	}
+}
+
+/****************************************************************************/
+/*																			*/
+/*	Altera MAX7000S and MAX9000 ISP											*/
+/*																			*/
+/****************************************************************************/
+
+void jam_sim_altera_pulse(JAMS_SIM_DEVICE *device)
+{
+	int reg = 0;
+
+	if (device->pulse == JAMC_SIM_PULSE_ERASE)
+	{
+		jam_sim_erase_rows(device, FALSE);
+	}
+	else if (device->pulse == JAMC_SIM_PULSE_PROGRAM)
+	{
+		/* each data register loaded since the last pulse programs its row */
+		for (reg = JAMC_SIM_REG_DATA; reg < JAMC_SIM_REG_READ; ++reg)
+		{
+			if (device->reg_dirty[reg] && (device->reg_length[reg] > 0))
+			{
+				jam_sim_program_row(device, reg, reg);
+			}
+		}
+	}
+
+	for (reg = 0; reg < JAMC_SIM_MAX_REGISTERS; ++reg)
+	{
+		device->reg_dirty[reg] = FALSE;
+	}
+}
+
+void jam_sim_altera_instruction(JAMS_SIM_DEVICE *device)
+{
+	/*
+	*	The low seven bits select the operation.  On MAX9000 parts the top
+	*	three bits select one of several data registers, and seven selects
+	*	all of them at once.
+	*/
+	int opcode = (int) (device->ir & 0x7f);
+	int index = (int) (device->ir >> 7);
+	int half = 0;
+
+	switch (opcode)
+	{
+	case 0x01E:
+		device->selected = JAMC_SIM_REG_ADDRESS;
+		break;
+
+	case 0x01A:
+		half = JAMC_SIM_DATA_HALF;
+		/* fall through */
+	case 0x016:
+		if (index == 7)
+		{
+			device->broadcast = TRUE;
+			index = 0;
+		}
+		if (index < JAMC_SIM_DATA_HALF)
+		{
+			device->selected = JAMC_SIM_REG_DATA + half + index;
+		}
+		break;
+
+	case 0x026:
+		half = JAMC_SIM_DATA_HALF;
+		/* fall through */
+	case 0x022:
+		if (index < JAMC_SIM_DATA_HALF)
+		{
+			device->selected = JAMC_SIM_REG_READ;
+			device->read_source = JAMC_SIM_REG_DATA + half + index;
+			device->read_token = device->read_source;
+
+			/* MAX9000 parts take the token for both halves from 016 */
+			if (device->part->family == JAM_SIM_MAX9000)
+			{
+				device->read_token = JAMC_SIM_REG_DATA + index;
+			}
+		}
+		break;
+
+	case 0x02A:
+		if (index < JAMC_SIM_AUX_COUNT)
+		{
+			device->selected = JAMC_SIM_REG_AUX + index;
+		}
+		break;
+
+	case 0x032:
+		device->selected = JAMC_SIM_REG_AUX2;
+		break;
+
+	case 0x02E:
+		device->selected = JAMC_SIM_REG_AUX3;
+		break;
+
+	case 0x006:
+		device->pulse = JAMC_SIM_PULSE_PROGRAM;
+		break;
+
+	case 0x00E:
+		if (device->pulse != JAMC_SIM_PULSE_OFF)
+		{
+			device->pulse = JAMC_SIM_PULSE_ERASE;
+		}
+		break;
+
+	case 0x00A:
+		jam_sim_altera_pulse(device);
+		break;
+
+	case 0x012:
+		device->pulse = JAMC_SIM_PULSE_OFF;
+		break;
+
+	default:
+		/* read modes, ISP entry and exit need no action */
+		break;
+	}
+}
+
+void jam_sim_altera_read(JAMS_SIM_DEVICE *device)
+{
+	/*
+	*	Each read bit covers five columns of a data register.  The data
+	*	register holds a token that picks the columns to be sensed.
+	*/
+	JAMS_SIM_ROW *row = jam_sim_find_row(device, device->read_source, FALSE);
+	unsigned char *token = device->reg[device->read_token];
+	unsigned char *read = device->reg[JAMC_SIM_REG_READ];
+	int group = 0;
+	int column = 0;
+	int sensed = 0;
+
+	for (group = 0; group < device->reg_length[JAMC_SIM_REG_READ]; ++group)
+	{
+		/* a group with no token senses nothing, erased cells read high */
+		sensed = 0;
+		read[group] = 1;
+
+		for (column = 5 * group; column < 5 * group + 5; ++column)
+		{
+			if (token[column])
+			{
+				sensed = 1;
+				read[group] &= (row != NULL) ? row->data[column] : 1;
+			}
+		}
+
+		if (!sensed && (row != NULL)) read[group] = row->data[5 * group + 4];
+	}
+}
+
+void jam_sim_max7000s_silicon_id(JAMS_SIM_DEVICE *device)
+{
+	/*
+	*	Row 0 holds the silicon ID.  The program reads it in five passes
+	*	over both halves, and picks bytes out of the captured bits.
+	*/
+	JAMS_SIM_ROW *row[2];
+	unsigned char id[15];
+	int width = device->reg_length[JAMC_SIM_REG_READ];
+	int pairs = width / 8;
+	int address_length = device->reg_length[JAMC_SIM_REG_ADDRESS];
+	int group = 0;
+	int offset = 0;
+	int index = 0;
+	int half = 0;
+	int pass = 0;
+	int i = 0;
+	int j = 0;
+
+	memset(id, 0, sizeof(id));
+	memcpy(id, device->part->silicon_id, 8);
+	id[9] = (unsigned char) device->part->revision;
+
+	device->reg[JAMC_SIM_REG_ADDRESS][address_length - 1] = 1;
+	device->reg[JAMC_SIM_REG_ADDRESS][107] = 1;
+	row[0] = jam_sim_find_row(device, JAMC_SIM_REG_DATA, TRUE);
+	row[1] = jam_sim_find_row(device,
+		JAMC_SIM_REG_DATA + JAMC_SIM_DATA_HALF, TRUE);
+	memset(device->reg[JAMC_SIM_REG_ADDRESS], 0, (size_t) address_length);
+
+	for (j = 0; (j < 15) && (row[0] != NULL) && (row[1] != NULL); ++j)
+	{
+		group = (j % (2 * pairs)) >> 1;
+		half = 0;
+		if (group >= (pairs >> 1))
+		{
+			half = 1;
+			group = pairs - group - 1;
+		}
+		offset = ((2 * (j / (2 * pairs)) + half) * width) +
+			(16 * group) + (8 * (~j & 1));
+
+		for (i = 0; i < 8; ++i)
+		{
+			index = offset + i;
+			pass = index / (2 * width);
+			half = (index / width) & 1;
+			row[half]->data[(5 * (index % width)) + 4 - pass] =
+				(unsigned char) ((id[j] >> i) & 1);
+		}
+	}
+
+	if (row[0] != NULL) row[0]->factory = TRUE;
+	if (row[1] != NULL) row[1]->factory = TRUE;
+}
+
+void jam_sim_max9000_silicon_id(JAMS_SIM_DEVICE *device)
+{
+	/*
+	*	The silicon ID is read from register 02E with the address register
+	*	cleared.  Every third bit is used, and some bits are skipped.
+	*/
+	static int offsets[15] =
+		{ 0, 8, 16, 24, 32, 40, 48, 56, 64, 69, 72, 75, 80, 83, 88 };
+	static int widths[15] =
+		{ 8, 8, 8, 8, 8, 8, 8, 8, 5, 3, 3, 5, 3, 5, 1 };
+	JAMS_SIM_ROW *row = NULL;
+	unsigned char id[15];
+	int bit = 0;
+	int i = 0;
+	int j = 0;
+
+	memset(id, 0, sizeof(id));
+	memcpy(id, device->part->silicon_id, 8);
+	id[8] = (unsigned char) device->part->revision;
+
+	row = jam_sim_find_row(device, JAMC_SIM_REG_AUX3, TRUE);
+
+	for (j = 0; (j < 15) && (row != NULL); ++j)
+	{
+		for (i = 0; i < widths[j]; ++i)
+		{
+			/* EPM9320 bit layout */
+			bit = offsets[j] + i;
+			if (bit >= 83) bit += 3;
+			else if (bit >= 57) bit += 1;
+
+			row->data[3 * bit] =
+				(unsigned char) ((id[j] >> (widths[j] - 1 - i)) & 1);
+		}
+	}
+
+	if (row != NULL) row->factory = TRUE;
+}
+
+/****************************************************************************/
+/*																			*/
+/*	Lattice ispLSI ISP														*/
+/*																			*/
+/****************************************************************************/
+
+void jam_sim_isplsi_instruction(JAMS_SIM_DEVICE *device)
+{
+	int high = JAMC_SIM_REG_DATA;
+	int low = JAMC_SIM_REG_DATA + JAMC_SIM_DATA_HALF;
+
+	switch ((int) device->ir)
+	{
+	case 1:		/* ADDSHFT */
+		device->selected = JAMC_SIM_REG_ADDRESS;
+		break;
+
+	case 2:		/* DATSHFT */
+		device->selected = JAMC_SIM_REG_DATA;
+		break;
+
+	case 3:		/* UBLKERS */
+	case 16:	/* ERALL */
+		jam_sim_erase_rows(device, TRUE);
+		break;
+
+	case 7:		/* PRGMHIGH */
+		jam_sim_program_row(device, high, JAMC_SIM_REG_DATA);
+		break;
+
+	case 8:		/* PRGMLOW */
+		jam_sim_program_row(device, low, JAMC_SIM_REG_DATA);
+		break;
+
+	case 10:	/* VRFLDHIP */
+	case 18:	/* VRFLDHIE */
+		jam_sim_load_row(device, high, JAMC_SIM_REG_DATA);
+		break;
+
+	case 11:	/* VRFLDLOP */
+	case 19:	/* VRFLDLOE */
+		jam_sim_load_row(device, low, JAMC_SIM_REG_DATA);
+		break;
+
+	default:
+		break;
+	}
+}
+
+/****************************************************************************/
+/*																			*/
+/*	Device registers														*/
+/*																			*/
+/****************************************************************************/
+
+void jam_sim_instruction(JAMS_SIM_DEVICE *device)
+{
+	unsigned long bypass = (1UL << device->ir_length) - 1UL;
+
+	device->selected = JAMC_SIM_REG_BYPASS;
+	device->broadcast = FALSE;
+
+	if (device->ir == bypass)
+	{
+		return;
+	}
+
+	if (device->part->family == JAM_SIM_GENERIC)
+	{
+		/* any instruction other than BYPASS selects the IDCODE */
+		if (device->idcode != 0L) device->selected = JAMC_SIM_REG_IDCODE;
+	}
+	else if ((device->idcode != 0L) &&
+		(device->ir == device->part->idcode_opcode))
+	{
+		device->selected = JAMC_SIM_REG_IDCODE;
+	}
+	else if (device->part->family == JAM_SIM_ISPLSI)
+	{
+		jam_sim_isplsi_instruction(device);
+	}
+	else
+	{
+		jam_sim_altera_instruction(device);
+	}
+
+	/* registers the part does not have act as BYPASS */
+	if (device->reg_length[device->selected] == 0)
+	{
+		device->selected = JAMC_SIM_REG_BYPASS;
+		device->broadcast = FALSE;
+	}
+}
+
+void jam_sim_reset(JAMS_SIM_DEVICE *device)
+{
+	unsigned long bypass = (1UL << device->ir_length) - 1UL;
+
+	device->ir = bypass;
+	if (device->idcode != 0L)
+	{
+		device->ir = (device->part->family == JAM_SIM_GENERIC) ?
+			0L : device->part->idcode_opcode;
+	}
+
+	device->pulse = JAMC_SIM_PULSE_OFF;
+	jam_sim_instruction(device);
+}
+
+void jam_sim_capture(JAMS_SIM_DEVICE *device)
+{
+	int i = 0;
+
+	switch (device->selected)
+	{
+	case JAMC_SIM_REG_BYPASS:
+		device->reg[JAMC_SIM_REG_BYPASS][0] = 0;
+		break;
+
+	case JAMC_SIM_REG_IDCODE:
+		for (i = 0; i < 32; ++i)
+		{
+			device->reg[JAMC_SIM_REG_IDCODE][i] =
+				(unsigned char) ((device->idcode >> i) & 1L);
+		}
+		break;
+
+	case JAMC_SIM_REG_READ:
+		jam_sim_altera_read(device);
+		break;
+
+	default:
+		/* MAX9000 auxiliary registers capture their row */
+		if (device->selected >= JAMC_SIM_REG_AUX)
+		{
+			jam_sim_load_row(device, device->selected, device->selected);
+		}
+
+		/* address and data registers keep their content */
+		break;
+	}
+}
+
+void jam_sim_update(JAMS_SIM_DEVICE *device)
+{
+	int first = device->selected;
+	int i = 0;
+
+	device->reg_dirty[device->selected] = TRUE;
+
+	if (device->broadcast)
+	{
+		for (i = 1; i < device->part->data_count; ++i)
+		{
+			memcpy(device->reg[first + i], device->reg[first],
+				(size_t) device->reg_length[first]);
+			device->reg_dirty[first + i] = TRUE;
+		}
+	}
+}
+
+int jam_sim_shift_dr(JAMS_SIM_DEVICE *device, int tdi)
+{
+	unsigned char *reg = device->reg[device->selected];
+	int length = device->reg_length[device->selected];
+	int tdo = reg[0];
+
+	memmove(reg, reg + 1, (size_t) (length - 1));
+	reg[length - 1] = (unsigned char) tdi;
+
+	return (tdo);
+}
+
+int jam_sim_shift_ir(JAMS_SIM_DEVICE *device, int tdi)
+{
+	int tdo = (int) (device->ir_shift & 1L);
+
+	device->ir_shift = (device->ir_shift >> 1) |
+		((unsigned long) tdi << (device->ir_length - 1));
+
+	return (tdo);
+}
+
+/****************************************************************************/
+/*																			*/
+/*	Chain setup																*/
+/*																			*/
+/****************************************************************************/
+
+int jam_sim_add_register(JAMS_SIM_DEVICE *device, int reg, int length)
+{
+	device->reg_length[reg] = length;
+	device->reg[reg] = (unsigned char *) jam_malloc((unsigned int) length);
+
+	if (device->reg[reg] == NULL)
+	{
+		device->reg_length[reg] = 0;
+		return (-1);
+	}
+
+	memset(device->reg[reg], 0, (size_t) length);
+
+	return (0);
+}
+
+int jam_sim_add_device(char *spec)
+{
+	JAMS_SIM_DEVICE *device = NULL;
+	JAMS_SIM_PART *part = NULL;
+	JAMS_SIM_PART *p = NULL;
+	char *arg = strchr(spec, ':');
+	char *end = NULL;
+	size_t name_length = (arg != NULL) ? (size_t) (arg - spec) : strlen(spec);
+	int status = 0;
+	int i = 0;
+
+	for (p = jam_sim_parts; p < &jam_sim_parts[JAMC_SIM_PART_COUNT]; ++p)
+	{
+		if ((strlen(p->name) == name_length) &&
+			(strncmp(spec, p->name, name_length) == 0))
+		{
+			part = p;
+		}
+	}
+
+	if ((part == NULL) || (jam_sim_device_count >= JAMC_SIM_MAX_DEVICES))
+	{
+		fprintf(stderr, "Error:  unknown simulated device \"%s\"\n", spec);
+		return (-1);
+	}
+
+	device = &jam_sim_devices[jam_sim_device_count];
+	memset(device, 0, sizeof(JAMS_SIM_DEVICE));
+	device->part = part;
+	device->ir_length = part->ir_length;
+	device->idcode = part->idcode;
+
+	/* generic devices take an IDCODE and an IR length */
+	if ((part->family == JAM_SIM_GENERIC) && (arg != NULL))
+	{
+		if (strcmp(part->name, "idcode") == 0)
+		{
+			device->idcode = strtoul(arg + 1, &end, 16);
+			arg = (*end == ':') ? end : NULL;
+		}
+
+		if (arg != NULL) device->ir_length = (int) strtol(arg + 1, &end, 10);
+	}
+
+	if ((device->ir_length < 2) || (device->ir_length > 31) ||
+		((strcmp(part->name, "idcode") == 0) && !(device->idcode & 1L)))
+	{
+		fprintf(stderr, "Error:  bad simulated device \"%s\"\n", spec);
+		return (-1);
+	}
+
+	++jam_sim_device_count;
+
+	status |= jam_sim_add_register(device, JAMC_SIM_REG_BYPASS, 1);
+	status |= jam_sim_add_register(device, JAMC_SIM_REG_IDCODE, 32);
+
+	if (part->family != JAM_SIM_GENERIC)
+	{
+		status |= jam_sim_add_register(device, JAMC_SIM_REG_ADDRESS,
+			part->address_length);
+		for (i = 0; i < part->data_count; ++i)
+		{
+			status |= jam_sim_add_register(device, JAMC_SIM_REG_DATA + i,
+				part->data_length);
+			status |= jam_sim_add_register(device,
+				JAMC_SIM_REG_DATA + JAMC_SIM_DATA_HALF + i, part->data_length);
+		}
+		status |= jam_sim_add_register(device, JAMC_SIM_REG_READ,
+			part->data_length / 5);
+	}
+
+	for (i = 0; i < part->aux_count; ++i)
+	{
+		status |= jam_sim_add_register(device, JAMC_SIM_REG_AUX + i,
+			part->aux_length[0]);
+	}
+
+	if (part->aux_length[1] > 0)
+	{
+		status |= jam_sim_add_register(device, JAMC_SIM_REG_AUX2,
+			part->aux_length[1]);
+		status |= jam_sim_add_register(device, JAMC_SIM_REG_AUX3,
+			part->aux_length[2]);
+	}
+
+	if (status != 0)
+	{
+		fprintf(stderr, "Error:  out of memory for simulated chain\n");
+		return (-1);
+	}
+
+	if (part->family == JAM_SIM_MAX7000S) jam_sim_max7000s_silicon_id(device);
+	if (part->family == JAM_SIM_MAX9000) jam_sim_max9000_silicon_id(device);
+
+	jam_sim_reset(device);
+
+	return (0);
+}
+
+/****************************************************************************/
+/*																			*/
+/*	Simulator transport														*/
+/*																			*/
+/****************************************************************************/
+
+void jam_sim_close(void);
+
+int jam_sim_open(char *device_path)
+{
+	char spec[64];
+	char *next = device_path;
+	size_t length = 0;
+	int status = 0;
+
+	jam_sim_device_count = 0;
+	jam_sim_state = RESET;
+	jam_sim_clocks = 0L;
+
+	if (device_path == NULL)
+	{
+		fprintf(stderr, "Error:  the simulated chain must be given with -j\n");
+		return (-1);
+	}
+
+	while ((status == 0) && (next != NULL) && (*next != '\0'))
+	{
+		length = strcspn(next, ",");
+		if (length >= sizeof(spec)) length = sizeof(spec) - 1;
+		memcpy(spec, next, length);
+		spec[length] = '\0';
+
+		status = jam_sim_add_device(spec);
+
+		next = strchr(next, ',');
+		if (next != NULL) ++next;
+	}
+
+	if ((status == 0) && (jam_sim_device_count == 0))
+	{
+		fprintf(stderr, "Error:  the simulated chain is empty\n");
+		status = -1;
+	}
+
+	if (status != 0) jam_sim_close();
+
+	return (status);
+}
+
+void jam_sim_close(void)
+{
+	JAMS_SIM_DEVICE *device = NULL;
+	JAMS_SIM_ROW *row = NULL;
+	int i = 0;
+
+	if (jam_sim_clocks > 0L)
+	{
+		fprintf(stderr, "%sSimulated %lu TCK clocks\n",
+			chain_prefix, jam_sim_clocks);
+	}
+
+	for (device = jam_sim_devices;
+		device < &jam_sim_devices[jam_sim_device_count]; ++device)
+	{
+		while ((row = device->rows) != NULL)
+		{
+			device->rows = row->next;
+			jam_free(row->address);
+			jam_free(row->data);
+			jam_free(row);
+		}
+
+		for (i = 0; i < JAMC_SIM_MAX_REGISTERS; ++i)
+		{
+			if (device->reg[i] != NULL) jam_free(device->reg[i]);
+			device->reg[i] = NULL;
+		}
+	}
+
+	jam_sim_device_count = 0;
+}
+
+int jam_sim_clock(int tms, int tdi, int read_tdo)
+{
+	JAME_JTAG_STATE next = RESET;
+	int bit = (tdi != 0) ? 1 : 0;
+	int tdo = 0;
+	int i = 0;
+
+	read_tdo = read_tdo;
+	++jam_sim_clocks;
+
+	if (jam_sim_state == DRSHIFT)
+	{
+		for (i = 0; i < jam_sim_device_count; ++i)
+		{
+			bit = jam_sim_shift_dr(&jam_sim_devices[i], bit);
+		}
+		tdo = bit;
+	}
+	else if (jam_sim_state == IRSHIFT)
+	{
+		for (i = 0; i < jam_sim_device_count; ++i)
+		{
+			bit = jam_sim_shift_ir(&jam_sim_devices[i], bit);
+		}
+		tdo = bit;
+	}
+
+	next = tms ? jam_sim_state_transitions[jam_sim_state].tms_high :
+		jam_sim_state_transitions[jam_sim_state].tms_low;
+
+	if (next != jam_sim_state)
+	{
+		jam_sim_state = next;
+
+		for (i = 0; i < jam_sim_device_count; ++i)
+		{
+			switch (jam_sim_state)
+			{
+			case RESET:
+				jam_sim_reset(&jam_sim_devices[i]);
+				break;
+
+			case DRCAPTURE:
+				jam_sim_capture(&jam_sim_devices[i]);
+				break;
+
+			case DRUPDATE:
+				jam_sim_update(&jam_sim_devices[i]);
+				break;
+
+			case IRCAPTURE:
+				jam_sim_devices[i].ir_shift = 1L;
+				break;
+
+			case IRUPDATE:
+				jam_sim_devices[i].ir = jam_sim_devices[i].ir_shift;
+				jam_sim_instruction(&jam_sim_devices[i]);
+				break;
+
+			default:
+				break;
+			}
+		}
+	}
+
+	return (tdo);
+}
+
+int jam_sim_tms_sequence(int count, int tms_bits)
+{
+	int i = 0;
+
+	for (i = 0; i < count; ++i)
+	{
+		jam_sim_clock((tms_bits >> i) & 1, 0, 0);
+	}
+
+	return (0);
+}
+
+int jam_sim_shift(int count, char *tdi, char *tdo)
+{
+	int i = 0;
+	int tdo_bit = 0;
+
+	for (i = 0; i < count; ++i)
+	{
+		tdo_bit = jam_sim_clock((i == count - 1),
+			tdi[i >> 3] & (1 << (i & 7)), (tdo != NULL));
+
+		if (tdo != NULL)
+		{
+			if (tdo_bit)
+			{
+				tdo[i >> 3] |= (1 << (i & 7));
+			}
+			else
+			{
+				tdo[i >> 3] &= ~(unsigned int) (1 << (i & 7));
+			}
+		}
+	}
+
+	return (0);
+}
+
+int jam_sim_idle(int tms, long cycles)
+{
+	long count = 0L;
+
+	/* once the TAP has settled in a stable state the clocks change nothing */
+	for (count = 0L; count < cycles; ++count)
+	{
+		if ((jam_sim_state_transitions[jam_sim_state].tms_high ==
+				jam_sim_state) && tms)
+		{
+			break;
+		}
+
+		if ((jam_sim_state_transitions[jam_sim_state].tms_low ==
+				jam_sim_state) && !tms && (jam_sim_state != DRSHIFT) &&
+			(jam_sim_state != IRSHIFT))
+		{
+			break;
+		}
+
+		jam_sim_clock(tms, 0, 0);
+	}
+
+	jam_sim_clocks += (unsigned long) (cycles - count);
+
+	return (0);
+}
+
+int jam_sim_delay(long microseconds)
+{
+	microseconds = microseconds;
+
+	return (0);
+}
+
+JAMS_TRANSPORT jam_sim_transport =
+{
+	"sim",
+	"simulated chain, -j lists the devices (e.g. epm7064s)",
+	jam_sim_open,
+	jam_sim_close,
+	jam_sim_clock,
+	jam_sim_tms_sequence,
+	jam_sim_shift,
+	jam_sim_idle,
+	NULL,
+	NULL,
+	NULL,
+	jam_sim_delay
+};
@@ -15,8 +15,9 @@
 #include "jamutil.h"
 #include "jamsym.h"
 #include "jamstack.h"
-
-JAMS_STACK_RECORD *jam_stack = 0;
+#include "jamheap.h"
+#include "jamjtag.h"
+#include "jamctx.h"
 
 /****************************************************************************/
 /*																			*/
@@ -43,14 +43,6 @@ typedef struct
 
 } JAMS_STACK_RECORD;
 
-/****************************************************************************/
-/*																			*/
-/*	Global variables														*/
-/*																			*/
-/****************************************************************************/
-
-extern JAMS_STACK_RECORD *jam_stack;
-
 /****************************************************************************/
 /*																			*/
 /*	Function prototypes														*/
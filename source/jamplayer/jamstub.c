@@ -121,25 +121,233 @@ extern unsigned int _stklen = 50000;
 #include <stdlib.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/time.h>
 #include "jtag.h"
+#include "jamtrans.h"
+#include "jamcache.h"
+
+/* JTAG transport backed by the OpenBMC JTAG driver */
+int aspeed_open(char *device_path);
+void aspeed_close(void);
+int aspeed_clock(int tms, int tdi, int read_tdo);
+int aspeed_tms_sequence(int count, int tms_bits);
+int aspeed_shift(int count, char *tdi, char *tdo);
+int aspeed_idle(int tms, long cycles);
+int aspeed_scan(int ir_scan, int start_state, int end_state,
+	int count, char *tdi, char *tdo);
+int aspeed_frequency(long hertz);
+void flush_bitbang(void);
+
+JAMS_TRANSPORT aspeed_transport =
+{
+	"aspeed",
+	"OpenBMC JTAG driver, needs -j (default)",
+	aspeed_open,
+	aspeed_close,
+	aspeed_clock,
+	aspeed_tms_sequence,
+	aspeed_shift,
+	aspeed_idle,
+	aspeed_scan,
+	aspeed_frequency,
+	flush_bitbang,
+	NULL
+};
+
+/* transports that can be selected with -t */
+JAMS_TRANSPORT *transport_list[] =
+{
+	&aspeed_transport,
+	&jam_null_transport,
+	&jam_loopback_transport,
+	&jam_sim_transport
+};
+
+#define TRANSPORT_COUNT \
+	((int) (sizeof(transport_list) / sizeof(transport_list[0])))
+
+/* number of JTAG chains that can be programmed at once */
+#define JAMC_MAX_CHAINS 16
+
+/* number of threads that can decode array data in the background */
+#define MAX_DECODE_THREADS 16
+
+/* default size limit of the directory of cache files given with -k */
+#define DEFAULT_CACHE_KBYTES 65536L
+
+JAMS_TRANSPORT *transport = &aspeed_transport;
+JAM_THREAD BOOL transport_open = FALSE;
+
 void printHelp()
 {
-       printf("Usage: jam [-h] [-v] [-d<var=val>] [-m<memsize>] [-j<jtagdevfile>] [-s <sleep_in_us_between_each_jtag_clock>]  <filename>\n");
+       int i = 0;
+
+       printf("Usage: jam [-h] [-v] [-d<var=val>] [-m<memsize>] [-c<statement_cache_kbytes>] [-l] [-p<decode_threads>] [-k<cache_dir>] [-x<cache_kbytes>] [-j<jtagdevfile> ...] [-t<transport>] [-s <sleep_in_us_between_each_jtag_clock>]  <filename>\n");
+       printf("Repeat -j to program up to %d JTAG chains in parallel.\n", JAMC_MAX_CHAINS);
+       printf("-l keeps only a window of large compressed arrays in memory.\n");
+       printf("-p decodes array data in up to %d background threads.\n", MAX_DECODE_THREADS);
+       printf("-k keeps decoded arrays between runs in a directory, -x limits its size (default %ld Kbytes).\n", DEFAULT_CACHE_KBYTES);
+       printf("Transports:\n");
+       for (i = 0; i < TRANSPORT_COUNT; ++i)
+       {
+               printf("    %-10s: %s\n", transport_list[i]->name,
+                       transport_list[i]->description);
+       }
 }
 
-int device_fd;
-char *device_path;
+/*
+*	Each JTAG chain is driven by its own thread, so the state of the
+*	device and of its queues is kept per thread
+*/
+JAM_THREAD int device_fd = -1;
+JAM_THREAD char *device_path = NULL;
 long sleep_ms = 0;
+JAM_THREAD long default_frequency = 0L;
+
+/* bit-bang requests are queued and submitted to the driver in one packet */
+#define BITBANG_BUFFER_SIZE 4096
+JAM_THREAD struct tck_bitbang bitbang_buffer[BITBANG_BUFFER_SIZE];
+JAM_THREAD int bitbang_count = 0;
+
+/*
+*	Scans whose TDO bits are still in the queue.  The bits are copied
+*	out to the caller's buffer when the queue is flushed.
+*/
+#define BITBANG_READ_COUNT 64
+struct bitbang_read
+{
+	char *tdo;
+	int first_bit;
+	int first_entry;
+	int count;
+};
+JAM_THREAD struct bitbang_read bitbang_reads[BITBANG_READ_COUNT];
+JAM_THREAD int bitbang_read_count = 0;
+
+/* long idle waits are clocked from a packet of identical entries */
+#define IDLE_BUFFER_SIZE 16384
+JAM_THREAD struct tck_bitbang idle_buffer[IDLE_BUFFER_SIZE];
+JAM_THREAD int idle_buffer_tms = -1;
+
+/* cleared if the driver rejects JTAG_IOCXFER, scans are then bit-banged */
+JAM_THREAD BOOL xfer_supported = TRUE;
+BOOL jtag_device_ready(void);
 #endif
 
-/* file buffer for JAM input file */
+/* file buffer for JAM input file, the user data of its interpreter context */
+struct jam_file
+{
 #if PORT == DOS
-char **file_buffer = NULL;
+	char **buffer;
 #else
-char *file_buffer = NULL;
+	char *buffer;
+#endif
+	long pointer;
+	long length;
+};
+
+/* printed before each message, names the chain when several are in use */
+JAM_THREAD char *chain_prefix = "";
+
+#if PORT == OPENBMC_AST
+/*
+*	One JTAG chain programmed by the player.  With several -j options,
+*	every chain runs the program in its own thread and interpreter
+*	context, with its own copy of the file pointer and workspace.
+*/
+struct jam_chain
+{
+	struct jam_file file;
+	char *device_path;
+	char *prefix;
+	char *workspace;
+	JAMS_CONTEXT *context;
+	char *action;
+	char **init_list;
+	int reset_jtag;
+	long workspace_size;
+	JAM_RETURN_TYPE exec_result;
+	long error_line;
+	int exit_code;
+	int format_version;
+	pthread_t thread;
+};
+
+/*
+*	Initialized array data decoded by one chain, or by a decode thread,
+*	for the chains running the same program.  An entry is DECODING until
+*	the thread which created it stores the data, chains wait for it
+*	meanwhile.  Arrays found in the cache file are READY from the start.
+*	The times are shown in verbose mode.
+*/
+#define SHARED_ARRAY_DECODING	0
+#define SHARED_ARRAY_READY		1
+#define SHARED_ARRAY_FAILED		2
+
+struct shared_array
+{
+	struct shared_array *next;
+	long position;
+	long words;
+	long *data;
+	int state;
+	BOOL background;
+	BOOL cached;				/* data is in the mapped cache file */
+	unsigned long decode_begin;
+	unsigned long decode_time;
+	unsigned long wait_time;
+};
+
+struct shared_array *shared_array_list = NULL;
+pthread_mutex_t shared_array_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t shared_array_cond = PTHREAD_COND_INITIALIZER;
+
+long *shared_array_find(long position, long words);
+void shared_array_store(long position, long words, long *data);
+void shared_array_prefetch(JAMS_ARRAY_REQUEST *request);
+
+JAMS_ARRAY_SHARE shared_arrays =
+{
+	shared_array_find,
+	shared_array_store,
+	shared_array_prefetch
+};
+
+/*
+*	Arrays which the program will use, queued by shared_array_prefetch()
+*	for the decode threads.  An array which a chain needs before a decode
+*	thread has started on it is decoded by the chain itself.
+*/
+struct array_job
+{
+	struct array_job *next;
+	JAMS_ARRAY_REQUEST request;
+};
+
+struct array_job *array_job_list = NULL;
+pthread_cond_t array_job_cond = PTHREAD_COND_INITIALIZER;
+BOOL array_jobs_stopped = FALSE;
+int decode_thread_count = 0;
+pthread_t decode_threads[MAX_DECODE_THREADS];
+
+/* decoded arrays and the program index are kept between runs (jamcache.c) */
+char *cache_directory = NULL;
+long cache_limit = DEFAULT_CACHE_KBYTES * 1024L;
+
+/*
+*	The program is mapped into memory when it is a regular file, so its
+*	pages are read by the kernel as jam_getc() reaches them and can be
+*	dropped again under memory pressure.  A pipe, or a file which cannot
+*	be mapped, is read into a buffer instead.
+*/
+#define PROGRAM_READ_SIZE		65536L
+
+BOOL program_mapped = FALSE;
+unsigned long startup_begin = 0UL;			/* from jam_get_microseconds() */
 #endif
-long file_pointer = 0L;
-long file_length = 0L;
 
 /* delay count for one millisecond delay */
 long one_ms_delay = 0L;
@@ -148,7 +356,7 @@ long one_ms_delay = 0L;
 int tck_delay = 0;
 
 /* serial port interface available on all platforms */
-BOOL jtag_hardware_initialized = FALSE;
+JAM_THREAD BOOL jtag_hardware_initialized = FALSE;
 char *serial_port_name = NULL;
 BOOL specified_com_port = FALSE;
 int com_port = -1;
@@ -261,19 +469,21 @@ BOOL verbose = FALSE;
 *	jam_jtag_io()
 *	jam_message()
 *	jam_delay()
+*	jam_get_microseconds()
 */
 
 int jam_getc(void)
 {
+	struct jam_file *file = (struct jam_file *) jam_get_context_data();
 	int ch = EOF;
 
-	if (file_pointer < file_length)
+	if (file->pointer < file->length)
 	{
 #if PORT == DOS
-		ch = (int) file_buffer[file_pointer >> 14L][file_pointer & 0x3fffL];
-		++file_pointer;
+		ch = (int) file->buffer[file->pointer >> 14L][file->pointer & 0x3fffL];
+		++file->pointer;
 #else
-		ch = (int) file_buffer[file_pointer++];
+		ch = (int) file->buffer[file->pointer++];
 #endif
 	}
 
@@ -282,11 +492,12 @@ int jam_getc(void)
 
 int jam_seek(long offset)
 {
+	struct jam_file *file = (struct jam_file *) jam_get_context_data();
 	int return_code = EOF;
 
-	if ((offset >= 0L) && (offset < file_length))
+	if ((offset >= 0L) && (offset < file->length))
 	{
-		file_pointer = offset;
+		file->pointer = offset;
 		return_code = 0;
 	}
 
@@ -368,51 +579,149 @@ int jam_jtag_io(int tms, int tdi, int read_tdo)
 	return (tdo);
 	}
 #elif PORT == OPENBMC_AST
-	struct tck_bitbang data;
-	struct bitbang_packet bb_packet;
+	if (!jtag_device_ready())
+	{
+		return -1;
+	}
 
-	if (!jtag_hardware_initialized)
+	return (transport->clock(tms, tdi, read_tdo));
+#else
+		/* parallel port interface not available */
+		tdo = 0;
+		return tdo;
+	}
+#endif
+
+}
+
+int jam_jtag_shift(int count, char *tdi, char *tdo)
+{
+	int i = 0;
+	int tdo_bit = 0;
+#if PORT == OPENBMC_AST
+	if (!jtag_device_ready())
 	{
-		initialize_jtag_hardware();
-		if (device_fd <0) {
-			fprintf(stderr, "Error:  Could not find OpenBMC JTAG driver handle\n");
-			return -1;
+		return -1;
+	}
+
+	if ((transport->shift != NULL) && (transport->shift(count, tdi, tdo) == 0))
+	{
+		return (0);
+	}
+#endif
+
+	for (i = 0; i < count; i++)
+	{
+		tdo_bit = jam_jtag_io(
+			(i == count - 1),
+			tdi[i >> 3] & (1 << (i & 7)),
+			(tdo != NULL));
+
+		if (tdo != NULL)
+		{
+			if (tdo_bit)
+			{
+				tdo[i >> 3] |= (1 << (i & 7));
+			}
+			else
+			{
+				tdo[i >> 3] &= ~(unsigned int) (1 << (i & 7));
+			}
 		}
-		jtag_hardware_initialized = TRUE;
 	}
 
+	return (0);
+}
 
-    if (sleep_ms != 0) {
-        usleep(sleep_ms);
-    }
-	data.tdi = 0;
-	if (tdi != 0)
-		data.tdi = 1;
-	data.tms = 0;
-	if (tms != 0)
-		data.tms = 1;
+int jam_jtag_tms_sequence(int count, int tms_bits)
+{
+	int i = 0;
 
-	bb_packet.length = 1;
-	bb_packet.data = &data;
-	if (device_fd >= 0)
-           ioctl(device_fd, JTAG_IOCBITBANG, &bb_packet);
+#if PORT == OPENBMC_AST
+	if (!jtag_device_ready())
+	{
+		return -1;
+	}
 
-	if (read_tdo == 0) {
-           return 0;
+	if ((transport->tms_sequence != NULL) &&
+		(transport->tms_sequence(count, tms_bits) == 0))
+	{
+		return (0);
 	}
-	return data.tdo;
-#else
-		/* parallel port interface not available */
-		tdo = 0;
-		return tdo;
+#endif
+
+	for (i = 0; i < count; ++i)
+	{
+		jam_jtag_io((tms_bits >> i) & 1, 0, 0);
+	}
+
+	return (0);
+}
+
+int jam_jtag_idle_clocks(int tms, long cycles)
+{
+	long count = 0L;
+#if PORT == OPENBMC_AST
+	if (!jtag_device_ready())
+	{
+		return -1;
+	}
+
+	if ((transport->idle != NULL) && (transport->idle(tms, cycles) == 0))
+	{
+		return (0);
+	}
+#endif
+
+	for (count = 0L; count < cycles; ++count)
+	{
+		jam_jtag_io(tms, 0, 0);
 	}
+
+	return (0);
+}
+
+void jam_jtag_flush(void)
+{
+#if PORT == OPENBMC_AST
+	/* deliver TDO data that the transport has not handed back yet */
+	if (transport_open && (transport->flush != NULL)) transport->flush();
 #endif
+}
+
+int jam_jtag_xfer
+(
+	int ir_scan,
+	int start_state,
+	int end_state,
+	int count,
+	char *tdi,
+	char *tdo
+)
+{
+#if PORT == OPENBMC_AST
+	if ((transport->scan == NULL) || (!jtag_device_ready()))
+	{
+		return (-1);
+	}
 
+	return (transport->scan(ir_scan, start_state, end_state, count, tdi, tdo));
+#else
+	/* no scan hardware -- caller must bit-bang the scan */
+	ir_scan = ir_scan;
+	start_state = start_state;
+	end_state = end_state;
+	count = count;
+	tdi = tdi;
+	tdo = tdo;
+
+	return (-1);
+#endif
 }
 
 void jam_message(char *message_text)
 {
-	puts(message_text);
+	printf("%s%s\n", chain_prefix, message_text);
 	fflush(stdout);
 }
 
@@ -420,7 +729,8 @@ void jam_export_integer(char *key, long value)
 {
 	if (verbose)
 	{
-		printf("Export: key = \"%s\", value = %ld\n", key, value);
+		printf("%sExport: key = \"%s\", value = %ld\n",
+			chain_prefix, key, value);
 		fflush(stdout);
 	}
 }
@@ -454,7 +764,8 @@ void jam_export_boolean_array(char *key, unsigned char *data, long count)
 	{
 		if (count > HEX_LINE_BITS)
 		{
-			printf("Export: key = \"%s\", %ld bits, value = HEX\n", key, count);
+			printf("%sExport: key = \"%s\", %ld bits, value = HEX\n",
+				chain_prefix, key, count);
 			lines = (count + (HEX_LINE_BITS - 1)) / HEX_LINE_BITS;
 
 			for (line = 0; line < lines; ++line)
@@ -489,7 +800,7 @@ void jam_export_boolean_array(char *key, unsigned char *data, long count)
 				}
 				if ((k & 3) > 0) string[j] = conv_to_hex(value);
 
-				printf("%s\n", string);
+				printf("%s%s\n", chain_prefix, string);
 			}
 
 			fflush(stdout);
@@ -513,8 +824,8 @@ void jam_export_boolean_array(char *key, unsigned char *data, long count)
 			}
 			if ((i & 3) > 0) string[j] = conv_to_hex(value);
 
-			printf("Export: key = \"%s\", %ld bits, value = HEX %s\n",
-				key, count, string);
+			printf("%sExport: key = \"%s\", %ld bits, value = HEX %s\n",
+				chain_prefix, key, count, string);
 			fflush(stdout);
 		}
 	}
@@ -530,10 +841,33 @@ void jam_delay(long microseconds)
 
 	delay_loop(microseconds *
 		((one_ms_delay / 1000L) + ((one_ms_delay % 1000L) ? 1 : 0)));
+#else
+	/* a simulated chain does not need to wait */
+	if ((transport->delay != NULL) && (transport->delay(microseconds) == 0))
+	{
+		return;
+	}
+
+	/* flush queued clocks so the delay starts after they have run */
+	if (transport_open && (transport->flush != NULL)) transport->flush();
 #endif
 	usleep(microseconds);
 }
 
+unsigned long jam_get_microseconds(void)
+{
+#if PORT == OPENBMC_AST || PORT == UNIX
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return ((unsigned long) now.tv_sec * 1000000UL +
+		(unsigned long) (now.tv_nsec / 1000L));
+#else
+	return ((unsigned long) ((double) clock() * 1000000.0 / CLOCKS_PER_SEC));
+#endif
+}
+
 int jam_vector_map
 (
 	int signal_count,
@@ -738,6 +1072,13 @@ int jam_set_frequency(long hertz)
 		tck_delay = (one_ms_delay * 1000) / hertz;
 	}
 
+#if PORT == OPENBMC_AST
+	if ((transport->frequency != NULL) && jtag_device_ready())
+	{
+		transport->frequency(hertz);
+	}
+#endif
+
 	return (0);
 }
 
@@ -999,85 +1340,727 @@ char *error_text[] =
 
 #define MAX_ERROR_CODE (int)((sizeof(error_text)/sizeof(error_text[0]))+1)
 
-/************************************************************************/
-
-int main(int argc, char **argv)
+/************************************************************************
+*
+*	report_result() -- Print the outcome of jam_execute()
+*
+*	The prefix names the chain when several chains are programmed.
+*	Returns the exit status of the player for this result.
+*/
+int report_result
+(
+	char *prefix,
+	JAM_RETURN_TYPE exec_result,
+	long error_line,
+	int exit_code,
+	int format_version,
+	char *action
+)
 {
-	BOOL help = FALSE;
-	char *filename = NULL;
-	long offset = 0L;
-	long error_line = 0L;
-	JAM_RETURN_TYPE crc_result = JAMC_SUCCESS;
-	JAM_RETURN_TYPE exec_result = JAMC_SUCCESS;
-	unsigned short expected_crc = 0;
-	unsigned short actual_crc = 0;
-	char key[33] = {0};
-	char value[257] = {0};
-	int exit_status = 0;
-#if PORT!=OPENBMC_AST
-	BOOL error = FALSE;
-	int arg = 0;
-#endif
-	int exit_code = 0;
-	int format_version = 0;
-	time_t start_time = 0;
-	time_t end_time = 0;
-	int time_delta = 0;
-	char *workspace = NULL;
-	char *action = NULL;
-	char *init_list[10];
-	int init_count = 0;
-	FILE *fp = NULL;
-	struct stat sbuf;
-	long workspace_size = 0;
+	int exit_status = -1;
 	char *exit_string = NULL;
-	int reset_jtag = 1;
-	int c = 0;
-	verbose = FALSE;
-
-	init_list[0] = NULL;
 
-	/* print out the version string and copyright message */
-	fprintf(stderr, "Jam STAPL Player Version 2.5 (20040526)\nCopyright (C) 1997-2004 Altera Corporation\n\n");
-#if PORT!=OPENBMC_AST
-	for (arg = 1; arg < argc; arg++)
+	if (exec_result == JAMC_SUCCESS)
 	{
-#if PORT == UNIX
-		if (argv[arg][0] == '-')
-#else
-		if ((argv[arg][0] == '-') || (argv[arg][0] == '/'))
-#endif
+		exit_status = 0;
+		if (format_version == 2)
 		{
-			switch(toupper(argv[arg][1]))
+			switch (exit_code)
 			{
-			case 'A':				/* set action name */
-				action = &argv[arg][2];
-				if (action[0] == '"') ++action;
-				break;
+			case  0: exit_string = "Success"; break;
+			case  1: exit_string = "Checking chain failure"; break;
+			case  2: exit_string = "Reading IDCODE failure"; break;
+			case  3: exit_string = "Reading USERCODE failure"; break;
+			case  4: exit_string = "Reading UESCODE failure"; break;
+			case  5: exit_string = "Entering ISP failure"; break;
+			case  6: exit_string = "Unrecognized device"; break;
+			case  7: exit_string = "Device revision is not supported"; break;
+			case  8: exit_string = "Erase failure"; break;
+			case  9: exit_string = "Device is not blank"; break;
+			case 10: exit_string = "Device programming failure"; break;
+			case 11: exit_string = "Device verify failure"; break;
+			case 12: exit_string = "Read failure"; break;
+			case 13: exit_string = "Calculating checksum failure"; break;
+			case 14: exit_string = "Setting security bit failure"; break;
+			case 15: exit_string = "Querying security bit failure"; break;
+			case 16: exit_string = "Exiting ISP failure"; break;
+			case 17: exit_string = "Performing system test failure"; break;
+			default: exit_string = "Unknown exit code"; break;
+			}
+		}
+		else
+		{
+			switch (exit_code)
+			{
+			case 0: exit_string = "Success"; break;
+			case 1: exit_string = "Illegal initialization values"; break;
+			case 2: exit_string = "Unrecognized device"; break;
+			case 3: exit_string = "Device revision is not supported"; break;
+			case 4: exit_string = "Device programming failure"; break;
+			case 5: exit_string = "Device is not blank"; break;
+			case 6: exit_string = "Device verify failure"; break;
+			case 7: exit_string = "SRAM configuration failure"; break;
+			default: exit_string = "Unknown exit code"; break;
+			}
+		}
+		if (exit_code != 0)
+			exit_status = exit_code;
+		printf("%sExit code = %d... %s\n", prefix, exit_code, exit_string);
+	}
+	else if ((format_version == 2) &&
+		(exec_result == JAMC_ACTION_NOT_FOUND))
+	{
+		if ((action == NULL) || (*action == '\0'))
+		{
+			printf("%sError: no action specified for Jam file.\nProgram terminated.\n", prefix);
+		}
+		else
+		{
+			printf("%sError: action \"%s\" is not supported for this Jam file.\nProgram terminated.\n", prefix, action);
+		}
+	}
+	else if (exec_result < MAX_ERROR_CODE)
+	{
+		printf("%sError on line %ld: %s.\nProgram terminated.\n",
+			prefix, error_line, error_text[exec_result]);
+	}
+	else
+	{
+		printf("%sUnknown error code %d\n", prefix, exec_result);
+	}
 
-#if PORT == WINDOWS || PORT == DOS
-			case 'C':				/* Use alternative ISP download cable */
-				if(toupper(argv[arg][2]) == 'L')
-					alternative_cable_l = TRUE;
-				else if(toupper(argv[arg][2]) == 'X')
-					alternative_cable_x = TRUE;
-				break;
-#endif
+	return (exit_status);
+}
 
-			case 'D':				/* initialization list */
-				if (argv[arg][2] == '"')
-				{
-					init_list[init_count] = &argv[arg][3];
-				}
-				else
-				{
-					init_list[init_count] = &argv[arg][2];
-				}
-				init_list[++init_count] = NULL;
-				break;
+#if PORT == OPENBMC_AST
+/************************************************************************
+*
+*	shared_array_lookup() -- Find the entry of an array
+*
+*	The caller holds shared_array_mutex.
+*/
+struct shared_array *shared_array_lookup(long position, long words)
+{
+	struct shared_array *entry = NULL;
 
-#if PORT == WINDOWS || PORT == DOS
-			case 'P':				/* set LPT port address */
+	for (entry = shared_array_list; entry != NULL; entry = entry->next)
+	{
+		if ((entry->position == position) && (entry->words == words)) break;
+	}
+
+	return (entry);
+}
+
+/************************************************************************
+*
+*	shared_array_add() -- Add an entry for an array about to be decoded
+*
+*	The caller holds shared_array_mutex.  Entries are kept in the order
+*	they are added.  Returns NULL if there is not enough memory.
+*/
+struct shared_array *shared_array_add(long position, long words,
+	BOOL background)
+{
+	struct shared_array *entry = NULL;
+	struct shared_array **last = &shared_array_list;
+
+	entry = (struct shared_array *) jam_malloc(sizeof(struct shared_array));
+
+	if (entry != NULL)
+	{
+		entry->position = position;
+		entry->words = words;
+		entry->data = NULL;
+		entry->state = SHARED_ARRAY_DECODING;
+		entry->background = background;
+		entry->cached = FALSE;
+		entry->decode_begin = jam_get_microseconds();
+		entry->decode_time = 0L;
+		entry->wait_time = 0L;
+		entry->next = NULL;
+
+		while (*last != NULL) last = &(*last)->next;
+		*last = entry;
+	}
+
+	return (entry);
+}
+
+/************************************************************************
+*
+*	shared_array_find() -- Look up array data decoded by another chain
+*
+*	Returns NULL if the caller is to decode the data itself, in which
+*	case it must pass the result to shared_array_store().  Waits if
+*	another chain is decoding the same array.
+*/
+long *shared_array_find(long position, long words)
+{
+	struct shared_array *entry = NULL;
+	long *data = NULL;
+	unsigned long wait_begin = 0L;
+
+	pthread_mutex_lock(&shared_array_mutex);
+
+	entry = shared_array_lookup(position, words);
+
+	if (entry == NULL)
+	{
+		shared_array_add(position, words, FALSE);
+	}
+	else
+	{
+		if (entry->state == SHARED_ARRAY_DECODING)
+		{
+			wait_begin = jam_get_microseconds();
+
+			while (entry->state == SHARED_ARRAY_DECODING)
+			{
+				pthread_cond_wait(&shared_array_cond, &shared_array_mutex);
+			}
+
+			entry->wait_time += jam_get_microseconds() - wait_begin;
+		}
+
+		if (entry->state == SHARED_ARRAY_READY)
+		{
+			data = entry->data;
+		}
+		else
+		{
+			/* the other thread failed, so this one tries again */
+			entry->state = SHARED_ARRAY_DECODING;
+			entry->background = FALSE;
+			entry->decode_begin = jam_get_microseconds();
+		}
+	}
+
+	pthread_mutex_unlock(&shared_array_mutex);
+
+	return (data);
+}
+
+/************************************************************************
+*
+*	shared_array_store() -- Keep array data decoded by this chain
+*
+*	Data is NULL if decoding failed.  Wakes the chains waiting for it.
+*/
+void shared_array_store(long position, long words, long *data)
+{
+	struct shared_array *entry = NULL;
+	long i = 0L;
+
+	pthread_mutex_lock(&shared_array_mutex);
+
+	entry = shared_array_lookup(position, words);
+
+	if ((entry != NULL) && (entry->state != SHARED_ARRAY_READY))
+	{
+		entry->state = SHARED_ARRAY_FAILED;
+		entry->decode_time = jam_get_microseconds() - entry->decode_begin;
+
+		if (data != NULL)
+		{
+			entry->data = (long *) jam_malloc(
+				(unsigned int) (words * (long) sizeof(long)));
+
+			if (entry->data != NULL)
+			{
+				for (i = 0L; i < words; ++i) entry->data[i] = data[i];
+				entry->state = SHARED_ARRAY_READY;
+			}
+		}
+
+		pthread_cond_broadcast(&shared_array_cond);
+	}
+
+	pthread_mutex_unlock(&shared_array_mutex);
+}
+
+/************************************************************************
+*
+*	shared_array_prefetch() -- Queue an array for the decode threads
+*/
+void shared_array_prefetch(JAMS_ARRAY_REQUEST *request)
+{
+	struct array_job *job = NULL;
+	struct array_job **last = &array_job_list;
+
+	job = (struct array_job *) jam_malloc(sizeof(struct array_job));
+
+	if (job != NULL)
+	{
+		job->next = NULL;
+		job->request = *request;
+
+		pthread_mutex_lock(&shared_array_mutex);
+
+		while (*last != NULL) last = &(*last)->next;
+		*last = job;
+
+		pthread_cond_signal(&array_job_cond);
+		pthread_mutex_unlock(&shared_array_mutex);
+	}
+}
+
+/************************************************************************
+*
+*	decode_thread() -- Thread function of a decode thread
+*
+*	Decodes the queued arrays which no chain has started to decode, with
+*	an interpreter context of its own to read the program.  Stops when
+*	array_jobs_stopped is set; arrays still queued are then not needed.
+*/
+void *decode_thread(void *arg)
+{
+	struct jam_file file = *(struct jam_file *) arg;
+	struct array_job *job = NULL;
+	JAMS_CONTEXT *context = jam_create_context(&file);
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+	BOOL claimed = FALSE;
+	long *data = NULL;
+
+	file.pointer = 0L;
+
+	while (context != NULL)
+	{
+		pthread_mutex_lock(&shared_array_mutex);
+
+		while (!array_jobs_stopped && (array_job_list == NULL))
+		{
+			pthread_cond_wait(&array_job_cond, &shared_array_mutex);
+		}
+
+		job = NULL;
+		claimed = FALSE;
+
+		if (!array_jobs_stopped)
+		{
+			job = array_job_list;
+			array_job_list = job->next;
+
+			if (shared_array_lookup(job->request.position,
+				job->request.words) == NULL)
+			{
+				claimed = (shared_array_add(job->request.position,
+					job->request.words, TRUE) != NULL);
+			}
+		}
+
+		pthread_mutex_unlock(&shared_array_mutex);
+
+		if (job == NULL) break;
+
+		if (claimed)
+		{
+			data = (long *) jam_malloc((unsigned int)
+				(job->request.words * (long) sizeof(long)));
+
+			status = (data == NULL) ? JAMC_OUT_OF_MEMORY :
+				jam_decode_array(context, &job->request, data);
+
+			shared_array_store(job->request.position, job->request.words,
+				(status == JAMC_SUCCESS) ? data : NULL);
+
+			if (data != NULL) jam_free(data);
+		}
+
+		jam_free(job);
+	}
+
+	if (context != NULL) jam_free_context(context);
+
+	return (NULL);
+}
+
+/************************************************************************
+*
+*	cache_add_array() -- Add an array of the cache file to the shared
+*	array store
+*/
+void cache_add_array(long position, long words, long *data)
+{
+	struct shared_array *entry = NULL;
+
+	if (shared_array_lookup(position, words) == NULL)
+	{
+		entry = shared_array_add(position, words, FALSE);
+
+		if (entry != NULL)
+		{
+			entry->data = data;
+			entry->state = SHARED_ARRAY_READY;
+			entry->cached = TRUE;
+		}
+	}
+}
+
+/************************************************************************
+*
+*	cache_next_array() -- Give the arrays of the shared array store to be
+*	written to the cache file, one at a time
+*/
+long *cache_next_array(void **cursor, long *position, long *words,
+	int *cached)
+{
+	struct shared_array *entry = (*cursor == NULL) ?
+		shared_array_list : ((struct shared_array *) *cursor)->next;
+
+	while ((entry != NULL) && (entry->state != SHARED_ARRAY_READY))
+	{
+		entry = entry->next;
+	}
+
+	*cursor = entry;
+
+	if (entry == NULL) return (NULL);
+
+	*position = entry->position;
+	*words = entry->words;
+	*cached = entry->cached;
+
+	return (entry->data);
+}
+
+/************************************************************************
+*
+*	report_array_times() -- Show how long each shared array took
+*/
+void report_array_times(struct jam_file *file)
+{
+	struct shared_array *entry = NULL;
+	long line = 1L;
+	long i = 0L;
+
+	for (entry = shared_array_list; entry != NULL; entry = entry->next)
+	{
+		line = 1L;
+		for (i = 0L; (i < entry->position) && (i < file->length); ++i)
+		{
+			if (file->buffer[i] == '\n') ++line;
+		}
+
+		if (entry->cached)
+		{
+			printf("Array on line %ld: loaded from cache\n", line);
+		}
+		else
+		{
+			printf("Array on line %ld: decoded in %lu us%s, waited %lu us\n",
+				line, entry->decode_time,
+				entry->background ? " in background" : "",
+				entry->wait_time);
+		}
+	}
+}
+
+/************************************************************************
+*
+*	map_program() -- Give the file access to the program
+*
+*	A regular file is mapped, and the kernel is told that it will be read
+*	from beginning to end first.  Anything else is read to its end with
+*	buffered reads, so the program can come from a pipe.  Returns zero
+*	for success.
+*/
+int map_program(char *filename, struct jam_file *file)
+{
+	struct stat sbuf;
+	char *map = MAP_FAILED;
+	char *buffer = NULL;
+	char *new_buffer = NULL;
+	long size = 0L;
+	long count = 0L;
+	size_t result = 0;
+	FILE *fp = NULL;
+	int fd = -1;
+	int status = 0;
+
+	file->buffer = NULL;
+	file->pointer = 0L;
+	file->length = 0L;
+
+	fd = open(filename, O_RDONLY);
+
+	if (fd < 0)
+	{
+		fprintf(stderr, "Error: can't open file \"%s\"\n", filename);
+		status = 1;
+	}
+	else if ((fstat(fd, &sbuf) == 0) && S_ISREG(sbuf.st_mode) &&
+		(sbuf.st_size > 0))
+	{
+		map = (char *) mmap(NULL, (size_t) sbuf.st_size, PROT_READ,
+			MAP_PRIVATE, fd, 0);
+
+		if (map != MAP_FAILED)
+		{
+			madvise(map, (size_t) sbuf.st_size, MADV_SEQUENTIAL);
+			madvise(map, (size_t) sbuf.st_size, MADV_WILLNEED);
+
+			file->buffer = map;
+			file->length = (long) sbuf.st_size;
+			program_mapped = TRUE;
+		}
+	}
+
+	if ((status == 0) && !program_mapped)
+	{
+		fp = fdopen(fd, "rb");
+
+		if (fp == NULL)
+		{
+			fprintf(stderr, "Error: can't open file \"%s\"\n", filename);
+			status = 1;
+		}
+		else
+		{
+			fd = -1;	/* closed with fp */
+		}
+
+		/* the buffer grows as the file is read */
+		while ((status == 0) && ((buffer == NULL) || (result != 0)))
+		{
+			if (count + PROGRAM_READ_SIZE > size)
+			{
+				size = 2L * size + PROGRAM_READ_SIZE;
+				new_buffer = (char *) jam_malloc((unsigned int) size);
+
+				if (new_buffer == NULL)
+				{
+					fprintf(stderr, "Error: can't allocate memory (%d Kbytes)\n",
+						(int) (size / 1024L));
+					status = 1;
+				}
+				else
+				{
+					if (count > 0L) memcpy(new_buffer, buffer, (size_t) count);
+					if (buffer != NULL) jam_free(buffer);
+					buffer = new_buffer;
+				}
+			}
+
+			if (status == 0)
+			{
+				result = fread(&buffer[count], 1, (size_t) PROGRAM_READ_SIZE, fp);
+				count += (long) result;
+
+				if ((result == 0) && ferror(fp))
+				{
+					fprintf(stderr, "Error reading file \"%s\"\n", filename);
+					status = 1;
+				}
+			}
+		}
+
+		if (status == 0)
+		{
+			file->buffer = buffer;
+			file->length = count;
+		}
+		else if (buffer != NULL)
+		{
+			jam_free(buffer);
+		}
+
+		if (fp != NULL) fclose(fp);
+	}
+
+	if (fd >= 0) close(fd);
+
+	return (status);
+}
+
+/************************************************************************
+*
+*	unmap_program() -- Release the program given by map_program()
+*/
+void unmap_program(struct jam_file *file)
+{
+	if (file->buffer != NULL)
+	{
+		if (program_mapped)
+		{
+			munmap(file->buffer, (size_t) file->length);
+		}
+		else
+		{
+			jam_free(file->buffer);
+		}
+
+		file->buffer = NULL;
+		program_mapped = FALSE;
+	}
+}
+
+/************************************************************************
+*
+*	report_startup() -- Show how the program was read, the time taken
+*	from the start of the player until the program runs, and the memory
+*	of the process then
+*/
+void report_startup(struct jam_file *file)
+{
+	FILE *fp = NULL;
+	long pages = 0L;
+	long resident = 0L;
+	long shared = 0L;
+	long page_kbytes = sysconf(_SC_PAGESIZE) / 1024L;
+
+	printf("Program %s: %ld Kbytes, started in %lu us\n",
+		program_mapped ? "mapped" : "read", (file->length + 1023L) / 1024L,
+		jam_get_microseconds() - startup_begin);
+
+	/* resident set, and the part of it which is file pages */
+	fp = fopen("/proc/self/statm", "r");
+
+	if (fp != NULL)
+	{
+		if (fscanf(fp, "%ld %ld %ld", &pages, &resident, &shared) == 3)
+		{
+			printf("Resident memory: %ld Kbytes (%ld Kbytes shared or file-backed)\n",
+				resident * page_kbytes, shared * page_kbytes);
+		}
+
+		fclose(fp);
+	}
+}
+
+/************************************************************************
+*
+*	run_chain() -- Execute the JAM program on one JTAG chain
+*/
+void run_chain(struct jam_chain *chain)
+{
+	device_path = chain->device_path;
+	chain_prefix = chain->prefix;
+	jam_set_context(chain->context);
+
+	chain->exec_result = jam_execute(
+		chain->file.buffer, chain->file.length,
+		chain->workspace, chain->workspace_size,
+		chain->action, chain->init_list, chain->reset_jtag,
+		&chain->error_line, &chain->exit_code, &chain->format_version);
+}
+
+/************************************************************************
+*
+*	chain_thread() -- Thread function for a chain of a multi-chain run
+*/
+void *chain_thread(void *arg)
+{
+	struct jam_chain *chain = (struct jam_chain *) arg;
+
+	run_chain(chain);
+
+	if (jtag_hardware_initialized) close_jtag_hardware();
+
+	jam_set_context(NULL);
+
+	return (NULL);
+}
+#endif /* PORT == OPENBMC_AST */
+
+/************************************************************************/
+
+int main(int argc, char **argv)
+{
+	BOOL help = FALSE;
+	char *filename = NULL;
+	long offset = 0L;
+	JAM_RETURN_TYPE crc_result = JAMC_SUCCESS;
+	unsigned short expected_crc = 0;
+	unsigned short actual_crc = 0;
+	JAMS_PROGRAM_INFO program_info;
+	char key[33] = {0};
+	char value[257] = {0};
+	int exit_status = 0;
+#if PORT!=OPENBMC_AST
+	BOOL error = FALSE;
+	int arg = 0;
+	long error_line = 0L;
+	JAM_RETURN_TYPE exec_result = JAMC_SUCCESS;
+	int exit_code = 0;
+	int format_version = 0;
+#endif
+	time_t start_time = 0;
+	time_t end_time = 0;
+	int time_delta = 0;
+	char *workspace = NULL;
+	char *action = NULL;
+	char *init_list[10];
+	int init_count = 0;
+#if PORT != OPENBMC_AST
+	FILE *fp = NULL;
+	struct stat sbuf;
+#endif
+	long workspace_size = 0;
+	int reset_jtag = 1;
+	struct jam_file jam_file = { NULL, 0L, 0L };
+	JAMS_CONTEXT *context = NULL;
+	int c = 0;
+#if PORT == OPENBMC_AST
+	int i = 0;
+	int status = 0;
+	char *chain_paths[JAMC_MAX_CHAINS];
+	int chain_count = 0;
+	struct jam_chain chains[JAMC_MAX_CHAINS];
+	struct jam_chain *chain = NULL;
+	BOOL thread_started[JAMC_MAX_CHAINS];
+	BOOL decode_thread_started[MAX_DECODE_THREADS];
+	struct jam_file decode_file = { NULL, 0L, 0L };
+	long code_limit = -1L;
+	BOOL array_cache = FALSE;
+#endif
+	verbose = FALSE;
+
+	init_list[0] = NULL;
+#if PORT == OPENBMC_AST
+	startup_begin = jam_get_microseconds();
+#endif
+
+	/* print out the version string and copyright message */
+	fprintf(stderr, "Jam STAPL Player Version 2.5 (20040526)\nCopyright (C) 1997-2004 Altera Corporation\n\n");
+#if PORT!=OPENBMC_AST
+	for (arg = 1; arg < argc; arg++)
+	{
+#if PORT == UNIX
+		if (argv[arg][0] == '-')
+#else
+		if ((argv[arg][0] == '-') || (argv[arg][0] == '/'))
+#endif
+		{
+			switch(toupper(argv[arg][1]))
+			{
+			case 'A':				/* set action name */
+				action = &argv[arg][2];
+				if (action[0] == '"') ++action;
+				break;
+
+#if PORT == WINDOWS || PORT == DOS
+			case 'C':				/* Use alternative ISP download cable */
+				if(toupper(argv[arg][2]) == 'L')
+					alternative_cable_l = TRUE;
+				else if(toupper(argv[arg][2]) == 'X')
+					alternative_cable_x = TRUE;
+				break;
+#endif
+
+			case 'D':				/* initialization list */
+				if (argv[arg][2] == '"')
+				{
+					init_list[init_count] = &argv[arg][3];
+				}
+				else
+				{
+					init_list[init_count] = &argv[arg][2];
+				}
+				init_list[++init_count] = NULL;
+				break;
+
+#if PORT == WINDOWS || PORT == DOS
+			case 'P':				/* set LPT port address */
 				specified_lpt_port = TRUE;
 				if (sscanf(&argv[arg][2], "%d", &lpt_port) != 1) error = TRUE;
 				if ((lpt_port < 1) || (lpt_port > 3)) error = TRUE;
@@ -1156,7 +2139,7 @@ int main(int argc, char **argv)
 device_path = NULL;
 sleep_ms = 0;
 
-while ((c = getopt(argc, argv, "vm:d:j:ha:s:")) != -1) {
+while ((c = getopt(argc, argv, "vm:d:j:ha:s:t:c:lp:k:x:")) != -1) {
        switch (c) {
                case 'v':
                        verbose = TRUE;
@@ -1175,8 +2158,47 @@ while ((c = getopt(argc, argv, "vm:d:j:ha:s:")) != -1) {
                        init_list[init_count] = optarg;
                        init_list[++init_count] = NULL;
                        break;
+               case 'c':
+                       code_limit = atol(optarg) * 1024L;
+                       break;
+               case 'l':
+                       array_cache = TRUE;
+                       break;
+               case 'p':
+                       decode_thread_count = atoi(optarg);
+                       if (decode_thread_count < 0) decode_thread_count = 0;
+                       if (decode_thread_count > MAX_DECODE_THREADS)
+                               decode_thread_count = MAX_DECODE_THREADS;
+                       break;
+               case 'k':
+                       cache_directory = optarg;
+                       break;
+               case 'x':
+                       cache_limit = atol(optarg) * 1024L;
+                       break;
                case 'j':
-                       device_path = optarg;
+                       if (chain_count == JAMC_MAX_CHAINS)
+                       {
+                               printf ("at most %d JTAG devices may be given\n", JAMC_MAX_CHAINS);
+                               exit (1);
+                       }
+                       chain_paths[chain_count++] = optarg;
+                       break;
+               case 't':
+                       transport = NULL;
+                       for (i = 0; i < TRANSPORT_COUNT; ++i)
+                       {
+                               if (strcmp(optarg, transport_list[i]->name) == 0)
+                               {
+                                       transport = transport_list[i];
+                               }
+                       }
+                       if (transport == NULL)
+                       {
+                               printf ("unknown JTAG transport \"%s\"\n", optarg);
+                               printHelp();
+                               exit (1);
+                       }
                        break;
                case 'h':
                        printHelp();
@@ -1186,11 +2208,28 @@ while ((c = getopt(argc, argv, "vm:d:j:ha:s:")) != -1) {
        }
 }
 
-if (!device_path) {
+if ((chain_count == 0) && (transport == &aspeed_transport)) {
        printf ("ast jtag device path must be present\n");
        exit (1);
 }
 
+/* without -j the transport gets a NULL device path */
+if (chain_count == 0) chain_paths[chain_count++] = NULL;
+
+for (i = 0; i < chain_count; ++i) {
+       chains[i].context = NULL;
+       chains[i].workspace = NULL;
+       chains[i].prefix = NULL;
+}
+
+#if defined(USE_STATIC_MEMORY) || defined(MEM_TRACKER)
+/* the memory functions of this build are not thread-safe */
+if (chain_count > 1) {
+       printf ("only one JTAG device may be given in this build\n");
+       exit (1);
+}
+#endif
+
 if (optind < argc)
        filename = argv[optind];
 
@@ -1236,8 +2275,11 @@ if (optind < argc)
 	}
 	else
 	{
+#if PORT == OPENBMC_AST
+		exit_status = map_program(filename, &jam_file);
+#else
 		/* get length of file */
-		if (stat(filename, &sbuf) == 0) file_length = sbuf.st_size;
+		if (stat(filename, &sbuf) == 0) jam_file.length = sbuf.st_size;
 
 		if ((fp = fopen(filename, "rb")) == NULL)
 		{
@@ -1250,33 +2292,33 @@ if (optind < argc)
 			*	Read entire file into a buffer
 			*/
 #if PORT == DOS
-			int pages = 1 + (int) (file_length >> 14L);
+			int pages = 1 + (int) (jam_file.length >> 14L);
 			int page;
-			file_buffer = (char **) jam_malloc((size_t) (pages * sizeof(char *)));
+			jam_file.buffer = (char **) jam_malloc((size_t) (pages * sizeof(char *)));
 			for (page = 0; page < pages; ++page)
 			{
 				/* allocate enough 16K blocks to store the file */
-				file_buffer[page] = (char *) jam_malloc (0x4000);
-				if (file_buffer[page] == NULL)
+				jam_file.buffer[page] = (char *) jam_malloc (0x4000);
+				if (jam_file.buffer[page] == NULL)
 				{
 					/* flag error and break out of loop */
-					file_buffer = NULL;
+					jam_file.buffer = NULL;
 					page = pages;
 				}
 			}
 #else
-			file_buffer = (char *) jam_malloc((size_t) file_length);
+			jam_file.buffer = (char *) jam_malloc((size_t) jam_file.length);
 #endif
-			if (file_buffer == NULL)
+			if (jam_file.buffer == NULL)
 			{
 				fprintf(stderr, "Error: can't allocate memory (%d Kbytes)\n",
-					(int) (file_length / 1024L));
+					(int) (jam_file.length / 1024L));
 				exit_status = 1;
 			}
 			else
 			{
 #if PORT == DOS
-				int pages = 1 + (int) (file_length >> 14L);
+				int pages = 1 + (int) (jam_file.length >> 14L);
 				int page;
 				size_t page_size = 0x4000;
 				for (page = 0; (page < pages) && (exit_status == 0); ++page)
@@ -1284,26 +2326,133 @@ if (optind < argc)
 					if (page == (pages - 1))
 					{
 						/* last page may not be full 16K bytes */
-						page_size = (size_t) (file_length & 0x3fffL);
+						page_size = (size_t) (jam_file.length & 0x3fffL);
 					}
-					if (fread(file_buffer[page], 1, page_size, fp) != page_size)
+					if (fread(jam_file.buffer[page], 1, page_size, fp) != page_size)
 					{
 						fprintf(stderr, "Error reading file \"%s\"\n", filename);
 						exit_status = 1;
 					}
 				}
 #else
-				if (fread(file_buffer, 1, (size_t) file_length, fp) !=
-					(size_t) file_length)
+				if (fread(jam_file.buffer, 1, (size_t) jam_file.length, fp) !=
+					(size_t) jam_file.length)
 				{
 					fprintf(stderr, "Error reading file \"%s\"\n", filename);
 					exit_status = 1;
 				}
 #endif
 			}
-
-			fclose(fp);
+
+			fclose(fp);
+		}
+#endif
+
+		if (exit_status == 0)
+		{
+			/*
+			*	Create the interpreter context, which gives jam_getc()
+			*	and jam_seek() access to the file buffer
+			*/
+			context = jam_create_context(&jam_file);
+
+			if (context == NULL)
+			{
+				fprintf(stderr, "Error: can't allocate memory for interpreter context\n");
+				exit_status = 1;
+			}
+			else
+			{
+				jam_set_context(context);
+#if PORT != DOS
+				/* the whole program is in jam_file.buffer */
+				jam_set_direct_scan(context, TRUE);
+#endif
+			}
+		}
+
+#if PORT == OPENBMC_AST
+		/*
+		*	Set up the chains.  The first one uses the context and
+		*	workspace made above, the others get their own.
+		*/
+		for (i = 0; i < chain_count; ++i)
+		{
+			chain = &chains[i];
+			chain->file = jam_file;
+			chain->device_path = chain_paths[i];
+			if (i == 0) chain->workspace = workspace;
+			if (i == 0) chain->context = context;
+			chain->action = action;
+			chain->init_list = init_list;
+			chain->reset_jtag = reset_jtag;
+			chain->workspace_size = workspace_size;
+			chain->exec_result = JAMC_SUCCESS;
+			chain->error_line = 0L;
+			chain->exit_code = 0;
+			chain->format_version = 0;
+			thread_started[i] = FALSE;
+		}
+
+		if ((exit_status == 0) && (cache_directory != NULL))
+		{
+			jam_cache_open(cache_directory, cache_limit, verbose,
+				jam_file.buffer, jam_file.length, cache_add_array);
+		}
+
+		for (i = 1; (i < chain_count) && (exit_status == 0); ++i)
+		{
+			chain = &chains[i];
+			chain->context = jam_create_context(&chain->file);
+
+			if ((chain->context == NULL) || ((workspace_size > 0) &&
+				((chain->workspace = (char *) jam_malloc(
+				(size_t) workspace_size)) == NULL)))
+			{
+				fprintf(stderr, "Error: can't allocate memory for chain \"%s\"\n",
+					chain->device_path);
+				exit_status = 1;
+			}
+		}
+
+		for (i = 0; (i < chain_count) && (exit_status == 0); ++i)
+		{
+			chain = &chains[i];
+
+			jam_set_code_limit(chain->context, code_limit);
+			jam_set_array_cache(chain->context, array_cache);
+			jam_set_direct_scan(chain->context, TRUE);
+
+			if (chain_count > 1)
+			{
+				/* messages of each chain start with its device path */
+				chain->prefix = (char *) jam_malloc(
+					(unsigned int) strlen(chain->device_path) + 3);
+
+				if (chain->prefix == NULL)
+				{
+					fprintf(stderr, "Error: can't allocate memory for chain \"%s\"\n",
+						chain->device_path);
+					exit_status = 1;
+				}
+				else
+				{
+					sprintf(chain->prefix, "%s: ", chain->device_path);
+				}
+			}
+
+			if ((chain_count > 1) || (decode_thread_count > 0) ||
+				(cache_directory != NULL))
+			{
+				jam_share_arrays(chain->context, &shared_arrays);
+			}
+
+			if (cache_directory != NULL)
+			{
+				jam_store_index(chain->context, &jam_cache_index);
+			}
 		}
+#endif
 
 		if (exit_status == 0)
 		{
@@ -1320,15 +2469,28 @@ if (optind < argc)
 			calibrate_delay();
 
 			/*
-			*	Check CRC
+			*	Load the program, which checks the CRC
 			*/
-			crc_result = jam_check_crc(
+#if PORT == OPENBMC_AST
+			/* a cache file was made by a run which checked the CRC */
+			if (!jam_cache_crc(&crc_result, &expected_crc, &actual_crc))
+#endif
+			{
+				crc_result = jam_load_program(
 #if PORT==DOS
-				0L, 0L,
+					0L, 0L,
 #else
-				file_buffer, file_length,
+					jam_file.buffer, jam_file.length,
 #endif
-				&expected_crc, &actual_crc);
+					&program_info);
+
+				if (crc_result == JAMC_SUCCESS)
+				{
+					crc_result = program_info.crc_status;
+					expected_crc = program_info.expected_crc;
+					actual_crc = program_info.actual_crc;
+				}
+			}
 
 			if (verbose || (crc_result == JAMC_CRC_ERROR))
 			{
@@ -1363,7 +2525,7 @@ if (optind < argc)
 #if PORT==DOS
 					0L, 0L,
 #else
-					file_buffer, file_length,
+					jam_file.buffer, jam_file.length,
 #endif
 					&offset, key, value, 256) == 0)
 				{
@@ -1375,85 +2537,103 @@ if (optind < argc)
 			*	Execute the JAM program
 			*/
 			time(&start_time);
-			exec_result = jam_execute(
-#if PORT==DOS
-				0L, 0L,
-#else
-				file_buffer, file_length,
-#endif
-				workspace, workspace_size, action, init_list,
-				reset_jtag, &error_line, &exit_code, &format_version);
-			time(&end_time);
+#if PORT == OPENBMC_AST
+			/* statements are now read where the program jumps to */
+			if (program_mapped)
+			{
+				madvise(jam_file.buffer, (size_t) jam_file.length, MADV_NORMAL);
+			}
+
+			if (verbose) report_startup(&jam_file);
 
-			exit_status = -1;
-			if (exec_result == JAMC_SUCCESS)
+			if (decode_thread_count == 0) shared_arrays.prefetch = NULL;
+
+			/* the decode threads read the program through their own copy */
+			decode_file = jam_file;
+
+			for (i = 0; i < decode_thread_count; ++i)
+			{
+				decode_thread_started[i] = (pthread_create(
+					&decode_threads[i], NULL, decode_thread, &decode_file) == 0);
+			}
+
+			if (chain_count == 1)
+			{
+				chains[0].prefix = "";
+				run_chain(&chains[0]);
+			}
+			else
 			{
-				exit_status = 0;
-				if (format_version == 2)
+				/* program the chains in parallel, one thread each */
+				for (i = 0; i < chain_count; ++i)
 				{
-					switch (exit_code)
-					{
-					case  0: exit_string = "Success"; break;
-					case  1: exit_string = "Checking chain failure"; break;
-					case  2: exit_string = "Reading IDCODE failure"; break;
-					case  3: exit_string = "Reading USERCODE failure"; break;
-					case  4: exit_string = "Reading UESCODE failure"; break;
-					case  5: exit_string = "Entering ISP failure"; break;
-					case  6: exit_string = "Unrecognized device"; break;
-					case  7: exit_string = "Device revision is not supported"; break;
-					case  8: exit_string = "Erase failure"; break;
-					case  9: exit_string = "Device is not blank"; break;
-					case 10: exit_string = "Device programming failure"; break;
-					case 11: exit_string = "Device verify failure"; break;
-					case 12: exit_string = "Read failure"; break;
-					case 13: exit_string = "Calculating checksum failure"; break;
-					case 14: exit_string = "Setting security bit failure"; break;
-					case 15: exit_string = "Querying security bit failure"; break;
-					case 16: exit_string = "Exiting ISP failure"; break;
-					case 17: exit_string = "Performing system test failure"; break;
-					default: exit_string = "Unknown exit code"; break;
-					}
+					thread_started[i] = (pthread_create(&chains[i].thread,
+						NULL, chain_thread, &chains[i]) == 0);
+
+					if (!thread_started[i]) chain_thread(&chains[i]);
 				}
-				else
+
+				for (i = 0; i < chain_count; ++i)
 				{
-					switch (exit_code)
-					{
-					case 0: exit_string = "Success"; break;
-					case 1: exit_string = "Illegal initialization values"; break;
-					case 2: exit_string = "Unrecognized device"; break;
-					case 3: exit_string = "Device revision is not supported"; break;
-					case 4: exit_string = "Device programming failure"; break;
-					case 5: exit_string = "Device is not blank"; break;
-					case 6: exit_string = "Device verify failure"; break;
-					case 7: exit_string = "SRAM configuration failure"; break;
-					default: exit_string = "Unknown exit code"; break;
-					}
+					if (thread_started[i]) pthread_join(chains[i].thread, NULL);
 				}
-				if (exit_code != 0)
-					exit_status = exit_code;
-				printf("Exit code = %d... %s\n", exit_code, exit_string);
 			}
-			else if ((format_version == 2) &&
-				(exec_result == JAMC_ACTION_NOT_FOUND))
+			time(&end_time);
+
+			/* arrays still queued are not needed any more */
+			pthread_mutex_lock(&shared_array_mutex);
+			array_jobs_stopped = TRUE;
+			pthread_cond_broadcast(&array_job_cond);
+			pthread_mutex_unlock(&shared_array_mutex);
+
+			for (i = 0; i < decode_thread_count; ++i)
 			{
-				if ((action == NULL) || (*action == '\0'))
-				{
-					printf("Error: no action specified for Jam file.\nProgram terminated.\n");
-				}
-				else
+				if (decode_thread_started[i])
 				{
-					printf("Error: action \"%s\" is not supported for this Jam file.\nProgram terminated.\n", action);
+					pthread_join(decode_threads[i], NULL);
 				}
 			}
-			else if (exec_result < MAX_ERROR_CODE)
+
+			/* the first failing chain gives the exit status */
+			exit_status = 0;
+			for (i = 0; i < chain_count; ++i)
 			{
-				printf("Error on line %ld: %s.\nProgram terminated.\n",
-					error_line, error_text[exec_result]);
+				chain = &chains[i];
+				status = report_result(chain->prefix, chain->exec_result,
+					chain->error_line, chain->exit_code,
+					chain->format_version, action);
+
+				if (exit_status == 0) exit_status = status;
 			}
-			else
+
+			if (verbose) report_array_times(&jam_file);
+
+			/* keep what this run decoded if the program ran to the end */
+			status = (cache_directory != NULL);
+			for (i = 0; i < chain_count; ++i)
+			{
+				if (chains[i].exec_result != JAMC_SUCCESS) status = 0;
+			}
+
+			if (status)
 			{
-				printf("Unknown error code %d\n", exec_result);
+				jam_cache_write(jam_file.length, crc_result,
+					expected_crc, actual_crc, cache_next_array);
 			}
+#else
+			exec_result = jam_execute(
+#if PORT==DOS
+				0L, 0L,
+#else
+				jam_file.buffer, jam_file.length,
+#endif
+				workspace, workspace_size, action, init_list,
+				reset_jtag, &error_line, &exit_code, &format_version);
+			time(&end_time);
+
+			exit_status = report_result("", exec_result, error_line,
+				exit_code, format_version, action);
+#endif
 
 			/*
 			*	Print out elapsed time
@@ -1471,8 +2651,41 @@ if (optind < argc)
 
 	if (jtag_hardware_initialized) close_jtag_hardware();
 
+#if PORT == OPENBMC_AST
+	for (i = 1; i < chain_count; ++i)
+	{
+		if (chains[i].context != NULL) jam_free_context(chains[i].context);
+		if (chains[i].workspace != NULL) jam_free(chains[i].workspace);
+	}
+	for (i = 0; (i < chain_count) && (chain_count > 1); ++i)
+	{
+		if (chains[i].prefix != NULL) jam_free(chains[i].prefix);
+	}
+	while (array_job_list != NULL)
+	{
+		struct array_job *next = array_job_list->next;
+		jam_free(array_job_list);
+		array_job_list = next;
+	}
+	while (shared_array_list != NULL)
+	{
+		struct shared_array *next = shared_array_list->next;
+		if ((shared_array_list->data != NULL) && !shared_array_list->cached)
+		{
+			jam_free(shared_array_list->data);
+		}
+		jam_free(shared_array_list);
+		shared_array_list = next;
+	}
+	jam_cache_close();
+#endif
+	if (context != NULL) jam_free_context(context);
 	if (workspace != NULL) jam_free(workspace);
-	if (file_buffer != NULL) jam_free(file_buffer);
+#if PORT == OPENBMC_AST
+	unmap_program(&jam_file);
+#else
+	if (jam_file.buffer != NULL) jam_free(jam_file.buffer);
+#endif
 
 	#if defined(MEM_TRACKER)
 	if (verbose)
@@ -1903,10 +3116,26 @@ void initialize_jtag_hardware()
 #endif
 
 #if PORT == OPENBMC_AST
-	device_fd = open(device_path, O_RDWR);
+	transport_open = (transport->open(device_path) == 0);
 #endif
 }
 
+#if PORT == OPENBMC_AST
+BOOL jtag_device_ready(void)
+{
+	if (!jtag_hardware_initialized)
+	{
+		initialize_jtag_hardware();
+		if (!transport_open) {
+			return FALSE;
+		}
+		jtag_hardware_initialized = TRUE;
+	}
+
+	return TRUE;
+}
+#endif /* PORT == OPENBMC_AST */
+
 void close_jtag_hardware()
 {
 #if PORT != OPENBMC_AST
@@ -1931,11 +3160,335 @@ void close_jtag_hardware()
 #endif
 	}
 #else
-	if (device_fd >=0)
-       close (device_fd);
+	if (transport_open) transport->close();
+
+	transport_open = FALSE;
 #endif
 }
 
+#if PORT == OPENBMC_AST
+/************************************************************************
+*
+*	OpenBMC JTAG driver transport
+*/
+
+int aspeed_open(char *device_path)
+{
+	struct jtag_mode mode;
+	unsigned int frequency = 0;
+
+	device_fd = open(device_path, O_RDWR);
+
+	if (device_fd < 0)
+	{
+		fprintf(stderr, "Error:  Could not find OpenBMC JTAG driver handle\n");
+		return (-1);
+	}
+
+	/*
+	*	Let the controller shift IR/DR scans in hardware.  Drivers
+	*	without this mode still handle JTAG_IOCXFER in software.
+	*/
+	mode.feature = JTAG_XFER_MODE;
+	mode.mode = JTAG_XFER_HW_MODE;
+	ioctl(device_fd, JTAG_SIOCMODE, &mode);
+
+	/* remember the driver's TCK rate so FREQUENCY can restore it */
+	if (ioctl(device_fd, JTAG_GIOCFREQ, &frequency) == 0)
+	{
+		default_frequency = (long) frequency;
+	}
+
+	return (0);
+}
+
+void aspeed_close(void)
+{
+	if (bitbang_count > 0) flush_bitbang();
+
+	if (device_fd >= 0)
+	{
+		close(device_fd);
+		device_fd = -1;
+	}
+}
+
+int aspeed_clock(int tms, int tdi, int read_tdo)
+{
+	int entry = 0;
+
+	if (sleep_ms != 0)
+	{
+		usleep(sleep_ms);
+	}
+
+	entry = bitbang_count;
+	bitbang_buffer[entry].tms = (tms != 0) ? 1 : 0;
+	bitbang_buffer[entry].tdi = (tdi != 0) ? 1 : 0;
+	bitbang_buffer[entry].tdo = 0;
+	++bitbang_count;
+
+	/*
+	*	Only go to the driver when TDO is needed, the queue is full,
+	*	or a delay between clocks was requested
+	*/
+	if (read_tdo || (sleep_ms != 0) || (bitbang_count >= BITBANG_BUFFER_SIZE))
+	{
+		flush_bitbang();
+	}
+
+	return (read_tdo ? bitbang_buffer[entry].tdo : 0);
+}
+
+int aspeed_tms_sequence(int count, int tms_bits)
+{
+	int i = 0;
+
+	/* a per-clock sleep needs one request per clock */
+	if (sleep_ms != 0)
+	{
+		return (-1);
+	}
+
+	/*
+	*	Queue the whole state move as one burst
+	*/
+	for (i = 0; i < count; ++i)
+	{
+		if (bitbang_count >= BITBANG_BUFFER_SIZE) flush_bitbang();
+
+		bitbang_buffer[bitbang_count].tms = (tms_bits >> i) & 1;
+		bitbang_buffer[bitbang_count].tdi = 0;
+		bitbang_buffer[bitbang_count].tdo = 0;
+		++bitbang_count;
+	}
+
+	return (0);
+}
+
+int aspeed_shift(int count, char *tdi, char *tdo)
+{
+	int i = 0;
+	int first_bit = 0;
+	int first_entry = 0;
+
+	/* a per-clock sleep needs one request per clock */
+	if (sleep_ms != 0)
+	{
+		return (-1);
+	}
+
+	/*
+	*	Queue the whole scan
+	*/
+	while (i < count)
+	{
+		first_bit = i;
+		first_entry = bitbang_count;
+
+		while ((i < count) && (bitbang_count < BITBANG_BUFFER_SIZE))
+		{
+			bitbang_buffer[bitbang_count].tms = (i == count - 1) ? 1 : 0;
+			bitbang_buffer[bitbang_count].tdi =
+				(tdi[i >> 3] & (1 << (i & 7))) ? 1 : 0;
+			bitbang_buffer[bitbang_count].tdo = 0;
+			++bitbang_count;
+			++i;
+		}
+
+		/* TDO is copied out when the queue goes to the driver */
+		if (tdo != NULL)
+		{
+			bitbang_reads[bitbang_read_count].tdo = tdo;
+			bitbang_reads[bitbang_read_count].first_bit = first_bit;
+			bitbang_reads[bitbang_read_count].first_entry = first_entry;
+			bitbang_reads[bitbang_read_count].count = i - first_bit;
+			++bitbang_read_count;
+		}
+
+		if ((bitbang_count >= BITBANG_BUFFER_SIZE) ||
+			(bitbang_read_count >= BITBANG_READ_COUNT))
+		{
+			flush_bitbang();
+		}
+	}
+
+	return (0);
+}
+
+int aspeed_idle(int tms, long cycles)
+{
+	struct bitbang_packet bb_packet;
+	long count = 0L;
+
+	/* a per-clock sleep needs one request per clock */
+	if (sleep_ms != 0)
+	{
+		return (-1);
+	}
+
+	tms = (tms != 0) ? 1 : 0;
+
+	if (bitbang_count + cycles <= BITBANG_BUFFER_SIZE)
+	{
+		/* short waits just join the queue */
+		for (count = 0L; count < cycles; ++count)
+		{
+			bitbang_buffer[bitbang_count].tms = tms;
+			bitbang_buffer[bitbang_count].tdi = 0;
+			bitbang_buffer[bitbang_count].tdo = 0;
+			++bitbang_count;
+		}
+
+		if (bitbang_count >= BITBANG_BUFFER_SIZE) flush_bitbang();
+	}
+	else
+	{
+		/* queued clocks must reach the TAP before the wait */
+		if (bitbang_count > 0) flush_bitbang();
+
+		if (idle_buffer_tms != tms)
+		{
+			for (count = 0L; count < IDLE_BUFFER_SIZE; ++count)
+			{
+				idle_buffer[count].tms = tms;
+				idle_buffer[count].tdi = 0;
+				idle_buffer[count].tdo = 0;
+			}
+			idle_buffer_tms = tms;
+		}
+
+		while (cycles > 0L)
+		{
+			count = (cycles > IDLE_BUFFER_SIZE) ? IDLE_BUFFER_SIZE : cycles;
+			bb_packet.length = (__u32) count;
+			bb_packet.data = idle_buffer;
+			ioctl(device_fd, JTAG_IOCBITBANG, &bb_packet);
+			cycles -= count;
+		}
+	}
+
+	return (0);
+}
+
+int aspeed_scan
+(
+	int ir_scan,
+	int start_state,
+	int end_state,
+	int count,
+	char *tdi,
+	char *tdo
+)
+{
+	struct jtag_xfer xfer;
+	char *buffer = (tdo != NULL) ? tdo : tdi;
+	int i = 0;
+
+	/*
+	*	A per-clock sleep can only be honored by bit-banging
+	*/
+	if ((!xfer_supported) || (sleep_ms != 0))
+	{
+		return (-1);
+	}
+
+	/* the driver shifts TDI from, and returns TDO in, the same buffer */
+	if ((tdo != NULL) && (tdo != tdi))
+	{
+		for (i = 0; i < ((count + 7) >> 3); ++i)
+		{
+			tdo[i] = tdi[i];
+		}
+	}
+
+	/* queued clocks must reach the TAP before the transfer */
+	if (bitbang_count > 0) flush_bitbang();
+
+	xfer.type = ir_scan ? JTAG_SIR_XFER : JTAG_SDR_XFER;
+	xfer.direction = (tdo != NULL) ? JTAG_READ_WRITE_XFER : JTAG_WRITE_XFER;
+	xfer.from = (__u8) start_state;
+	xfer.endstate = (__u8) end_state;
+	xfer.padding = 0;
+	xfer.length = (__u32) count;
+	xfer.tdio = (__u64) (unsigned long) buffer;
+
+	if (ioctl(device_fd, JTAG_IOCXFER, &xfer) < 0)
+	{
+		xfer_supported = FALSE;
+
+		if (verbose)
+		{
+			printf("JTAG driver rejected JTAG_IOCXFER, using bit-bang scans\n");
+			fflush(stdout);
+		}
+
+		return (-1);
+	}
+
+	return (0);
+}
+
+int aspeed_frequency(long hertz)
+{
+	unsigned int frequency = 0;
+
+	/*
+	*	Only a limit is programmed.  The default (-1) restores the rate
+	*	the driver had when it was opened, and a stopped clock (0) is
+	*	not supported by the driver.
+	*/
+	frequency = (unsigned int) ((hertz > 0L) ? hertz : default_frequency);
+
+	if (frequency == 0)
+	{
+		return (-1);
+	}
+
+	/* the new rate applies to clocks issued from here on */
+	if (bitbang_count > 0) flush_bitbang();
+
+	return ((ioctl(device_fd, JTAG_SIOCFREQ, &frequency) < 0) ? -1 : 0);
+}
+
+void flush_bitbang(void)
+{
+	struct bitbang_packet bb_packet;
+	struct bitbang_read *read = NULL;
+	int entry = 0;
+	int bit = 0;
+	int i = 0;
+
+	bb_packet.length = bitbang_count;
+	bb_packet.data = bitbang_buffer;
+	if ((device_fd >= 0) && (bitbang_count > 0))
+           ioctl(device_fd, JTAG_IOCBITBANG, &bb_packet);
+
+	/* queue entries now hold the TDO values of the scans in the queue */
+	for (i = 0; i < bitbang_read_count; ++i)
+	{
+		read = &bitbang_reads[i];
+		entry = read->first_entry;
+
+		for (bit = read->first_bit;
+			bit < read->first_bit + read->count; ++bit, ++entry)
+		{
+			if (bitbang_buffer[entry].tdo)
+			{
+				read->tdo[bit >> 3] |= (1 << (bit & 7));
+			}
+			else
+			{
+				read->tdo[bit >> 3] &= ~(unsigned int) (1 << (bit & 7));
+			}
+		}
+	}
+
+	bitbang_count = 0;
+	bitbang_read_count = 0;
+}
+#endif /* PORT == OPENBMC_AST */
+
 #if PORT == WINDOWS
 /**************************************************************************/
 /*                                                                        */
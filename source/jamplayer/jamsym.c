@@ -13,26 +13,21 @@
 /*					structures.  Actual symbols now live at the top of the	*/
 /*					workspace, and grow dynamically downwards in memory.	*/
 /*																			*/
+/*					1.2 the table is searched by open addressing and grows	*/
+/*					as symbols are added.  Each record holds its name,		*/
+/*					allocated to its length.								*/
+/*																			*/
 /****************************************************************************/
 
 #include "jamexprt.h"
 #include "jamdefs.h"
 #include "jamsym.h"
+#include "jamstack.h"
 #include "jamheap.h"
+#include "jamjtag.h"
 #include "jamutil.h"
+#include "jamctx.h"
 #include <stddef.h>
-/****************************************************************************/
-/*																			*/
-/*	Global variables														*/
-/*																			*/
-/****************************************************************************/
-
-JAMS_SYMBOL_RECORD **jam_symbol_table = NULL;
-
-void *jam_symbol_bottom = NULL;
-
-extern BOOL jam_checking_uses_list;
-
 /****************************************************************************/
 /*																			*/
 
@@ -40,7 +35,10 @@ JAM_RETURN_TYPE jam_init_symbol_table()
 
 /*																			*/
 /*	Description:	Initializes the symbol table.  The symbol table is		*/
-/*					located at the beginning of the workspace buffer.		*/
+/*					located at the beginning of the workspace buffer,		*/
+/*					where space for JAMC_MAX_SYMBOL_COUNT pointers is		*/
+/*					kept for it.  It starts with JAMC_SYMBOL_TABLE_SIZE		*/
+/*					slots, and grows as symbols are added.					*/
 /*																			*/
 /*	Returns:		JAMC_SUCCESS for success, or JAMC_OUT_OF_MEMORY if the	*/
 /*					size of the workspace buffer is too small to hold the	*/
@@ -48,9 +46,12 @@ JAM_RETURN_TYPE jam_init_symbol_table()
 /*																			*/
 /****************************************************************************/
 {
-	int index = 0;
+	long index = 0L;
 	JAM_RETURN_TYPE status = JAMC_SUCCESS;
 
+	jam_symbol_table_size = JAMC_SYMBOL_TABLE_SIZE;
+	jam_symbol_count = 0L;
+
 	if (jam_workspace != NULL)
 	{
 		jam_symbol_table = (JAMS_SYMBOL_RECORD **) jam_workspace;
@@ -67,7 +68,7 @@ JAM_RETURN_TYPE jam_init_symbol_table()
 	else
 	{
 		jam_symbol_table = (JAMS_SYMBOL_RECORD **) jam_malloc(
-			(JAMC_MAX_SYMBOL_COUNT * sizeof(void *)));
+			(unsigned int) (jam_symbol_table_size * sizeof(void *)));
 
 		if (jam_symbol_table == NULL)
 		{
@@ -77,7 +78,7 @@ JAM_RETURN_TYPE jam_init_symbol_table()
 
 	if (status == JAMC_SUCCESS)
 	{
-		for (index = 0; index < JAMC_MAX_SYMBOL_COUNT; ++index)
+		for (index = 0L; index < jam_symbol_table_size; ++index)
 		{
 			jam_symbol_table[index] = NULL;
 		}
@@ -88,25 +89,24 @@ JAM_RETURN_TYPE jam_init_symbol_table()
 
 void jam_free_symbol_table()
 {
-	int hash = 0;
-	JAMS_SYMBOL_RECORD *symbol_record = NULL;
-	JAMS_SYMBOL_RECORD *next = NULL;
+	long index = 0L;
 
 	if ((jam_symbol_table != NULL) && (jam_workspace == NULL))
 	{
-		for (hash = 0; hash < JAMC_MAX_SYMBOL_COUNT; ++hash)
+		for (index = 0L; index < jam_symbol_table_size; ++index)
 		{
-			symbol_record = jam_symbol_table[hash];
-			while (symbol_record != NULL)
+			if (jam_symbol_table[index] != NULL)
 			{
-				next = symbol_record->next;
-				jam_free(symbol_record);
-				symbol_record = next;
+				jam_free(jam_symbol_table[index]);
 			}
 		}
 
 		jam_free(jam_symbol_table);
 	}
+
+	jam_symbol_table = NULL;
+	jam_symbol_table_size = 0L;
+	jam_symbol_count = 0L;
 }
 
 /****************************************************************************/
@@ -225,6 +225,161 @@ int jam_hash
 /****************************************************************************/
 /*																			*/
 
+unsigned long jam_symbol_hash
+(
+	char *name
+)
+
+/*																			*/
+/*	Description:	Calculates the hash value of a symbolic name for the	*/
+/*					symbol table (32-bit FNV-1a).  Every character of the	*/
+/*					name counts, so that names which differ only near the	*/
+/*					beginning do not land in the same slot.					*/
+/*																			*/
+/*	Returns:		The hash value											*/
+/*																			*/
+/****************************************************************************/
+{
+	unsigned long hash = 2166136261UL;
+
+	while (*name != JAMC_NULL_CHAR)
+	{
+		hash ^= (unsigned long) (unsigned char) *name++;
+		hash = (hash * 16777619UL) & 0xffffffffUL;
+	}
+
+	return (hash);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAMS_SYMBOL_RECORD **jam_find_symbol_slot
+(
+	char *name,
+	unsigned long hash
+)
+
+/*																			*/
+/*	Description:	Searches the symbol table for a name, starting at the	*/
+/*					slot given by its hash value and going on through the	*/
+/*					following slots until the name or an empty slot is		*/
+/*					found.  The table always has empty slots.				*/
+/*																			*/
+/*	Returns:		Pointer to the slot of the symbol record, or to the		*/
+/*					empty slot where it would be added						*/
+/*																			*/
+/****************************************************************************/
+{
+	long mask = jam_symbol_table_size - 1L;
+	long index = (long) (hash & (unsigned long) mask);
+	JAMS_SYMBOL_RECORD *symbol_record = NULL;
+
+	while ((symbol_record = jam_symbol_table[index]) != NULL)
+	{
+		if ((symbol_record->name[0] == name[0]) &&
+			(jam_strcmp(symbol_record->name, name) == 0))
+		{
+			break;
+		}
+
+		index = (index + 1L) & mask;
+	}
+
+	return (&jam_symbol_table[index]);
+}
+
+/****************************************************************************/
+/*																			*/
+
+JAM_RETURN_TYPE jam_grow_symbol_table
+(
+	void
+)
+
+/*																			*/
+/*	Description:	Doubles the number of slots in the symbol table, and	*/
+/*					moves every record to its slot in the new table.  In a	*/
+/*					workspace, the new table is taken from the top, below	*/
+/*					the symbol records, and the space of the old one is		*/
+/*					not used again.											*/
+/*																			*/
+/*	Returns:		JAMC_SUCCESS for success, or JAMC_OUT_OF_MEMORY			*/
+/*																			*/
+/****************************************************************************/
+{
+	long index = 0L;
+	long old_size = jam_symbol_table_size;
+	long new_size = old_size * 2L;
+	long mask = new_size - 1L;
+	long slot = 0L;
+	JAMS_SYMBOL_RECORD **old_table = jam_symbol_table;
+	JAMS_SYMBOL_RECORD **new_table = NULL;
+	JAM_RETURN_TYPE status = JAMC_SUCCESS;
+
+	if (jam_workspace != NULL)
+	{
+		new_table = (JAMS_SYMBOL_RECORD **) (((long)jam_symbol_bottom) -
+			(new_size * (long) sizeof(void *)));
+
+		if ((long)jam_heap_top > (long)new_table)
+		{
+			status = JAMC_OUT_OF_MEMORY;
+		}
+		else
+		{
+			jam_symbol_bottom = (void *) new_table;
+		}
+	}
+	else
+	{
+		new_table = (JAMS_SYMBOL_RECORD **) jam_malloc(
+			(unsigned int) (new_size * sizeof(void *)));
+
+		if (new_table == NULL)
+		{
+			status = JAMC_OUT_OF_MEMORY;
+		}
+	}
+
+	if (status == JAMC_SUCCESS)
+	{
+		for (index = 0L; index < new_size; ++index)
+		{
+			new_table[index] = NULL;
+		}
+
+		for (index = 0L; index < old_size; ++index)
+		{
+			if (old_table[index] != NULL)
+			{
+				slot = (long) (jam_symbol_hash(old_table[index]->name) &
+					(unsigned long) mask);
+
+				while (new_table[slot] != NULL)
+				{
+					slot = (slot + 1L) & mask;
+				}
+
+				new_table[slot] = old_table[index];
+			}
+		}
+
+		jam_symbol_table = new_table;
+		jam_symbol_table_size = new_size;
+
+		if (jam_workspace == NULL)
+		{
+			jam_free(old_table);
+		}
+	}
+
+	return (status);
+}
+
+/****************************************************************************/
+/*																			*/
+
 JAM_RETURN_TYPE jam_add_symbol
 (
 	JAME_SYMBOL_TYPE type,
@@ -248,15 +403,14 @@ JAM_RETURN_TYPE jam_add_symbol
 /*																			*/
 /****************************************************************************/
 {
-	char r, l;
 	int ch_index = 0;
-	int hash = 0;
+	long size = 0L;
+	unsigned long hash = 0UL;
 	long init_list_value = 0L;
-	BOOL match = FALSE;
 	BOOL identical_redeclaration = FALSE;
 	JAM_RETURN_TYPE status = JAMC_SUCCESS;
 	JAMS_SYMBOL_RECORD *symbol_record = NULL;
-	JAMS_SYMBOL_RECORD *prev_symbol_record = NULL;
+	JAMS_SYMBOL_RECORD **slot = NULL;
 
 	/*
 	*	Check for legal characters in name, and legal name length
@@ -272,33 +426,15 @@ JAM_RETURN_TYPE jam_add_symbol
 	}
 
 	/*
-	*	Get hash key for this name
-	*/
-	hash = jam_hash(name);
-
-	/*
-	*	Get pointer to first symbol record corresponding to this hash key
-	*/
-	symbol_record = jam_symbol_table[hash];
-
-	/*
-	*	Then check for duplicate entry in symbol table
+	*	Find the slot for this name, and check for a duplicate entry
 	*/
-	while ((status == JAMC_SUCCESS) && (symbol_record != NULL) &&
-		(!identical_redeclaration))
+	if (status == JAMC_SUCCESS)
 	{
-		match = TRUE;
-		ch_index = 0;
-		do
-		{
-			r = symbol_record->name[ch_index];
-			l = name[ch_index];
-			match = (r == l);
-			++ch_index;
-		}
-		while (match && (r != '\0') && (l != '\0'));
+		hash = jam_symbol_hash(name);
+		slot = jam_find_symbol_slot(name, hash);
+		symbol_record = *slot;
 
-		if (match)
+		if (symbol_record != NULL)
 		{
 			/*
 			*	Check if symbol was already declared identically
@@ -327,6 +463,7 @@ JAM_RETURN_TYPE jam_add_symbol
 				*	For identical redeclaration, simply assign the value
 				*/
 				identical_redeclaration = TRUE;
+				jam_jtag_symbol_access(symbol_record);
 
 				if (jam_version != 2)
 				{
@@ -348,9 +485,6 @@ JAM_RETURN_TYPE jam_add_symbol
 				status = JAMC_REDEFINED_SYMBOL;
 			}
 		}
-
-		prev_symbol_record = symbol_record;
-		symbol_record = symbol_record->next;
 	}
 
 	/*
@@ -375,12 +509,32 @@ JAM_RETURN_TYPE jam_add_symbol
 		}
 
 		/*
-		*	Add the symbol
+		*	Keep at least half of the slots empty, or a quarter in a
+		*	workspace, where the space of an old table is lost
 		*/
-		if (jam_workspace != NULL)
+		if ((jam_symbol_count + 1L) * ((jam_workspace != NULL) ? 4L : 2L) >
+			jam_symbol_table_size * ((jam_workspace != NULL) ? 3L : 1L))
 		{
+			status = jam_grow_symbol_table();
+
+			if (status == JAMC_SUCCESS)
+			{
+				slot = jam_find_symbol_slot(name, hash);
+			}
+		}
+
+		/*
+		*	Add the symbol, in a record just long enough for its name
+		*/
+		size = (long) sizeof(JAMS_SYMBOL_RECORD) + ch_index;
+
+		if ((status == JAMC_SUCCESS) && (jam_workspace != NULL))
+		{
+			size = (size + (long) sizeof(long) - 1L) &
+				~((long) sizeof(long) - 1L);
+
 			jam_symbol_bottom = (void *)
-				(((long)jam_symbol_bottom) - sizeof(JAMS_SYMBOL_RECORD));
+				(((long)jam_symbol_bottom) - size);
 
 			symbol_record = (JAMS_SYMBOL_RECORD *) jam_symbol_bottom;
 
@@ -389,10 +543,10 @@ JAM_RETURN_TYPE jam_add_symbol
 				status = JAMC_OUT_OF_MEMORY;
 			}
 		}
-		else
+		else if (status == JAMC_SUCCESS)
 		{
 			symbol_record = (JAMS_SYMBOL_RECORD *)
-				jam_malloc(sizeof(JAMS_SYMBOL_RECORD));
+				jam_malloc((unsigned int) size);
 
 			if (symbol_record == NULL)
 			{
@@ -406,25 +560,10 @@ JAM_RETURN_TYPE jam_add_symbol
 			symbol_record->value = value;
 			symbol_record->position = position;
 			symbol_record->parent = jam_current_block;
-			symbol_record->next = NULL;
-
-			if (prev_symbol_record == NULL)
-			{
-				jam_symbol_table[hash] = symbol_record;
-			}
-			else
-			{
-				prev_symbol_record->next = symbol_record;
-			}
+			jam_strcpy(symbol_record->name, name);
 
-			ch_index = 0;
-			while ((ch_index < JAMC_MAX_NAME_LENGTH) &&
-				(name[ch_index] != '\0'))
-			{
-				symbol_record->name[ch_index] = name[ch_index];
-				++ch_index;
-			}
-			symbol_record->name[ch_index] = '\0';
+			*slot = symbol_record;
+			++jam_symbol_count;
 		}
 	}
 
@@ -448,50 +587,29 @@ JAM_RETURN_TYPE jam_get_symbol_record
 /*																			*/
 /****************************************************************************/
 {
-	char r, l;
 	char save_ch = 0;
 	int ch_index = 0;
-	int hash = 0;
 	int name_begin = 0;
 	int name_end = 0;
-	BOOL match = FALSE;
 	JAMS_SYMBOL_RECORD *tmp_symbol_record = NULL;
 	JAM_RETURN_TYPE status = JAMC_UNDEFINED_SYMBOL;
 
 	/*
-	*	Get hash key for this name
+	*	Search for name in symbol table
 	*/
-	hash = jam_hash(name);
+	tmp_symbol_record = *jam_find_symbol_slot(name, jam_symbol_hash(name));
 
-	/*
-	*	Get pointer to first symbol record corresponding to this hash key
-	*/
-	tmp_symbol_record = jam_symbol_table[hash];
+	if (tmp_symbol_record != NULL)
+	{
+		status = JAMC_SUCCESS;
+	}
 
 	/*
-	*	Search for name in symbol table
+	*	A scan may still owe this symbol its captured data
 	*/
-	while ((!match) && (tmp_symbol_record != NULL))
+	if (status == JAMC_SUCCESS)
 	{
-		match = TRUE;
-		ch_index = 0;
-		do
-		{
-			r = tmp_symbol_record->name[ch_index];
-			l = name[ch_index];
-			match = (r == l);
-			++ch_index;
-		}
-		while (match && (r != '\0') && (l != '\0'));
-
-		if (match)
-		{
-			status = JAMC_SUCCESS;
-		}
-		else
-		{
-			tmp_symbol_record = tmp_symbol_record->next;
-		}
+		jam_jtag_symbol_access(tmp_symbol_record);
 	}
 
 	/*
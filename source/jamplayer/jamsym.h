@@ -7,6 +7,7 @@
 /*	Description:	Prototypes for symbol-table management functions		*/
 /*																			*/
 /*	Revisions:		1.1	added jam_free_symbol_table()						*/
+/*					1.2	open addressing table of interned names				*/
 /*																			*/
 /****************************************************************************/
 
@@ -36,38 +37,31 @@ typedef enum
 
 } JAME_SYMBOL_TYPE;
 
-/* symbol record structure */
+/*
+*	symbol record structure.  The record is allocated to the length of
+*	its name, which is kept only here.
+*/
 typedef struct JAMS_SYMBOL_STRUCT
 {
-	char name[JAMC_MAX_NAME_LENGTH + 1];
 	JAME_SYMBOL_TYPE type;
 	long value;
 	long position;
 	struct JAMS_SYMBOL_STRUCT *parent;
-	struct JAMS_SYMBOL_STRUCT *next;
+	char name[1];				/* symbol name */
 
 } JAMS_SYMBOL_RECORD;
 
-/****************************************************************************/
-/*																			*/
-/*	Global variables														*/
-/*																			*/
-/****************************************************************************/
-
-extern JAMS_SYMBOL_RECORD **jam_symbol_table;
-
-extern void *jam_symbol_bottom;
-
-extern JAMS_SYMBOL_RECORD *jam_current_block;
-
-extern int jam_version;
-
 /****************************************************************************/
 /*																			*/
 /*	Function prototypes														*/
 /*																			*/
 /****************************************************************************/
 
+int jam_hash
+(
+	char *name
+);
+
 JAM_RETURN_TYPE jam_init_symbol_table
 (
 	void
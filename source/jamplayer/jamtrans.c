@@ -0,0 +1,182 @@
+/****************************************************************************/
+/*																			*/
+/*	Module:			jamtrans.c												*/
+/*																			*/
+/*	Description:	JTAG transports that need no hardware.  The null		*/
+/*					transport discards every clock and reads TDO low, so	*/
+/*					the interpreter can be timed on its own.  The loopback	*/
+/*					transport returns each TDI bit on TDO one clock later.	*/
+/*																			*/
+/****************************************************************************/
+
+#include "jamexprt.h"
+#include "jamdefs.h"
+#include "jamtrans.h"
+
+/****************************************************************************/
+/*																			*/
+/*	Null transport															*/
+/*																			*/
+/****************************************************************************/
+
+int jam_null_open(char *device_path)
+{
+	device_path = device_path;
+
+	return (0);
+}
+
+void jam_null_close(void)
+{
+}
+
+int jam_null_clock(int tms, int tdi, int read_tdo)
+{
+	tms = tms;
+	tdi = tdi;
+	read_tdo = read_tdo;
+
+	return (0);
+}
+
+int jam_null_tms_sequence(int count, int tms_bits)
+{
+	count = count;
+	tms_bits = tms_bits;
+
+	return (0);
+}
+
+int jam_null_shift(int count, char *tdi, char *tdo)
+{
+	int i = 0;
+
+	tdi = tdi;
+
+	if (tdo != NULL)
+	{
+		for (i = 0; i < count; ++i)
+		{
+			tdo[i >> 3] &= ~(unsigned int) (1 << (i & 7));
+		}
+	}
+
+	return (0);
+}
+
+int jam_null_idle(int tms, long cycles)
+{
+	tms = tms;
+	cycles = cycles;
+
+	return (0);
+}
+
+JAMS_TRANSPORT jam_null_transport =
+{
+	"null",
+	"discards all clocks, TDO reads low",
+	jam_null_open,
+	jam_null_close,
+	jam_null_clock,
+	jam_null_tms_sequence,
+	jam_null_shift,
+	jam_null_idle,
+	NULL,
+	NULL,
+	NULL,
+	NULL
+};
+
+/****************************************************************************/
+/*																			*/
+/*	Loopback transport														*/
+/*																			*/
+/****************************************************************************/
+
+/* TDI of the previous clock, returned on TDO of the next one */
+JAM_THREAD int jam_loopback_tdi = 0;
+
+int jam_loopback_open(char *device_path)
+{
+	device_path = device_path;
+	jam_loopback_tdi = 0;
+
+	return (0);
+}
+
+void jam_loopback_close(void)
+{
+}
+
+int jam_loopback_clock(int tms, int tdi, int read_tdo)
+{
+	int tdo = jam_loopback_tdi;
+
+	tms = tms;
+	read_tdo = read_tdo;
+	jam_loopback_tdi = (tdi != 0) ? 1 : 0;
+
+	return (tdo);
+}
+
+int jam_loopback_tms_sequence(int count, int tms_bits)
+{
+	tms_bits = tms_bits;
+
+	/* TDI is held low during state moves */
+	if (count > 0) jam_loopback_tdi = 0;
+
+	return (0);
+}
+
+int jam_loopback_shift(int count, char *tdi, char *tdo)
+{
+	int i = 0;
+	int tdo_bit = 0;
+
+	for (i = 0; i < count; ++i)
+	{
+		tdo_bit = jam_loopback_tdi;
+		jam_loopback_tdi = (tdi[i >> 3] & (1 << (i & 7))) ? 1 : 0;
+
+		if (tdo != NULL)
+		{
+			if (tdo_bit)
+			{
+				tdo[i >> 3] |= (1 << (i & 7));
+			}
+			else
+			{
+				tdo[i >> 3] &= ~(unsigned int) (1 << (i & 7));
+			}
+		}
+	}
+
+	return (0);
+}
+
+int jam_loopback_idle(int tms, long cycles)
+{
+	tms = tms;
+
+	if (cycles > 0L) jam_loopback_tdi = 0;
+
+	return (0);
+}
+
+JAMS_TRANSPORT jam_loopback_transport =
+{
+	"loopback",
+	"TDO returns TDI delayed by one clock",
+	jam_loopback_open,
+	jam_loopback_close,
+	jam_loopback_clock,
+	jam_loopback_tms_sequence,
+	jam_loopback_shift,
+	jam_loopback_idle,
+	NULL,
+	NULL,
+	NULL,
+	NULL
+};
@@ -0,0 +1,62 @@
+/****************************************************************************/
+/*																			*/
+/*	Module:			jamtrans.h												*/
+/*																			*/
+/*	Description:	Definitions of the JTAG transport interface used by		*/
+/*					the stub to reach the JTAG chain						*/
+/*																			*/
+/****************************************************************************/
+
+#ifndef INC_JAMTRANS_H
+#define INC_JAMTRANS_H
+
+/****************************************************************************/
+/*																			*/
+/*	Type definitions														*/
+/*																			*/
+/****************************************************************************/
+
+/*
+*	A transport must provide open(), close() and clock().  The other
+*	operations may be NULL, or may return non-zero to decline a request,
+*	in which case the stub falls back to one clock() call per TCK.  If
+*	delay() is NULL or declines, WAIT delays are taken in real time.
+*
+*	Bit buffers hold the first bit in bit 0 of byte 0.  shift() clocks
+*	TMS high on the last bit only.  TAP states are JAME_JTAG_STATE values.
+*
+*	shift() may leave the TDO buffer unwritten until the next flush(), so
+*	the caller must keep the buffer until then.
+*/
+typedef struct JAMS_TRANSPORT_STRUCT
+{
+	char *name;
+	char *description;
+	int (*open)(char *device_path);
+	void (*close)(void);
+	int (*clock)(int tms, int tdi, int read_tdo);
+	int (*tms_sequence)(int count, int tms_bits);
+	int (*shift)(int count, char *tdi, char *tdo);
+	int (*idle)(int tms, long cycles);
+	int (*scan)(int ir_scan, int start_state, int end_state,
+		int count, char *tdi, char *tdo);
+	int (*frequency)(long hertz);
+	void (*flush)(void);
+	int (*delay)(long microseconds);
+
+} JAMS_TRANSPORT;
+
+/****************************************************************************/
+/*																			*/
+/*	Global variables														*/
+/*																			*/
+/****************************************************************************/
+
+extern JAMS_TRANSPORT jam_null_transport;
+extern JAMS_TRANSPORT jam_loopback_transport;
+extern JAMS_TRANSPORT jam_sim_transport;
+
+/* set by the stub, names the chain in messages of a multi-chain run */
+extern JAM_THREAD char *chain_prefix;
+
+#endif /* INC_JAMTRANS_H */
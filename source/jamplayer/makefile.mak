@@ -17,6 +17,12 @@ OBJS = \
 	jamarray.obj \
 	jamcomp.obj \
 	jamjtag.obj \
+	jamctx.obj \
+	jamcode.obj \
+	jamload.obj \
+	jamtrans.obj \
+	jamsim.obj \
+	jamcache.obj \
 	jamutil.obj \
 	jamexp.obj
 
@@ -47,29 +53,48 @@ jamexec.obj : \
 	jamstack.h \
 	jamheap.h \
 	jamarray.h \
-	jamjtag.h
+	jamjtag.h \
+	jamcomp.h \
+	jamcode.h \
+	jamload.h \
+	jamctx.h
 
 jamnote.obj : \
 	jamnote.c \
 	jamexprt.h \
 	jamdefs.h \
 	jamexec.h \
-	jamutil.h
+	jamsym.h \
+	jamstack.h \
+	jamheap.h \
+	jamjtag.h \
+	jamutil.h \
+	jamload.h \
+	jamctx.h
 
 jamcrc.obj : \
 	jamcrc.c \
 	jamexprt.h \
 	jamdefs.h \
 	jamexec.h \
-	jamutil.h
+	jamsym.h \
+	jamstack.h \
+	jamheap.h \
+	jamjtag.h \
+	jamutil.h \
+	jamload.h \
+	jamctx.h
 
 jamsym.obj : \
 	jamsym.c \
 	jamexprt.h \
 	jamdefs.h \
 	jamsym.h \
+	jamstack.h \
 	jamheap.h \
-	jamutil.h
+	jamjtag.h \
+	jamutil.h \
+	jamctx.h
 
 jamstack.obj : \
 	jamstack.c \
@@ -77,7 +102,10 @@ jamstack.obj : \
 	jamdefs.h \
 	jamutil.h \
 	jamsym.h \
-	jamstack.h
+	jamstack.h \
+	jamheap.h \
+	jamjtag.h \
+	jamctx.h
 
 jamheap.obj : \
 	jamheap.c \
@@ -87,7 +115,9 @@ jamheap.obj : \
 	jamsym.h \
 	jamstack.h \
 	jamheap.h \
-	jamutil.h
+	jamjtag.h \
+	jamutil.h \
+	jamctx.h
 
 jamarray.obj : \
 	jamarray.c \
@@ -98,9 +128,11 @@ jamarray.obj : \
 	jamsym.h \
 	jamstack.h \
 	jamheap.h \
+	jamjtag.h \
 	jamutil.h \
 	jamcomp.h \
-	jamarray.h
+	jamarray.h \
+	jamctx.h
 
 jamcomp.obj : \
 	jamcomp.c \
@@ -112,8 +144,67 @@ jamjtag.obj : \
 	jamexprt.h \
 	jamdefs.h \
 	jamsym.h \
+	jamstack.h \
+	jamheap.h \
 	jamutil.h \
-	jamjtag.h
+	jamjtag.h \
+	jamctx.h
+
+jamctx.obj : \
+	jamctx.c \
+	jamexprt.h \
+	jamdefs.h \
+	jamsym.h \
+	jamstack.h \
+	jamheap.h \
+	jamjtag.h \
+	jamcode.h \
+	jamload.h \
+	jamctx.h
+
+jamcode.obj : \
+	jamcode.c \
+	jamexprt.h \
+	jamdefs.h \
+	jamsym.h \
+	jamstack.h \
+	jamheap.h \
+	jamjtag.h \
+	jamcode.h \
+	jamutil.h \
+	jamctx.h
+
+jamload.obj : \
+	jamload.c \
+	jamexprt.h \
+	jamdefs.h \
+	jamexec.h \
+	jamsym.h \
+	jamstack.h \
+	jamheap.h \
+	jamjtag.h \
+	jamutil.h \
+	jamcode.h \
+	jamload.h \
+	jamctx.h
+
+jamtrans.obj : \
+	jamtrans.c \
+	jamexprt.h \
+	jamdefs.h \
+	jamtrans.h
+
+jamsim.obj : \
+	jamsim.c \
+	jamexprt.h \
+	jamjtag.h \
+	jamtrans.h
+
+jamcache.obj : \
+	jamcache.c \
+	jamport.h \
+	jamexprt.h \
+	jamcache.h
 
 jamutil.obj : \
 	jamutil.c \
@@ -125,7 +216,10 @@ jamexp.obj : \
 	jamdefs.h \
 	jamexp.h \
 	jamsym.h \
+	jamstack.h \
 	jamheap.h \
+	jamjtag.h \
 	jamarray.h \
 	jamutil.h \
-	jamytab.h
+	jamytab.h \
+	jamctx.h
@@ -0,0 +1,71 @@
+#!/bin/sh
+#
+# Runs the example programs on the simulated JTAG chain ("-t sim") and
+# compares the output of each run with the expected output.
+#
+# usage: sim_regression.sh <jam-player> <examples dir> <expected dir>
+#
+
+if [ $# -ne 3 ]; then
+	echo "usage: $0 <jam-player> <examples dir> <expected dir>" >&2
+	exit 2
+fi
+
+player=$1
+examples=$2
+expected=$3
+output=$(mktemp) || exit 2
+failed=0
+
+trap 'rm -f "$output"' EXIT
+
+# run_case <name> <program> <devices> [<options>...]
+run_case()
+{
+	name=$1
+	program=$2
+	devices=$3
+	shift 3
+
+	"$player" -t sim -j "$devices" "$@" "$examples/$program" > "$output" 2>&1
+
+	if diff -u "$expected/$name.out" "$output"; then
+		echo "PASS $name"
+	else
+		echo "FAIL $name"
+		failed=1
+	fi
+}
+
+# demo board programs, each on a chain of its own device
+for board in jam_demo_board/7064s:epm7064s jam_demo_board/9320:epm9320 \
+	jam_demo_board/3256a:isplsi3256a isp_demo_board/7128s:epm7128s \
+	isp_demo_board/9320:epm9320
+do
+	program=${board%%:*}.jam
+	device=${board##*:}
+	prefix=$(echo "${board%%:*}" | tr / _)
+
+	run_case "${prefix}_program" "$program" "$device" \
+		-dDO_PROGRAM=1 -dDO_VERIFY=1
+	run_case "${prefix}_erase" "$program" "$device" \
+		-dDO_ERASE=1 -dDO_BLANKCHECK=1
+done
+
+# the largest program in a fixed workspace
+run_case jam_demo_board_9320_workspace jam_demo_board/9320.jam epm9320 \
+	-m4000000 -dDO_PROGRAM=1 -dDO_VERIFY=1
+
+# language examples, which do not scan
+for program in "$examples"/how_to_use_jam/*.jam; do
+	program=how_to_use_jam/$(basename "$program")
+	prefix=$(echo "${program%.jam}" | tr / _)
+
+	if [ "$program" = how_to_use_jam/power.jam ]; then
+		run_case "$prefix" "$program" bypass -dnumber=2 -dpower=4
+	else
+		run_case "$prefix" "$program" bypass
+	fi
+done
+
+exit $failed
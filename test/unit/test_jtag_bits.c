@@ -0,0 +1,412 @@
+/****************************************************************************/
+/*																			*/
+/*	Module:			test_jtag_bits.c										*/
+/*																			*/
+/*	Description:	Checks the bit block primitives of jamjtag.c against	*/
+/*					the bit-by-bit loops they replaced, on random data,		*/
+/*					offsets and lengths, and times both.					*/
+/*																			*/
+/*					usage: test_jtag_bits [bench]							*/
+/*																			*/
+/*					With "bench", the copies are timed over more rounds.	*/
+/*																			*/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "jamexprt.h"
+#include "jamjtag.h"
+
+#define DATA_LONGS		64			/* 2048 bits of long array */
+#define BUFFER_CHARS	256			/* 2048 bits of scan buffer */
+#define DATA_BITS		(DATA_LONGS * 32L)
+#define BUFFER_BITS		(BUFFER_CHARS * 8L)
+#define TRIALS			100000L
+
+#define BENCH_BITS		32000L
+#define BENCH_ROUNDS	200
+#define BENCH_ROUNDS_LONG 20000
+
+/* lengths around the word boundaries are tried more often */
+static const long edge_lengths[] = { 0, 1, 31, 32, 33, 63, 64, 65 };
+
+#define EDGE_LENGTH_COUNT \
+	((int) (sizeof(edge_lengths) / sizeof(edge_lengths[0])))
+
+static unsigned long random_state = 0x2545f491UL;
+
+/****************************************************************************/
+/*																			*/
+
+static unsigned long random_bits(void)
+
+/*																			*/
+/*	Description:	xorshift generator, the same sequence on every host		*/
+/*																			*/
+/*	Returns:		32 random bits											*/
+/*																			*/
+/****************************************************************************/
+{
+	random_state ^= (random_state << 13) & 0xffffffffUL;
+	random_state ^= random_state >> 17;
+	random_state ^= (random_state << 5) & 0xffffffffUL;
+
+	return (random_state & 0xffffffffUL);
+}
+
+static long random_length(long limit)
+{
+	long length = 0L;
+
+	if ((random_bits() & 1) == 0)
+	{
+		length = edge_lengths[random_bits() % EDGE_LENGTH_COUNT];
+	}
+	else
+	{
+		length = (long) (random_bits() % 600UL);
+	}
+
+	return ((length > limit) ? limit : length);
+}
+
+/****************************************************************************/
+/*																			*/
+/*	Bit-by-bit loops of jam_jtag_concatenate_data() and						*/
+/*	jam_jtag_extract_target_data() before they were replaced				*/
+/*																			*/
+/****************************************************************************/
+
+static void old_copy_to_buffer
+(
+	char *buffer,
+	long buffer_index,
+	long *data,
+	long data_index,
+	long count
+)
+{
+	long i = 0L;
+	long j = data_index;
+
+	for (i = buffer_index; i < buffer_index + count; ++i, ++j)
+	{
+		if (data[j >> 5] & (1L << (j & 0x1f)))
+		{
+			buffer[i >> 3] |= (1 << (i & 7));
+		}
+		else
+		{
+			buffer[i >> 3] &= ~(unsigned int) (1 << (i & 7));
+		}
+	}
+}
+
+static void old_copy_from_buffer
+(
+	long *data,
+	long data_index,
+	char *buffer,
+	long buffer_index,
+	long count
+)
+{
+	long i = 0L;
+	long j = buffer_index;
+
+	for (i = data_index; i < data_index + count; ++i, ++j)
+	{
+		if (buffer[j >> 3] & (1 << (j & 7)))
+		{
+			data[i >> 5] |= (1L << (i & 0x1f));
+		}
+		else
+		{
+			data[i >> 5] &= ~(unsigned long) (1L << (i & 0x1f));
+		}
+	}
+}
+
+/****************************************************************************/
+/*																			*/
+/*	Checks																	*/
+/*																			*/
+/****************************************************************************/
+
+static void fill_random(long *data, char *buffer)
+{
+	int i = 0;
+
+	for (i = 0; i < DATA_LONGS; ++i)
+	{
+		/* the bits above bit 31 of a long are not part of the array */
+		data[i] = (long) (random_bits() | (random_bits() << 16 << 16));
+	}
+
+	for (i = 0; i < BUFFER_CHARS; ++i)
+	{
+		buffer[i] = (char) random_bits();
+	}
+}
+
+static int same_data(long *a, long *b)
+{
+	int i = 0;
+
+	for (i = 0; i < DATA_LONGS; ++i)
+	{
+		if (((unsigned long) (a[i] ^ b[i]) & 0xffffffffUL) != 0UL) return (0);
+	}
+
+	return (1);
+}
+
+static long overlapping_index(int copy, long last_index, long last_count,
+	long limit)
+{
+	long index = 0L;
+
+	/* half of the later copies start inside the range of the last one */
+	if ((copy > 0) && ((random_bits() & 1) == 0))
+	{
+		index = last_index + (long) (random_bits() %
+			(unsigned long) (last_count + 1L));
+	}
+	else
+	{
+		index = (long) (random_bits() % (unsigned long) (limit + 1L));
+	}
+
+	return ((index > limit) ? limit : index);
+}
+
+static int check_words(void)
+{
+	long data[DATA_LONGS];
+	char buffer[BUFFER_CHARS];
+	long old_data[DATA_LONGS];
+	char old_buffer[BUFFER_CHARS];
+	unsigned long bits = 0UL;
+	unsigned long expected = 0UL;
+	long index = 0L;
+	long trial = 0L;
+	int count = 0;
+	int i = 0;
+
+	for (trial = 0L; trial < TRIALS; ++trial)
+	{
+		fill_random(data, buffer);
+		memcpy(old_data, data, sizeof(data));
+		memcpy(old_buffer, buffer, sizeof(buffer));
+
+		count = (int) (random_bits() % 33UL);
+		index = (long) (random_bits() % (unsigned long) (DATA_BITS - 64L));
+		bits = random_bits();
+
+		/* reads: one bit at a time is the reference */
+		expected = 0UL;
+		for (i = 0; i < count; ++i)
+		{
+			if (data[(index + i) >> 5] & (1L << ((index + i) & 0x1f)))
+			{
+				expected |= 1UL << i;
+			}
+		}
+
+		if (jam_jtag_get_data_bits(data, index, count) != expected)
+		{
+			printf("get_data_bits(%ld, %d) differs\n", index, count);
+			return (1);
+		}
+
+		expected = 0UL;
+		for (i = 0; i < count; ++i)
+		{
+			if (buffer[(index + i) >> 3] & (1 << ((index + i) & 7)))
+			{
+				expected |= 1UL << i;
+			}
+		}
+
+		if (jam_jtag_get_buffer_bits(buffer, index, count) != expected)
+		{
+			printf("get_buffer_bits(%ld, %d) differs\n", index, count);
+			return (1);
+		}
+
+		/* writes: the bits around the block must be kept */
+		jam_jtag_set_data_bits(data, index, count, bits);
+		jam_jtag_set_buffer_bits(buffer, index, count, bits);
+
+		for (i = 0; i < count; ++i)
+		{
+			old_data[(index + i) >> 5] &=
+				~(unsigned long) (1L << ((index + i) & 0x1f));
+			if (bits & (1UL << i))
+			{
+				old_data[(index + i) >> 5] |= 1L << ((index + i) & 0x1f);
+			}
+
+			old_buffer[(index + i) >> 3] &=
+				~(unsigned int) (1 << ((index + i) & 7));
+			if (bits & (1UL << i))
+			{
+				old_buffer[(index + i) >> 3] |= (char) (1 << ((index + i) & 7));
+			}
+		}
+
+		if (!same_data(data, old_data) ||
+			(memcmp(buffer, old_buffer, sizeof(buffer)) != 0))
+		{
+			printf("set_bits(%ld, %d) differs\n", index, count);
+			return (1);
+		}
+	}
+
+	return (0);
+}
+
+static int check_copies(void)
+{
+	long data[DATA_LONGS];
+	char buffer[BUFFER_CHARS];
+	long old_data[DATA_LONGS];
+	char old_buffer[BUFFER_CHARS];
+	long data_index = 0L;
+	long buffer_index = 0L;
+	long count = 0L;
+	long last_count = 0L;
+	long trial = 0L;
+	int copy = 0;
+
+	for (trial = 0L; trial < TRIALS; ++trial)
+	{
+		fill_random(data, buffer);
+		memcpy(old_data, data, sizeof(data));
+		memcpy(old_buffer, buffer, sizeof(buffer));
+
+		/* three copies in a row, like preamble, target and postamble */
+		for (copy = 0; copy < 3; ++copy)
+		{
+			count = random_length(DATA_BITS / 2L);
+			data_index = (long) (random_bits() %
+				(unsigned long) (DATA_BITS - count + 1L));
+			buffer_index = overlapping_index(copy, buffer_index,
+				last_count, BUFFER_BITS - count);
+			last_count = count;
+
+			jam_jtag_copy_to_buffer(buffer, buffer_index,
+				data, data_index, count);
+			old_copy_to_buffer(old_buffer, buffer_index,
+				old_data, data_index, count);
+
+			if (memcmp(buffer, old_buffer, sizeof(buffer)) != 0)
+			{
+				printf("copy_to_buffer(%ld, %ld, %ld) differs\n",
+					buffer_index, data_index, count);
+				return (1);
+			}
+		}
+
+		for (copy = 0; copy < 3; ++copy)
+		{
+			count = random_length(DATA_BITS / 2L);
+			data_index = overlapping_index(copy, data_index,
+				last_count, DATA_BITS - count);
+			buffer_index = (long) (random_bits() %
+				(unsigned long) (BUFFER_BITS - count + 1L));
+			last_count = count;
+
+			jam_jtag_copy_from_buffer(data, data_index,
+				buffer, buffer_index, count);
+			old_copy_from_buffer(old_data, data_index,
+				old_buffer, buffer_index, count);
+
+			if (!same_data(data, old_data))
+			{
+				printf("copy_from_buffer(%ld, %ld, %ld) differs\n",
+					data_index, buffer_index, count);
+				return (1);
+			}
+		}
+	}
+
+	return (0);
+}
+
+/****************************************************************************/
+/*																			*/
+/*	Timing																	*/
+/*																			*/
+/****************************************************************************/
+
+static double seconds_since(clock_t begin)
+{
+	return ((double) (clock() - begin) / (double) CLOCKS_PER_SEC);
+}
+
+static void time_copies(int rounds)
+{
+	static long data[(BENCH_BITS / 32L) + 2L];
+	static char buffer[(BENCH_BITS / 8L) + 2L];
+	clock_t begin = 0;
+	int round = 0;
+	int i = 0;
+
+	for (i = 0; i < (int) ((BENCH_BITS / 32L) + 2L); ++i)
+	{
+		data[i] = (long) random_bits();
+	}
+
+	/* odd offsets on both sides, as with preamble bits */
+	begin = clock();
+	for (round = 0; round < rounds; ++round)
+	{
+		old_copy_to_buffer(buffer, 5L, data, 3L, BENCH_BITS);
+	}
+	printf("pack %ld bits, old: %8.3f us\n", BENCH_BITS,
+		seconds_since(begin) * 1e6 / rounds);
+
+	begin = clock();
+	for (round = 0; round < rounds; ++round)
+	{
+		jam_jtag_copy_to_buffer(buffer, 5L, data, 3L, BENCH_BITS);
+	}
+	printf("pack %ld bits, new: %8.3f us\n", BENCH_BITS,
+		seconds_since(begin) * 1e6 / rounds);
+
+	begin = clock();
+	for (round = 0; round < rounds; ++round)
+	{
+		old_copy_from_buffer(data, 3L, buffer, 5L, BENCH_BITS);
+	}
+	printf("unpack %ld bits, old: %8.3f us\n", BENCH_BITS,
+		seconds_since(begin) * 1e6 / rounds);
+
+	begin = clock();
+	for (round = 0; round < rounds; ++round)
+	{
+		jam_jtag_copy_from_buffer(data, 3L, buffer, 5L, BENCH_BITS);
+	}
+	printf("unpack %ld bits, new: %8.3f us\n", BENCH_BITS,
+		seconds_since(begin) * 1e6 / rounds);
+}
+
+int main(int argc, char **argv)
+{
+	int failed = 0;
+
+	failed = check_words() || check_copies();
+
+	printf("%s: %ld random cases of each primitive\n",
+		failed ? "FAIL" : "PASS", TRIALS);
+
+	if (!failed)
+	{
+		time_copies(((argc > 1) && (strcmp(argv[1], "bench") == 0)) ?
+			BENCH_ROUNDS_LONG : BENCH_ROUNDS);
+	}
+
+	return (failed);
+}
@@ -0,0 +1,357 @@
+/****************************************************************************/
+/*																			*/
+/*	Module:			test_packed_read.c										*/
+/*																			*/
+/*	Description:	Checks jam_read_packed(), which keeps its read position	*/
+/*					in a cursor, against the reader with static locals it	*/
+/*					replaced, on random data and field widths.  Also		*/
+/*					checks that jam_uncompress() gives the same output		*/
+/*					when several threads uncompress at once, and times		*/
+/*					both readers.											*/
+/*																			*/
+/*					usage: test_packed_read [bench]							*/
+/*																			*/
+/*					With "bench", the readers are timed over more rounds.	*/
+/*																			*/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "jamexprt.h"
+#include "jamcomp.h"
+
+#define BUFFER_CHARS	64
+#define TRIALS			100000L
+
+#define STREAM_COUNT	4			/* one per thread */
+#define STREAM_CHARS	20000L
+#define STREAM_ROUNDS	50
+
+#define BENCH_CHARS		65536L
+#define BENCH_ROUNDS	20
+#define BENCH_ROUNDS_LONG 2000
+
+#define	OLD_SHORT_BITS	16
+#define	OLD_CHAR_BITS	8
+
+static unsigned long random_state = 0x2545f491UL;
+
+/****************************************************************************/
+/*																			*/
+
+static unsigned long random_bits(void)
+
+/*																			*/
+/*	Description:	xorshift generator, the same sequence on every host		*/
+/*																			*/
+/*	Returns:		32 random bits											*/
+/*																			*/
+/****************************************************************************/
+{
+	random_state ^= (random_state << 13) & 0xffffffffUL;
+	random_state ^= random_state >> 17;
+	random_state ^= (random_state << 5) & 0xffffffffUL;
+
+	return (random_state & 0xffffffffUL);
+}
+
+/****************************************************************************/
+/*																			*/
+/*	jam_read_packed() before the cursor replaced its static locals			*/
+/*																			*/
+/****************************************************************************/
+
+static short old_read_packed(char *buffer, long length, short bits)
+{
+	short			result = -1;
+	static long		index = 0L;
+	static short	bits_avail = 0;
+	short			shift = 0;
+
+	/* If buffer is NULL then initialize. */
+	if (buffer == NULL)
+	{
+		index = 0;
+		bits_avail = OLD_CHAR_BITS;
+	}
+	else
+	{
+		result = 0;
+		while (result != -1 && bits > 0)
+		{
+			result = (short) (result | (((buffer[index] >> (OLD_CHAR_BITS - bits_avail)) & (0xFF >> (OLD_CHAR_BITS - bits_avail))) << shift));
+
+			if (bits <= bits_avail)
+			{
+				result = (short) (result & (0xFFFF >> (OLD_SHORT_BITS - (bits + shift))));
+				bits_avail = (short) (bits_avail - bits);
+				bits = 0;
+			}
+			else
+			{
+				/* Check for buffer overflow. */
+				if (++index >= length) result = -1;
+				else
+				{
+					shift = (short) (shift + bits_avail);
+					bits = (short) (bits - bits_avail);
+					bits_avail = OLD_CHAR_BITS;
+				}
+			}
+		}
+	}
+
+	return (result);
+}
+
+/****************************************************************************/
+/*																			*/
+/*	Checks																	*/
+/*																			*/
+/****************************************************************************/
+
+static int check_reads(void)
+{
+	char buffer[BUFFER_CHARS];
+	JAMS_PACKED_CURSOR cursor = { 0L, 0 };
+	long length = 0L;
+	long trial = 0L;
+	short bits = 0;
+	short expected = 0;
+	short result = 0;
+	int i = 0;
+
+	for (trial = 0L; trial < TRIALS; ++trial)
+	{
+		for (i = 0; i < BUFFER_CHARS; ++i)
+		{
+			buffer[i] = (char) random_bits();
+		}
+
+		length = 1L + (long) (random_bits() % BUFFER_CHARS);
+
+		old_read_packed(NULL, 0L, 0);
+		jam_read_packed(&cursor, NULL, 0L, 0);
+
+		/* read fields of 1 to 16 bits until the buffer is overrun */
+		do
+		{
+			bits = (short) (1 + (random_bits() % 16UL));
+			expected = old_read_packed(buffer, length, bits);
+			result = jam_read_packed(&cursor, buffer, length, bits);
+
+			if (result != expected)
+			{
+				printf("read of %d bits at byte %ld of %ld: %d, expected %d\n",
+					bits, cursor.index, length, result, expected);
+				return (1);
+			}
+		}
+		while (expected != -1);
+	}
+
+	return (0);
+}
+
+static void put_bits(char *out, long *position, long value, short bits)
+{
+	short i = 0;
+
+	/* least significant bit first, as jam_read_packed() reads them */
+	for (i = 0; i < bits; ++i, ++*position)
+	{
+		if (value & (1L << i))
+		{
+			out[*position >> 3] |= (char) (1 << (*position & 7));
+		}
+	}
+}
+
+static long make_stream(char *in, long in_length, char *expected,
+	long data_length)
+{
+	long position = 0L;
+	long i = 0L;
+	long j = 0L;
+	long offset = 0L;
+	long length = 0L;
+	long window = 0L;
+
+	memset(in, 0, (size_t) in_length);
+	put_bits(in, &position, data_length, 32);
+
+	/* version 2 data: literals of three bytes and back references */
+	while (i < data_length)
+	{
+		window = (i > 8191L) ? 8191L : i;
+
+		if ((window == 0L) || ((random_bits() & 1) == 0))
+		{
+			put_bits(in, &position, 0L, 1);
+			for (j = 0; (j < 3) && (i < data_length); ++j, ++i)
+			{
+				expected[i] = (char) random_bits();
+				put_bits(in, &position, (long) expected[i] & 0xffL, 8);
+			}
+		}
+		else
+		{
+			offset = 1L + (long) (random_bits() % (unsigned long) window);
+			length = (long) (random_bits() % 40UL);
+			put_bits(in, &position, 1L, 1);
+			put_bits(in, &position, offset,
+				jam_bits_required((short) window));
+			put_bits(in, &position, length, 8);
+			for (j = 0; (j < length) && (i < data_length); ++j, ++i)
+			{
+				expected[i] = expected[i - offset];
+			}
+		}
+	}
+
+	return ((position + 7L) >> 3);
+}
+
+typedef struct
+{
+	char in[STREAM_CHARS * 2L];
+	long in_length;
+	char expected[STREAM_CHARS];
+	char out[STREAM_CHARS];
+	int failed;
+
+} STREAM;
+
+static STREAM streams[STREAM_COUNT];
+
+/* the threads start together, so that their reads overlap */
+static pthread_barrier_t start_barrier;
+
+static void *uncompress_stream(void *arg)
+{
+	STREAM *stream = (STREAM *) arg;
+	int round = 0;
+
+	pthread_barrier_wait(&start_barrier);
+
+	for (round = 0; round < STREAM_ROUNDS; ++round)
+	{
+		if ((jam_uncompress(stream->in, stream->in_length,
+				stream->out, STREAM_CHARS, 2) != STREAM_CHARS) ||
+			(memcmp(stream->out, stream->expected, STREAM_CHARS) != 0))
+		{
+			stream->failed = 1;
+		}
+	}
+
+	return (NULL);
+}
+
+static int check_threads(void)
+{
+	pthread_t threads[STREAM_COUNT];
+	int failed = 0;
+	int i = 0;
+
+	for (i = 0; i < STREAM_COUNT; ++i)
+	{
+		streams[i].in_length = make_stream(streams[i].in,
+			(long) sizeof(streams[i].in), streams[i].expected, STREAM_CHARS);
+		streams[i].failed = 0;
+	}
+
+	pthread_barrier_init(&start_barrier, NULL, STREAM_COUNT);
+
+	for (i = 0; i < STREAM_COUNT; ++i)
+	{
+		pthread_create(&threads[i], NULL, uncompress_stream, &streams[i]);
+	}
+
+	for (i = 0; i < STREAM_COUNT; ++i)
+	{
+		pthread_join(threads[i], NULL);
+		if (streams[i].failed)
+		{
+			printf("uncompress of stream %d on its own thread differs\n", i);
+			failed = 1;
+		}
+	}
+
+	pthread_barrier_destroy(&start_barrier);
+
+	return (failed);
+}
+
+/****************************************************************************/
+/*																			*/
+/*	Timing																	*/
+/*																			*/
+/****************************************************************************/
+
+static double seconds_since(clock_t begin)
+{
+	return ((double) (clock() - begin) / (double) CLOCKS_PER_SEC);
+}
+
+static void time_reads(int rounds)
+{
+	static char buffer[BENCH_CHARS];
+	JAMS_PACKED_CURSOR cursor = { 0L, 0 };
+	clock_t begin = 0;
+	long sum = 0L;
+	int round = 0;
+	long i = 0L;
+
+	for (i = 0L; i < BENCH_CHARS; ++i)
+	{
+		buffer[i] = (char) random_bits();
+	}
+
+	/* a flag bit and a byte, as in the literal data of a stream */
+	begin = clock();
+	for (round = 0; round < rounds; ++round)
+	{
+		old_read_packed(NULL, 0L, 0);
+		while (old_read_packed(buffer, BENCH_CHARS, 1) != -1)
+		{
+			sum += old_read_packed(buffer, BENCH_CHARS, 8);
+		}
+	}
+	printf("read %ld bytes, old: %8.3f us\n", BENCH_CHARS,
+		seconds_since(begin) * 1e6 / rounds);
+
+	begin = clock();
+	for (round = 0; round < rounds; ++round)
+	{
+		jam_read_packed(&cursor, NULL, 0L, 0);
+		while (jam_read_packed(&cursor, buffer, BENCH_CHARS, 1) != -1)
+		{
+			sum -= jam_read_packed(&cursor, buffer, BENCH_CHARS, 8);
+		}
+	}
+	printf("read %ld bytes, new: %8.3f us\n", BENCH_CHARS,
+		seconds_since(begin) * 1e6 / rounds);
+
+	/* the same values were read, so the sums cancel */
+	if (sum != 0L) printf("readers disagree in the timed loop\n");
+}
+
+int main(int argc, char **argv)
+{
+	int failed = 0;
+
+	failed = check_reads() || check_threads();
+
+	printf("%s: %ld random reads, %d streams on %d threads\n",
+		failed ? "FAIL" : "PASS", TRIALS, STREAM_COUNT, STREAM_COUNT);
+
+	if (!failed)
+	{
+		time_reads(((argc > 1) && (strcmp(argv[1], "bench") == 0)) ?
+			BENCH_ROUNDS_LONG : BENCH_ROUNDS);
+	}
+
+	return (failed);
+}
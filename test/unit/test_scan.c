@@ -0,0 +1,376 @@
+/****************************************************************************/
+/*																			*/
+/*	Module:			test_scan.c												*/
+/*																			*/
+/*	Description:	Checks jam_get_statement() scanning the program in		*/
+/*					memory (jam_set_direct_scan()) against the character	*/
+/*					loop through jam_getc() that it replaced.  Both must	*/
+/*					give the same status, statement, label, positions and	*/
+/*					file pointer.  The programs are random text made of		*/
+/*					fragments, and fixed programs with quoted ; ' and :,	*/
+/*					comments inside comments and array data, cut at every	*/
+/*					length so that the last statement runs past the end		*/
+/*					of the program.  Also times both scans.					*/
+/*																			*/
+/*					usage: test_scan [bench]								*/
+/*																			*/
+/*					With "bench", the scans are timed over more rounds.		*/
+/*																			*/
+/****************************************************************************/
+
+/* the system headers come last, as jamdefs.h has its own NULL */
+#include "jamexprt.h"
+#include "jamdefs.h"
+#include "jamexec.h"
+#include "jamsym.h"
+#include "jamstack.h"
+#include "jamheap.h"
+#include "jamjtag.h"
+#include "jamload.h"
+#include "jamctx.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define PROGRAM_CHARS	4000
+#define TRIALS			100000L
+#define MAX_STATEMENTS	40
+
+#define STATEMENT_CHARS	300
+#define LABEL_CHARS		(JAMC_MAX_NAME_LENGTH + 8)
+
+#define BENCH_CHARS		200000L
+#define BENCH_ROUNDS	5
+#define BENCH_ROUNDS_LONG 200
+
+/* the text that the stub's jam_getc() and jam_seek() read */
+struct jam_file
+{
+	char *buffer;
+	long pointer;
+	long length;
+};
+
+/* the result of one jam_get_statement() */
+typedef struct
+{
+	JAM_RETURN_TYPE status;
+	long file_position;
+	long statement_position;
+	long next_statement_position;
+	long pointer;
+	char statement[STATEMENT_CHARS];
+	char label[LABEL_CHARS];
+
+} SCAN_RESULT;
+
+/* fragments which the random programs are made of */
+static const char *fragments[] =
+{
+	"'", "\"", ";", ":", "]", "[", "@", " ", "  ", "\t", "\n", "\r\n", "\r",
+	"BOOLEAN", "boolean", "x", "ABC", "lbl", "=", "$", "#", "12", "\xff",
+	"_", "a b", "hex", "@AB_c", "Q\x80", ";BOOLEAN ", ";BOOLEAN x\"]\"",
+	"; boolean v[3] = ", "\"a]b\"", "\"long quoted text here\"", "DATA",
+	";\n", "\"a;b\"", "\"it's\"", "\"x:y\"", "\"';:\"", "' a ' b \"c ; d\n",
+	"''\n", "L1: ", "#1011", "$0F;", "zap"
+};
+
+#define FRAGMENT_COUNT \
+	((int) (sizeof(fragments) / sizeof(fragments[0])))
+
+/* programs which are checked at every length */
+static const char *programs[] =
+{
+	"PRINT \"a;b\"; PRINT \"it's\"; PRINT \"x:y\"; PRINT \"';:\";\n",
+	"' comment ' inside a comment \"not a string ; :\nA = 1; ' ; \"\r\nB;",
+	"L1: BOOLEAN b[16] = #1011010111110000; L2: GOTO L1;\n",
+	"boolean v[8] = $0F\t\r\n; boolean w[64] = @AB_c0123;\nEXIT 0;",
+	"BOOLEAN s[8] = \"]\" #1; ' trailing comment with \" and :\nEXIT 0;",
+	"LABEL_THAT_IS_MUCH_LONGER_THAN_THIRTY_TWO_CHARS: X; A: B: C;"
+};
+
+#define PROGRAM_COUNT \
+	((int) (sizeof(programs) / sizeof(programs[0])))
+
+static unsigned long random_state = 0x2545f491UL;
+
+/****************************************************************************/
+/*																			*/
+
+static unsigned long random_bits(void)
+
+/*																			*/
+/*	Description:	xorshift generator, the same sequence on every host		*/
+/*																			*/
+/*	Returns:		32 random bits											*/
+/*																			*/
+/****************************************************************************/
+{
+	random_state ^= (random_state << 13) & 0xffffffffUL;
+	random_state ^= random_state >> 17;
+	random_state ^= (random_state << 5) & 0xffffffffUL;
+
+	return (random_state & 0xffffffffUL);
+}
+
+/****************************************************************************/
+/*																			*/
+/*	Scanning																*/
+/*																			*/
+/****************************************************************************/
+
+static void get_statement
+(
+	JAMS_CONTEXT *context,
+	struct jam_file *file,
+	int buffer_size,
+	SCAN_RESULT *result
+)
+{
+	jam_set_context(context);
+	jam_program = file->buffer;
+	jam_program_size = file->length;
+	jam_statement_buffer_size = buffer_size;
+
+	/* bytes past the end of the statement must not be written */
+	memset(result->statement, 0x55, sizeof(result->statement));
+	memset(result->label, 0x55, sizeof(result->label));
+
+	result->status = jam_get_statement(result->statement, result->label);
+	result->file_position = jam_current_file_position;
+	result->statement_position = jam_current_statement_position;
+	result->next_statement_position = jam_next_statement_position;
+	result->pointer = file->pointer;
+}
+
+static int same_result(SCAN_RESULT *a, SCAN_RESULT *b)
+{
+	return ((a->status == b->status) &&
+		(a->file_position == b->file_position) &&
+		(a->statement_position == b->statement_position) &&
+		(a->next_statement_position == b->next_statement_position) &&
+		(a->pointer == b->pointer) &&
+		(memcmp(a->statement, b->statement, sizeof(a->statement)) == 0) &&
+		(memcmp(a->label, b->label, sizeof(a->label)) == 0));
+}
+
+static int check_program(char *program, long length, int buffer_size)
+{
+	struct jam_file loop_file;
+	struct jam_file direct_file;
+	JAMS_CONTEXT *loop_context = NULL;
+	JAMS_CONTEXT *direct_context = NULL;
+	SCAN_RESULT loop;
+	SCAN_RESULT direct;
+	int failed = 0;
+	int i = 0;
+
+	loop_file.buffer = direct_file.buffer = program;
+	loop_file.pointer = direct_file.pointer = 0L;
+	loop_file.length = direct_file.length = length;
+
+	loop_context = jam_create_context(&loop_file);
+	direct_context = jam_create_context(&direct_file);
+	jam_set_direct_scan(direct_context, TRUE);
+
+	for (i = 0; (!failed) && (i < MAX_STATEMENTS); ++i)
+	{
+		get_statement(loop_context, &loop_file, buffer_size, &loop);
+		get_statement(direct_context, &direct_file, buffer_size, &direct);
+
+		if (!same_result(&loop, &direct))
+		{
+			printf("statement %d of %ld characters, buffer %d: "
+				"status %d/%d, position %ld/%ld, pointer %ld/%ld\n",
+				i, length, buffer_size, loop.status, direct.status,
+				loop.file_position, direct.file_position,
+				loop.pointer, direct.pointer);
+			printf("[%.*s]\n[%.*s]\n", buffer_size, loop.statement,
+				buffer_size, direct.statement);
+			failed = 1;
+		}
+
+		/* stop at the end of the program or at an error */
+		if (loop.status != JAMC_SUCCESS) break;
+	}
+
+	jam_set_context(NULL);
+	jam_free_context(loop_context);
+	jam_free_context(direct_context);
+
+	return (failed);
+}
+
+/****************************************************************************/
+/*																			*/
+/*	Checks																	*/
+/*																			*/
+/****************************************************************************/
+
+static long random_program(char *program, long limit)
+{
+	const char *fragment = NULL;
+	long length = 0L;
+	long fragment_length = 0L;
+	int count = (int) (random_bits() % 60UL);
+	int repeat = 0;
+	int i = 0;
+
+	for (i = 0; i < count; ++i)
+	{
+		fragment = fragments[random_bits() % FRAGMENT_COUNT];
+		fragment_length = (long) strlen(fragment);
+
+		/* some fragments are repeated, to fill the statement buffer */
+		repeat = ((random_bits() % 3UL) == 0UL) ?
+			1 + (int) (random_bits() % 30UL) : 1;
+
+		while ((repeat-- > 0) && (length + fragment_length <= limit))
+		{
+			memcpy(program + length, fragment, (size_t) fragment_length);
+			length += fragment_length;
+		}
+	}
+
+	return (length);
+}
+
+static int check_random(void)
+{
+	static char program[PROGRAM_CHARS];
+	long length = 0L;
+	long trial = 0L;
+	int buffer_size = 0;
+
+	for (trial = 0L; trial < TRIALS; ++trial)
+	{
+		length = random_program(program, PROGRAM_CHARS);
+		buffer_size = 1 + (int) (random_bits() % 60UL);
+
+		if ((random_bits() & 3) == 0)
+		{
+			buffer_size = STATEMENT_CHARS - 1;
+		}
+
+		if (check_program(program, length, buffer_size)) return (1);
+	}
+
+	return (0);
+}
+
+static int check_cut(void)
+{
+	static char program[PROGRAM_CHARS];
+	static const int buffer_sizes[] = { 1, 7, 8, 20, STATEMENT_CHARS - 1 };
+	long length = 0L;
+	long cut = 0L;
+	int i = 0;
+	int j = 0;
+
+	for (i = 0; i < PROGRAM_COUNT; ++i)
+	{
+		length = (long) strlen(programs[i]);
+		memcpy(program, programs[i], (size_t) length);
+
+		/* the program ends inside each statement, string and comment */
+		for (cut = 0L; cut <= length; ++cut)
+		{
+			for (j = 0; j < (int) (sizeof(buffer_sizes) / sizeof(int)); ++j)
+			{
+				if (check_program(program, cut, buffer_sizes[j]))
+				{
+					printf("program %d cut at %ld\n", i, cut);
+					return (1);
+				}
+			}
+		}
+	}
+
+	return (0);
+}
+
+/****************************************************************************/
+/*																			*/
+/*	Timing																	*/
+/*																			*/
+/****************************************************************************/
+
+static double seconds_since(clock_t begin)
+{
+	return ((double) (clock() - begin) / (double) CLOCKS_PER_SEC);
+}
+
+static double time_scan(char *program, long length, int direct, int rounds)
+{
+	static char statement[STATEMENT_CHARS];
+	char label[LABEL_CHARS];
+	struct jam_file file;
+	JAMS_CONTEXT *context = NULL;
+	clock_t begin = 0;
+	int round = 0;
+
+	file.buffer = program;
+	file.length = length;
+	context = jam_create_context(&file);
+	jam_set_direct_scan(context, direct);
+	jam_set_context(context);
+	jam_program = program;
+	jam_program_size = length;
+	jam_statement_buffer_size = STATEMENT_CHARS - 1;
+
+	begin = clock();
+	for (round = 0; round < rounds; ++round)
+	{
+		file.pointer = 0L;
+		jam_current_file_position = 0L;
+		while (jam_get_statement(statement, label) == JAMC_SUCCESS)
+		{
+		}
+	}
+
+	jam_set_context(NULL);
+	jam_free_context(context);
+
+	return (seconds_since(begin) * 1e6 / rounds);
+}
+
+static void time_scans(int rounds)
+{
+	static const char statement[] =
+		"BOOLEAN data[64] = #1011010111110000101101011111000010110101; "
+		"' set up the instruction register\r\n"
+		"IRSCAN 10, $2C5, CAPTURE ir_data[9..0];\r\n";
+	static char program[BENCH_CHARS];
+	long statement_length = (long) strlen(statement);
+	long length = 0L;
+
+	/* statements of the kind that make up a device program */
+	while (length + statement_length <= BENCH_CHARS)
+	{
+		memcpy(program + length, statement, (size_t) statement_length);
+		length += statement_length;
+	}
+
+	printf("scan %ld characters, old: %10.1f us\n", length,
+		time_scan(program, length, FALSE, rounds));
+	printf("scan %ld characters, new: %10.1f us\n", length,
+		time_scan(program, length, TRUE, rounds));
+}
+
+int main(int argc, char **argv)
+{
+	int failed = 0;
+
+	failed = check_random() || check_cut();
+
+	printf("%s: %ld random programs, %d programs cut at every length\n",
+		failed ? "FAIL" : "PASS", TRIALS, PROGRAM_COUNT);
+
+	if (!failed)
+	{
+		time_scans(((argc > 1) && (strcmp(argv[1], "bench") == 0)) ?
+			BENCH_ROUNDS_LONG : BENCH_ROUNDS);
+	}
+
+	return (failed);
+}